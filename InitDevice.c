@@ -75,10 +75,10 @@ extern void EMU_enter_DefaultMode_from_RESET(void) {
 	EMU_EM4Init_TypeDef em4Init = EMU_EM4INIT_DEFAULT;
 
 	em4Init.retainLfrco = 0;
-	em4Init.retainLfxo = 0;
+	em4Init.retainLfxo = 1;
 	em4Init.retainUlfrco = 0;
-	em4Init.em4State = emuEM4Shutoff;
-	em4Init.pinRetentionMode = emuPinRetentionDisable;
+	em4Init.em4State = emuEM4Hibernate;
+	em4Init.pinRetentionMode = emuPinRetentionLatch;
 
 	EMU_EM4Init(&em4Init);
 	// [EMU Initialization]$
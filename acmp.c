@@ -0,0 +1,143 @@
+/**
+ * @file acmp.c
+ * @brief The implementation for the joystick comparator
+ *
+ * This file implements the ACMP0 joystick watch. See the associated header
+ * file for function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "acmp.h"
+#include "cmu.h"
+#include "slp.h"
+#include "prof.h"
+#include "vtmr.h"
+#include "atom.h"
+
+/* Called when the line trips, NULL while not armed */
+static void (*volatile acmp_trip)(void) = NULL;
+
+/* ACMP_EM is blocked, and the timer that lets it go */
+static volatile uint32_t acmp_blocked = 0;
+static vtmr_t acmp_idle;
+
+/* The line stayed at rest, stop holding the system in EM3 */
+static void _acmp_release(void *arg) {
+	if (atom_xchg(&acmp_blocked, 0)) {
+		slp_unblockSleepMode(ACMP_EM);
+	}
+}
+
+void ACMP0_IRQHandler(void) {
+	PROF_ISR_ENTER(PROF_ACMP0);
+
+	void (*trip)(void) = acmp_trip;
+
+	ACMP_IntClear(ACMP0, ACMP_IFC_EDGE);
+
+	/* One shot, the ADC takes over the line */
+	acmp_disarm();
+
+	if (trip) {
+		trip();
+	}
+
+	PROF_ISR_EXIT(PROF_ACMP0);
+}
+
+bool acmp_arm(void (*trip)(void)) {
+
+	cmu_acquire(CMU_CLK_ACMP0);
+	ACMP_Enable(ACMP0);
+
+	/* Output is invalid until the comparator is up */
+	while (!(ACMP0->STATUS & ACMP_STATUS_ACMPACT));
+
+	/* Held before the interrupt can disarm it */
+	acmp_blocked = 1;
+	slp_blockSleepMode(ACMP_EM);
+	vtmr_start(&acmp_idle, VTMR_MS(ACMP_EM4_IDLE_MS), 0);
+
+	/* Armed before the output is read, an edge in between would otherwise
+	 * be cleared and missed */
+	acmp_trip = trip;
+	ACMP_IntClear(ACMP0, ACMP_IFC_EDGE);
+	ACMP_IntEnable(ACMP0, ACMP_IEN_EDGE);
+
+	/* Output is low while the line is below the threshold */
+	if (!(ACMP0->STATUS & ACMP_STATUS_ACMPOUT)) {
+		acmp_disarm();
+		return false;
+	}
+
+	return true;
+}
+
+void acmp_disarm(void) {
+	bool armed;
+
+	CORE_ATOMIC_IRQ_DISABLE();
+	armed = acmp_trip != NULL;
+	acmp_trip = NULL;
+	CORE_ATOMIC_IRQ_ENABLE();
+
+	if (!armed) {
+		return;
+	}
+
+	ACMP_IntDisable(ACMP0, ACMP_IEN_EDGE);
+	ACMP_Disable(ACMP0);
+	ACMP_IntClear(ACMP0, ACMP_IFC_EDGE);
+	cmu_release(CMU_CLK_ACMP0);
+
+	vtmr_stop(&acmp_idle);
+	_acmp_release(NULL);
+}
+
+void acmp_init(void) {
+
+	/* Structures */
+	ACMP_Init_TypeDef acmp_init = {
+		.biasProg = ACMP_BIAS,
+		.interruptOnFallingEdge = true,
+		.interruptOnRisingEdge = false,
+		.inputRange = acmpInputRangeFull,
+		.accuracy = acmpAccuracyLow,
+		.powerSource = acmpPowerSourceAvdd,
+		.hysteresisLevel_0 = acmpHysteresisLevel0,
+		.hysteresisLevel_1 = acmpHysteresisLevel0,
+		.vlpInput = acmpVLPInputVADIV,
+		.inactiveValue = false,
+		.enable = false,
+	};
+
+	/* The divider gives the hysteresis, div1 applies while the output is
+	 * high (line at rest) */
+	ACMP_VAConfig_TypeDef va_init = {
+		.input = acmpVAInputVDD,
+		.div0 = ACMP_JOY_RELEASE,
+		.div1 = ACMP_JOY_TRIP,
+	};
+
+	cmu_acquire(CMU_CLK_ACMP0);
+
+	/* Initialize operation */
+	ACMP_Init(ACMP0, &acmp_init);
+	ACMP_VAConfig(ACMP0, &va_init);
+	ACMP_ChannelSet(ACMP0, acmpInputVADIV, ACMP_JOY_INPUT);
+
+	/* Clear and enable interrupts */
+	ACMP_IntDisable(ACMP0, _ACMP_IEN_MASK);
+	ACMP_IntClear(ACMP0, _ACMP_IFC_MASK);
+	NVIC_ClearPendingIRQ(ACMP0_IRQn);
+	NVIC_EnableIRQ(ACMP0_IRQn);
+
+	cmu_release(CMU_CLK_ACMP0);
+
+	vtmr_create(&acmp_idle, _acmp_release, NULL);
+
+	return;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file acmp.h
+ * @brief Definitions and interfaces for the joystick comparator
+ *
+ * This file declares functions for ACMP0, which watches the joystick line
+ * against a fraction of VDD while the ADC is shut down. It stays powered in
+ * EM2 and EM3 and wakes the core when the joystick leaves its rest position.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __ACMP_H__
+#define __ACMP_H__
+
+#include "main.h"
+#include "em_acmp.h"
+
+/*
+ * @brief EM level, the comparator and its edge interrupt work down to EM3
+ */
+#define ACMP_EM 3
+
+/*
+ * @brief Time in ms the watch holds ACMP_EM with the line at rest
+ *
+ * Afterwards the system may go down to EM4H if nothing else keeps it in EM3.
+ * ACMP0 is off there, the EM4 wakeups (see slp.h) restart the firmware, which
+ * arms the watch again or samples a joystick that is being held.
+ */
+#define ACMP_EM4_IDLE_MS 60000
+
+/*
+ * @brief Joystick input (PA0, same as the ADC)
+ */
+#define ACMP_JOY_INPUT acmpInputAPORT3XCH8
+
+/*
+ * @brief Thresholds as VDD * (n + 1) / 64. The line trips below
+ * ACMP_JOY_TRIP (about 3776 counts, just under the classifier's rest band)
+ * and the comparator only flips back above ACMP_JOY_RELEASE.
+ */
+#define ACMP_JOY_TRIP 58
+#define ACMP_JOY_RELEASE 60
+
+/*
+ * @brief Bias current setting, the lowest one is plenty for a button
+ */
+#define ACMP_BIAS 0
+
+/**
+ * @brief Start watching the joystick line
+ *
+ * This function powers up the comparator, waits for it to settle and enables
+ * the edge interrupt. The callback runs once from the interrupt handler when
+ * the line trips, after which the comparator is powered down again. The
+ * output is read after the interrupt is enabled, so a trip in between is not
+ * lost, and if the line is already past the threshold the comparator is
+ * powered down right away. ACMP_EM is blocked for ACMP_EM4_IDLE_MS of the
+ * watch.
+ *
+ * @param trip Function to call when the line trips
+ *
+ * @return False if the line is already past the threshold
+ */
+bool acmp_arm(void (*trip)(void));
+
+/**
+ * @brief Stop watching the joystick line
+ *
+ * @return Void
+ */
+void acmp_disarm(void);
+
+/**
+ * @brief Initializes ACMP0
+ *
+ * This function configures the comparator inputs and thresholds, leaving it
+ * disabled until armed.
+ *
+ * @return Void
+ */
+void acmp_init(void);
+
+#endif /* __ACMP_H__ */
@@ -26,67 +26,301 @@
 #include "letimer.h"
 #include "slp.h"
 #include "bma280.h"
+#include "evt.h"
+#include "prof.h"
+#include "cmu.h"
+#include "dma.h"
+#include "atom.h"
+#include "acmp.h"
+#include "gest.h"
+#include "em_rtcc.h"
+#include "em_prs.h"
 
-static uint32_t adc_joystick = 0;
-static bool adc_debounce_flag = false;
-static int joystick_temp = 0;
-
-void ADC0_IRQHandler(void) {
-
-	if (ADC_IntGet(ADC0) & ADC_IF_SINGLECMP) {
-		ADC_IntClear(ADC0, ADC_IF_SINGLECMP | ADC_IF_SINGLE | ADC_IF_SINGLEUF | ADC_IF_SCANUF | ADC_IF_SINGLECMP);
-
-		/* Wait until the system sleeps again so there are no repeat commands */
-		if (adc_debounce_flag == false) {
-
-			/* Get command from joystick (read enough to clear FIFO */
-			for (int i = 0; i < 10; i++) {
-				adc_joystick = ADC_DataSingleGet(ADC0);
-			}
-
-			if (adc_joystick > ADC_JOY_UP_GT && adc_joystick < ADC_JOY_UP_LT) {
-				/* Want this to happen immediately */
-				//gpio_setLED1(true);
-				bma280_enable();
-			} else if (adc_joystick > ADC_JOY_RIGHT_GT && adc_joystick < ADC_JOY_RIGHT_LT) {
-				letimer_cmd_state[LETIMER_CMD_INC]++;
-			} else if (adc_joystick > ADC_JOY_LEFT_GT && adc_joystick < ADC_JOY_LEFT_LT) {
-				letimer_cmd_state[LETIMER_CMD_DEC]++;
-			} else if (adc_joystick > ADC_JOY_DOWN_GT && adc_joystick < ADC_JOY_DOWN_LT) {
-				/* Want this to happen immediately */
-				//gpio_setLED1(false);
-				bma280_disable();
-			} else if (adc_joystick > ADC_JOY_PRESS_GT && adc_joystick < ADC_JOY_PRESS_LT) {
-				letimer_cmd_state[LETIMER_CMD_RST]++;
-			} else {
-				/* Shouldn't happen under normal operation */
-				letimer_cmd_state[LETIMER_CMD_NONE]++;
-			}
-
-			/* Wait until the system sleeps again to act.
-			 * This effectively just captures the rising edge or first change */
-			adc_debounce_flag = true;
+/* LDMA descriptors per channel: stop, SINGLECTRL, SINGLECTRLX, FIFO clear,
+ * start, samples */
+#define ADC_DESC_PER_CH 6
+
+/* Bits of adc_ready, one per half and one set by the comparator */
+#define ADC_READY_HALVES 3
+#define ADC_READY_WAKE (1 << 2)
+
+/* ADC gating, the ADC runs during a burst and ACMP0 watches otherwise */
+typedef enum adc_state_e {
+	ADC_STATE_WATCH,
+	ADC_STATE_BURST
+} adc_state_t;
+
+/* Inputs of each channel */
+typedef struct adc_input_s {
+	ADC_PosSel_TypeDef pos;
+	ADC_Ref_TypeDef ref;
+	ADC_AcqTime_TypeDef acq;
+} adc_input_t;
+
+static const adc_input_t adc_input[ADC_NUM_CH] = {
+	[ADC_CH_JOY]  = { adcPosSelAPORT3XCH8, adcRefVDD,   adcAcqTime32 },
+	[ADC_CH_AVDD] = { adcPosSelAVDD,       adcRef5V,    adcAcqTime32 },
+	[ADC_CH_TEMP] = { adcPosSelTEMP,       adcRef1V25,  adcAcqTime64 },
+};
+
+/* Where each channel sits in a scan and its compare window */
+static const adc_layout_t adc_layout[ADC_NUM_CH] = {
+	[ADC_CH_JOY]  = { ADC_JOY_OFS,  ADC_BATCH,    ADC_JOY_GT,  ADC_JOY_LT  },
+	[ADC_CH_AVDD] = { ADC_AVDD_OFS, ADC_AVDD_OVS, ADC_AVDD_GT, ADC_AVDD_LT },
+	[ADC_CH_TEMP] = { ADC_TEMP_OFS, ADC_TEMP_OVS, ADC_TEMP_GT, ADC_TEMP_LT },
+};
+
+/* Sample ring filled by the LDMA, one scan per half */
+static volatile uint16_t adc_ring[2][ADC_SCAN_SIZE];
+static LDMA_Descriptor_t adc_desc[2][ADC_NUM_CH][ADC_DESC_PER_CH];
+static const LDMA_TransferCfg_t adc_dma_cfg =
+		LDMA_TRANSFER_CFG_PERIPHERAL(ldmaPeripheralSignal_ADC0_SINGLE);
+
+/* SINGLECTRL and SINGLECTRLX for each channel */
+static uint32_t adc_ctrl[ADC_NUM_CH];
+static uint32_t adc_ctrlx[ADC_NUM_CH];
+
+/* Temperature calibration */
+static adc_cal_t adc_cal;
+
+/* Latest scan */
+static adc_scan_t adc_scan;
+static bool adc_scan_valid = false;
+
+/* Bit n is set when half n is ready to be classified */
+static volatile uint32_t adc_ready = 0;
+
+/* Half the LDMA fills next */
+static uint32_t adc_half = 0;
+
+/* Joystick classifier and the position last reported */
+static joy_filter_t adc_joy_filter;
+static joy_t adc_joy = JOY_NONE;
+
+static adc_state_t adc_state = ADC_STATE_WATCH;
+
+/* Scans in a row with the joystick released */
+static uint32_t adc_idle = 0;
+
+/* Half of the ring done, called from the LDMA interrupt */
+static void _adc_dma_done(uint32_t ch) {
+	atom_or(&adc_ready, 1 << adc_half);
+	adc_half ^= 1;
+
+	evt_post(EVT_JOY);
+}
+
+#if ADC_ACMP
+/* Joystick line tripped ACMP0, called from its interrupt */
+static void _adc_wake(void) {
+	atom_or(&adc_ready, ADC_READY_WAKE);
+	evt_post(EVT_JOY);
+}
+#endif
+
+/* Power up the ADC and start filling the ring from the first half */
+static void _adc_start(void) {
+	cmu_acquire(CMU_CLK_ADC0);
+	slp_blockSleepMode(ADC_EM);
+
+	joy_filter_init(&adc_joy_filter);
+	adc_half = 0;
+	adc_idle = 0;
+	adc_state = ADC_STATE_BURST;
+
+#if ADC_PRS
+	/* The CRYOTIMER belongs to the sleep manager and never stops, only its
+	 * period is ours */
+	CRYOTIMER_PeriodSet(ADC_PRS_ACTIVE);
+	PRS_SourceSignalSet(ADC_PRS_CH, PRS_CH_CTRL_SOURCESEL_CRYOTIMER,
+			PRS_CH_CTRL_SIGSEL_CRYOTIMERPERIOD, prsEdgeOff);
+#endif
+
+	/* In continuous mode the descriptors also start the conversions */
+	LDMA_StartTransfer(DMA_CH_ADC, &adc_dma_cfg, &adc_desc[0][0][0]);
+}
+
+#if ADC_ACMP
+/* Stop the ring and power down the ADC, a half in progress is dropped */
+static void _adc_stop(void) {
+	LDMA_StopTransfer(DMA_CH_ADC);
+	ADC0->CMD = ADC_CMD_SINGLESTOP;
+
+#if ADC_PRS
+	PRS_SourceSignalSet(ADC_PRS_CH, PRS_CH_CTRL_SOURCESEL_NONE, 0, prsEdgeOff);
+#endif
+
+	atom_xchg(&adc_ready, 0);
+
+	slp_unblockSleepMode(ADC_EM);
+	cmu_release(CMU_CLK_ADC0);
+}
+
+/* Hand the joystick line to ACMP0. Both use the same APORT bus so the ADC
+ * must be stopped first. If the line is already past the threshold the
+ * burst goes on. */
+static void _adc_watch(void) {
+	if (adc_state == ADC_STATE_BURST) {
+		_adc_stop();
+	}
+
+	if (acmp_arm(_adc_wake)) {
+		adc_state = ADC_STATE_WATCH;
+	} else {
+		_adc_start();
+	}
+}
+#endif
+
+/* Act on a joystick gesture. Holding left or right keeps stepping the
+ * on-time, faster the longer it is held. */
+static void _adc_gest(gest_t gest, joy_t joy, uint32_t ms) {
+	if (gest != GEST_PRESS && gest != GEST_REPEAT) {
+		return;
+	}
+
+	switch (joy) {
+	case JOY_UP:
+		bma280_enable();
+		break;
+	case JOY_RIGHT:
+		letimer_cmd_post(LETIMER_CMD_INC);
+		break;
+	case JOY_LEFT:
+		letimer_cmd_post(LETIMER_CMD_DEC);
+		break;
+	case JOY_DOWN:
+		bma280_disable();
+		break;
+	case JOY_PRESS:
+		letimer_cmd_post(LETIMER_CMD_RST);
+		break;
+	case JOY_NONE:
+	default:
+		break;
+	}
+}
+
+/* Classify a batch in one pass, only a change of position is reported. The
+ * whole batch is stamped with the time it completed. */
+static void _adc_classify(const volatile uint16_t *samples, uint32_t n) {
+	uint32_t now = RTCC_CounterGet();
+	joy_t joy;
+
+	for (uint32_t i = 0; i < n; i++) {
+		joy = joy_classify(&adc_joy_filter, samples[i]);
+
+		if (joy != adc_joy) {
+			adc_joy = joy;
+			gest_update(joy, now);
 		}
+	}
+}
+
+/* Build the descriptors for one channel of one half. After switching
+ * channel, the samples (skipped ones first) go to the channel's place in the
+ * scan. All descriptors link to the next one, the caller closes the loop. */
+static void _adc_desc_build(uint32_t half, adc_ch_t ch) {
+	LDMA_Descriptor_t *d = adc_desc[half][ch];
+	uint32_t ofs = adc_layout[ch].ofs - ADC_SCAN_SKIP;
+
+	d[0] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_WRITE(
+			ADC_CMD_SINGLESTOP, &ADC0->CMD, 1);
+	d[1] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_WRITE(
+			adc_ctrl[ch], &ADC0->SINGLECTRL, 1);
+	d[2] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_WRITE(
+			adc_ctrlx[ch], &ADC0->SINGLECTRLX, 1);
+	d[3] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_WRITE(
+			ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR, &ADC0->SINGLEFIFOCLEAR, 1);
+	d[4] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_WRITE(
+			ADC_PRS ? 0 : ADC_CMD_SINGLESTART, &ADC0->CMD, 1);
+	d[5] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(
+			&ADC0->SINGLEDATA, &adc_ring[half][ofs],
+			adc_layout[ch].n + ADC_SCAN_SKIP, 1);
+	d[5].xfer.size = ldmaCtrlSizeHalf;
+}
 
+void adc_scan_parse(const adc_layout_t *layout, const volatile uint16_t *raw,
+		const adc_cal_t *cal, adc_scan_t *scan) {
+	uint32_t sum;
+	int32_t delta;
+
+	scan->alarm = 0;
+
+	for (int ch = 0; ch < ADC_NUM_CH; ch++) {
+		sum = 0;
+		for (uint32_t i = 0; i < layout[ch].n; i++) {
+			sum += raw[layout[ch].ofs + i];
+		}
+		scan->avg[ch] = (sum + layout[ch].n / 2) / layout[ch].n;
+
+		if (scan->avg[ch] < layout[ch].gt || scan->avg[ch] > layout[ch].lt) {
+			scan->alarm |= 1 << ch;
+		}
 	}
 
-	joystick_temp++;
-	return;
+	scan->avdd_mv = (uint32_t) scan->avg[ADC_CH_AVDD] * ADC_AVDD_REF_MV / 4096;
+
+	/* Sensor output falls as temperature rises, in tenths of a degree */
+	delta = (int32_t) cal->temp_read - scan->avg[ADC_CH_TEMP];
+	scan->temp_dc = cal->temp_c * 10 +
+			(int32_t) ((int64_t) delta * ADC_TEMP_REF_MV * 10000 /
+			(4096 * ADC_TEMP_SLOPE_UV));
 }
 
-void adc_debounce(void) {
-	/* Set a flag when going to sleep so we know the joystick action is valid again */
-	adc_debounce_flag = false;
-	return;
+bool adc_get_scan(adc_scan_t *scan) {
+	*scan = adc_scan;
+	return adc_scan_valid;
+}
+
+void adc_task(void) {
+	uint32_t ready = atom_xchg(&adc_ready, 0);
+
+	if ((ready & ADC_READY_WAKE) && adc_state == ADC_STATE_WATCH) {
+		_adc_start();
+		return;
+	}
+
+	for (uint32_t half = 0; half < 2; half++) {
+		if (ready & (1 << half)) {
+			adc_scan_parse(adc_layout, adc_ring[half], &adc_cal, &adc_scan);
+			adc_scan_valid = true;
+			_adc_classify(&adc_ring[half][ADC_JOY_OFS], ADC_BATCH);
+		}
+	}
+
+#if ADC_PRS && !ADC_ACMP
+	/* Sample faster while the joystick is in use, bursts always run fast */
+	CRYOTIMER_PeriodSet(adc_joy == JOY_NONE ? ADC_PRS_IDLE : ADC_PRS_ACTIVE);
+#endif
+
+#if ADC_ACMP
+	/* End the burst once the joystick has been released long enough */
+	if (ready & ADC_READY_HALVES) {
+		adc_idle = adc_joy == JOY_NONE ? adc_idle + 1 : 0;
+		if (adc_idle >= ADC_ACMP_IDLE) {
+			_adc_watch();
+		}
+	}
+#endif
 }
 
 void adc_init(void) {
 
+	gest_init(_adc_gest);
+
+	/* Clock is held for setup, afterwards only while the ADC runs */
+	cmu_acquire(CMU_CLK_ADC0);
+
 	/* Structures */
 	ADC_Init_TypeDef adc_init = {
+#if ADC_PRS
+		.em2ClockConfig = adcEm2ClockOnDemand,
+#else
 		.em2ClockConfig = adcEm2ClockAlwaysOn,
+#endif
 		.ovsRateSel = adcOvsRateSel2,
-		.prescale = 111, // Calculated for 200Hz
+		.prescale = ADC_PRESCALE,
 		.tailgate = false,
 		.timebase = _ADC_CTRL_TIMEBASE_DEFAULT,
 		.warmUpMode = adcWarmupNormal,
@@ -99,23 +333,47 @@ void adc_init(void) {
 		.leftAdjust = false,
 		.negSel = adcNegSelVSS,
 		.posSel = adcPosSelAPORT3XCH8,
-		.prsEnable = false,
-		.prsSel = adcPRSSELCh0,
+		.prsEnable = ADC_PRS,
+		.prsSel = ADC_PRS_SEL,
 		.reference = adcRefVDD,
-		.rep = true,
+		.rep = !ADC_PRS,
 		.resolution = adcRes12Bit,
-		.singleDmaEm2Wu = false,
+		.singleDmaEm2Wu = true,
 	};
 
+	LDMA_Descriptor_t *last;
+
 	/* Initialize operation */
 	ADC_Init(ADC0, &adc_init);
-	ADC_InitSingle(ADC0, &single_init);
 
-	/* Set compare */
-	ADC0->SINGLECTRL |= ADC_SINGLECTRL_CMPEN;
-	ADC0->CMPTHR = _ADC_CMPTHR_RESETVALUE;
-	ADC0->CMPTHR = (ADC_GT << _ADC_CMPTHR_ADGT_SHIFT) |
-				   (ADC_LT << _ADC_CMPTHR_ADLT_SHIFT);
+	/* Let emlib work out the control registers of each channel, the LDMA
+	 * writes them when switching */
+	for (int ch = ADC_NUM_CH - 1; ch >= 0; ch--) {
+		single_init.posSel = adc_input[ch].pos;
+		single_init.reference = adc_input[ch].ref;
+		single_init.acqTime = adc_input[ch].acq;
+		ADC_InitSingle(ADC0, &single_init);
+		adc_ctrl[ch] = ADC0->SINGLECTRL;
+		adc_ctrlx[ch] = ADC0->SINGLECTRLX;
+	}
+
+	/* One scan per half, each half raises the done interrupt and the second
+	 * links back to the first */
+	for (uint32_t half = 0; half < 2; half++) {
+		for (int ch = 0; ch < ADC_NUM_CH; ch++) {
+			_adc_desc_build(half, (adc_ch_t) ch);
+		}
+		adc_desc[half][ADC_NUM_CH - 1][ADC_DESC_PER_CH - 1].xfer.doneIfs = 1;
+	}
+	last = &adc_desc[1][ADC_NUM_CH - 1][ADC_DESC_PER_CH - 1];
+	last->xfer.linkAddr = -(int32_t) ((last - &adc_desc[0][0][0]) *
+			sizeof(LDMA_Descriptor_t)) / 4;
+
+	/* Factory temperature sensor calibration */
+	adc_cal.temp_read = (DEVINFO->ADC0CAL3 & _DEVINFO_ADC0CAL3_TEMPREAD1V25_MASK)
+			>> _DEVINFO_ADC0CAL3_TEMPREAD1V25_SHIFT;
+	adc_cal.temp_c = (DEVINFO->CAL & _DEVINFO_CAL_TEMP_MASK)
+			>> _DEVINFO_CAL_TEMP_SHIFT;
 
 	/* Clear any interrupts */
 	ADC0->IFC |= ADC_IFC_PROGERR |
@@ -128,18 +386,24 @@ void adc_init(void) {
 			ADC_IFC_SINGLEOF;
 	ADC_IntClear(ADC0, ADC_IF_SINGLECMP | ADC_IF_SINGLE | ADC_IF_SINGLEUF | ADC_IF_SCANUF | ADC_IF_SINGLECMP);
 
-	/* Set interrupt */
-	ADC0->IEN |= ADC_IEN_SINGLECMP;
+#if ADC_PRS
+	/* Conversion trigger, the CRYOTIMER period pulse goes straight to the
+	 * ADC once a burst connects it */
+	cmu_acquire(CMU_CLK_PRS);
+#endif
 
-	/* Block on correct sleep level using sleep library */
-	slp_blockSleepMode(ADC_EM);
+	/* No ADC interrupts, the LDMA wakes us up once per scan */
+	dma_init();
+	dma_register(DMA_CH_ADC, _adc_dma_done);
 
-	/* Enable CPU interrupt */
-	NVIC_EnableIRQ(ADC0_IRQn);
-	NVIC_SetPriority(TIMER0_IRQn, 1);
+	cmu_release(CMU_CLK_ADC0);
 
-	/* Start operation */
-	ADC0->CMD |= ADC_CMD_SINGLESTART;
+#if ADC_ACMP
+	acmp_init();
+	_adc_watch();
+#else
+	_adc_start();
+#endif
 
 	return;
 
@@ -25,41 +25,166 @@
 
 #include "main.h"
 #include "em_adc.h"
+#include "em_cryotimer.h"
+#include "joy.h"
 
-/* EM level */
-#define ADC_EM 3
-
-/* Thresholds for interrupt */
-#define ADC_GT 0
-#define ADC_LT 3800
-
-/* Thresholds for joystick found experimentally, tunable */
-#define ADC_JOY_UP_GT    3300
-#define ADC_JOY_UP_LT    3800
-#define ADC_JOY_DOWN_GT  1700
-#define ADC_JOY_DOWN_LT  2200
-#define ADC_JOY_RIGHT_GT 2800
-#define ADC_JOY_RIGHT_LT 3300
-#define ADC_JOY_LEFT_GT  2200
-#define ADC_JOY_LEFT_LT  2800
-#define ADC_JOY_NONE_GT  3800
-#define ADC_JOY_NONE_LT  4096
-#define ADC_JOY_PRESS_GT 0
-#define ADC_JOY_PRESS_LT 200
+/* EM level, LDMA transfers can wake up from EM2 but not EM3 */
+#define ADC_EM 2
+
+/* Trigger each conversion from the period pulse of the sleep clock
+ * CRYOTIMER (on the ULFRCO, see slp.h) through PRS instead of running the ADC
+ * continuously. The ADC and the AUXHFRCO are then only powered for the
+ * conversion itself. Sampling runs at the idle rate while the joystick is
+ * released and at the active rate otherwise. */
+#ifndef ADC_PRS
+#define ADC_PRS 1
+#endif
+#define ADC_PRS_CH 1
+#define ADC_PRS_SEL adcPRSSELCh1
+#define ADC_PRS_IDLE cryotimerPeriod_32
+#define ADC_PRS_ACTIVE cryotimerPeriod_8
+
+/* Gate the ADC with ACMP0. While the joystick is at rest the ADC, its
+ * trigger and the LDMA channel are stopped and only the comparator watches
+ * the line (see acmp.h). A trip starts a burst of scans at the active rate,
+ * which ends after ADC_ACMP_IDLE scans with the joystick released. Supply
+ * and temperature are then only measured during bursts. */
+#ifndef ADC_ACMP
+#define ADC_ACMP 1
+#endif
+#define ADC_ACMP_IDLE 2
+
+/* ADC clock prescaler, continuous mode is paced by it (about 200 Hz), PRS
+ * mode converts as fast as possible to keep the window short */
+#if ADC_PRS
+#define ADC_PRESCALE 0
+#else
+#define ADC_PRESCALE 111
+#endif
+
+/* Joystick samples per scan, about 100 ms at 200 Hz or 160 ms at the PRS
+ * active rate */
+#define ADC_BATCH 20
+
+/* Samples averaged per scan for the other channels */
+#define ADC_AVDD_OVS 4
+#define ADC_TEMP_OVS 4
+
+/* Samples thrown away after switching channel */
+#define ADC_SCAN_SKIP 1
+
+/* Layout of one scan in the sample ring, channels in adc_ch_t order */
+#define ADC_JOY_OFS  (ADC_SCAN_SKIP)
+#define ADC_AVDD_OFS (ADC_JOY_OFS + ADC_BATCH + ADC_SCAN_SKIP)
+#define ADC_TEMP_OFS (ADC_AVDD_OFS + ADC_AVDD_OVS + ADC_SCAN_SKIP)
+#define ADC_SCAN_SIZE (ADC_TEMP_OFS + ADC_TEMP_OVS)
+
+/* References in mV for conversion */
+#define ADC_AVDD_REF_MV 5000
+#define ADC_TEMP_REF_MV 1250
+
+/* Per channel compare windows on the averaged raw value, a channel outside
+ * its window is flagged in the scan result. The joystick window is the one
+ * the old compare interrupt used (pressed in any direction). */
+#define ADC_JOY_GT   0
+#define ADC_JOY_LT   3800
+#define ADC_AVDD_MIN_MV 2200
+#define ADC_AVDD_GT  (ADC_AVDD_MIN_MV * 4096 / ADC_AVDD_REF_MV)
+#define ADC_AVDD_LT  4096
+#define ADC_TEMP_GT  0
+#define ADC_TEMP_LT  4096
+
+/* Temperature sensor slope in uV per degree C (magnitude, output falls as
+ * temperature rises) */
+#define ADC_TEMP_SLOPE_UV 1840
+
+
+/*
+ * @brief Channels converted in each scan, in order
+ */
+typedef enum adc_ch_e {
+	ADC_CH_JOY,
+	ADC_CH_AVDD,
+	ADC_CH_TEMP,
+	ADC_NUM_CH
+} adc_ch_t;
+
+/*
+ * @brief Where a channel sits in a scan and its compare window on the
+ * averaged raw value
+ */
+typedef struct adc_layout_s {
+	uint16_t ofs;
+	uint16_t n;
+	uint16_t gt;
+	uint16_t lt;
+} adc_layout_t;
+
+/*
+ * @brief Factory calibration needed to parse a scan
+ */
+typedef struct adc_cal_s {
+	uint16_t temp_read;
+	int16_t temp_c;
+} adc_cal_t;
+
+/*
+ * @brief Result of one scan
+ *
+ * Averages are raw 12 bit values. Bit n of alarm is set when channel n was
+ * outside its compare window. Temperature is in tenths of a degree C.
+ */
+typedef struct adc_scan_s {
+	uint16_t avg[ADC_NUM_CH];
+	uint32_t alarm;
+	uint16_t avdd_mv;
+	int16_t temp_dc;
+} adc_scan_t;
+
+/**
+ * @brief Parse a scan
+ *
+ * This function averages each channel of a raw scan, checks the compare
+ * windows and converts supply voltage and temperature. It only touches its
+ * arguments and needs no peripheral, so it also runs on a host against
+ * recorded or made up scans given their layout.
+ *
+ * @param layout Layout of each channel, in adc_ch_t order
+ * @param raw Samples as laid out by layout
+ * @param cal Calibration values
+ * @param scan Location to store the result
+ *
+ * @return Void
+ */
+void adc_scan_parse(const adc_layout_t *layout, const volatile uint16_t *raw,
+		const adc_cal_t *cal, adc_scan_t *scan);
+
+/**
+ * @brief Get the latest scan
+ *
+ * @param scan Location to store the result
+ *
+ * @return False if no scan has completed yet
+ */
+bool adc_get_scan(adc_scan_t *scan);
 
 /**
- * @brief Debounce helper function
+ * @brief Process sampled batches
  *
- * This function sets a debounce flag to let the system know when to sleep.
+ * This function parses every scan the LDMA has completed since the last call
+ * and classifies its joystick samples in one pass, acting on each new stable
+ * joystick position. It is run from the main loop on EVT_JOY.
  *
  * @return Void
  */
-void adc_debounce(void);
+void adc_task(void);
 
 /**
  * @brief Initializes ADC
  *
- * This function initializes the ADC to sense joystick input.
+ * This function initializes the ADC to sense joystick input, supply voltage
+ * and temperature. The LDMA switches channels and moves samples to a ring in
+ * RAM in EM2, one scan per half of the ring.
  *
  * @return Void
  */
@@ -0,0 +1,174 @@
+/**
+ * @file atom.h
+ * @brief Lock-free atomic helpers
+ *
+ * This file implements small atomic read-modify-write helpers on top of the
+ * Cortex-M exclusive access instructions (LDREX/STREX). Unlike the
+ * CORE_ATOMIC_IRQ_DISABLE/ENABLE pair they never mask interrupts. An exception
+ * taken between the load and the store clears the exclusive monitor, so the
+ * store fails and the operation is retried with the updated value.
+ *
+ * Host builds (the tests in test/) use C11 atomics instead, which also hold
+ * up between threads.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __ATOM_H__
+#define __ATOM_H__
+
+#include "main.h"
+#include "em_device.h"
+
+#if !defined(__arm__)
+#include <stdatomic.h>
+
+/* The helpers take plain volatile words like the target build */
+#define _ATOM(p) ((volatile _Atomic uint32_t *) (p))
+#endif
+
+/**
+ * @brief Atomically increment a counter
+ *
+ * @param p The counter to increment
+ *
+ * @return The new value
+ */
+static inline uint32_t atom_inc(volatile uint32_t *p) {
+#if defined(__arm__)
+	uint32_t v;
+
+	do {
+		v = __LDREXW(p) + 1;
+	} while (__STREXW(v, p));
+
+	return v;
+#else
+	return atomic_fetch_add(_ATOM(p), 1) + 1;
+#endif
+}
+
+/**
+ * @brief Atomically decrement a counter without underflow
+ *
+ * When the counter is already zero it is left untouched.
+ *
+ * @param p The counter to decrement
+ *
+ * @return True if the counter was decremented
+ */
+static inline bool atom_dec(volatile uint32_t *p) {
+#if defined(__arm__)
+	uint32_t v;
+
+	do {
+		v = __LDREXW(p);
+		if (v == 0) {
+			__CLREX();
+			return false;
+		}
+	} while (__STREXW(v - 1, p));
+
+	return true;
+#else
+	uint32_t v = atomic_load(_ATOM(p));
+
+	do {
+		if (v == 0) {
+			return false;
+		}
+	} while (!atomic_compare_exchange_weak(_ATOM(p), &v, v - 1));
+
+	return true;
+#endif
+}
+
+/**
+ * @brief Atomically set bits
+ *
+ * @param p The word to modify
+ * @param bits The bits to set
+ *
+ * @return Void
+ */
+static inline void atom_or(volatile uint32_t *p, uint32_t bits) {
+#if defined(__arm__)
+	do {
+	} while (__STREXW(__LDREXW(p) | bits, p));
+#else
+	atomic_fetch_or(_ATOM(p), bits);
+#endif
+}
+
+/**
+ * @brief Atomically exchange a word
+ *
+ * @param p The word to modify
+ * @param v The new value
+ *
+ * @return The old value
+ */
+static inline uint32_t atom_xchg(volatile uint32_t *p, uint32_t v) {
+#if defined(__arm__)
+	uint32_t old;
+
+	do {
+		old = __LDREXW(p);
+	} while (__STREXW(v, p));
+
+	return old;
+#else
+	return atomic_exchange(_ATOM(p), v);
+#endif
+}
+
+/**
+ * @brief Atomically make a bit follow a counter
+ *
+ * This function sets the bit while the counter is non-zero and clears it
+ * otherwise. Whoever moves the counter between zero and non-zero calls it
+ * afterwards, so racing calls always settle on the latest count. On the
+ * target the counter is read inside the exclusive section and a change to
+ * the word fails the store. A compare and swap would miss an update that
+ * stores the same value, so the host build checks the counter again after
+ * storing instead.
+ *
+ * @param p The word holding the bit
+ * @param bit The bit to update
+ * @param count The counter it follows
+ *
+ * @return Void
+ */
+static inline void atom_track(volatile uint32_t *p, uint32_t bit,
+		volatile uint32_t *count) {
+#if defined(__arm__)
+	uint32_t v;
+
+	do {
+		v = __LDREXW(p);
+		if (*count > 0) {
+			v |= bit;
+		} else {
+			v &= ~bit;
+		}
+	} while (__STREXW(v, p));
+#else
+	uint32_t v;
+	bool set;
+
+	do {
+		set = atomic_load(_ATOM(count)) > 0;
+		if (set) {
+			atomic_fetch_or(_ATOM(p), bit);
+		} else {
+			atomic_fetch_and(_ATOM(p), ~bit);
+		}
+		v = atomic_load(_ATOM(p));
+	} while (set != (atomic_load(_ATOM(count)) > 0) ||
+			set != ((v & bit) != 0));
+#endif
+}
+
+#endif /* __ATOM_H__ */
@@ -24,237 +24,462 @@
 
 #include "bma280.h"
 #include "slp.h"
-#include "em_timer.h"
+#include "vtmr.h"
 #include "gpio.h"
+#include "evt.h"
+#include "atom.h"
+#include "pt.h"
+#include "prof.h"
+#include "cmu.h"
+#include "spi.h"
+
+/* Delay timers and their expired flags */
+static vtmr_t bma280_tmr[BMA280_TMR_NUM];
+static volatile bool bma280_tmr_flag[BMA280_TMR_NUM];
+
+static volatile bool bma280_check_tap = false;
+
+/* BMA280 enabled state */
+static bool bma280_enabled = false;
+
+/* Pending enable or disable request */
+static volatile uint32_t bma280_req = BMA280_REQ_NONE;
+
+/* Threads */
+static pt_t bma280_tap_pt;
+static pt_t bma280_enable_pt;
+static bool bma280_enabling = false;
+static pt_t bma280_disable_pt;
+static bool bma280_disabling = false;
+
+/* A soft reset went out and the device is not listening yet */
+static bool bma280_resetting = false;
+
+/* Register access from a thread, the transfer is queued and the thread
+ * waits on spi_busy() instead of sleeping in spi_wait() */
+typedef struct bma280_io_s {
+	spi_xfer_t xfer;
+	uint8_t tx[2];
+	uint8_t rx;
+} bma280_io_t;
+
+static bma280_io_t bma280_tap_io;
+static bma280_io_t bma280_enable_io;
+
+/* Set with EVT_BMA280, lets bma280_init() sleep until a thread can go on */
+static volatile bool bma280_wake = false;
+
+/* Tap configuration, written in this order */
+static const uint8_t bma280_config_tbl[][2] = {
+	/* Range 4g */
+	{ BMA280_PMU_RANGE, BMA280_PMU_RANGE_RANGE },
+
+	/* Bandwidth 128Hz */
+	{ BMA280_PMU_BW, BMA280_PMU_BW_BW },
 
-/* Timer interrupt flag */
-volatile bool bma280_tmr_flag = false;
+	/* Tap quiet 30ms, tap shock 50ms, tap duration 200ms */
+	{ BMA280_INT_8, BMA280_INT_8_TAP_DUR   |
+					BMA280_INT_8_TAP_SHOCK |
+					BMA280_INT_8_TAP_QUIET },
 
-static bool bma280_check_tap = false;
+	/* Tap samples and threshold */
+	{ BMA280_INT_9, BMA280_INT_9_TAP_TH | BMA280_INT_9_TAP_SAMP },
 
-/* Swap endian helper function for 2 byte transfers*/
-static uint16_t _bma280_swap(uint16_t d) {
-	return (d >> 8) | (d << 8);
+	/* Map interrupts to INT2 */
+	{ BMA280_INT_MAP_0, BMA280_INT_MAP_0_INT1_S_TAP | BMA280_INT_MAP_0_INT1_D_TAP },
+
+	/* Enable interrupts and 500ms latch */
+	{ BMA280_INT_EN_0, BMA280_INT_EN_0_S_TAP_EN | BMA280_INT_EN_0_D_TAP_EN },
+	{ BMA280_INT_RST_LATCH, BMA280_INT_RST_LATCH_LATCH_INT },
+
+#if BMA280_FIFO
+	/* Watermark interrupt on the tap pin, stream mode last as it clears the
+	 * FIFO */
+	{ BMA280_FIFO_CONFIG_0, BMA280_FIFO_WM },
+	{ BMA280_INT_MAP_1, BMA280_INT_MAP_1_INT1_FWM },
+	{ BMA280_INT_EN_1, BMA280_INT_EN_1_INT_FWM_EN },
+	{ BMA280_FIFO_CONFIG_1, BMA280_FIFO_CONFIG_1_MODE_STREAM |
+							BMA280_FIFO_CONFIG_1_DATA_SELECT_XYZ },
+#endif
+};
+
+/* Chip select on the shared bus */
+static const spi_dev_t bma280_spi = {
+	.port = BMA280_SPI_PORT,
+	.pin = BMA280_SPI_CS,
+};
+
+/* FIFO streaming, transfers are queued from interrupt handlers */
+static volatile bool bma280_streaming = false;
+static const uint8_t bma280_cmd_status = BMA280_READ | BMA280_INT_STATUS_0;
+static const uint8_t bma280_cmd_fifo = BMA280_READ | BMA280_FIFO_DATA;
+static const uint8_t bma280_cmd_clear[2] = {
+	BMA280_WRITE | BMA280_FIFO_CONFIG_1,
+	BMA280_FIFO_CONFIG_1_MODE_STREAM | BMA280_FIFO_CONFIG_1_DATA_SELECT_XYZ,
+};
+static uint8_t bma280_status[BMA280_STATUS_NUM];
+static uint8_t bma280_fifo_buf[BMA280_FIFO_FRAMES * BMA280_ACCD_NUM];
+static spi_xfer_t bma280_status_xfer;
+static spi_xfer_t bma280_fifo_xfer;
+static spi_xfer_t bma280_clear_xfer;
+
+/* Sample ring, filled from the LDMA interrupt */
+static bma280_xyz_t bma280_ring[BMA280_RING_SIZE];
+static volatile uint32_t bma280_ring_head = 0;
+static volatile uint32_t bma280_ring_tail = 0;
+static bma280_fifo_stats_t bma280_fifo_stats;
+
+/* Convert a sample, left aligned, shift down keeping the sign */
+static void _bma280_parse(const uint8_t *d, bma280_xyz_t *xyz) {
+	xyz->x = (int16_t) ((d[1] << 8) | d[0]) >> BMA280_ACCD_SHIFT;
+	xyz->y = (int16_t) ((d[3] << 8) | d[2]) >> BMA280_ACCD_SHIFT;
+	xyz->z = (int16_t) ((d[5] << 8) | d[4]) >> BMA280_ACCD_SHIFT;
 }
 
-/* GPIO interrupt for BMA280 */
-void GPIO_ODD_IRQHandler(void) {
+/* Read the status registers, only called from interrupt handlers so the
+ * busy checks can't race */
+static void _bma280_fifo_poll(void) {
+	if (bma280_streaming && !spi_busy(&bma280_status_xfer) &&
+		!spi_busy(&bma280_fifo_xfer)) {
+		spi_submit(&bma280_status_xfer);
+	}
+}
 
-	if (GPIO_IntGet() & _GPIO_IF_EXT_MASK) {
-		/* Clear interrupts */
-		GPIO_IntClear(_GPIO_IF_EXT_MASK);
+/* Status read, tell taps from the watermark and drain what is there */
+static void _bma280_status_done(spi_xfer_t *xfer) {
+	uint8_t fifo = bma280_status[BMA280_FIFO_STATUS - BMA280_INT_STATUS_0];
+	uint32_t n = fifo & BMA280_FIFO_STATUS_FRAME_COUNTER_MASK;
 
-		/* Set flag to check if it is a single tap or double tap (latched for 500ms) */
+	if (bma280_status[0] & (BMA280_INT_STATUS_0_S_TAP_INT |
+			BMA280_INT_STATUS_0_D_TAP_INT)) {
 		bma280_check_tap = true;
+		evt_post(EVT_TAP);
+	}
+
+	if (fifo & BMA280_FIFO_STATUS_OVERRUN_MASK) {
+		bma280_fifo_stats.overruns++;
+	}
+
+	if (n > BMA280_FIFO_FRAMES) {
+		n = BMA280_FIFO_FRAMES;
+	}
+
+	/* The FIFO data address does not increment, one burst takes it all.
+	 * Streaming may have been stopped while the status was read. */
+	if (n && bma280_streaming) {
+		bma280_fifo_xfer.rx_len = n * BMA280_ACCD_NUM;
+		spi_submit(&bma280_fifo_xfer);
+	}
 
+	/* The overrun flag stays set until FIFO_CONFIG_1 is written, which also
+	 * empties the FIFO, so it is written right after the drain */
+	if ((fifo & BMA280_FIFO_STATUS_OVERRUN_MASK) && bma280_streaming) {
+		spi_submit(&bma280_clear_xfer);
 	}
 }
 
-/* TIMER0 interrupt handler */
-void TIMER0_IRQHandler(void) {
-	CORE_ATOMIC_IRQ_DISABLE();
+/* FIFO drained, move the frames into the ring */
+static void _bma280_fifo_done(spi_xfer_t *xfer) {
+	uint32_t n = xfer->rx_len / BMA280_ACCD_NUM;
+	uint32_t head = bma280_ring_head;
 
-	TIMER_IntClear(TIMER0, TIMER_IF_OF);
+	for (uint32_t i = 0; i < n; i++) {
+		if (head - bma280_ring_tail >= BMA280_RING_SIZE) {
+			bma280_fifo_stats.dropped += n - i;
+			break;
+		}
+		_bma280_parse(&bma280_fifo_buf[i * BMA280_ACCD_NUM],
+				&bma280_ring[head & (BMA280_RING_SIZE - 1)]);
+		head++;
+	}
 
-	/* Reset timer */
-	TIMER_Enable(TIMER0, false);
-	TIMER_CounterSet(TIMER0, 0);
+	/* Make sure the samples are written before they are published */
+	__DMB();
+	bma280_ring_head = head;
 
-	bma280_tmr_flag = true;
+	bma280_fifo_stats.frames += n;
+	bma280_fifo_stats.drains++;
+	evt_post(EVT_ACCEL);
 
-	CORE_ATOMIC_IRQ_ENABLE();
+	/* Only edges are seen and the pin is shared with the latched tap
+	 * interrupt. After a full watermark more may be waiting, look again
+	 * while the pin is high. */
+	if (n >= BMA280_FIFO_WM &&
+		GPIO_PinInGet(BMA280_INT_PORT, BMA280_INT_PIN)) {
+		_bma280_fifo_poll();
+	}
 }
 
-void bma280_usart_init() {
-	USART_InitSync_TypeDef usart_init = {
-		.autoCsEnable = true,
-		.autoCsHold = 0,
-		.autoCsSetup = 0,
-		.autoTx = false,
-		.baudrate = 100000,
-		.clockMode = usartClockMode3,
-		.databits = usartDatabits8,
-		.enable = usartDisable,
-		.master = true,
-		.msbf = true,
-		.prsRxCh = usartPrsRxCh0,
-		.prsRxEnable = false,
-		.refFreq = 0,
+/* Set up the streaming transfers */
+static void _bma280_fifo_init(void) {
+	bma280_status_xfer = (spi_xfer_t) {
+		.dev = &bma280_spi,
+		.tx = &bma280_cmd_status,
+		.tx_len = 1,
+		.rx = bma280_status,
+		.rx_len = BMA280_STATUS_NUM,
+		.done = _bma280_status_done,
+	};
+
+	bma280_fifo_xfer = (spi_xfer_t) {
+		.dev = &bma280_spi,
+		.tx = &bma280_cmd_fifo,
+		.tx_len = 1,
+		.rx = bma280_fifo_buf,
+		.done = _bma280_fifo_done,
 	};
 
-	slp_blockSleepMode(BMA280_USART_EM);
+	bma280_clear_xfer = (spi_xfer_t) {
+		.dev = &bma280_spi,
+		.tx = bma280_cmd_clear,
+		.tx_len = sizeof(bma280_cmd_clear),
+	};
+}
 
-	USART_InitSync(USART1, &usart_init);
+/* GPIO interrupt for BMA280 */
+void GPIO_ODD_IRQHandler(void) {
+	PROF_ISR_ENTER(PROF_GPIO_ODD);
+
+	if (GPIO_IntGet() & _GPIO_IF_EXT_MASK) {
+		/* Clear interrupts */
+		GPIO_IntClear(_GPIO_IF_EXT_MASK);
+
+		if (bma280_streaming) {
+			/* Watermark or tap, the status registers tell */
+			_bma280_fifo_poll();
+		} else {
+			/* Set flag to check if it is a single tap or double tap (latched for 500ms) */
+			bma280_check_tap = true;
+			evt_post(EVT_TAP);
+		}
+
+	}
 
-	/* Route pins and enable*/
-	USART1->ROUTELOC0 = USART_ROUTELOC0_CSLOC_LOC11 | USART_ROUTELOC0_CLKLOC_LOC11 | USART_ROUTELOC0_TXLOC_LOC11 | USART_ROUTELOC0_RXLOC_LOC11;
-	USART1->ROUTEPEN = USART_ROUTEPEN_CSPEN | USART_ROUTEPEN_CLKPEN | USART_ROUTEPEN_TXPEN | USART_ROUTEPEN_RXPEN;
+	PROF_ISR_EXIT(PROF_GPIO_ODD);
+}
 
-	USART_Enable(USART1, usartEnable);
+/* Thread transfer done, called from the LDMA interrupt */
+static void _bma280_io_done(spi_xfer_t *xfer) {
 
+	/* Let the waiting thread run */
+	bma280_wake = true;
+	evt_post(EVT_BMA280);
 }
 
-void bma280_tmr_delay(uint32_t ms) {
-	bma280_tmr_flag = false;
+/* Queue a transfer for a thread */
+static void _bma280_io_submit(bma280_io_t *io, const uint8_t *tx,
+		uint32_t tx_len, uint32_t rx_len) {
+	io->xfer = (spi_xfer_t) {
+		.dev = &bma280_spi,
+		.tx = tx,
+		.tx_len = tx_len,
+		.rx = &io->rx,
+		.rx_len = rx_len,
+		.done = _bma280_io_done,
+	};
 
-	/* Set TIMER TOP for overflow */
-	TIMER_TopSet(TIMER0, ms*1000000/1024/BMA280_TMR_PERIOD);
+	spi_submit(&io->xfer);
+}
 
-	/* Enable */
-	TIMER_Enable(TIMER0, true);
+/* Start reading a register, the value is in io->rx once done */
+static void _bma280_io_read(bma280_io_t *io, uint8_t address) {
+	io->tx[0] = BMA280_READ | address;
+	_bma280_io_submit(io, io->tx, 1, 1);
+}
 
-	/* Block on correct sleep level using sleep library */
-	slp_blockSleepMode(BMA280_TMR_EM);
+/* Start writing a register */
+static void _bma280_io_write(bma280_io_t *io, uint8_t address, uint8_t data) {
+	io->tx[0] = address;
+	io->tx[1] = data;
+	_bma280_io_submit(io, io->tx, 2, 0);
+}
 
-	while(bma280_tmr_flag == false) {
-		/* Snooze */
-		slp_sleep();
-	}
+/* Delay timer expired, called from the RTCC interrupt */
+static void _bma280_tmr_expire(void *arg) {
+	bma280_tmr_flag[(uint32_t) arg] = true;
 
-	/* Unblock sleep mode */
-	slp_unblockSleepMode(BMA280_TMR_EM);
+	/* Let the waiting thread run */
+	bma280_wake = true;
+	evt_post(EVT_BMA280);
 }
 
-void bma280_tmr_init() {
-	/* Initialize TIMER0 */
-	TIMER_Init_TypeDef timerInit = {
-	  .enable     = false,
-	  .debugRun   = true,
-	  .prescale   = timerPrescale1024,
-	  .clkSel     = timerClkSelHFPerClk,
-	  .fallAction = timerInputActionNone,
-	  .riseAction = timerInputActionNone,
-	  .mode       = timerModeUp,
-	  .dmaClrAct  = false,
-	  .quadModeX4 = false,
-	  .oneShot    = false,
-	  .sync       = false,
-	};
+void bma280_usart_init() {
+	/* The bus belongs to the SPI driver, USART1 in mode 3 */
+	spi_init();
+}
 
-	/* Set TIMER TOP for overflow */
-	TIMER_TopSet(TIMER0, BMA280_TMR_TICKS/1024);
+bool bma280_tmr_delay(uint8_t owner, uint32_t ms) {
 
-	/* Overflow interrupt */
-	TIMER_IntEnable(TIMER0, TIMER_IF_OF);
+	/* Start the timer on the first call, one extra tick since the current
+	 * one is already partly over */
+	if (!vtmr_active(&bma280_tmr[owner]) && bma280_tmr_flag[owner] == false) {
+		vtmr_start(&bma280_tmr[owner], VTMR_MS(ms) + 1, 0);
+		return false;
+	}
 
-	/* NVIC enable and priority (nesting) */
-	NVIC_EnableIRQ(TIMER0_IRQn);
-	NVIC_SetPriority(TIMER0_IRQn, 0);
+	/* Still running */
+	if (bma280_tmr_flag[owner] == false) {
+		return false;
+	}
 
-	/* Initialize TIMER0, don't enable yet */
-	TIMER_Init(TIMER0, &timerInit);
+	/* Done, ready for the next delay */
+	bma280_tmr_flag[owner] = false;
 
-	return;
+	return true;
 }
 
-void bma280_tap_handle() {
-	if (bma280_check_tap == true) {
+/* Cancel a delay without waiting for it */
+static void _bma280_tmr_cancel(uint8_t owner) {
+	vtmr_stop(&bma280_tmr[owner]);
+	bma280_tmr_flag[owner] = false;
+}
 
-		/* Get status */
-		uint8_t rd1 = bma280_read(BMA280_INT_STATUS_0);
+void bma280_tmr_init() {
+	for (uint32_t i = 0; i < BMA280_TMR_NUM; i++) {
+		vtmr_create(&bma280_tmr[i], _bma280_tmr_expire, (void *) i);
+		bma280_tmr_flag[i] = false;
+	}
+
+	return;
+}
 
-		/* Wait for second tap max time */
-		bma280_tmr_delay(280);
-		uint8_t rd2 = bma280_read(BMA280_INT_STATUS_0);
+/* Tap thread, tells single from double taps */
+static PT_THREAD(_bma280_tap_thread(pt_t *pt)) {
+	static uint8_t rd1;
+	static uint8_t rd2;
+
+	PT_BEGIN(pt);
+
+	/* Get status */
+	_bma280_io_read(&bma280_tap_io, BMA280_INT_STATUS_0);
+	PT_WAIT_WHILE(pt, spi_busy(&bma280_tap_io.xfer));
+	rd1 = bma280_tap_io.rx;
+
+	/* Wait for second tap max time */
+	PT_WAIT_UNTIL(pt, bma280_tmr_delay(BMA280_TMR_TAP, 280));
+	_bma280_io_read(&bma280_tap_io, BMA280_INT_STATUS_0);
+	PT_WAIT_WHILE(pt, spi_busy(&bma280_tap_io.xfer));
+	rd2 = bma280_tap_io.rx;
+
+	/* Reset interrupts (if using latch mode, safer just to always do it) */
+	_bma280_io_write(&bma280_tap_io, BMA280_INT_RST_LATCH,
+			BMA280_INT_RST_LATCH_RESET_INT | BMA280_INT_RST_LATCH_LATCH_INT);
+	PT_WAIT_WHILE(pt, spi_busy(&bma280_tap_io.xfer));
+
+	/* A watermark may have come in while the pin was held by the tap, look
+	 * from the pin interrupt */
+	if (bma280_streaming) {
+		GPIO_IntSet(1 << BMA280_INT_PIN);
+	}
 
-		/* Reset interrupts (if using latch mode, safer just to always do it) */
-		bma280_write(BMA280_INT_RST_LATCH, BMA280_INT_RST_LATCH_RESET_INT |
-					BMA280_INT_RST_LATCH_LATCH_INT);
+	/* Toggle LED */
+	if (rd1 == 32 && rd2 == 16) {
+		gpio_setLED1(true);
+	} else if (rd1 == 32 && rd2 == 0) {
+		gpio_setLED1(false);
+	}
 
-		/* Reset flag */
-		bma280_check_tap = false;
+	PT_END(pt);
+}
 
-		/* Toggle LED */
-		if (rd1 == 32 && rd2 == 16) {
-			gpio_setLED1(true);
-		} else if (rd1 == 32 && rd2 == 0) {
-			gpio_setLED1(false);
+void bma280_tap_handle() {
+	if (bma280_check_tap == true) {
+		if (!PT_SCHEDULE(_bma280_tap_thread(&bma280_tap_pt))) {
+			/* Reset flag */
+			bma280_check_tap = false;
 		}
-
 	}
 }
 
 uint8_t bma280_read(uint8_t address) {
+	uint8_t data;
 
-	uint16_t tx = 0;
-	uint16_t rx = 0;
-	tx = ((uint16_t) (BMA280_READ | address) << 8) | 0x00;
-	tx = _bma280_swap(tx);
+	bma280_read_burst(address, &data, 1);
 
-	USART_TxDouble(USART1, tx);
-	while(!(USART1->STATUS & USART_STATUS_TXC)) {}
+	return data;
+}
 
-	rx = USART1->RXDOUBLE;
-	rx = rx >> 8;
+void bma280_write(uint8_t address, uint8_t data) {
+	const uint8_t pair[1][2] = { { address, data } };
 
-	return (uint8_t) rx;
+	bma280_write_burst(pair, 1);
 
+	return;
 }
 
-void bma280_write(uint8_t address, uint8_t data) {
+void bma280_read_burst(uint8_t address, uint8_t *data, uint32_t n) {
+	uint8_t cmd = BMA280_READ | address;
+	spi_xfer_t xfer = {
+		.dev = &bma280_spi,
+		.tx = &cmd,
+		.tx_len = 1,
+		.rx = data,
+		.rx_len = n,
+	};
 
-	uint16_t tx = 0;
-	tx = ((uint16_t) (BMA280_WRITE | address)) << 8 | data;
+	/* Sleeps in EM1 while the LDMA moves the bytes */
+	spi_submit(&xfer);
+	spi_wait(&xfer);
 
-	/* Swap for double Tx buffer order */
-	tx = _bma280_swap(tx);
+	return;
+}
 
-	USART_TxDouble(USART1, tx);
-	while(!(USART1->STATUS & USART_STATUS_TXC)) {}
+void bma280_write_burst(const uint8_t (*pairs)[2], uint32_t n) {
+	/* BMA280_WRITE is a clear bit, the pairs go out as they are */
+	spi_xfer_t xfer = {
+		.dev = &bma280_spi,
+		.tx = &pairs[0][0],
+		.tx_len = 2 * n,
+	};
 
-	/* Clear any Rx with dummy variable */
-	while ((USART1->STATUS & USART_STATUS_RXDATAV)) {
-		tx = USART1->RXDOUBLE;
-	}
+	spi_submit(&xfer);
+	spi_wait(&xfer);
 
 	return;
 }
 
-void bma280_config() {
-	/* Range 4g */
-	bma280_write(BMA280_PMU_RANGE, BMA280_PMU_RANGE_RANGE);
+void bma280_read_xyz(bma280_xyz_t *xyz) {
+	uint8_t d[BMA280_ACCD_NUM];
 
-	/* Bandwidth 128Hz */
-	bma280_write(BMA280_PMU_BW, BMA280_PMU_BW_BW);
+	/* Reading the LSB first locks the MSB until it is read */
+	bma280_read_burst(BMA280_ACCD_X_LSB, d, BMA280_ACCD_NUM);
+	_bma280_parse(d, xyz);
 
-	/* Tap quiet 30ms, tap shock 50ms, tap duration 200ms */
-	bma280_write(BMA280_INT_8, BMA280_INT_8_TAP_DUR   |
-							   BMA280_INT_8_TAP_SHOCK |
-							   BMA280_INT_8_TAP_QUIET );
+	return;
+}
 
-	/* Tap samples and threshold */
-	bma280_write(BMA280_INT_9, BMA280_INT_9_TAP_TH   |
-							   BMA280_INT_9_TAP_SAMP );
+uint32_t bma280_fifo_read(bma280_xyz_t *xyz, uint32_t max) {
+	uint32_t tail = bma280_ring_tail;
+	uint32_t n = bma280_ring_head - tail;
 
-	/* Map interrupts to INT2 */
-	bma280_write(BMA280_INT_MAP_0, BMA280_INT_MAP_0_INT1_S_TAP | BMA280_INT_MAP_0_INT1_D_TAP);
+	if (n > max) {
+		n = max;
+	}
 
-	/* Enable interrupts and 500ms latch */
-	bma280_write(BMA280_INT_EN_0, BMA280_INT_EN_0_S_TAP_EN |
-								  BMA280_INT_EN_0_D_TAP_EN );
-	bma280_write(BMA280_INT_RST_LATCH, BMA280_INT_RST_LATCH_LATCH_INT);
+	for (uint32_t i = 0; i < n; i++) {
+		xyz[i] = bma280_ring[(tail + i) & (BMA280_RING_SIZE - 1)];
+	}
 
-}
+	/* Done with the slots before handing them back */
+	__DMB();
+	bma280_ring_tail = tail + n;
 
-void bma280_disable() {
-	/* Put the device to sleep */
-	uint8_t rd = bma280_read(BMA280_PMU_LPW);
-	bma280_write(BMA280_PMU_LPW, BMA280_PMU_LPW_DEEP_SUSPEND);
+	return n;
 }
 
-void bma280_enable() {
-	/* Do some stuff */
-	bma280_write(BMA280_BGW_SOFTRESET, BMA280_BGW_SOFTRESET_SOFTRESET);
-
-	/* Delay timer */
-	bma280_tmr_delay(2);
+void bma280_fifo_get_stats(bma280_fifo_stats_t *stats) {
+	CORE_ATOMIC_IRQ_DISABLE();
+	*stats = bma280_fifo_stats;
+	CORE_ATOMIC_IRQ_ENABLE();
+}
 
-	/* Clear any pending interrupts */
-	uint16_t rd = bma280_read(BMA280_INT_RST_LATCH);
-	bma280_write(BMA280_INT_RST_LATCH, BMA280_INT_RST_LATCH_RESET_INT |
-			BMA280_INT_RST_LATCH_LATCH_INT);
-	rd = bma280_read(BMA280_INT_RST_LATCH);
+void bma280_config() {
+	bma280_write_burst(bma280_config_tbl,
+			sizeof(bma280_config_tbl) / sizeof(bma280_config_tbl[0]));
+}
 
+/* Arm the GPIO interrupt for the BMA280 interrupt pin */
+static void _bma280_int_init(void) {
 	/* Set interrupt pin to BMA280 */
 	GPIO_PinModeSet(BMA280_INT_PORT, BMA280_INT_PIN, gpioModeInput, 0);
 
@@ -266,9 +491,133 @@ void bma280_enable() {
 
 	/* Enable BMA280 GPIO interrupt pin for rising edge*/
 	GPIO_IntConfig(BMA280_INT_PORT, BMA280_INT_PIN, true, false, true);
+}
+
+/* Disable thread, puts the device to sleep. It shares the enable thread's
+ * transfer, so the write goes out after whatever an aborted enable left on
+ * the bus and an enable started later waits for it. */
+static PT_THREAD(_bma280_disable_thread(pt_t *pt)) {
+	bma280_io_t *io = &bma280_enable_io;
+
+	PT_BEGIN(pt);
+
+	bma280_streaming = false;
+	bma280_enabled = false;
+
+	PT_WAIT_WHILE(pt, spi_busy(&io->xfer));
+
+	/* An aborted enable may have just reset the device, which would miss
+	 * the write */
+	if (bma280_resetting) {
+		PT_WAIT_UNTIL(pt, bma280_tmr_delay(BMA280_TMR_ENABLE, 2));
+		bma280_resetting = false;
+	}
+
+	_bma280_io_write(io, BMA280_PMU_LPW, BMA280_PMU_LPW_DEEP_SUSPEND);
+	PT_WAIT_WHILE(pt, spi_busy(&io->xfer));
+
+	PT_END(pt);
+}
+
+/* Enable thread, resets and configures the device */
+static PT_THREAD(_bma280_enable_thread(pt_t *pt)) {
+	bma280_io_t *io = &bma280_enable_io;
+
+	PT_BEGIN(pt);
+
+	/* A restarted enable may still have a transfer queued */
+	PT_WAIT_WHILE(pt, spi_busy(&io->xfer));
+
+	/* The reset stops the FIFO */
+	bma280_streaming = false;
+
+	/* Do some stuff */
+	_bma280_io_write(io, BMA280_BGW_SOFTRESET, BMA280_BGW_SOFTRESET_SOFTRESET);
+	bma280_resetting = true;
+	PT_WAIT_WHILE(pt, spi_busy(&io->xfer));
+
+	/* Delay timer */
+	PT_WAIT_UNTIL(pt, bma280_tmr_delay(BMA280_TMR_ENABLE, 2));
+	bma280_resetting = false;
+
+	/* Clear any pending interrupts */
+	_bma280_io_read(io, BMA280_INT_RST_LATCH);
+	PT_WAIT_WHILE(pt, spi_busy(&io->xfer));
+	_bma280_io_write(io, BMA280_INT_RST_LATCH, BMA280_INT_RST_LATCH_RESET_INT |
+			BMA280_INT_RST_LATCH_LATCH_INT);
+	PT_WAIT_WHILE(pt, spi_busy(&io->xfer));
+	_bma280_io_read(io, BMA280_INT_RST_LATCH);
+	PT_WAIT_WHILE(pt, spi_busy(&io->xfer));
+
+	/* Arm interrupt pin */
+	_bma280_int_init();
+
+	/* Configure settings, the table goes out in one burst */
+	_bma280_io_submit(io, &bma280_config_tbl[0][0],
+			sizeof(bma280_config_tbl), 0);
+	PT_WAIT_WHILE(pt, spi_busy(&io->xfer));
 
-	/* Configure settings */
-	bma280_config();
+	bma280_enabled = true;
+	bma280_streaming = BMA280_FIFO;
+
+	PT_END(pt);
+}
+
+void bma280_disable() {
+	bma280_req = BMA280_REQ_DISABLE;
+	evt_post(EVT_BMA280);
+}
+
+void bma280_enable() {
+	bma280_req = BMA280_REQ_ENABLE;
+	evt_post(EVT_BMA280);
+}
+
+void bma280_task() {
+	uint32_t req = atom_xchg(&bma280_req, BMA280_REQ_NONE);
+
+	/* Latest request wins, a disable aborts an enable in progress */
+	if (req == BMA280_REQ_DISABLE) {
+		_bma280_tmr_cancel(BMA280_TMR_ENABLE);
+		bma280_enabling = false;
+		PT_INIT(&bma280_disable_pt);
+		bma280_disabling = true;
+	} else if (req == BMA280_REQ_ENABLE) {
+		_bma280_tmr_cancel(BMA280_TMR_ENABLE);
+		bma280_disabling = false;
+		PT_INIT(&bma280_enable_pt);
+		bma280_enabling = true;
+	}
+
+	if (bma280_disabling) {
+		if (!PT_SCHEDULE(_bma280_disable_thread(&bma280_disable_pt))) {
+			bma280_disabling = false;
+		}
+	}
+
+	if (bma280_enabling) {
+		if (!PT_SCHEDULE(_bma280_enable_thread(&bma280_enable_pt))) {
+			bma280_enabling = false;
+		}
+	}
+
+	bma280_tap_handle();
+}
+
+bool bma280_isEnabled() {
+	return bma280_enabled;
+}
+
+/* Sleep until a thread can go on. As in the main loop, interrupts stay
+ * masked between the check and the sleep so a wakeup that comes in between
+ * is not missed. */
+static void _bma280_init_sleep(void) {
+	CORE_ATOMIC_IRQ_DISABLE();
+	if (!bma280_wake) {
+		slp_sleep();
+	}
+	bma280_wake = false;
+	CORE_ATOMIC_IRQ_ENABLE();
 }
 
 void bma280_init() {
@@ -278,12 +627,44 @@ void bma280_init() {
 
 	/* Initialize USART */
 	bma280_usart_init();
+	_bma280_fifo_init();
 
-	/* Initialization to BMA280 */
-	bma280_enable();
+	/* Initialization to BMA280, run to completion */
+	PT_INIT(&bma280_enable_pt);
+	while (PT_SCHEDULE(_bma280_enable_thread(&bma280_enable_pt))) {
+		_bma280_init_sleep();
+	}
 
 	/* Turn off BMA280 */
-	bma280_disable();
+	PT_INIT(&bma280_disable_pt);
+	while (PT_SCHEDULE(_bma280_disable_thread(&bma280_disable_pt))) {
+		_bma280_init_sleep();
+	}
+
+	return;
+
+}
+
+void bma280_warm_init(bool enabled) {
+
+	/* Initialize timer */
+	bma280_tmr_init();
+
+	/* Initialize USART */
+	bma280_usart_init();
+	_bma280_fifo_init();
+
+	/* Configuration survived EM4, only the MCU side needs to be set up */
+	bma280_enabled = enabled;
+	bma280_streaming = enabled && BMA280_FIFO;
+	if (enabled) {
+		_bma280_int_init();
+	}
+
+	/* The FIFO kept filling, drain it if the watermark edge was missed */
+	if (bma280_streaming) {
+		GPIO_IntSet(1 << BMA280_INT_PIN);
+	}
 
 	return;
 
@@ -25,7 +25,6 @@
 #define __BMA280_H__
 
 #include "main.h"
-#include "em_timer.h"
 #include "em_usart.h"
 #include "em_gpio.h"
 #include "stdint.h"
@@ -41,21 +40,23 @@
 #define BMA280_INT_PIN 11
 #define BMA280_INT_PORT gpioPortD
 
-/* Timer delay in ns */
-#define BMA280_TMR_DELAY 2000000
+/* Delay timer owners, one virtual timer each */
+#define BMA280_TMR_TAP 0
+#define BMA280_TMR_ENABLE 1
+#define BMA280_TMR_NUM 2
 
-/* Timer clock in MHz */
-#define BMA280_TMR_CLK 19
+/* Stream acceleration through the 32 frame FIFO. The sensor raises its
+ * interrupt at the watermark and the FIFO is drained in one burst into a
+ * ring of BMA280_RING_SIZE samples (a power of two). */
+#define BMA280_FIFO 1
+#define BMA280_FIFO_FRAMES 32
+#define BMA280_FIFO_WM 24
+#define BMA280_RING_SIZE 128
 
-/* Timer period in ns */
-#define BMA280_TMR_PERIOD (1000/BMA280_TMR_CLK)
-
-/* Timer clock ticks to count */
-#define BMA280_TMR_TICKS BMA280_TMR_DELAY/(BMA280_TMR_PERIOD)
-
-/* Timer sleep mode */
-#define BMA280_TMR_EM 1
-#define BMA280_USART_EM 1
+/* Enable and disable requests */
+#define BMA280_REQ_NONE 0
+#define BMA280_REQ_ENABLE 1
+#define BMA280_REQ_DISABLE 2
 
 /* Selected BMA280 register access macros */
 #define BMA280_PMU_LPW 0x11
@@ -118,42 +119,100 @@
 #define BMA280_INT_MAP_0_INT1_S_TAP (1<<5)
 #define BMA280_INT_MAP_0_INT1_D_TAP (1<<4)
 
+#define BMA280_INT_EN_1 0x17
+#define BMA280_INT_EN_1_INT_FWM_EN_MASK (1<<6)
+#define BMA280_INT_EN_1_INT_FWM_EN (1<<6)
+
+#define BMA280_INT_MAP_1 0x1a
+#define BMA280_INT_MAP_1_INT1_FWM_MASK (1<<1)
+#define BMA280_INT_MAP_1_INT1_FWM (1<<1)
+
+#define BMA280_FIFO_STATUS 0x0e
+#define BMA280_FIFO_STATUS_OVERRUN_MASK (1<<7)
+#define BMA280_FIFO_STATUS_FRAME_COUNTER_MASK 0x7f
+
+#define BMA280_FIFO_CONFIG_0 0x30
+#define BMA280_FIFO_CONFIG_0_WATER_MARK_MASK 0x3f
+
+#define BMA280_FIFO_CONFIG_1 0x3e
+#define BMA280_FIFO_CONFIG_1_MODE_MASK (0b11<<6)
+#define BMA280_FIFO_CONFIG_1_DATA_SELECT_MASK 0b11
+#define BMA280_FIFO_CONFIG_1_MODE_STREAM (0b10<<6)
+#define BMA280_FIFO_CONFIG_1_DATA_SELECT_XYZ 0b00
+
+#define BMA280_FIFO_DATA 0x3f
+
+/* Status registers read on each interrupt, INT_STATUS_0 to FIFO_STATUS */
+#define BMA280_STATUS_NUM (BMA280_FIFO_STATUS - BMA280_INT_STATUS_0 + 1)
+
 #define BMA280_INT_MAP_2 0x21
 #define BMA280_INT_MAP_2_INT1_S_TAP_MASK (1<<5)
 #define BMA280_INT_MAP_2_INT1_D_TAP_MASK (1<<4)
 #define BMA280_INT_MAP_2_INT1_S_TAP (1<<5)
 #define BMA280_INT_MAP_2_INT1_D_TAP (1<<4)
 
+#define BMA280_ACCD_X_LSB 0x02
+#define BMA280_ACCD_NUM 6
+#define BMA280_ACCD_SHIFT 2
+
 #define BMA280_RW_MASK (1<<7)
 #define BMA280_READ (1<<7)
 #define BMA280_WRITE (0<<7)
 
+/*
+ * @brief Acceleration sample, 14 bit signed counts
+ */
+typedef struct bma280_xyz_s {
+	int16_t x;
+	int16_t y;
+	int16_t z;
+} bma280_xyz_t;
+
+/*
+ * @brief FIFO streaming statistics
+ *
+ * Overruns count the times the sensor FIFO overflowed (oldest frames lost)
+ * as seen by the next drain, dropped counts samples lost because the ring
+ * was full.
+ */
+typedef struct bma280_fifo_stats_s {
+	uint32_t frames;
+	uint32_t drains;
+	uint32_t overruns;
+	uint32_t dropped;
+} bma280_fifo_stats_t;
+
 /**
  * @brief Initializes the USART module for SPI communication
  *
- * This function initializes the USART peripheral for SPI mode in order to
- * communicate with the BMA280.
+ * This function initializes the shared SPI bus (see spi.h) in order to
+ * communicate with the BMA280. Register accesses sleep in EM1 while the LDMA
+ * runs the transfer.
  *
  * @return Void
  */
 void bma280_usart_init(void);
 
 /**
- * @brief Starts the delay timer
+ * @brief Non-blocking delay
  *
- * This function enables the delay timer on TIMER0. When done, bma280_trm_flag
- * will go high.
+ * This function is meant to be polled from a thread with PT_WAIT_UNTIL. The
+ * first call starts the owner's virtual timer, and later calls return true
+ * once it has expired. The RTCC keeps counting in EM2, so the core can sleep
+ * there while it waits.
  *
- * @return Void
+ * @param owner Identifies the calling thread (BMA280_TMR_*)
+ * @param ms Time to delay in milliseconds
+ *
+ * @return True when the delay has expired
  */
-void bma280_tmr_delay(uint32_t ms);
+bool bma280_tmr_delay(uint8_t owner, uint32_t ms);
 
 /**
  * @brief Initializes the timer for BMA280 delay functions
  *
- * This function initializes TIMER0 for delay functionality.
+ * This function sets up a virtual timer for each delay owner.
  *
- * @param ms Time to delay in milliseconds
  * @return Void
  */
 void bma280_tmr_init(void);
@@ -162,21 +221,35 @@ void bma280_tmr_init(void);
  * @brief Handle the tap event
  *
  * This function looks at the tap flag from the GPIO interrupt and
- * toggles LED1 according to a single tap or a double tap.
+ * toggles LED1 according to a single tap or a double tap. It runs the tap
+ * thread, which returns while waiting for the double tap window or for a
+ * register transfer instead of blocking.
  *
  * @return Void
  */
 void bma280_tap_handle(void);
 
+/**
+ * @brief Run BMA280 threads
+ *
+ * This function processes enable and disable requests and runs the enable
+ * and tap threads. It is called from the main loop on EVT_TAP and EVT_BMA280,
+ * which the delay timers and the threads' SPI transfers post when done.
+ *
+ * @return Void
+ */
+void bma280_task(void);
+
 /**
  * @brief Configure the BMA280
  *
  * This function configures the registers in the BMA280 for single and double
- * tap interrupt modes.
+ * tap interrupt modes, and FIFO streaming if enabled, in a single burst
+ * write.
  *
  * @return Void
  */
-void bma280_configure(void);
+void bma280_config(void);
 
 /**
  * @brief Read data from BMA280
@@ -189,6 +262,67 @@ void bma280_configure(void);
  */
 uint8_t bma280_read(uint8_t address);
 
+/**
+ * @brief Read consecutive registers from BMA280
+ *
+ * This function reads n registers starting at address in one transaction,
+ * the BMA280 increments the address after each byte.
+ *
+ * @param address The first address to read from
+ * @param data Where to store the data
+ * @param n Number of registers to read
+ *
+ * @return Void
+ */
+void bma280_read_burst(uint8_t address, uint8_t *data, uint32_t n);
+
+/**
+ * @brief Write several registers of BMA280
+ *
+ * This function writes address and data pairs in one transaction. The
+ * addresses need not be consecutive, the BMA280 takes each pair in turn.
+ *
+ * @param pairs Address and data of each register, in write order
+ * @param n Number of pairs
+ *
+ * @return Void
+ */
+void bma280_write_burst(const uint8_t (*pairs)[2], uint32_t n);
+
+/**
+ * @brief Read an acceleration sample from BMA280
+ *
+ * This function reads all three axes in one burst, so they come from the
+ * same sample.
+ *
+ * @param xyz Where to store the sample
+ *
+ * @return Void
+ */
+void bma280_read_xyz(bma280_xyz_t *xyz);
+
+/**
+ * @brief Take samples from the FIFO stream
+ *
+ * This function copies the oldest samples out of the ring. EVT_ACCEL is
+ * posted after each drain of the sensor FIFO.
+ *
+ * @param xyz Where to store the samples
+ * @param max Room in xyz
+ *
+ * @return Number of samples copied
+ */
+uint32_t bma280_fifo_read(bma280_xyz_t *xyz, uint32_t max);
+
+/**
+ * @brief Get FIFO streaming statistics
+ *
+ * @param stats Where to store the statistics
+ *
+ * @return Void
+ */
+void bma280_fifo_get_stats(bma280_fifo_stats_t *stats);
+
 /**
  * @brief Write data to BMA280
  *
@@ -204,7 +338,10 @@ void bma280_write(uint8_t address, uint8_t data);
 /**
  * @brief Disables BMA280
  *
- * This function disables the BMA280 accelerometer, putting it to sleep.
+ * This function requests the BMA280 accelerometer to be put to sleep. It is
+ * safe to call from interrupt handlers, the request is carried out by the
+ * disable thread in bma280_task() and cancels any enable in progress. The
+ * write is queued behind any transfer the enable left on the bus.
  *
  * @return Void
  */
@@ -213,12 +350,21 @@ void bma280_disable(void);
 /**
  * @brief Enables BMA280
  *
- * This function enables the BMA280 accelerometer, bringing it out of sleep.
+ * This function requests the BMA280 accelerometer to be brought out of sleep.
+ * It is safe to call from interrupt handlers, the reset and configuration are
+ * carried out by the enable thread in bma280_task().
  *
  * @return Void
  */
 void bma280_enable(void);
 
+/**
+ * @brief Check if BMA280 is enabled
+ *
+ * @return True if the BMA280 is enabled and sensing taps
+ */
+bool bma280_isEnabled(void);
+
 /**
  * @brief Initializes BMA280
  *
@@ -228,4 +374,17 @@ void bma280_enable(void);
  */
 void bma280_init(void);
 
+/**
+ * @brief Initializes BMA280 after EM4 wakeup
+ *
+ * This function brings up the delay timers and USART1 without resetting or reconfiguring
+ * the BMA280, which stays powered and keeps its registers while the MCU is in
+ * EM4. If it was enabled, the tap interrupt pin is armed again.
+ *
+ * @param enabled Whether the BMA280 was enabled before EM4
+ *
+ * @return Void
+ */
+void bma280_warm_init(bool enabled);
+
 #endif /* __BMA280_H__ */
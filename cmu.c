@@ -23,14 +23,143 @@
 
 #include "cmu.h"
 #include "letimer.h"
+#include "slp.h"
 
-void cmu_init(void){
-	/* Set up HFRCO and disable HFXO */
-	CMU_HFXOAutostartEnable(0,false,false);
-	CMU_ClockSelectSet(cmuClock_HF, cmuSelect_HFRCO);
-	CMU_HFRCOBandSet(cmuHFRCOFreq_19M0Hz);
-	CMU_OscillatorEnable(cmuOsc_HFXO, false, false);
+/* How to turn a managed clock on and what it needs first */
+typedef struct cmu_desc_s {
+	CMU_Clock_TypeDef clock;
+	CMU_Osc_TypeDef osc;
+	bool is_osc;
+	uint32_t deps;
+} cmu_desc_t;
+
+static const cmu_desc_t cmu_desc[CMU_NUM_CLK] = {
+	[CMU_CLK_AUXHFRCO] = { .osc = cmuOsc_AUXHFRCO, .is_osc = true },
+	[CMU_CLK_HFPER]    = { .clock = cmuClock_HFPER },
+	[CMU_CLK_GPIO]     = { .clock = cmuClock_GPIO },
+	[CMU_CLK_CORELE]   = { .clock = cmuClock_CORELE },
+	[CMU_CLK_LETIMER0] = { .clock = cmuClock_LETIMER0,
+						   .deps = (1 << CMU_CLK_CORELE) },
+	[CMU_CLK_ADC0]     = { .clock = cmuClock_ADC0,
+						   .deps = (1 << CMU_CLK_HFPER) | (1 << CMU_CLK_AUXHFRCO) },
+	[CMU_CLK_USART1]   = { .clock = cmuClock_USART1,
+						   .deps = (1 << CMU_CLK_HFPER) },
+	[CMU_CLK_CRYOTIMER] = { .clock = cmuClock_CRYOTIMER },
+	[CMU_CLK_LDMA]     = { .clock = cmuClock_LDMA },
+	[CMU_CLK_PRS]      = { .clock = cmuClock_PRS },
+	[CMU_CLK_ACMP0]    = { .clock = cmuClock_ACMP0,
+						   .deps = (1 << CMU_CLK_HFPER) },
+};
+
+/* Users of each clock */
+static uint32_t cmu_users[CMU_NUM_CLK] = {0};
+
+/* Usage accounting, sleep clock time each clock was last turned on */
+static uint32_t cmu_enables[CMU_NUM_CLK] = {0};
+static uint32_t cmu_ticks[CMU_NUM_CLK] = {0};
+static uint32_t cmu_since[CMU_NUM_CLK] = {0};
+
+/* Turn the hardware for a clock on or off */
+static void _cmu_set(cmu_clk_t clk, bool on) {
+	if (cmu_desc[clk].is_osc) {
+		CMU_OscillatorEnable(cmu_desc[clk].osc, on, on);
+	} else {
+		CMU_ClockEnable(cmu_desc[clk].clock, on);
+	}
+}
+
+/* Acquire without locking, dependencies are turned on first */
+static void _cmu_acquire(cmu_clk_t clk) {
+	uint32_t deps = cmu_desc[clk].deps;
+
+	if (cmu_users[clk]++ > 0) {
+		return;
+	}
+
+	while (deps) {
+		_cmu_acquire((cmu_clk_t) (31 - __CLZ(deps)));
+		deps &= ~(1 << (31 - __CLZ(deps)));
+	}
+
+	_cmu_set(clk, true);
+
+	cmu_enables[clk]++;
+	cmu_since[clk] = slp_now();
+}
+
+/* Release without locking, dependencies are released after */
+static void _cmu_release(cmu_clk_t clk) {
+	uint32_t deps = cmu_desc[clk].deps;
+
+	if (cmu_users[clk] == 0 || --cmu_users[clk] > 0) {
+		return;
+	}
+
+	cmu_ticks[clk] += slp_now() - cmu_since[clk];
+
+	_cmu_set(clk, false);
+
+	while (deps) {
+		_cmu_release((cmu_clk_t) (31 - __CLZ(deps)));
+		deps &= ~(1 << (31 - __CLZ(deps)));
+	}
+}
+
+/* Callers may already have interrupts masked (spi_submit(), sleep hooks), so
+ * the previous state is restored instead of unmasking */
+void cmu_acquire(cmu_clk_t clk) {
+	CORE_DECLARE_IRQ_STATE;
+
+	CORE_ENTER_CRITICAL();
+	_cmu_acquire(clk);
+	CORE_EXIT_CRITICAL();
+}
+
+void cmu_release(cmu_clk_t clk) {
+	CORE_DECLARE_IRQ_STATE;
 
+	CORE_ENTER_CRITICAL();
+	_cmu_release(clk);
+	CORE_EXIT_CRITICAL();
+}
+
+void cmu_get_stats(cmu_stats_t *stats) {
+	CORE_DECLARE_IRQ_STATE;
+	uint32_t now;
+
+	CORE_ENTER_CRITICAL();
+	now = slp_now();
+	for (int i = 0; i < CMU_NUM_CLK; i++) {
+		stats->users[i] = cmu_users[i];
+		stats->enables[i] = cmu_enables[i];
+		stats->ticks[i] = cmu_ticks[i];
+		if (cmu_users[i] > 0) {
+			stats->ticks[i] += now - cmu_since[i];
+		}
+	}
+	CORE_EXIT_CRITICAL();
+
+	return;
+}
+
+void cmu_start_stats(void) {
+	CORE_DECLARE_IRQ_STATE;
+	uint32_t now;
+
+	CORE_ENTER_CRITICAL();
+	now = slp_now();
+	for (int i = 0; i < CMU_NUM_CLK; i++) {
+		if (cmu_users[i] > 0) {
+			cmu_since[i] = now;
+		}
+	}
+	CORE_EXIT_CRITICAL();
+
+	return;
+}
+
+/* Clock setup shared by cold and warm init */
+static void _cmu_clocks_init(void) {
 	if (LETIMER_EM == 3) {
 		/* Set up ULFRCO */
 		CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_ULFRCO);
@@ -40,25 +169,51 @@ void cmu_init(void){
 		CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFXO);
 	}
 
-	/* Set up LFXO and disable LFRCO */
-	CMU_OscillatorEnable(cmuOsc_LFXO, true, true);
+	/* Disable LFRCO */
 	CMU_OscillatorEnable(cmuOsc_LFRCO, false, false);
 
-	/* Set up ADC clock */
+	/* Select ADC clock, AUXHFRCO is only started when ADC0 is acquired */
 	CMU_AUXHFRCOBandSet(cmuAUXHFRCOFreq_1M0Hz);
-	CMU_OscillatorEnable(cmuOsc_AUXHFRCO, true, true);
 	CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
 
-	/* Set up HFPERCO */
-	CMU_ClockEnable(cmuClock_HFPER, true);
+	/* The RTCC is always in use (virtual timers) */
+	_cmu_acquire(CMU_CLK_CORELE);
+
+	/* The stack and the generated device init use peripherals on HFPER
+	 * behind our back, so it is never gated. Other clocks they turned on are
+	 * left alone, only a clock a driver acquires and then releases is ever
+	 * turned off. */
+	_cmu_acquire(CMU_CLK_HFPER);
+}
+
+void cmu_init(void){
+	/* Set up HFRCO and disable HFXO */
+	CMU_HFXOAutostartEnable(0,false,false);
+	CMU_ClockSelectSet(cmuClock_HF, cmuSelect_HFRCO);
+	CMU_HFRCOBandSet(cmuHFRCOFreq_19M0Hz);
+	CMU_OscillatorEnable(cmuOsc_HFXO, false, false);
+
+	/* Set up LFXO */
+	CMU_OscillatorEnable(cmuOsc_LFXO, true, true);
 
-	/* Enable peripheral clocks */
-	CMU_ClockEnable(cmuClock_GPIO, true);
+	_cmu_clocks_init();
+
+}
+
+void cmu_warm_init(void){
+	/* Run straight from HFRCO, the HFXO was never started after reset */
+	CMU_ClockSelectSet(cmuClock_HF, cmuSelect_HFRCO);
+	CMU_HFRCOBandSet(cmuHFRCOFreq_19M0Hz);
+
+	/* LFXO kept running through EM4H, no need to wait for it */
+	CMU_OscillatorEnable(cmuOsc_LFXO, true, false);
+
+	/* RTCC kept counting, just make sure it is still clocked from LFXO */
 	CMU_ClockEnable(cmuClock_CORELE, true);
-	CMU_ClockEnable(cmuClock_LETIMER0, true);
-	CMU_ClockEnable(cmuClock_ADC0, true);
-	CMU_ClockEnable(cmuClock_TIMER0, true);
-	CMU_ClockEnable(cmuClock_USART1, true);
+	CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_LFXO);
+	CMU_ClockEnable(cmuClock_RTCC, true);
+
+	_cmu_clocks_init();
 
 }
 
@@ -27,13 +27,106 @@
 #include "main.h"
 #include "em_cmu.h"
 
+/*
+ * @brief Clocks and oscillators managed by reference count
+ */
+typedef enum cmu_clk_e {
+	CMU_CLK_AUXHFRCO,
+	CMU_CLK_HFPER,
+	CMU_CLK_GPIO,
+	CMU_CLK_CORELE,
+	CMU_CLK_LETIMER0,
+	CMU_CLK_ADC0,
+	CMU_CLK_USART1,
+	CMU_CLK_CRYOTIMER,
+	CMU_CLK_LDMA,
+	CMU_CLK_PRS,
+	CMU_CLK_ACMP0,
+	CMU_NUM_CLK
+} cmu_clk_t;
+
+/*
+ * @brief Clock usage statistics
+ *
+ * Times are in sleep clock ticks (see SLP_CLK_FREQ) and include the current
+ * enabled period of clocks that are still on.
+ */
+typedef struct cmu_stats_s {
+	uint32_t users[CMU_NUM_CLK];
+	uint32_t enables[CMU_NUM_CLK];
+	uint32_t ticks[CMU_NUM_CLK];
+} cmu_stats_t;
+
+/**
+ * @brief Acquire a clock
+ *
+ * This function adds a user to a clock. The first user turns the clock on
+ * together with everything it depends on (HFPER branch, oscillator). May be
+ * called from interrupt handlers and with interrupts masked, which it leaves
+ * masked.
+ *
+ * @param clk The clock to acquire
+ *
+ * @return Void
+ */
+void cmu_acquire(cmu_clk_t clk);
+
+/**
+ * @brief Release a clock
+ *
+ * This function removes a user from a clock. When the last user goes the
+ * clock is turned off and its dependencies are released in turn, shutting
+ * down oscillators that nobody needs any more. Releasing a clock with no
+ * users has no effect.
+ *
+ * @param clk The clock to release
+ *
+ * @return Void
+ */
+void cmu_release(cmu_clk_t clk);
+
+/**
+ * @brief Get clock usage statistics
+ *
+ * @param stats Location to store the statistics
+ *
+ * @return Void
+ */
+void cmu_get_stats(cmu_stats_t *stats);
+
+/**
+ * @brief Start the on time of held clocks
+ *
+ * This function restarts the on time of every clock that has users from the
+ * sleep clock as it reads now. Clocks acquired before the sleep clock runs
+ * are stamped with whatever the stopped counter read, so slp_init() calls
+ * this once the CRYOTIMER is started.
+ *
+ * @return Void
+ */
+void cmu_start_stats(void);
+
 /**
  * @brief Initializes CMU
  *
- * This function initializes the CMU for the demo.
+ * This function initializes the CMU for the demo. Oscillators and clock
+ * sources are selected. Managed clocks are not touched until a driver
+ * acquires them, so whatever reset, device init or the stack turned on stays
+ * on until its last driver releases it.
  *
  * @return Void
  */
 void cmu_init(void);
 
+/**
+ * @brief Initializes CMU after EM4 wakeup
+ *
+ * This function sets up the same clocks as cmu_init() after waking up from
+ * EM4H. The HFXO is never started and the LFXO, which is retained in EM4H, is
+ * not waited on.
+ *
+ * @return Void
+ */
+void cmu_warm_init(void);
+
 #endif /* __CMU_H__ */
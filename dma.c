@@ -0,0 +1,78 @@
+/**
+ * @file dma.c
+ * @brief The implementation for the LDMA channel manager
+ *
+ * This file implements the LDMA channel manager. See the associated header
+ * file for function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "dma.h"
+#include "cmu.h"
+#include "prof.h"
+
+/* Completion callbacks */
+static void (*dma_done[DMA_NUM_CH])(uint32_t ch);
+
+/* Bus errors */
+static uint32_t dma_err = 0;
+
+static bool dma_ready = false;
+
+void LDMA_IRQHandler(void) {
+	PROF_ISR_ENTER(PROF_LDMA);
+
+	uint32_t pending = LDMA->IF & LDMA->IEN;
+	uint32_t ch;
+
+	/* Controller halts on error, nothing to do but count it */
+	if (pending & LDMA_IF_ERROR) {
+		LDMA->IFC = LDMA_IFC_ERROR;
+		dma_err++;
+	}
+
+	pending &= (1 << DMA_NUM_CH) - 1;
+	LDMA->IFC = pending;
+
+	while (pending) {
+		ch = 31 - __CLZ(pending);
+		pending &= ~(1 << ch);
+
+		if (dma_done[ch]) {
+			dma_done[ch](ch);
+		}
+	}
+
+	PROF_ISR_EXIT(PROF_LDMA);
+}
+
+void dma_register(uint32_t ch, void (*done)(uint32_t ch)) {
+	dma_done[ch] = done;
+
+	LDMA->IFC = 1 << ch;
+	LDMA->IEN |= 1 << ch;
+}
+
+uint32_t dma_errors(void) {
+	return dma_err;
+}
+
+void dma_init(void) {
+	LDMA_Init_t ldma_init = LDMA_INIT_DEFAULT;
+
+	if (dma_ready) {
+		return;
+	}
+
+	cmu_acquire(CMU_CLK_LDMA);
+
+	/* Enables the error interrupt and the NVIC line */
+	LDMA_Init(&ldma_init);
+
+	dma_ready = true;
+
+	return;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file dma.h
+ * @brief Definitions and interfaces for the LDMA channel manager
+ *
+ * This file declares the LDMA channel manager. Drivers own fixed channels,
+ * start their own transfers with emlib and get a callback from the single
+ * LDMA interrupt handler when a descriptor with doneIfs set completes.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __DMA_H__
+#define __DMA_H__
+
+#include "main.h"
+#include "em_ldma.h"
+
+/*
+ * @brief Channel assignments
+ */
+#define DMA_CH_ADC 0
+#define DMA_CH_SPI_TX 1
+#define DMA_CH_SPI_RX 2
+#define DMA_NUM_CH DMA_CHAN_COUNT
+
+/**
+ * @brief Register a channel completion callback
+ *
+ * This function sets the function called from the LDMA interrupt handler when
+ * the channel raises its done flag. The channel interrupt is enabled.
+ *
+ * @param ch The channel
+ * @param done Function to call, gets the channel number
+ *
+ * @return Void
+ */
+void dma_register(uint32_t ch, void (*done)(uint32_t ch));
+
+/**
+ * @brief Get number of LDMA errors
+ *
+ * @return Number of bus errors seen since init
+ */
+uint32_t dma_errors(void);
+
+/**
+ * @brief Initializes the LDMA
+ *
+ * This function acquires the LDMA clock and initializes the controller. It
+ * may be called by every driver that uses a channel, only the first call
+ * does anything.
+ *
+ * @return Void
+ */
+void dma_init(void);
+
+#endif /* __DMA_H__ */
@@ -0,0 +1,77 @@
+/**
+ * @file evt.c
+ * @brief The implementation for the event dispatcher
+ *
+ * This file implements the event dispatcher used by the main loop. See the
+ * associated header file for function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "evt.h"
+#include "atom.h"
+#include "em_device.h"
+
+/* Pending event bits */
+static volatile uint32_t evt_pending_mask = 0;
+
+/* Handlers */
+static void (*evt_handlers[EVT_NUM])(void);
+
+/* Statistics */
+static evt_stats_t evt_stats;
+
+void evt_post(evt_t evt) {
+	atom_or(&evt_pending_mask, 1 << evt);
+}
+
+bool evt_pending(void) {
+	return evt_pending_mask != 0;
+}
+
+void evt_register(evt_t evt, void (*handler)(void)) {
+	evt_handlers[evt] = handler;
+}
+
+void evt_dispatch(void) {
+	uint32_t mask = atom_xchg(&evt_pending_mask, 0);
+	uint32_t start;
+	evt_t evt;
+
+	while (mask) {
+		/* Lowest pending event first */
+		evt = (evt_t) (31 - __CLZ(mask & (~mask + 1)));
+		mask &= ~(1 << evt);
+
+		if (evt_handlers[evt]) {
+			start = DWT->CYCCNT;
+			evt_handlers[evt]();
+			evt_stats.cycles[evt] += DWT->CYCCNT - start;
+		}
+		evt_stats.count[evt]++;
+	}
+
+	return;
+}
+
+void evt_get_stats(evt_stats_t *stats) {
+	*stats = evt_stats;
+}
+
+void evt_init(void) {
+
+	evt_pending_mask = 0;
+	for (int i = 0; i < EVT_NUM; i++) {
+		evt_stats.count[i] = 0;
+		evt_stats.cycles[i] = 0;
+	}
+
+	/* Enable the cycle counter */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	return;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file evt.h
+ * @brief Definitions and interfaces for the event dispatcher
+ *
+ * This file declares the event dispatcher used by the main loop. Interrupt
+ * handlers post event bits and the main loop only runs the handlers of
+ * pending events before going back to sleep.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EVT_H__
+#define __EVT_H__
+
+#include "main.h"
+
+/*
+ * @brief Events, lower values are dispatched first
+ */
+typedef enum evt_e {
+	EVT_TAP,
+	EVT_JOY,
+	EVT_GEST,
+	EVT_BMA280,
+	EVT_LETIMER,
+	EVT_ACCEL,
+	EVT_NUM
+} evt_t;
+
+/*
+ * @brief Dispatch statistics for each event
+ *
+ * Cycles are core clock cycles spent in the handler, measured with the DWT
+ * cycle counter.
+ */
+typedef struct evt_stats_s {
+	uint32_t count[EVT_NUM];
+	uint32_t cycles[EVT_NUM];
+} evt_stats_t;
+
+/**
+ * @brief Post an event
+ *
+ * When called, this function marks an event as pending. It is lock-free and
+ * meant to be called from interrupt handlers. Posting an event that is
+ * already pending has no further effect.
+ *
+ * @param evt The event to post
+ *
+ * @return Void
+ */
+void evt_post(evt_t evt);
+
+/**
+ * @brief Check for pending events
+ *
+ * @return True if any event is pending
+ */
+bool evt_pending(void);
+
+/**
+ * @brief Register an event handler
+ *
+ * This function sets the function run by evt_dispatch() when the event is
+ * pending. Only one handler per event is supported.
+ *
+ * @param evt The event to handle
+ * @param handler The function to run
+ *
+ * @return Void
+ */
+void evt_register(evt_t evt, void (*handler)(void));
+
+/**
+ * @brief Dispatch pending events
+ *
+ * This function atomically takes all pending events and runs their handlers
+ * in order. Events posted while handlers run stay pending for the next call.
+ *
+ * @return Void
+ */
+void evt_dispatch(void);
+
+/**
+ * @brief Get dispatch statistics
+ *
+ * @param stats Location to store the statistics
+ *
+ * @return Void
+ */
+void evt_get_stats(evt_stats_t *stats);
+
+/**
+ * @brief Initializes the event dispatcher
+ *
+ * This function clears all events and statistics and starts the DWT cycle
+ * counter, which the interrupt profiling in prof.h shares.
+ *
+ * @return Void
+ */
+void evt_init(void);
+
+#endif /* __EVT_H__ */
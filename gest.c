@@ -0,0 +1,131 @@
+/**
+ * @file gest.c
+ * @brief The implementation for joystick gestures
+ *
+ * This file implements the joystick gesture layer. See the associated header
+ * file for function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "gest.h"
+#include "vtmr.h"
+#include "evt.h"
+#include "atom.h"
+#include "em_rtcc.h"
+
+/* Gestures each position supports besides press and release */
+#define GEST_F_LONG   (1 << 0)
+#define GEST_F_REPEAT (1 << 1)
+
+static const uint8_t gest_flags[JOY_NUM] = {
+	[JOY_UP]    = GEST_F_LONG,
+	[JOY_DOWN]  = GEST_F_LONG,
+	[JOY_LEFT]  = GEST_F_REPEAT,
+	[JOY_RIGHT] = GEST_F_REPEAT,
+	[JOY_PRESS] = GEST_F_LONG,
+};
+
+/* Timers, the argument is the bit set in gest_due */
+static vtmr_t gest_long_tmr;
+static vtmr_t gest_rep_tmr;
+static volatile uint32_t gest_due = 0;
+
+/* Position held, when it was pressed and the next repeat interval */
+static joy_t gest_joy = JOY_NONE;
+static uint32_t gest_press = 0;
+static uint32_t gest_period = 0;
+
+static void (*gest_handler)(gest_t gest, joy_t joy, uint32_t ms);
+
+/* Called from the RTCC interrupt */
+static void _gest_timer(void *arg) {
+	atom_or(&gest_due, (uint32_t) arg);
+	evt_post(EVT_GEST);
+}
+
+/* Ticks left of a delay, changes are reported a little late */
+static uint32_t _gest_left(uint32_t ticks, uint32_t tick) {
+	uint32_t elapsed = RTCC_CounterGet() - tick;
+
+	return elapsed < ticks ? ticks - elapsed : 1;
+}
+
+static void _gest_emit(gest_t gest, uint32_t tick) {
+	uint32_t ms = (uint32_t) ((uint64_t) (tick - gest_press) * 1000 /
+			VTMR_FREQ);
+
+	if (gest_handler) {
+		gest_handler(gest, gest_joy, ms);
+	}
+}
+
+void gest_update(joy_t joy, uint32_t tick) {
+
+	if (joy == gest_joy) {
+		return;
+	}
+
+	vtmr_stop(&gest_long_tmr);
+	vtmr_stop(&gest_rep_tmr);
+	atom_xchg(&gest_due, 0);
+
+	if (gest_joy != JOY_NONE) {
+		_gest_emit(GEST_RELEASE, tick);
+	}
+
+	gest_joy = joy;
+	gest_press = tick;
+
+	if (joy == JOY_NONE) {
+		return;
+	}
+
+	_gest_emit(GEST_PRESS, tick);
+
+	if (gest_flags[joy] & GEST_F_LONG) {
+		vtmr_start(&gest_long_tmr, _gest_left(VTMR_MS(GEST_LONG_MS), tick), 0);
+	}
+
+	if (gest_flags[joy] & GEST_F_REPEAT) {
+		gest_period = VTMR_MS(GEST_REPEAT_START_MS);
+		vtmr_start(&gest_rep_tmr,
+				_gest_left(VTMR_MS(GEST_REPEAT_DELAY_MS), tick), 0);
+	}
+}
+
+void gest_task(void) {
+	uint32_t due = atom_xchg(&gest_due, 0);
+	uint32_t now = RTCC_CounterGet();
+
+	/* Released since the timer fired */
+	if (gest_joy == JOY_NONE) {
+		return;
+	}
+
+	if (due & GEST_F_LONG) {
+		_gest_emit(GEST_LONG, now);
+	}
+
+	if (due & GEST_F_REPEAT) {
+		_gest_emit(GEST_REPEAT, now);
+
+		/* One-shot so the interval can shrink each time */
+		vtmr_start(&gest_rep_tmr, gest_period, 0);
+		gest_period = gest_period * GEST_REPEAT_ACCEL_NUM / GEST_REPEAT_ACCEL_DEN;
+		if (gest_period < VTMR_MS(GEST_REPEAT_MIN_MS)) {
+			gest_period = VTMR_MS(GEST_REPEAT_MIN_MS);
+		}
+	}
+}
+
+void gest_init(void (*handler)(gest_t gest, joy_t joy, uint32_t ms)) {
+	gest_handler = handler;
+
+	vtmr_create(&gest_long_tmr, _gest_timer, (void *) GEST_F_LONG);
+	vtmr_create(&gest_rep_tmr, _gest_timer, (void *) GEST_F_REPEAT);
+
+	return;
+}
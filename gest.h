@@ -0,0 +1,82 @@
+/**
+ * @file gest.h
+ * @brief Definitions and interfaces for joystick gestures
+ *
+ * This file declares the gesture layer on top of the joystick classifier.
+ * Position changes are timestamped with the RTCC and turned into press,
+ * release, long-press and auto-repeat gestures. Long-press and repeat run on
+ * virtual timers, so a held joystick costs one wakeup per gesture.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __GEST_H__
+#define __GEST_H__
+
+#include "main.h"
+#include "joy.h"
+
+/*
+ * @brief Hold time before a long-press
+ */
+#define GEST_LONG_MS 800
+
+/*
+ * @brief Hold time before the first repeat and the interval after it. Each
+ * repeat shortens the interval by GEST_REPEAT_ACCEL_NUM / GEST_REPEAT_ACCEL_DEN
+ * down to GEST_REPEAT_MIN_MS.
+ */
+#define GEST_REPEAT_DELAY_MS 500
+#define GEST_REPEAT_START_MS 250
+#define GEST_REPEAT_MIN_MS 60
+#define GEST_REPEAT_ACCEL_NUM 3
+#define GEST_REPEAT_ACCEL_DEN 4
+
+/*
+ * @brief Gestures
+ */
+typedef enum gest_e {
+	GEST_PRESS,
+	GEST_RELEASE,
+	GEST_LONG,
+	GEST_REPEAT
+} gest_t;
+
+/**
+ * @brief Report a joystick position change
+ *
+ * This function is called by the classifier owner each time the position
+ * changes. Press and release gestures are reported right away, timers are
+ * started for the others.
+ *
+ * @param joy The new position
+ * @param tick RTCC counter when the change was seen
+ *
+ * @return Void
+ */
+void gest_update(joy_t joy, uint32_t tick);
+
+/**
+ * @brief Report due gestures
+ *
+ * This function is registered for EVT_GEST, which the gesture timers post.
+ *
+ * @return Void
+ */
+void gest_task(void);
+
+/**
+ * @brief Initializes the gesture layer
+ *
+ * The virtual timer service must already be running.
+ *
+ * @param handler Function called from task context for each gesture, gets
+ * the gesture, the position and the hold time in ms
+ *
+ * @return Void
+ */
+void gest_init(void (*handler)(gest_t gest, joy_t joy, uint32_t ms));
+
+#endif /* __GEST_H__ */
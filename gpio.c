@@ -23,6 +23,7 @@
 
 #include "gpio.h"
 #include "bma280.h"
+#include "cmu.h"
 
 /* LED0 state */
 static bool gpio_led0_state = false;
@@ -77,8 +78,15 @@ void gpio_setLED1(bool on) {
 		}
 }
 
+bool gpio_getLED1(void) {
+	return gpio_led1_state;
+}
+
 void gpio_init(void){
 
+	/* LEDs and pin interrupts need GPIO all the time */
+	cmu_acquire(CMU_CLK_GPIO);
+
 	/* Set LED ports to be standard output drive with default off (cleared) */
 	GPIO_DriveStrengthSet(GPIO_LED0_PORT, gpioDriveStrengthStrongAlternateStrong);
 	GPIO_PinModeSet(GPIO_LED0_PORT, GPIO_LED0_PIN, gpioModePushPull, GPIO_LED0_DEFAULT);
@@ -90,6 +90,13 @@ void gpio_setLED0(bool on);
  */
 void gpio_setLED1(bool on);
 
+/**
+ * @brief Get LED1
+ *
+ * @return True if LED1 is on
+ */
+bool gpio_getLED1(void);
+
 /**
  * @brief Initializes GPIO
  *
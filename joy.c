@@ -0,0 +1,93 @@
+/**
+ * @file joy.c
+ * @brief The implementation for the joystick classifier
+ *
+ * This file implements the joystick classifier. See the associated header
+ * file for function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "joy.h"
+
+/* Position of every raw value, bands exclude their thresholds. Values
+ * outside every band are left zero, which is JOY_INVALID. */
+static const uint8_t joy_lut[4096] = {
+	[JOY_PRESS_GT + 1 ... JOY_PRESS_LT - 1] = JOY_PRESS,
+	[JOY_DOWN_GT + 1 ... JOY_DOWN_LT - 1]   = JOY_DOWN,
+	[JOY_LEFT_GT + 1 ... JOY_LEFT_LT - 1]   = JOY_LEFT,
+	[JOY_RIGHT_GT + 1 ... JOY_RIGHT_LT - 1] = JOY_RIGHT,
+	[JOY_UP_GT + 1 ... JOY_UP_LT - 1]       = JOY_UP,
+	[JOY_NONE_GT + 1 ... JOY_NONE_LT - 1]   = JOY_NONE,
+};
+_Static_assert(JOY_INVALID == 0, "joy_lut relies on JOY_INVALID being zero");
+
+/* Band of each position widened by the hysteresis */
+typedef struct joy_band_s {
+	int16_t lo;
+	int16_t hi;
+} joy_band_t;
+
+static const joy_band_t joy_band[JOY_NUM] = {
+	[JOY_INVALID] = { 1, 0 },
+	[JOY_NONE]    = { JOY_NONE_GT - JOY_HYST,  JOY_NONE_LT + JOY_HYST },
+	[JOY_UP]      = { JOY_UP_GT - JOY_HYST,    JOY_UP_LT + JOY_HYST },
+	[JOY_DOWN]    = { JOY_DOWN_GT - JOY_HYST,  JOY_DOWN_LT + JOY_HYST },
+	[JOY_LEFT]    = { JOY_LEFT_GT - JOY_HYST,  JOY_LEFT_LT + JOY_HYST },
+	[JOY_RIGHT]   = { JOY_RIGHT_GT - JOY_HYST, JOY_RIGHT_LT + JOY_HYST },
+	[JOY_PRESS]   = { JOY_PRESS_GT - JOY_HYST, JOY_PRESS_LT + JOY_HYST },
+};
+
+/* Median of three samples */
+static uint16_t _joy_median3(uint16_t a, uint16_t b, uint16_t c) {
+	uint16_t t;
+
+	if (a > b) {
+		t = a; a = b; b = t;
+	}
+	if (b > c) {
+		b = c;
+	}
+
+	return (a > b) ? a : b;
+}
+
+joy_t joy_lookup(uint16_t sample) {
+	return (joy_t) joy_lut[sample & 0xfff];
+}
+
+void joy_filter_init(joy_filter_t *f) {
+	f->n = 0;
+	f->pos = 0;
+	f->cur = JOY_NONE;
+}
+
+joy_t joy_classify(joy_filter_t *f, uint16_t sample) {
+	uint16_t v;
+	joy_t joy;
+
+	f->hist[f->pos] = sample & 0xfff;
+	f->pos = (f->pos + 1) % JOY_MEDIAN;
+
+	/* Not enough history yet */
+	if (f->n < JOY_MEDIAN) {
+		f->n++;
+		return f->cur;
+	}
+
+	v = _joy_median3(f->hist[0], f->hist[1], f->hist[2]);
+
+	/* Stay put near the edges of the current band */
+	if (v >= joy_band[f->cur].lo && v <= joy_band[f->cur].hi) {
+		return f->cur;
+	}
+
+	joy = joy_lookup(v);
+	if (joy != JOY_INVALID) {
+		f->cur = joy;
+	}
+
+	return f->cur;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file joy.h
+ * @brief Definitions and interfaces for the joystick classifier
+ *
+ * This file declares the joystick classifier. Raw 12 bit ADC samples are
+ * median filtered, looked up in a table and held in their position with
+ * hysteresis around the band edges.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __JOY_H__
+#define __JOY_H__
+
+#include "main.h"
+
+/* Thresholds for joystick found experimentally, tunable */
+#define JOY_UP_GT    3300
+#define JOY_UP_LT    3800
+#define JOY_DOWN_GT  1700
+#define JOY_DOWN_LT  2200
+#define JOY_RIGHT_GT 2800
+#define JOY_RIGHT_LT 3300
+#define JOY_LEFT_GT  2200
+#define JOY_LEFT_LT  2800
+#define JOY_NONE_GT  3800
+#define JOY_NONE_LT  4096
+#define JOY_PRESS_GT 0
+#define JOY_PRESS_LT 200
+
+/* Counts a sample may stray outside the current position's band before the
+ * position changes */
+#define JOY_HYST 40
+
+/* Length of the median filter, only 3 is supported */
+#define JOY_MEDIAN 3
+
+/*
+ * @brief Joystick positions
+ */
+typedef enum joy_e {
+	JOY_INVALID,
+	JOY_NONE,
+	JOY_UP,
+	JOY_DOWN,
+	JOY_LEFT,
+	JOY_RIGHT,
+	JOY_PRESS,
+	JOY_NUM
+} joy_t;
+
+/*
+ * @brief Classifier state, one per sample stream
+ */
+typedef struct joy_filter_s {
+	uint16_t hist[JOY_MEDIAN];
+	uint8_t n;
+	uint8_t pos;
+	joy_t cur;
+} joy_filter_t;
+
+/**
+ * @brief Look up the position of a raw sample
+ *
+ * @param sample Raw 12 bit sample
+ *
+ * @return The position, JOY_INVALID on a threshold
+ */
+joy_t joy_lookup(uint16_t sample);
+
+/**
+ * @brief Reset a classifier
+ *
+ * @param f Classifier state
+ *
+ * @return Void
+ */
+void joy_filter_init(joy_filter_t *f);
+
+/**
+ * @brief Classify a sample
+ *
+ * This function feeds a sample through the median filter and returns the
+ * position it settles on. The current position is kept while the filtered
+ * value stays within JOY_HYST of its band. All state is in the argument and
+ * the table is constant, so it can be called from interrupt handlers and
+ * tasks alike, one state per caller.
+ *
+ * @param f Classifier state
+ * @param sample Raw 12 bit sample
+ *
+ * @return The current position
+ */
+joy_t joy_classify(joy_filter_t *f, uint16_t sample);
+
+#endif /* __JOY_H__ */
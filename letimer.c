@@ -23,17 +23,302 @@
 
 #include "letimer.h"
 #include "em_letimer.h"
+#include "em_rtcc.h"
 #include "slp.h"
 #include "gpio.h"
 #include "bma280.h"
+#include "evt.h"
+#include "prof.h"
+#include "cmu.h"
 
 /* Current on time in ms */
-static int32_t letimer_ontime = 0;
+static int32_t letimer_ontime = LETIMER_ONTIME_MS;
+
+/* Default timing, worked out at compile time */
+static const letimer_timing_t letimer_default =
+		LETIMER_TIMING(LETIMER_FREQ, LETIMER_PERIOD_MS, LETIMER_ONTIME_MS);
+
+/* Current timing */
+static letimer_timing_t letimer_cur =
+		LETIMER_TIMING(LETIMER_FREQ, LETIMER_PERIOD_MS, LETIMER_ONTIME_MS);
+
+/* Clock frequency in Hz, corrected by calibration */
+static volatile uint32_t letimer_freq = LETIMER_FREQ;
+
+/* Timing to load at the next underflow */
+static letimer_timing_t letimer_next;
+static volatile bool letimer_next_pending = false;
+
+/* Stop LETIMER0 once the staged timing is loaded, LED0 is off for good */
+static volatile bool letimer_next_stop = false;
+
+/* LETIMER0 is running and holds LETIMER_EM */
+static volatile bool letimer_running = false;
+
+#if LETIMER_CAL
+/* Calibration progress */
+typedef enum letimer_cal_e {
+	LETIMER_CAL_IDLE,
+	LETIMER_CAL_SETTLE,
+	LETIMER_CAL_RUN,
+} letimer_cal_t;
+
+static volatile letimer_cal_t letimer_cal = LETIMER_CAL_IDLE;
+static uint32_t letimer_cal_last = 0;
+static uint32_t letimer_cal_start = 0;
+static uint32_t letimer_cal_count = 0;
+#endif
+
+/* Command ring, single producer (_adc_gest() in adc.c, called from the
+ * gesture layer) and single consumer (letimer_task() in the main loop). The head is only written by the
+ * producer and the tail only by the consumer, so no locking is needed. */
+static letimer_cmd_rec_t letimer_cmdq[LETIMER_CMDQ_SIZE];
+static volatile uint32_t letimer_cmdq_head = 0;
+static volatile uint32_t letimer_cmdq_tail = 0;
+
+/* Number of commands dropped because the ring was full */
+static uint32_t letimer_cmdq_dropped = 0;
+
+/* Take the oldest command off the ring */
+static bool _letimer_cmd_pop(letimer_cmd_rec_t *rec) {
+	uint32_t tail = letimer_cmdq_tail;
+
+	if (tail == letimer_cmdq_head) {
+		return false;
+	}
+
+	/* Make sure the record is read after the head that published it */
+	__DMB();
+	*rec = letimer_cmdq[tail & (LETIMER_CMDQ_SIZE - 1)];
+
+	/* Make sure the record is read before the slot is handed back */
+	__DMB();
+	letimer_cmdq_tail = tail + 1;
+
+	return true;
+}
 
-/* Command message queue */
-uint32_t letimer_cmd_state[LETIMER_NUMCMD] = {0,0,0,0};
+/* Calculate the compare values for the current on time and clock frequency
+ * and stage them. They are written by the interrupt handler at the next
+ * underflow, when the counter has just been reloaded from COMP0, so the timer
+ * never stops and the current period is not cut short. Must be called with
+ * interrupts disabled or from the interrupt handler. */
+static void _letimer_stage(void) {
+
+	letimer_timing(letimer_freq, LETIMER_PERIOD_MS, letimer_ontime, &letimer_next);
+	letimer_next_pending = true;
+	letimer_next_stop = letimer_ontime == 0;
+
+	/* Make sure we get the underflow to load it. The flag is set on every
+	 * underflow, drop a stale one or it would load mid period */
+	if (!(LETIMER0->IEN & LETIMER_IEN_UF)) {
+		LETIMER_IntClear(LETIMER0, LETIMER_IFC_UF);
+		LETIMER_IntEnable(LETIMER0, LETIMER_IEN_UF);
+	}
+}
+
+#if LETIMER_CAL
+/* Start a calibration, EM2 is blocked until it is done */
+static void _letimer_cal_start(void) {
+	if (letimer_cal != LETIMER_CAL_IDLE) {
+		return;
+	}
+
+	slp_blockSleepMode(LETIMER_CAL_EM);
+	letimer_cal = LETIMER_CAL_SETTLE;
+	letimer_cal_last = slp_now();
+	if (!(LETIMER0->IEN & LETIMER_IEN_UF)) {
+		LETIMER_IntClear(LETIMER0, LETIMER_IFC_UF);
+		LETIMER_IntEnable(LETIMER0, LETIMER_IEN_UF);
+	}
+}
+
+/* Whether the last calibration is older than LETIMER_CAL_INTERVAL_MS */
+static bool _letimer_cal_due(void) {
+	return slp_now() - letimer_cal_last >=
+			(uint32_t) ((uint64_t) LETIMER_CAL_INTERVAL_MS * SLP_CLK_FREQ / 1000);
+}
+
+/* Count an underflow towards the calibration, called from the interrupt
+ * handler. At the end, the ULFRCO cycles in the window over the RTCC time
+ * gives the frequency. */
+static void _letimer_cal_uf(void) {
+	uint32_t now = RTCC_CounterGet();
+	uint64_t cycles;
+
+	switch (letimer_cal) {
+	case LETIMER_CAL_SETTLE:
+		letimer_cal_start = now;
+		letimer_cal_count = 0;
+		letimer_cal = LETIMER_CAL_RUN;
+		break;
+	case LETIMER_CAL_RUN:
+		if (++letimer_cal_count < LETIMER_CAL_PERIODS) {
+			break;
+		}
+
+		/* Counter reloads from COMP0, so a period is COMP0 + 1 ticks */
+		cycles = (uint64_t) ((uint32_t) letimer_cur.comp0 + 1) <<
+				letimer_cur.presc;
+		cycles *= LETIMER_CAL_PERIODS;
+		if (now != letimer_cal_start) {
+			letimer_freq = (uint32_t) ((cycles * SLP_RTCC_FREQ +
+					(now - letimer_cal_start) / 2) / (now - letimer_cal_start));
+			_letimer_stage();
+		}
+
+		letimer_cal = LETIMER_CAL_IDLE;
+		slp_unblockSleepMode(LETIMER_CAL_EM);
+		break;
+	case LETIMER_CAL_IDLE:
+	default:
+		break;
+	}
+}
+#endif
+
+/* Start LETIMER0 with the current on time. It holds LETIMER_EM for as long
+ * as it runs. Only called while it is stopped, so no interrupt can come. */
+static void _letimer_start(void) {
+	cmu_acquire(CMU_CLK_LETIMER0);
+	slp_blockSleepMode(LETIMER_EM);
+
+	/* Period and prescaler are constant, only the on time or the frequency
+	 * may differ from the default */
+	letimer_cur = letimer_default;
+	if (letimer_ontime != LETIMER_ONTIME_MS || letimer_freq != LETIMER_FREQ) {
+		letimer_timing(letimer_freq, LETIMER_PERIOD_MS, letimer_ontime, &letimer_cur);
+	}
+
+	/* Clear low four bits and rewrite with prescaler */
+	CMU->LFAPRESC0 &= ~0xf;
+	CMU->LFAPRESC0 |= letimer_cur.presc;
+
+	LETIMER_CompareSet(LETIMER0, 0, letimer_cur.comp0);
+	LETIMER_CompareSet(LETIMER0, 1, letimer_cur.comp1);
+
+	LETIMER_IntClear(LETIMER0, LETIMER_IFC_UF | LETIMER_IFC_COMP1);
+#if !LETIMER_PWM
+	/* Enable UF and COMP1 interrupts */
+	LETIMER_IntEnable(LETIMER0, LETIMER_IEN_UF | LETIMER_IEN_COMP1);
+#endif
+
+	letimer_running = true;
+	LETIMER_Enable(LETIMER0, true);
+
+#if LETIMER_CAL
+	/* Calibrate right away */
+	CORE_ATOMIC_IRQ_DISABLE();
+	_letimer_cal_start();
+	CORE_ATOMIC_IRQ_ENABLE();
+#endif
+}
+
+/* Stop LETIMER0 at an underflow, where output 0 has just gone idle, and let
+ * the system sleep below LETIMER_EM. Called from the interrupt handler. */
+static void _letimer_stop(void) {
+	LETIMER_Enable(LETIMER0, false);
+	LETIMER_IntDisable(LETIMER0, LETIMER_IEN_UF | LETIMER_IEN_COMP1);
+	LETIMER_IntClear(LETIMER0, LETIMER_IFC_UF | LETIMER_IFC_COMP1);
+
+#if LETIMER_CAL
+	/* A calibration in progress is dropped */
+	if (letimer_cal != LETIMER_CAL_IDLE) {
+		letimer_cal = LETIMER_CAL_IDLE;
+		slp_unblockSleepMode(LETIMER_CAL_EM);
+	}
+#endif
+
+	letimer_running = false;
+	cmu_release(CMU_CLK_LETIMER0);
+	slp_unblockSleepMode(LETIMER_EM);
+}
+
+/* Apply a new on time from the main loop. A running timer takes it at the
+ * next underflow and stops there if it is zero, a stopped one is started
+ * with it. */
+static void _letimer_update(void) {
+	bool start;
+
+	CORE_ATOMIC_IRQ_DISABLE();
+	start = !letimer_running && letimer_ontime > 0;
+	if (letimer_running) {
+		_letimer_stage();
+#if LETIMER_CAL
+		/* Woken up at the next underflow anyway, calibrate from there */
+		if (_letimer_cal_due()) {
+			_letimer_cal_start();
+		}
+#endif
+	}
+	CORE_ATOMIC_IRQ_ENABLE();
+
+	if (start) {
+		_letimer_start();
+	}
+}
+
+/* Apply a net change to the on time */
+static void _letimer_apply(int32_t delta) {
+	letimer_ontime += delta;
+	if (letimer_ontime > LETIMER_PERIOD_MS) {
+		letimer_ontime = LETIMER_PERIOD_MS;
+	} else if (letimer_ontime < 0) {
+		letimer_ontime = 0;
+	}
+}
+
+/* Drain the command ring in order. Runs of INC and DEC are coalesced into a
+ * single net delta, a reset discards whatever came before it. */
+static void _letimer_process(void) {
+	letimer_cmd_rec_t rec;
+	int32_t delta = 0;
+	bool changed = false;
+
+	while (_letimer_cmd_pop(&rec)) {
+		switch (rec.cmd) {
+		case LETIMER_CMD_NONE:
+			/* Shouldn't happen under normal operation */
+			break;
+		case LETIMER_CMD_INC:
+			delta += LETIMER_STEP;
+			changed = true;
+			break;
+		case LETIMER_CMD_DEC:
+			delta -= LETIMER_STEP;
+			changed = true;
+			break;
+		case LETIMER_CMD_RST:
+			delta = 0;
+			letimer_ontime = LETIMER_ONTIME_MS;
+			gpio_setLED1(false);
+			bma280_disable();
+			changed = true;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (changed) {
+		_letimer_apply(delta);
+		_letimer_update();
+	}
+}
+
+#if LETIMER_PWM
+/* Underflow interrupts are needed to load staged timing or to calibrate */
+static bool _letimer_need_uf(void) {
+#if LETIMER_CAL
+	return letimer_next_pending || letimer_cal != LETIMER_CAL_IDLE;
+#else
+	return letimer_next_pending;
+#endif
+}
+#endif
 
 void LETIMER0_IRQHandler(void) {
+	PROF_ISR_ENTER(PROF_LETIMER0);
 
 	uint32_t int_flag = 0;
 
@@ -48,106 +333,147 @@ void LETIMER0_IRQHandler(void) {
 
 		LETIMER_IntClear(LETIMER0, LETIMER_IEN_UF | LETIMER_IEN_COMP1);
 
-		/* Only do if underflow */
-		if (int_flag == LETIMER_IF_UF) {
-		/* Go through state buffer and look for commands */
-		for (int i = 0; i < LETIMER_NUMCMD; i++) {
-			if (letimer_cmd_state[i] > 0) {
-
-				/* Execute command the right number of times */
-				for (int j = 0; j < letimer_cmd_state[i]; j++) {
-					switch (i) {
-					case LETIMER_CMD_NONE:
-						/* Shouldn't happen under normal operation */
-						break;
-					case LETIMER_CMD_INC:
-						letimer_ontime += 500;
-						if (letimer_ontime > LETIMER_PERIOD * 1000) {
-							letimer_ontime = LETIMER_PERIOD * 1000;
-						}
-						break;
-					case LETIMER_CMD_DEC:
-						//gpio_setLED0(false);
-						//gpio_setLED1(true);
-						letimer_ontime -= 500;
-						if (letimer_ontime < 0) {
-							letimer_ontime = 0;
-						}
-						break;
-					case LETIMER_CMD_RST:
-						//gpio_setLED0(false);
-						//gpio_setLED1(false);
-						letimer_ontime = 20;
-						gpio_setLED1(false);
-						bma280_disable();
-						break;
-					default:
-						break;
-					}
-
-				}
-
-				/* Calculate and set compare values for duty cycle with new ontime as
-				 * defined by macros in associated header file */
-				uint32_t comp0_val = 0;
-				uint32_t comp1_val = 0;
-
-				/* Calculate number of ticks */
-				if (LETIMER_EM == 3) {
-					comp0_val = LETIMER_ULFRCO_FREQ * LETIMER_PERIOD;
-					comp1_val = LETIMER_ULFRCO_FREQ * letimer_ontime / 1000;
-				} else {
-					comp0_val = LETIMER_LFXO_FREQ * LETIMER_PERIOD;
-					comp1_val = LETIMER_LFXO_FREQ * letimer_ontime / 1000;
-				}
-
-				/* Adjust ticks if greater than 16 bits */
-				uint8_t div = 0;
-				while (comp0_val > LETIMER_MAX) {
-					comp0_val /= 2;
-					comp1_val /=2;
-					div++;
-				}
-
-				/* Stop timer */
-				LETIMER0->CMD = LETIMER_CMD_STOP;
-
-				/* Wait until the timer is not busy (clock crossing) */
-				while(LETIMER0->SYNCBUSY) {}
-
-				/* Clear low four bits and rewrite with value of div */
-				CMU->LFAPRESC0 &= ~0xf;
-				CMU->LFAPRESC0 |= div;
-
-				/* Set new compare */
-				LETIMER_CompareSet(LETIMER0, 0, comp0_val);
-				LETIMER_CompareSet(LETIMER0, 1, comp1_val);
-
-				/* Clear timer */
-				LETIMER0->CMD = LETIMER_CMD_CLEAR;
-				while(LETIMER0->SYNCBUSY) {}
-
-				/* Start again */
-				LETIMER0->CMD = LETIMER_CMD_START;
-				while(LETIMER0->SYNCBUSY) {}
-			}
+		/* The counter reloaded from COMP0 at the underflow and passed COMP1
+		 * at the match, how far it has counted down since gives the trigger */
+		PROF_ISR_LATENCY(PROF_LETIMER0, prof_ago(_prof_start,
+				(uint16_t) (((int_flag == LETIMER_IF_UF) ? letimer_cur.comp0 :
+				letimer_cur.comp1) - LETIMER_CounterGet(LETIMER0)),
+				letimer_freq >> letimer_cur.presc));
 
-			/* set command state buffer for that command to 0 */
-			letimer_cmd_state[i] = 0;
+#if LETIMER_CAL
+		if (int_flag == LETIMER_IF_UF) {
+			_letimer_cal_uf();
 		}
+#endif
+
+		/* New period just started, load staged timing */
+		if (int_flag == LETIMER_IF_UF && letimer_next_pending) {
+			if (letimer_next.presc != letimer_cur.presc) {
+				CMU->LFAPRESC0 = (CMU->LFAPRESC0 & ~0xf) | letimer_next.presc;
+			}
+			LETIMER_CompareSet(LETIMER0, 0, letimer_next.comp0);
+			LETIMER_CompareSet(LETIMER0, 1, letimer_next.comp1);
+			letimer_cur = letimer_next;
+			letimer_next_pending = false;
+
+			/* Output 0 just went idle, leave it there */
+			if (letimer_next_stop) {
+				_letimer_stop();
+			}
 		}
 
+#if LETIMER_PWM
+		/* Hardware drives the LED, nothing more to wait for */
+		if (!_letimer_need_uf()) {
+			LETIMER_IntDisable(LETIMER0, LETIMER_IEN_UF);
+		}
+#else
 		/* Strict toggle on match mode */
 		if (int_flag == LETIMER_IF_UF) {
 			gpio_setLED0(false);
 		} else if (int_flag == LETIMER_IF_COMP1) {
 			gpio_setLED0(true);
 		}
+#endif
 	}
 
+	PROF_ISR_EXIT(PROF_LETIMER0);
+
 	return;
 }
 
+void letimer_task(void) {
+	_letimer_process();
+}
+
+
+bool letimer_cmd_post(letimer_cmd_t cmd) {
+	uint32_t head = letimer_cmdq_head;
+
+	if (head - letimer_cmdq_tail >= LETIMER_CMDQ_SIZE) {
+		letimer_cmdq_dropped++;
+		return false;
+	}
+
+	letimer_cmdq[head & (LETIMER_CMDQ_SIZE - 1)].cmd = cmd;
+	letimer_cmdq[head & (LETIMER_CMDQ_SIZE - 1)].time = RTCC_CounterGet();
+
+	/* Make sure the record is written before it is published */
+	__DMB();
+	letimer_cmdq_head = head + 1;
+
+	/* Process from the main loop, the result is applied at the next
+	 * underflow anyway */
+	evt_post(EVT_LETIMER);
+
+	return true;
+}
+
+uint32_t letimer_cmd_dropped(void) {
+	return letimer_cmdq_dropped;
+}
+
+bool letimer_timing(uint32_t freq, uint32_t period_ms, uint32_t ontime_ms,
+		letimer_timing_t *timing) {
+	uint32_t period = LETIMER_TICKS(freq, period_ms);
+	uint32_t presc = 0;
+
+	if (ontime_ms > period_ms) {
+		ontime_ms = period_ms;
+	}
+
+	/* Smallest prescaler that fits the period in 16 bits */
+	if (period > LETIMER_MAX) {
+		presc = 32 - __CLZ(period >> 16);
+	}
+	if (presc > LETIMER_PRESC_MAX) {
+		return false;
+	}
+
+	timing->presc = presc;
+	timing->comp0 = period >> presc;
+	timing->comp1 = LETIMER_TICKS(freq, ontime_ms) >> presc;
+
+	return true;
+}
+
+uint32_t letimer_getFreq(void) {
+	return letimer_freq;
+}
+
+int32_t letimer_getOntime(void) {
+	return letimer_ontime;
+}
+
+void letimer_setOntime(int32_t ms) {
+	letimer_ontime = ms;
+}
+
+uint32_t letimer_nextWake(void) {
+	uint32_t ien = LETIMER0->IEN;
+	uint32_t freq = letimer_freq;
+	uint32_t cnt;
+	uint32_t comp1;
+	uint32_t ticks;
+
+	/* Stopped, or nothing enabled, e.g. PWM mode with no update pending */
+	if (!letimer_running || !(ien & (LETIMER_IEN_UF | LETIMER_IEN_COMP1))) {
+		return SLP_WAKE_NONE;
+	}
+
+	cnt = LETIMER_CounterGet(LETIMER0);
+	comp1 = LETIMER_CompareGet(LETIMER0, 1);
+
+	/* Counter runs down from COMP0, COMP1 match comes first if not passed */
+	if ((ien & LETIMER_IEN_COMP1) && cnt > comp1) {
+		ticks = cnt - comp1;
+	} else {
+		ticks = cnt + 1;
+	}
+
+	return (uint32_t) (((uint64_t) ticks << letimer_cur.presc) * 1000000 / freq);
+}
+
 void letimer_init(void){
 	/* Initialize LETIMER0 for COMP0 controlling period via underflow and
 	 * COMP1 controlling duty cycle*/
@@ -159,41 +485,16 @@ void letimer_init(void){
 		.out0Pol = 0,
 		.out1Pol = 0,
 		.repMode = letimerRepeatFree,
+#if LETIMER_PWM
+		.ufoa0 = letimerUFOAPwm,
+#else
 		.ufoa0 = letimerUFOANone,
+#endif
 		.ufoa1 = letimerUFOANone,
 	};
 
-	/* Get default on time in ms */
-	letimer_ontime = LETIMER_ONTIME * 1000;
-
-	/* Calculate and set compare values for correct period and duty cycle as
-	 * defined by macros in associated header file */
-	uint32_t comp0_val = 0;
-	uint32_t comp1_val = 0;
-
-	/* Calculate number of ticks */
-	if (LETIMER_EM == 3) {
-		comp0_val = LETIMER_ULFRCO_FREQ * LETIMER_PERIOD;
-		comp1_val = LETIMER_ULFRCO_FREQ * letimer_ontime / 1000;
-	} else {
-		comp0_val = LETIMER_LFXO_FREQ * LETIMER_PERIOD;
-		comp1_val = LETIMER_LFXO_FREQ * letimer_ontime / 1000;
-	}
-
-	/* Adjust ticks if greater than 16 bits */
-	uint8_t div = 0;
-	while (comp0_val > LETIMER_MAX) {
-		comp0_val /= 2;
-		comp1_val /=2;
-		div++;
-	}
-
-	/* Clear low four bits and rewrite with value of div */
-	CMU->LFAPRESC0 &= ~0xf;
-	CMU->LFAPRESC0 |= div;
-
-	LETIMER_CompareSet(LETIMER0, 0, comp0_val);
-	LETIMER_CompareSet(LETIMER0, 1, comp1_val);
+	/* Clock is held for setup, afterwards only while LETIMER0 runs */
+	cmu_acquire(CMU_CLK_LETIMER0);
 
 	/* Initialize LETIMER0 */
 	LETIMER_Init(LETIMER0, &letimerInit);
@@ -208,17 +509,25 @@ void letimer_init(void){
 		LETIMER_IFC_REP1 |
 		LETIMER_IFC_UF;
 
-	/* Enable UF and COMP1 interrupts */
-	LETIMER0->IEN |= LETIMER_IEN_UF | LETIMER_IEN_COMP1;
+#if LETIMER_PWM
+	/* Drive LED0 from output 0, no interrupts until a command comes in */
+	LETIMER0->ROUTELOC0 = LETIMER_ROUTELOC0_OUT0LOC_LOC28;
+	LETIMER0->ROUTEPEN = LETIMER_ROUTEPEN_OUT0PEN;
+#endif
 
-	/* Block on correct sleep level using sleep library */
-	slp_blockSleepMode(LETIMER_EM);
+	/* Let the sleep governor know when we wake up next */
+	slp_registerWakeSource(letimer_nextWake);
 
 	/* Enable interrupts in NVIC */
 	NVIC_EnableIRQ(LETIMER0_IRQn);
 
-	/* Enable LETIMER0 */
-	LETIMER_Enable(LETIMER0, true);
+	cmu_release(CMU_CLK_LETIMER0);
+
+	/* An on time of zero restored from EM4 leaves LED0 dark and the timer
+	 * stopped */
+	if (letimer_ontime > 0) {
+		_letimer_start();
+	}
 
 	return;
 }
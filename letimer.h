@@ -27,19 +27,53 @@
 #include "main.h"
 
 /*
- * @brief Lowest energy state the LETIMER should run at
+ * @brief Lowest energy state the LETIMER should run at, blocked only while it
+ * runs
  */
 #define LETIMER_EM 3
 
 /*
- * @brief Period of LETIMER0 in seconds
+ * @brief Drive LED0 from LETIMER0 output 0 in PWM mode instead of toggling it
+ * from the UF and COMP1 interrupts. The core is then only woken up to apply a
+ * new duty cycle, and with LETIMER_CAL for the periods of a calibration.
  */
-#define LETIMER_PERIOD 1.75
+#ifndef LETIMER_PWM
+#define LETIMER_PWM 1
+#endif
 
 /*
- * @brief On time of LED in seconds
+ * @brief Calibrate the ULFRCO against the LFXO
+ *
+ * The ULFRCO is only accurate to tens of percent. When LETIMER0 runs from it,
+ * a calibration is started each time LETIMER0 starts, and with the first
+ * command once LETIMER_CAL_INTERVAL_MS has passed on the sleep clock, as the
+ * core wakes up at the next underflow to load it anyway. EM2 is only blocked
+ * during the calibration itself, so the LFXO and the RTCC keep running, and
+ * the RTCC time of LETIMER_CAL_PERIODS LETIMER0 periods gives the actual
+ * ULFRCO frequency. The first underflow is skipped while the LFXO settles
+ * after EM3. The underflow interrupt is only enabled for those periods.
+ *
+ * Nothing that runs in EM3 can time the interval without waking the core,
+ * the RTCC stops with the LFXO and a virtual timer would hold EM2 for all of
+ * it, so an untouched LED0 keeps its last calibration. Off by default, the
+ * LED0 timing is then as accurate as the ULFRCO.
+ */
+#ifndef LETIMER_CAL
+#define LETIMER_CAL 0
+#endif
+#define LETIMER_CAL_INTERVAL_MS 60000
+#define LETIMER_CAL_PERIODS 2
+#define LETIMER_CAL_EM 2
+
+/*
+ * @brief Period of LETIMER0 in ms
  */
-#define LETIMER_ONTIME 0.02
+#define LETIMER_PERIOD_MS 1750
+
+/*
+ * @brief On time of LED in ms
+ */
+#define LETIMER_ONTIME_MS 20
 
 /*
  * @brief Frequencies for LFA clocks in Hz
@@ -47,18 +81,70 @@
 #define LETIMER_LFXO_FREQ 32768
 #define LETIMER_ULFRCO_FREQ 1000
 
+/*
+ * @brief LFA clock frequency for the selected energy mode
+ */
+#define LETIMER_FREQ ((LETIMER_EM == 3) ? LETIMER_ULFRCO_FREQ : LETIMER_LFXO_FREQ)
+
 /*
  * @brief Maximum count for LETIMER
  */
 #define LETIMER_MAX 65535
 
 /*
- * @brief Number of commands available including none command
+ * @brief Largest LFA prescaler for LETIMER0 (divide by 32768)
  */
-#define LETIMER_NUMCMD 4
+#define LETIMER_PRESC_MAX 15
 
 /*
- * @briefs Commands from ADC interrupt
+ * @brief Compile time timing helpers
+ *
+ * LETIMER_TICKS gives the number of clock ticks in a time, LETIMER_PRESC the
+ * smallest prescaler that brings a tick count within 16 bits (or
+ * LETIMER_PRESC_MAX + 1 if none does) and LETIMER_TIMING an initializer for
+ * letimer_timing_t. With constant arguments everything folds to constants.
+ */
+#define LETIMER_TICKS(freq, ms) ((uint32_t) (((uint64_t) (freq) * (ms)) / 1000))
+#define _LETIMER_FITS(t, p) (((t) >> (p)) <= LETIMER_MAX)
+#define LETIMER_PRESC(t) \
+	(_LETIMER_FITS(t, 0) ? 0 : _LETIMER_FITS(t, 1) ? 1 : \
+	 _LETIMER_FITS(t, 2) ? 2 : _LETIMER_FITS(t, 3) ? 3 : \
+	 _LETIMER_FITS(t, 4) ? 4 : _LETIMER_FITS(t, 5) ? 5 : \
+	 _LETIMER_FITS(t, 6) ? 6 : _LETIMER_FITS(t, 7) ? 7 : \
+	 _LETIMER_FITS(t, 8) ? 8 : _LETIMER_FITS(t, 9) ? 9 : \
+	 _LETIMER_FITS(t, 10) ? 10 : _LETIMER_FITS(t, 11) ? 11 : \
+	 _LETIMER_FITS(t, 12) ? 12 : _LETIMER_FITS(t, 13) ? 13 : \
+	 _LETIMER_FITS(t, 14) ? 14 : _LETIMER_FITS(t, 15) ? 15 : 16)
+#define LETIMER_TIMING(freq, period_ms, ontime_ms) { \
+	.presc = LETIMER_PRESC(LETIMER_TICKS(freq, period_ms)), \
+	.comp0 = LETIMER_TICKS(freq, period_ms) >> \
+		LETIMER_PRESC(LETIMER_TICKS(freq, period_ms)), \
+	.comp1 = LETIMER_TICKS(freq, ontime_ms) >> \
+		LETIMER_PRESC(LETIMER_TICKS(freq, period_ms)), \
+}
+
+/* Range checks for the configured timing on both clock sources */
+_Static_assert(LETIMER_PRESC(LETIMER_TICKS(LETIMER_ULFRCO_FREQ, LETIMER_PERIOD_MS))
+		<= LETIMER_PRESC_MAX, "LETIMER period too long for ULFRCO");
+_Static_assert(LETIMER_PRESC(LETIMER_TICKS(LETIMER_LFXO_FREQ, LETIMER_PERIOD_MS))
+		<= LETIMER_PRESC_MAX, "LETIMER period too long for LFXO");
+_Static_assert(LETIMER_TICKS(LETIMER_ULFRCO_FREQ, LETIMER_PERIOD_MS) > 0,
+		"LETIMER period too short for ULFRCO");
+_Static_assert(LETIMER_ONTIME_MS <= LETIMER_PERIOD_MS,
+		"LETIMER on time longer than period");
+
+/*
+ * @brief On time change per INC or DEC command in ms
+ */
+#define LETIMER_STEP 500
+
+/*
+ * @brief Size of the command ring, must be a power of two
+ */
+#define LETIMER_CMDQ_SIZE 16
+
+/*
+ * @briefs Commands from the joystick
  */
 typedef enum letimer_cmd_e {
 	LETIMER_CMD_NONE,
@@ -67,13 +153,118 @@ typedef enum letimer_cmd_e {
 	LETIMER_CMD_RST,
 } letimer_cmd_t;
 
-/* Command message queue */
-extern uint32_t letimer_cmd_state[];
+/*
+ * @brief Prescaler and compare values for a period and on time
+ */
+typedef struct letimer_timing_s {
+	uint8_t presc;
+	uint16_t comp0;
+	uint16_t comp1;
+} letimer_timing_t;
+
+/*
+ * @brief Command record with RTCC timestamp of when it was posted
+ */
+typedef struct letimer_cmd_rec_s {
+	letimer_cmd_t cmd;
+	uint32_t time;
+} letimer_cmd_rec_t;
+
+/**
+ * @brief Post a command
+ *
+ * When called, this function adds a timestamped command to the command ring.
+ * Commands are processed in order from the main loop, with runs of INC and
+ * DEC coalesced into a single net change, and take effect at the next
+ * underflow. The ring is lock-free with a single producer, so this must only
+ * be called from one context, the joystick gestures in adc.c.
+ *
+ * @param cmd The command to post
+ *
+ * @return True if posted, false if the ring was full
+ */
+bool letimer_cmd_post(letimer_cmd_t cmd);
+
+/**
+ * @brief Process commands
+ *
+ * This function is the bottom half of the LETIMER0 interrupt. It drains the
+ * command ring and stages the new compare value. It is run from the main loop
+ * on EVT_LETIMER, which letimer_cmd_post() posts.
+ *
+ * @return Void
+ */
+void letimer_task(void);
+
+/**
+ * @brief Get number of dropped commands
+ *
+ * @return Number of commands dropped because the command ring was full
+ */
+uint32_t letimer_cmd_dropped(void);
+
+/**
+ * @brief Calculate LETIMER timing
+ *
+ * This function calculates the prescaler and compare values for a period and
+ * on time with integer math only. It gives the same result as LETIMER_TIMING
+ * and is meant for values only known at run time.
+ *
+ * @param freq Clock frequency in Hz
+ * @param period_ms Period in ms
+ * @param ontime_ms On time in ms, clamped to the period
+ * @param timing Location to store the result
+ *
+ * @return True if the period fits the prescaler range
+ */
+bool letimer_timing(uint32_t freq, uint32_t period_ms, uint32_t ontime_ms,
+		letimer_timing_t *timing);
+
+/**
+ * @brief Get LED on time
+ *
+ * @return The current on time in ms
+ */
+int32_t letimer_getOntime(void);
+
+/**
+ * @brief Set LED on time
+ *
+ * This function sets the on time used by letimer_init(). It is used to restore
+ * the on time after waking up from EM4 and must be called before init.
+ *
+ * @param ms The on time in ms
+ *
+ * @return Void
+ */
+void letimer_setOntime(int32_t ms);
+
+/**
+ * @brief Get the LETIMER0 clock frequency
+ *
+ * @return The nominal frequency, or the last calibrated one, in Hz
+ */
+uint32_t letimer_getFreq(void);
+
+/**
+ * @brief Time until next LETIMER0 interrupt
+ *
+ * This function returns the time until the next underflow or COMP1 match as
+ * a wake source for the sleep governor.
+ *
+ * @return Time until the next interrupt in microseconds
+ */
+uint32_t letimer_nextWake(void);
 
 /**
  * @brief Initializes LETIMER0
  *
- * This function initializes LETIMER0 for the demo.
+ * This function initializes LETIMER0 for the demo and starts it unless the
+ * on time is zero. LETIMER0 only runs, and only holds LETIMER_EM, while LED0
+ * has an on time. Dimming it to zero stops the timer at the next underflow
+ * with LED0 off, which lets the system sleep in EM4H, and a later command
+ * starts it again. With LETIMER_CAL a calibration is started each time the
+ * timer starts.
  *
  * @return Void
  */
@@ -92,6 +92,10 @@ uint8_t boot_to_dfu = 0;
 #include "letimer.h"
 #include "adc.h"
 #include "bma280.h"
+#include "evt.h"
+#include "prof.h"
+#include "vtmr.h"
+#include "gest.h"
 #include "em_cmu.h"
 
 //***********************************************************************************
@@ -103,6 +107,8 @@ uint8_t boot_to_dfu = 0;
 // global variables
 //***********************************************************************************
 
+/* Latest accelerometer sample from the FIFO stream */
+static bma280_xyz_t main_accel;
 
 //***********************************************************************************
 // function prototypes
@@ -113,6 +119,30 @@ uint8_t boot_to_dfu = 0;
 // functions
 //***********************************************************************************
 
+/**
+ * @brief Collect application state to keep across EM4
+ */
+static void main_em4_save(slp_retain_t *state) {
+	state->letimer_ontime = letimer_getOntime();
+	state->bma280_enabled = bma280_isEnabled();
+	state->led1 = gpio_getLED1();
+}
+
+/**
+ * @brief Drain the accelerometer sample ring
+ *
+ * Run on EVT_ACCEL so the ring never fills up. Nothing acts on the samples
+ * yet, the latest one is kept in main_accel.
+ */
+static void main_accel_task(void) {
+	bma280_xyz_t xyz[BMA280_FIFO_FRAMES];
+	uint32_t n;
+
+	while ((n = bma280_fifo_read(xyz, BMA280_FIFO_FRAMES)) > 0) {
+		main_accel = xyz[n - 1];
+	}
+}
+
 
 //***********************************************************************************
 // main
@@ -124,6 +154,11 @@ uint8_t boot_to_dfu = 0;
  */
 int main(void) {
 	//int i;
+	slp_retain_t retain;
+	bool warm;
+
+	/* Chip errata first, before any peripheral is touched */
+	CHIP_Init();
 
 	#ifdef FEATURE_SPI_FLASH
 	  /* Put the SPI flash into Deep Power Down mode for those radio boards where it is available */
@@ -134,42 +169,98 @@ int main(void) {
 
 	#endif /* FEATURE_SPI_FLASH */
 
-    /* Initialize peripherals */
-    enter_DefaultMode_from_RESET();
-	//CHIP_Init();
+	/* Check for a wakeup from EM4 with retained state */
+	warm = slp_em4_restore(&retain);
+
+	if (warm) {
+		/* LFXO and RTCC kept running, skip their setup */
+		EMU_enter_DefaultMode_from_RESET();
+		PRS_enter_DefaultMode_from_RESET();
+	} else {
+		/* Initialize peripherals, this runs CHIP_Init() again which only
+		 * repeats the errata writes */
+		enter_DefaultMode_from_RESET();
+	}
 
     /* Initialize stack */
     gecko_init(&config);
 
 	/* Initialize clocks */
-	cmu_init();
+	if (warm) {
+		cmu_warm_init();
+	} else {
+		cmu_init();
+	}
 
 	/* Initialize GPIO */
 	gpio_init();
 
+	/* Put LED1 back and release the pins latched through EM4. LED0 is driven
+	 * by LETIMER0 and comes back with it. */
+	if (warm) {
+		gpio_setLED1(retain.led1);
+		EMU_UnlatchPinRetention();
+	}
+
+	/* Initialize interrupt profiling */
+	prof_init();
+
+	/* Initialize event dispatcher */
+	evt_init();
+
 	/* Initialize sleep system */
 	slp_init();
+	slp_em4_setHandler(main_em4_save);
+
+	/* Initialize virtual timers on the RTCC */
+	vtmr_init();
 
 	/* Initialize the low energy timer */
+	if (warm) {
+		letimer_setOntime(retain.letimer_ontime);
+	}
 	letimer_init();
 
 	/* Initialize the ADC */
 	adc_init();
 
 	/* Temp */
-	bma280_init();
+	if (warm) {
+		bma280_warm_init(retain.bma280_enabled);
+	} else {
+		bma280_init();
+	}
 
-	/* Always go into the lowest energy state */
-	while (1) {
+	/* Process LED1 toggle from tap sensor */
+	evt_register(EVT_TAP, bma280_task);
+	evt_register(EVT_BMA280, bma280_task);
+
+	/* Classify joystick samples each time the LDMA fills half the ring */
+	evt_register(EVT_JOY, adc_task);
+
+	/* Joystick long-press and auto-repeat timers */
+	evt_register(EVT_GEST, gest_task);
 
-		/* Process LED1 toggle from tap sensor */
-		bma280_tap_handle();
+	/* LETIMER0 command processing */
+	evt_register(EVT_LETIMER, letimer_task);
 
-		/* Set flag when going to sleep to debounce switch */
-		adc_debounce();
+	/* Samples streamed from the BMA280 FIFO */
+	evt_register(EVT_ACCEL, main_accel_task);
+
+	/* Always go into the lowest energy state */
+	while (1) {
 
-		/* Sleep */
-		slp_sleep();
+		/* Run handlers of events posted by interrupts */
+		evt_dispatch();
+
+		/* Sleep unless an event came in since dispatching. Interrupts stay
+		 * masked so none is missed, the core still wakes up and the handler
+		 * runs once they are enabled again. */
+		CORE_ATOMIC_IRQ_DISABLE();
+		if (!evt_pending()) {
+			slp_sleep();
+		}
+		CORE_ATOMIC_IRQ_ENABLE();
 	}
 
     /* Event pointer for handling events */
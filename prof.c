@@ -0,0 +1,55 @@
+/**
+ * @file prof.c
+ * @brief The implementation for interrupt profiling
+ *
+ * This file implements the interrupt profiling layer. See the associated
+ * header file for function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "prof.h"
+
+#if PROF_ENABLE
+
+/* Histograms */
+prof_hist_t prof_hist[PROF_NUM_ISR];
+
+void prof_get(prof_isr_t isr, prof_hist_t *hist) {
+
+	/* Copy atomically so the snapshot is consistent with interrupts */
+	CORE_ATOMIC_IRQ_DISABLE();
+	*hist = prof_hist[isr];
+	CORE_ATOMIC_IRQ_ENABLE();
+
+	return;
+}
+
+void prof_clear(void) {
+
+	CORE_ATOMIC_IRQ_DISABLE();
+	for (int i = 0; i < PROF_NUM_ISR; i++) {
+		prof_hist[i].count = 0;
+		prof_hist[i].dur_max = 0;
+		prof_hist[i].lat_max = 0;
+		for (int j = 0; j < PROF_BUCKETS; j++) {
+			prof_hist[i].dur[j] = 0;
+			prof_hist[i].lat[j] = 0;
+		}
+	}
+	CORE_ATOMIC_IRQ_ENABLE();
+
+	return;
+}
+
+void prof_init(void) {
+
+	/* The cycle counter belongs to evt_init() */
+	prof_clear();
+
+	return;
+}
+
+#endif /* PROF_ENABLE */
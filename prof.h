@@ -0,0 +1,193 @@
+/**
+ * @file prof.h
+ * @brief Definitions and interfaces for interrupt profiling
+ *
+ * This file declares the interrupt profiling layer. Each instrumented handler
+ * timestamps its entry and exit with the DWT cycle counter and the duration
+ * is kept in a log2 bucketed histogram in RAM. Handlers that can tell when
+ * their interrupt condition arose also keep a histogram of the start latency.
+ * With PROF_ENABLE set to 0 the instrumentation compiles to nothing.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __PROF_H__
+#define __PROF_H__
+
+#include "main.h"
+#include "em_device.h"
+
+/*
+ * @brief Set to 0 to compile out all interrupt profiling
+ */
+#ifndef PROF_ENABLE
+#define PROF_ENABLE 1
+#endif
+
+/*
+ * @brief Number of histogram buckets, bucket n counts values in [2^(n-1), 2^n)
+ */
+#define PROF_BUCKETS 33
+
+/*
+ * @brief Core clock in Hz, cmu_init() runs the core from the HFRCO at 19 MHz
+ */
+#define PROF_CORE_FREQ 19000000
+
+/*
+ * @brief Instrumented interrupt handlers
+ */
+typedef enum prof_isr_e {
+	PROF_LDMA,
+	PROF_LETIMER0,
+	PROF_GPIO_ODD,
+	PROF_RTCC,
+	PROF_ACMP0,
+	PROF_NUM_ISR
+} prof_isr_t;
+
+/*
+ * @brief Histograms for one interrupt handler, all values in core cycles
+ */
+typedef struct prof_hist_s {
+	uint32_t count;
+	uint32_t dur_max;
+	uint32_t lat_max;
+	uint32_t dur[PROF_BUCKETS];
+	uint32_t lat[PROF_BUCKETS];
+} prof_hist_t;
+
+#if PROF_ENABLE
+
+/* Histograms, only to be accessed through the macros and functions below */
+extern prof_hist_t prof_hist[PROF_NUM_ISR];
+
+/**
+ * @brief Log2 bucket of a value, 0 for 0
+ */
+static inline uint32_t prof_bucket(uint32_t v) {
+	return 32 - __CLZ(v);
+}
+
+/**
+ * @brief Record handler entry
+ */
+static inline uint32_t prof_enter(prof_isr_t isr) {
+	return DWT->CYCCNT;
+}
+
+/**
+ * @brief Record handler exit
+ */
+static inline void prof_exit(prof_isr_t isr, uint32_t start) {
+	prof_hist_t *h = &prof_hist[isr];
+	uint32_t dur = DWT->CYCCNT - start;
+
+	h->dur[prof_bucket(dur)]++;
+	if (dur > h->dur_max) {
+		h->dur_max = dur;
+	}
+	h->count++;
+}
+
+/**
+ * @brief Record how long after its trigger a handler started
+ *
+ * @param isr The handler
+ * @param start Cycle counter at handler entry
+ * @param trigger Cycle counter when the interrupt condition arose
+ */
+static inline void prof_latency(prof_isr_t isr, uint32_t start,
+		uint32_t trigger) {
+	prof_hist_t *h = &prof_hist[isr];
+	uint32_t lat = start - trigger;
+
+	h->lat[prof_bucket(lat)]++;
+	if (lat > h->lat_max) {
+		h->lat_max = lat;
+	}
+}
+
+/**
+ * @brief Cycle counter value a number of ticks of a slower clock earlier
+ *
+ * The DWT counter stops while the core sleeps, so a trigger that woke the
+ * core can't be stamped when it happens. A handler whose peripheral counts
+ * on from a compare value works it out from how far the counter got
+ * instead, to the resolution of one tick.
+ *
+ * @param cyc Cycle counter value
+ * @param ticks Ticks of the slower clock
+ * @param hz Frequency of the slower clock
+ *
+ * @return Cycle counter value that many ticks before cyc
+ */
+static inline uint32_t prof_ago(uint32_t cyc, uint32_t ticks, uint32_t hz) {
+	return cyc - (uint32_t) ((uint64_t) ticks * PROF_CORE_FREQ / hz);
+}
+
+/**
+ * @brief Put at the very start of a handler
+ *
+ * @param isr The handler (prof_isr_t)
+ */
+#define PROF_ISR_ENTER(isr) uint32_t _prof_start = prof_enter(isr)
+
+/**
+ * @brief Put at every exit of a handler
+ *
+ * @param isr The handler (prof_isr_t)
+ */
+#define PROF_ISR_EXIT(isr) prof_exit((isr), _prof_start)
+
+/**
+ * @brief Record the start latency, after PROF_ISR_ENTER
+ *
+ * The trigger is only evaluated with profiling compiled in.
+ *
+ * @param isr The handler (prof_isr_t)
+ * @param trigger Cycle counter when the interrupt condition arose
+ */
+#define PROF_ISR_LATENCY(isr, trigger) prof_latency((isr), _prof_start, (trigger))
+
+/**
+ * @brief Get histograms of a handler
+ *
+ * This function copies the histograms of one interrupt handler.
+ *
+ * @param isr The handler
+ * @param hist Location to store the histograms
+ *
+ * @return Void
+ */
+void prof_get(prof_isr_t isr, prof_hist_t *hist);
+
+/**
+ * @brief Clear all histograms
+ *
+ * @return Void
+ */
+void prof_clear(void);
+
+/**
+ * @brief Initializes interrupt profiling
+ *
+ * This function clears the histograms. The DWT cycle counter is started by
+ * evt_init(), which also times event handlers with it.
+ *
+ * @return Void
+ */
+void prof_init(void);
+
+#else
+
+#define PROF_ISR_ENTER(isr)
+#define PROF_ISR_EXIT(isr)
+#define PROF_ISR_LATENCY(isr, trigger)
+#define prof_init()
+
+#endif /* PROF_ENABLE */
+
+#endif /* __PROF_H__ */
@@ -0,0 +1,98 @@
+/**
+ * @file pt.h
+ * @brief Stackless cooperative threads
+ *
+ * This file implements protothreads, stackless coroutines built on a switch
+ * statement in the style of Adam Dunkels' protothreads. A thread function
+ * returns whenever it has to wait and continues where it left off the next
+ * time it is called. Local variables are not kept across a wait, so any state
+ * needed after a wait has to be static. Only one wait is allowed per source
+ * line and a thread can't use switch statements around a wait.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __PT_H__
+#define __PT_H__
+
+#include "main.h"
+
+/*
+ * @brief Thread states returned by a thread function
+ */
+typedef enum pt_state_e {
+	PT_WAITING,
+	PT_YIELDED,
+	PT_EXITED,
+	PT_ENDED
+} pt_state_t;
+
+/*
+ * @brief Thread control block, holds the line to continue from
+ */
+typedef struct pt_s {
+	uint16_t lc;
+} pt_t;
+
+/**
+ * @brief Initialize or restart a thread
+ */
+#define PT_INIT(pt) ((pt)->lc = 0)
+
+/**
+ * @brief Declare a thread function
+ */
+#define PT_THREAD(name_args) pt_state_t name_args
+
+/**
+ * @brief Start of a thread body
+ */
+#define PT_BEGIN(pt) switch ((pt)->lc) { case 0:
+
+/**
+ * @brief Wait until a condition is true
+ */
+#define PT_WAIT_UNTIL(pt, cond) \
+	do { \
+		(pt)->lc = __LINE__; case __LINE__: \
+		if (!(cond)) { \
+			return PT_WAITING; \
+		} \
+	} while (0)
+
+/**
+ * @brief Wait while a condition is true
+ */
+#define PT_WAIT_WHILE(pt, cond) PT_WAIT_UNTIL((pt), !(cond))
+
+/**
+ * @brief Give other threads a chance to run once
+ */
+#define PT_YIELD(pt) \
+	do { \
+		(pt)->lc = __LINE__; \
+		return PT_YIELDED; case __LINE__:; \
+	} while (0)
+
+/**
+ * @brief Exit the thread, it restarts from the beginning when called again
+ */
+#define PT_EXIT(pt) \
+	do { \
+		PT_INIT(pt); \
+		return PT_EXITED; \
+	} while (0)
+
+/**
+ * @brief End of a thread body
+ */
+#define PT_END(pt) } PT_INIT(pt); return PT_ENDED
+
+/**
+ * @brief Run a thread once, true while the thread has not finished
+ */
+#define PT_SCHEDULE(f) ((f) < PT_EXITED)
+
+#endif /* __PT_H__ */
@@ -23,59 +23,348 @@
  */
 
 #include "slp.h"
+#include "atom.h"
+#include "cmu.h"
 #include "em_emu.h"
+#include "em_cmu.h"
+#include "em_rtcc.h"
+#include "em_rmu.h"
+#include "em_gpio.h"
+#include "em_cryotimer.h"
 
-/* Global shared sleep state */
-static uint32_t slp_state[SLP_NUM_EM] = {0};
+/* Global shared sleep state, count of blockers per energy mode */
+static volatile uint32_t slp_state[SLP_NUM_EM] = {0};
+
+/* Bit n is set while slp_state[n] is non-zero */
+static volatile uint32_t slp_mask = 0;
+
+/* Registered suspend/resume hooks */
+static slp_hook_t slp_hooks[SLP_MAX_HOOKS];
+static uint32_t slp_num_hooks = 0;
+
+/* Registered next wake time providers */
+static uint32_t (*slp_wake_sources[SLP_MAX_WAKE])(void);
+static uint32_t slp_num_wake_sources = 0;
+
+/* Cost of each energy mode, typical figures for the EFR32BG1 running from the
+ * 19 MHz HFRCO through the DCDC. Latency covers entry plus wakeup, and the
+ * transition charge is the extra charge drawn by entry, wakeup and clock
+ * restore on top of the resident current. */
+static const slp_cost_t slp_cost[SLP_NUM_EM] = {
+	[EM0] = { .latency_us = 0,   .transition_nC = 0,   .current_nA = 1200000 },
+	[EM1] = { .latency_us = 1,   .transition_nC = 0,   .current_nA = 700000  },
+	[EM2] = { .latency_us = 11,  .transition_nC = 15,  .current_nA = 2500    },
+	[EM3] = { .latency_us = 12,  .transition_nC = 16,  .current_nA = 2000    },
+	[EM4] = { .latency_us = 300, .transition_nC = 400, .current_nA = 600     },
+};
+
+/* EM4 snapshot handler */
+static void (*slp_em4_save)(slp_retain_t *state) = NULL;
+
+/* Residency accounting */
+static slp_stats_t slp_stats = {{0}, {0}};
+
+/* Sleep clock time of the last wakeup (or of the last clear) */
+static uint32_t slp_last_wake = 0;
+
+/* Account for one sleep between two sleep clock timestamps. The CRYOTIMER
+ * counter is 32 bits wide so unsigned subtraction handles wrap around. */
+static void _slp_account(slp_em_t em, uint32_t entry, uint32_t exit) {
+	slp_stats.ticks[EM0] += entry - slp_last_wake;
+	slp_stats.ticks[em] += exit - entry;
+	slp_stats.count[em]++;
+	slp_stats.count[EM0]++;
+	slp_last_wake = exit;
+}
+
+/* Bring the mask bit of an energy mode in line with its counter. If an
+ * interrupt changes the counter (and the mask) halfway through, the bit is
+ * recomputed, see atom_track(). */
+static void _slp_sync_mask(slp_em_t em) {
+	atom_track(&slp_mask, 1 << em, &slp_state[em]);
+}
+
+/* Lowest energy mode allowed by the blockers. EM4 is always treated as
+ * blocked so the mask is never empty, then the lowest set bit is isolated
+ * and found with a single count leading zeros instruction. */
+static slp_em_t _slp_lowest(void) {
+	uint32_t mask = slp_mask | (1 << EM4);
+
+	return (slp_em_t) (31 - __CLZ(mask & (~mask + 1)));
+}
+
+/* Save the application state to RTCC retention registers, arm the wakeup
+ * sources and enter EM4H. Does not return, wakeup goes through reset. */
+static void _slp_enter_em4(void) {
+	slp_retain_t state;
+	uint32_t words[SLP_RETAIN_WORDS];
+
+	/* Snapshot application state */
+	slp_em4_save(&state);
+	slp_em4_pack(&state, words);
+	for (int i = 0; i < SLP_RETAIN_WORDS; i++) {
+		RTCC->RET[i].REG = words[i];
+	}
+
+	/* Periodic wakeup from the sleep clock, the ADC trigger period it may
+	 * have been set to doesn't matter any more */
+	CRYOTIMER_PeriodSet(SLP_EM4_CRYO_PERIOD);
+	CRYOTIMER_EM4WakeupEnable(true);
+	CRYOTIMER_IntClear(CRYOTIMER_IF_PERIOD);
+	CRYOTIMER_IntEnable(CRYOTIMER_IEN_PERIOD);
+
+	/* Push button wakeup */
+	GPIO_PinModeSet(SLP_EM4_WU_PORT, SLP_EM4_WU_PIN, gpioModeInputPullFilter, 1);
+	GPIO_EM4EnablePinWakeup(SLP_EM4_WU_MASK, 0);
+
+	EMU_EnterEM4();
+}
+
+/* Time in microseconds until the earliest scheduled wakeup */
+static uint32_t _slp_next_wake(void) {
+	uint32_t next = SLP_WAKE_NONE;
+	uint32_t t;
+
+	for (uint32_t i = 0; i < slp_num_wake_sources; i++) {
+		t = slp_wake_sources[i]();
+		if (t < next) {
+			next = t;
+		}
+	}
+
+	return next;
+}
+
+slp_em_t slp_govern(slp_em_t deepest, uint32_t next_us) {
+	slp_em_t best = deepest;
+	uint64_t best_pC = UINT64_MAX;
+	uint64_t cost_pC;
+
+	/* Nothing scheduled, nothing to gain by staying shallow */
+	if (next_us == SLP_WAKE_NONE) {
+		return deepest;
+	}
+
+	/* Charge over the idle window for each allowed mode, in pC. Modes that
+	 * cannot wake up in time are skipped. */
+	for (int em = EM1; em <= deepest; em++) {
+		if (em > EM1 && slp_cost[em].latency_us > next_us) {
+			continue;
+		}
+
+		cost_pC = (uint64_t) slp_cost[em].transition_nC * 1000 +
+				(uint64_t) slp_cost[em].current_nA * next_us / 1000;
+
+		if (cost_pC < best_pC) {
+			best_pC = cost_pC;
+			best = (slp_em_t) em;
+		}
+	}
+
+	return best;
+}
 
 void slp_sleep(void) {
+	slp_em_t em;
+	uint32_t entry;
+	uint32_t i;
+
+	em = _slp_lowest();
+
 	/* Lowest state is EM0 */
-	if (slp_state[EM0] > 0) {
+	if (em == EM0) {
 		return;
+	}
 
-	/* Lowest state is EM1 */
-	} else if (slp_state[EM1] > 0) {
-		EMU_EnterEM1();
+	/* EM4 needs somewhere to put the application state */
+	if (em == EM4 && slp_em4_save == NULL) {
+		em = EM3;
+	}
 
-	/* Lowest state is EM2 */
-	} else if (slp_state[EM2] > 0) {
-		EMU_EnterEM2(true);
+	/* Don't go deeper than pays off before the next scheduled wakeup */
+	em = slp_govern(em, _slp_next_wake());
 
-	/* Lowest state is EM3 */
-	} else if (slp_state[EM3] > 0) {
-		EMU_EnterEM3(true);
+	/* Let drivers power down for the chosen mode */
+	for (i = 0; i < slp_num_hooks; i++) {
+		if (em >= slp_hooks[i].minimum && slp_hooks[i].suspend) {
+			slp_hooks[i].suspend(em);
+		}
+	}
+
+	entry = slp_now();
 
-	/* Lowest state is EM4 */
-	} else{
-		/* Temporarily set as EM3 because EM4 is hard to debug */
+	switch (em) {
+	case EM4:
+		_slp_enter_em4();
+		break;
+	case EM1:
+		EMU_EnterEM1();
+		break;
+	case EM2:
+		EMU_EnterEM2(true);
+		break;
+	case EM3:
+	default:
 		EMU_EnterEM3(true);
+		break;
+	}
+
+	_slp_account(em, entry, slp_now());
+
+	/* Resume in reverse order */
+	for (i = slp_num_hooks; i > 0; i--) {
+		if (em >= slp_hooks[i-1].minimum && slp_hooks[i-1].resume) {
+			slp_hooks[i-1].resume(em);
+		}
 	}
+
 	return;
 }
 
+uint32_t slp_now(void) {
+	return CRYOTIMER_CounterGet();
+}
+
 void slp_blockSleepMode(slp_em_t minimum) {
 
-	/* Atomically change sleep state */
+	/* Atomically change sleep state without masking interrupts */
+	if (atom_inc(&slp_state[minimum]) == 1) {
+		_slp_sync_mask(minimum);
+	}
+
+	return;
+}
+
+void slp_unblockSleepMode(slp_em_t minimum) {
+
+	/* Atomically unblock sleep mode, never going below zero */
+	if (atom_dec(&slp_state[minimum]) && slp_state[minimum] == 0) {
+		_slp_sync_mask(minimum);
+	}
+
+	return;
+}
+
+bool slp_registerHook(slp_em_t minimum, void (*suspend)(slp_em_t),
+		void (*resume)(slp_em_t)) {
+
+	if (slp_num_hooks >= SLP_MAX_HOOKS) {
+		return false;
+	}
+
+	slp_hooks[slp_num_hooks].minimum = minimum;
+	slp_hooks[slp_num_hooks].suspend = suspend;
+	slp_hooks[slp_num_hooks].resume = resume;
+	slp_num_hooks++;
+
+	return true;
+}
+
+bool slp_registerWakeSource(uint32_t (*next_wake)(void)) {
+
+	if (slp_num_wake_sources >= SLP_MAX_WAKE) {
+		return false;
+	}
+
+	slp_wake_sources[slp_num_wake_sources] = next_wake;
+	slp_num_wake_sources++;
+
+	return true;
+}
+
+void slp_em4_setHandler(void (*save)(slp_retain_t *state)) {
+	slp_em4_save = save;
+}
+
+void slp_em4_pack(const slp_retain_t *state, uint32_t *words) {
+	words[0] = SLP_RETAIN_MAGIC;
+	words[1] = (uint32_t) state->letimer_ontime;
+	words[2] = (state->bma280_enabled ? (1 << 0) : 0) |
+			   (state->led1 ? (1 << 1) : 0);
+	words[3] = ~(words[0] ^ words[1] ^ words[2]);
+}
+
+bool slp_em4_unpack(const uint32_t *words, slp_retain_t *state) {
+	if (words[0] != SLP_RETAIN_MAGIC ||
+		words[3] != ~(words[0] ^ words[1] ^ words[2])) {
+		return false;
+	}
+
+	state->letimer_ontime = (int32_t) words[1];
+	state->bma280_enabled = (words[2] & (1 << 0)) != 0;
+	state->led1 = (words[2] & (1 << 1)) != 0;
+
+	return true;
+}
+
+bool slp_em4_restore(slp_retain_t *state) {
+	uint32_t words[SLP_RETAIN_WORDS];
+	uint32_t cause = RMU_ResetCauseGet();
+
+	RMU_ResetCauseClear();
+
+	if (!(cause & RMU_RSTCAUSE_EM4RST)) {
+		return false;
+	}
+
+	/* Retention registers live in the RTCC */
+	CMU_ClockEnable(cmuClock_CORELE, true);
+	CMU_ClockEnable(cmuClock_RTCC, true);
+
+	for (int i = 0; i < SLP_RETAIN_WORDS; i++) {
+		words[i] = RTCC->RET[i].REG;
+	}
+
+	/* Only restore once */
+	RTCC->RET[0].REG = 0;
+
+	return slp_em4_unpack(words, state);
+}
+
+void slp_get_stats(slp_stats_t *stats) {
+
+	/* Copy atomically so the snapshot is consistent with interrupts */
 	CORE_ATOMIC_IRQ_DISABLE();
-	slp_state[minimum]++;
+	*stats = slp_stats;
+	stats->ticks[EM0] += slp_now() - slp_last_wake;
 	CORE_ATOMIC_IRQ_ENABLE();
 
 	return;
 }
 
-void slp_unblockSleepMode(slp_em_t minimum) {
+void slp_clear_stats(void) {
 
-	/* Atomically unblock sleep mode */
 	CORE_ATOMIC_IRQ_DISABLE();
-	if(slp_state[minimum] > 0) {
-		slp_state[minimum]--;
+	for (int i = 0; i < SLP_NUM_EM; i++) {
+		slp_stats.count[i] = 0;
+		slp_stats.ticks[i] = 0;
 	}
+	slp_last_wake = slp_now();
 	CORE_ATOMIC_IRQ_ENABLE();
 
 	return;
 }
 
 void slp_init(void) {
+	CRYOTIMER_Init_TypeDef cryo_init = {
+		.enable = true,
+		.debugRun = false,
+		.em4Wakeup = false,
+		.osc = cryotimerOscULFRCO,
+		.presc = cryotimerPresc_1,
+		.period = SLP_EM4_CRYO_PERIOD,
+	};
+
+	/* Sleep clock, never stops. Others may change the period but not the
+	 * counter. */
+	cmu_acquire(CMU_CLK_CRYOTIMER);
+	CRYOTIMER_Init(&cryo_init);
+
+	/* Clocks acquired so far were stamped before it ran */
+	cmu_start_stats();
+
+	/* Start residency accounting from now */
+	slp_clear_stats();
 
 	return;
 }
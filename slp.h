@@ -33,6 +33,24 @@
  */
 #define SLP_NUM_EM 5
 
+/**
+ * @brief Tick rate of the RTCC used for residency accounting in Hz
+ *
+ * The RTCC runs from the LFXO (32768 Hz) with a prescaler of 32 as set up in
+ * InitDevice.c, so one tick is just under a millisecond.
+ */
+#define SLP_RTCC_FREQ 1024
+
+/**
+ * @brief Tick rate of the sleep clock used for residency accounting in Hz
+ *
+ * The LFXO and with it the RTCC stop in EM3, so residency is timed with the
+ * CRYOTIMER running from the ULFRCO instead, which keeps counting in every
+ * energy mode. The rate is nominal, the ULFRCO is only as accurate as noted
+ * for LETIMER_CAL.
+ */
+#define SLP_CLK_FREQ 1000
+
 /*
  * @brief Enumeration of energy mode names
  */
@@ -44,23 +62,124 @@ typedef enum slp_em_e {
 	EM4=4
 } slp_em_t;
 
+/**
+ * @brief Maximum number of suspend/resume hooks
+ */
+#define SLP_MAX_HOOKS 8
+
+/**
+ * @brief Maximum number of next wake time providers
+ */
+#define SLP_MAX_WAKE 4
+
+/**
+ * @brief Returned by a wake source with nothing scheduled
+ */
+#define SLP_WAKE_NONE 0xffffffff
+
+/**
+ * @brief EM4 wakeup sources
+ *
+ * EM4H is reached once LED0 has been dimmed to zero, which stops LETIMER0
+ * and its EM3 block, and the joystick has been at rest for ACMP_EM4_IDLE_MS,
+ * after which ACMP0 stops blocking EM3 as well. Anything else blocking a
+ * shallower mode, like a virtual timer, keeps the system out of EM4H.
+ *
+ * The sleep clock CRYOTIMER keeps running from the ULFRCO in EM4H and wakes
+ * the system about every two seconds. The GPIO wake pin is push button 1
+ * (PF7, EM4WU1) on the WSTK and wakes the system when pulled low.
+ */
+#define SLP_EM4_CRYO_PERIOD cryotimerPeriod_2k
+#define SLP_EM4_WU_PORT gpioPortF
+#define SLP_EM4_WU_PIN 7
+#define SLP_EM4_WU_MASK GPIO_EXTILEVEL_EM4WU1
+
+/**
+ * @brief Number of RTCC retention registers used for the EM4 snapshot
+ */
+#define SLP_RETAIN_WORDS 4
+
+/**
+ * @brief Marks a valid EM4 snapshot in retained memory
+ */
+#define SLP_RETAIN_MAGIC 0x534c5034
+
+/*
+ * @brief Application state kept across EM4
+ */
+typedef struct slp_retain_s {
+	int32_t letimer_ontime;
+	bool bma280_enabled;
+	bool led1;
+} slp_retain_t;
+
+/*
+ * @brief Cost of an energy mode used by the sleep governor
+ *
+ * Latency is the entry plus wakeup time, transition charge is the extra
+ * charge spent by one entry and exit, and current is drawn while resident.
+ */
+typedef struct slp_cost_s {
+	uint32_t latency_us;
+	uint32_t transition_nC;
+	uint32_t current_nA;
+} slp_cost_t;
+
+/*
+ * @brief Suspend/resume hook
+ *
+ * The suspend callback runs just before the core enters an energy mode equal
+ * to or lower than minimum, and the resume callback runs right after wakeup.
+ * Both receive the energy mode that was chosen. They run inside slp_sleep()
+ * with interrupts masked by the caller, so they must not wait on an
+ * interrupt being serviced, and anything they call must leave the interrupt
+ * state as it found it.
+ */
+typedef struct slp_hook_s {
+	slp_em_t minimum;
+	void (*suspend)(slp_em_t em);
+	void (*resume)(slp_em_t em);
+} slp_hook_t;
+
+/*
+ * @brief Residency statistics for each energy mode
+ *
+ * Times are in sleep clock ticks (see SLP_CLK_FREQ). EM0 time is the time spent
+ * awake between sleeps and its count is the number of wakeups.
+ */
+typedef struct slp_stats_s {
+	uint32_t count[SLP_NUM_EM];
+	uint32_t ticks[SLP_NUM_EM];
+} slp_stats_t;
+
 /**
  * @brief Sleep function
  *
  * When called, this function makes sure the system settles into the lowest
  * energy state possible based on the current values of the shared variable
- * sleep_state.
+ * sleep_state. If the next scheduled wakeup is known from the registered wake
+ * sources, slp_govern() may pick a shallower mode when the deeper one does not
+ * pay off. Registered suspend hooks run before sleeping and resume hooks run
+ * after waking up.
  *
  * @return Void
  */
 void slp_sleep(void);
 
+/**
+ * @brief Get the sleep clock time
+ *
+ * @return The free running CRYOTIMER count in ticks of SLP_CLK_FREQ
+ */
+uint32_t slp_now(void);
+
 /**
  * @brief Block sleep mode function
  *
  * When called, this function increments a global shared variable that makes
  * sure the system cannot sleep beyond the given energy mode until the mode
- * is completely unblocked.
+ * is completely unblocked. The update is lock-free and does not mask
+ * interrupts, so it is safe to call from any interrupt handler.
  *
  * @param minimum The lowest energy mode that needs to be blocked
  *
@@ -73,7 +192,8 @@ void slp_blockSleepMode(slp_em_t minimum);
  *
  * When called, this function decrements a global shared variable that makes
  * sure the system cannot sleep beyond the given energy mode until the mode
- * is completely unblocked.
+ * is completely unblocked. Unblocking a mode that is not blocked has no
+ * effect. Like slp_blockSleepMode() it does not mask interrupts.
  *
  * @param minimum The energy mode to be unblocked
  *
@@ -81,10 +201,135 @@ void slp_blockSleepMode(slp_em_t minimum);
  */
 void slp_unblockSleepMode(slp_em_t minimum);
 
+/**
+ * @brief Register a suspend/resume hook
+ *
+ * When called, this function adds a driver callback pair that is run around
+ * every sleep at or below the given energy mode. This lets a peripheral power
+ * down only when the chosen mode requires it instead of blocking sleep.
+ * Suspend hooks run in registration order and resume hooks in reverse order.
+ * Either callback may be NULL. Both run with interrupts masked, see
+ * slp_hook_t.
+ *
+ * @param minimum The highest energy mode that needs the hook
+ * @param suspend Function called before sleeping
+ * @param resume Function called after waking up
+ *
+ * @return True if registered, false if the registry is full
+ */
+bool slp_registerHook(slp_em_t minimum, void (*suspend)(slp_em_t),
+		void (*resume)(slp_em_t));
+
+/**
+ * @brief Register a next wake time provider
+ *
+ * When called, this function adds a driver callback that returns the time in
+ * microseconds until its next scheduled interrupt, or SLP_WAKE_NONE if it has
+ * nothing scheduled. It is called before every sleep from slp_sleep(), which
+ * the main loop runs with interrupts masked, so it must only read state and
+ * must not wait on an interrupt being serviced.
+ *
+ * @param next_wake Function returning the time until the next wakeup
+ *
+ * @return True if registered, false if the registry is full
+ */
+bool slp_registerWakeSource(uint32_t (*next_wake)(void));
+
+/**
+ * @brief Choose the energy mode for an idle window
+ *
+ * This function compares the charge spent in each mode from EM1 down to the
+ * deepest allowed mode over the given idle window, including the transition
+ * cost, and returns the cheapest. Modes whose latency exceeds the window are
+ * not considered.
+ *
+ * @param deepest The deepest energy mode allowed by the blockers
+ * @param next_us Time until the next wakeup in us, or SLP_WAKE_NONE
+ *
+ * @return The energy mode to enter
+ */
+slp_em_t slp_govern(slp_em_t deepest, uint32_t next_us);
+
+/**
+ * @brief Set the EM4 snapshot handler
+ *
+ * When called, this function sets the callback that fills in the application
+ * state right before the system enters EM4. Without a handler EM4 is never
+ * entered and EM3 is used instead.
+ *
+ * @param save Function that collects the state to retain
+ *
+ * @return Void
+ */
+void slp_em4_setHandler(void (*save)(slp_retain_t *state));
+
+/**
+ * @brief Restore EM4 snapshot
+ *
+ * This function checks if the last reset was a wakeup from EM4 and if the
+ * retained memory holds a valid snapshot. The snapshot is invalidated so it is
+ * only restored once. It is meant to be called first thing in main() to pick
+ * a warm or cold start.
+ *
+ * @param state Location to store the restored state
+ *
+ * @return True if the state was restored
+ */
+bool slp_em4_restore(slp_retain_t *state);
+
+/**
+ * @brief Pack EM4 snapshot
+ *
+ * This function encodes the application state into words for retained memory
+ * with a magic number and checksum.
+ *
+ * @param state The state to pack
+ * @param words Location to store SLP_RETAIN_WORDS words
+ *
+ * @return Void
+ */
+void slp_em4_pack(const slp_retain_t *state, uint32_t *words);
+
+/**
+ * @brief Unpack EM4 snapshot
+ *
+ * This function decodes words read back from retained memory.
+ *
+ * @param words SLP_RETAIN_WORDS words from retained memory
+ * @param state Location to store the state
+ *
+ * @return True if the magic number and checksum are valid
+ */
+bool slp_em4_unpack(const uint32_t *words, slp_retain_t *state);
+
+/**
+ * @brief Get residency statistics
+ *
+ * This function copies a consistent snapshot of the time spent and number of
+ * entries in each energy mode since initialization or the last clear. The
+ * EM0 residency includes the time awake up to the moment of the call.
+ *
+ * @param stats Location to store the snapshot
+ *
+ * @return Void
+ */
+void slp_get_stats(slp_stats_t *stats);
+
+/**
+ * @brief Clear residency statistics
+ *
+ * This function resets all residency counters and restarts accounting from
+ * the current sleep clock time.
+ *
+ * @return Void
+ */
+void slp_clear_stats(void);
+
 /**
  * @brief Initializes sleep system
  *
- * This function initializes the sleep system for the demo.
+ * This function initializes the sleep system for the demo and starts the
+ * sleep clock. It must run before anything else uses the CRYOTIMER.
  *
  * @return Void
  */
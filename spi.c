@@ -0,0 +1,192 @@
+/**
+ * @file spi.c
+ * @brief The implementation for the SPI transaction engine
+ *
+ * This file implements the queued SPI driver. See the associated header file
+ * for function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "spi.h"
+#include "dma.h"
+#include "cmu.h"
+#include "slp.h"
+
+/* Queue, the head is on the bus */
+static spi_xfer_t *spi_head = NULL;
+static spi_xfer_t *spi_tail = NULL;
+
+/* Descriptors of the transfer on the bus, one per phase */
+static LDMA_Descriptor_t spi_tx_desc[2];
+static LDMA_Descriptor_t spi_rx_desc[2];
+
+static const LDMA_TransferCfg_t spi_tx_cfg =
+		LDMA_TRANSFER_CFG_PERIPHERAL(ldmaPeripheralSignal_USART1_TXBL);
+static const LDMA_TransferCfg_t spi_rx_cfg =
+		LDMA_TRANSFER_CFG_PERIPHERAL(ldmaPeripheralSignal_USART1_RXDATAV);
+
+/* Sent during the receive phase, and where dropped bytes go */
+static const uint8_t spi_zero = 0;
+static uint8_t spi_junk;
+
+static bool spi_ready = false;
+
+/* Put a transfer on the bus, called with interrupts disabled */
+static void _spi_start(spi_xfer_t *xfer) {
+	uint32_t n = 0;
+
+	GPIO_PinOutClear(xfer->dev->port, xfer->dev->pin);
+	SPI_USART->CMD = USART_CMD_CLEARRX | USART_CMD_CLEARTX;
+
+	if (xfer->tx_len) {
+		spi_tx_desc[n] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(
+				xfer->tx, &SPI_USART->TXDATA, xfer->tx_len, 1);
+		spi_rx_desc[n] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(
+				&SPI_USART->RXDATA, &spi_junk, xfer->tx_len, 1);
+		spi_rx_desc[n].xfer.dstInc = ldmaCtrlDstIncNone;
+		n++;
+	}
+
+	if (xfer->rx_len) {
+		spi_tx_desc[n] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(
+				&spi_zero, &SPI_USART->TXDATA, xfer->rx_len, 1);
+		spi_tx_desc[n].xfer.srcInc = ldmaCtrlSrcIncNone;
+		spi_rx_desc[n] = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(
+				&SPI_USART->RXDATA, xfer->rx ? xfer->rx : &spi_junk,
+				xfer->rx_len, 1);
+		if (!xfer->rx) {
+			spi_rx_desc[n].xfer.dstInc = ldmaCtrlDstIncNone;
+		}
+		n++;
+	}
+
+	/* The last byte received ends the transfer */
+	spi_tx_desc[n - 1].xfer.link = 0;
+	spi_rx_desc[n - 1].xfer.link = 0;
+	spi_rx_desc[n - 1].xfer.doneIfs = 1;
+
+	/* Receive first so no byte is missed */
+	LDMA_StartTransfer(DMA_CH_SPI_RX, &spi_rx_cfg, spi_rx_desc);
+	LDMA_StartTransfer(DMA_CH_SPI_TX, &spi_tx_cfg, spi_tx_desc);
+}
+
+/* Receive channel done, called from the LDMA interrupt */
+static void _spi_done(uint32_t ch) {
+	spi_xfer_t *xfer = spi_head;
+
+	GPIO_PinOutSet(xfer->dev->port, xfer->dev->pin);
+
+	/* Keep the bus busy before running the callback */
+	spi_head = xfer->next;
+	if (spi_head) {
+		_spi_start(spi_head);
+	} else {
+		spi_tail = NULL;
+		slp_unblockSleepMode(SPI_EM);
+		cmu_release(CMU_CLK_USART1);
+	}
+
+	xfer->busy = false;
+	if (xfer->done) {
+		xfer->done(xfer);
+	}
+}
+
+bool spi_submit(spi_xfer_t *xfer) {
+	CORE_DECLARE_IRQ_STATE;
+
+	if (xfer->tx_len > SPI_MAX_LEN || xfer->rx_len > SPI_MAX_LEN ||
+		xfer->tx_len + xfer->rx_len == 0) {
+		return false;
+	}
+
+	/* May be called from a completion callback or with interrupts already
+	 * masked, and the same transfer could be submitted from two contexts, so
+	 * busy is tested and set inside the critical section */
+	CORE_ENTER_CRITICAL();
+
+	if (xfer->busy) {
+		CORE_EXIT_CRITICAL();
+		return false;
+	}
+
+	xfer->next = NULL;
+	xfer->busy = true;
+
+	if (spi_tail) {
+		spi_tail->next = xfer;
+		spi_tail = xfer;
+	} else {
+		spi_head = spi_tail = xfer;
+		cmu_acquire(CMU_CLK_USART1);
+		slp_blockSleepMode(SPI_EM);
+		_spi_start(xfer);
+	}
+
+	CORE_EXIT_CRITICAL();
+
+	return true;
+}
+
+bool spi_busy(const spi_xfer_t *xfer) {
+	return xfer->busy;
+}
+
+void spi_wait(const spi_xfer_t *xfer) {
+
+	/* Interrupts stay masked between the check and the sleep, the core
+	 * still wakes up when the transfer completes */
+	CORE_ATOMIC_IRQ_DISABLE();
+	while (xfer->busy) {
+		slp_sleep();
+		CORE_ATOMIC_IRQ_ENABLE();
+		CORE_ATOMIC_IRQ_DISABLE();
+	}
+	CORE_ATOMIC_IRQ_ENABLE();
+}
+
+void spi_init(void) {
+	USART_InitSync_TypeDef usart_init = {
+		.autoCsEnable = false,
+		.autoCsHold = 0,
+		.autoCsSetup = 0,
+		.autoTx = false,
+		.baudrate = SPI_BAUDRATE,
+		.clockMode = SPI_CLOCK_MODE,
+		.databits = usartDatabits8,
+		.enable = usartDisable,
+		.master = true,
+		.msbf = true,
+		.prsRxCh = usartPrsRxCh0,
+		.prsRxEnable = false,
+		.refFreq = 0,
+	};
+
+	if (spi_ready) {
+		return;
+	}
+
+	/* Configuration is kept while the clock is off */
+	cmu_acquire(CMU_CLK_USART1);
+
+	USART_InitSync(SPI_USART, &usart_init);
+
+	/* Route pins and enable, chip selects are plain GPIO */
+	SPI_USART->ROUTELOC0 = USART_ROUTELOC0_CLKLOC_LOC11 | USART_ROUTELOC0_TXLOC_LOC11 | USART_ROUTELOC0_RXLOC_LOC11;
+	SPI_USART->ROUTEPEN = USART_ROUTEPEN_CLKPEN | USART_ROUTEPEN_TXPEN | USART_ROUTEPEN_RXPEN;
+
+	USART_Enable(SPI_USART, usartEnable);
+
+	/* Only needed while transfers are queued */
+	cmu_release(CMU_CLK_USART1);
+
+	dma_init();
+	dma_register(DMA_CH_SPI_RX, _spi_done);
+
+	spi_ready = true;
+
+	return;
+}
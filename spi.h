@@ -0,0 +1,116 @@
+/**
+ * @file spi.h
+ * @brief Definitions and interfaces for the SPI transaction engine
+ *
+ * This file declares a queued SPI driver on USART1. Transfers are moved by
+ * two LDMA channels and completion is signalled by callback, so the core can
+ * sleep in EM1 while the bus is busy. Each transfer names the device it is
+ * for, several devices with their own chip select share the bus.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __SPI_H__
+#define __SPI_H__
+
+#include "main.h"
+#include "em_usart.h"
+#include "em_gpio.h"
+
+/*
+ * @brief Bus settings, shared by all devices
+ */
+#define SPI_USART USART1
+#define SPI_BAUDRATE 1000000
+#define SPI_CLOCK_MODE usartClockMode3
+
+/*
+ * @brief EM level, the USART and the LDMA need the HF clocks
+ */
+#define SPI_EM 1
+
+/*
+ * @brief Longest phase of a transfer, one LDMA descriptor each
+ */
+#define SPI_MAX_LEN 2048
+
+/*
+ * @brief Device on the bus, the chip select pin must already be a push-pull
+ * output driven high
+ */
+typedef struct spi_dev_s {
+	GPIO_Port_TypeDef port;
+	uint8_t pin;
+} spi_dev_t;
+
+/*
+ * @brief Transfer
+ *
+ * A transfer selects the device, sends tx_len bytes from tx and then clocks
+ * in rx_len bytes into rx while sending zeros. What comes back during the
+ * first phase is dropped. Owned by the caller and must stay in place until
+ * it is done.
+ */
+typedef struct spi_xfer_s {
+	const spi_dev_t *dev;
+	const uint8_t *tx;
+	uint16_t tx_len;
+	uint8_t *rx;
+	uint16_t rx_len;
+	void (*done)(struct spi_xfer_s *xfer);
+	void *arg;
+
+	/* Private to the driver */
+	struct spi_xfer_s *next;
+	volatile bool busy;
+} spi_xfer_t;
+
+/**
+ * @brief Queue a transfer
+ *
+ * This function adds a transfer to the queue and starts it if the bus is
+ * idle. The done callback, if any, runs from the LDMA interrupt handler
+ * after the chip select is released, so it should be short. It may queue
+ * another transfer.
+ *
+ * @param xfer The transfer
+ *
+ * @return False if the transfer is already queued or its lengths are bad
+ */
+bool spi_submit(spi_xfer_t *xfer);
+
+/**
+ * @brief Check if a transfer is queued or running
+ *
+ * @param xfer The transfer
+ *
+ * @return True until the transfer is done
+ */
+bool spi_busy(const spi_xfer_t *xfer);
+
+/**
+ * @brief Wait for a transfer
+ *
+ * This function sleeps until the transfer is done. Only EM1 is reachable
+ * while the bus is busy.
+ *
+ * @param xfer The transfer
+ *
+ * @return Void
+ */
+void spi_wait(const spi_xfer_t *xfer);
+
+/**
+ * @brief Initializes the SPI bus
+ *
+ * This function sets up USART1 in SPI master mode and the LDMA channels. It
+ * may be called by every device driver on the bus, only the first call does
+ * anything.
+ *
+ * @return Void
+ */
+void spi_init(void);
+
+#endif /* __SPI_H__ */
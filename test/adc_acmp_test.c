@@ -0,0 +1,14 @@
+/**
+ * @file adc_acmp_test.c
+ * @brief Host simulation of the joystick sampling current with ACMP0 gating
+ *
+ * This file builds adc_power_test.c again with the default ADC_PRS and
+ * ADC_ACMP, so ACMP0 watches the joystick line at rest and a press starts a
+ * burst of PRS triggered scans.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "adc_power_test.c"
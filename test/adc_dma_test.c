@@ -0,0 +1,343 @@
+/**
+ * @file adc_dma_test.c
+ * @brief Host test and benchmark for the LDMA sample ring
+ *
+ * This test runs the joystick through the same script twice, first with the
+ * old per-sample interrupt (a copy of the original ADC0_IRQHandler and
+ * adc_init()) and then with adc.c. The Makefile builds adc.c in continuous
+ * mode without PRS and ACMP0 so only the sample ring differs. For a rest
+ * period and a held press it reports wakeups and sample interrupts per
+ * second and the host time spent handling each sample. The target's cycles
+ * are not modelled, the host time only compares the two code paths. It
+ * checks that the LDMA raises one interrupt per scan and none per sample,
+ * that no sample is lost, that the scans hold the modelled supply and
+ * temperature and that short presses in each direction still act.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "adc.h"
+#include "letimer.h"
+#include "bma280.h"
+#include "dma.h"
+#include "gest.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+#include "sim_bma280.h"
+
+_Static_assert(!ADC_PRS && !ADC_ACMP, "build with ADC_PRS=0 and ADC_ACMP=0");
+
+/* Length of each measured part of the script */
+#define TEST_REST SIM_S(20)
+#define TEST_HOLD SIM_S(10)
+
+/* Short presses, each held for TEST_TAP */
+#define TEST_TAP SIM_MS(400)
+#define TEST_TAP_EVERY SIM_S(2)
+
+/* Raw joystick values in the middle of each band */
+#define TEST_RAW_REST 4095
+#define TEST_RAW_RIGHT 3050
+#define TEST_RAW_LEFT 2500
+#define TEST_RAW_PRESS 100
+
+/*
+ * @brief A short press and the on time expected after it
+ */
+typedef struct test_tap_s {
+	uint16_t raw;
+	int32_t ontime;
+} test_tap_t;
+
+static const test_tap_t test_taps[] = {
+	{ TEST_RAW_RIGHT, LETIMER_ONTIME_MS + LETIMER_STEP },
+	{ TEST_RAW_RIGHT, LETIMER_ONTIME_MS + 2 * LETIMER_STEP },
+	{ TEST_RAW_LEFT,  LETIMER_ONTIME_MS + LETIMER_STEP },
+	{ TEST_RAW_PRESS, LETIMER_ONTIME_MS },
+};
+
+#define TEST_NUM_TAPS (sizeof(test_taps) / sizeof(test_taps[0]))
+
+/*
+ * @brief What a part of the script cost
+ */
+typedef struct test_seg_s {
+	uint64_t ns;
+	uint32_t wakes;
+	uint32_t irqs;
+	uint32_t samples;
+	uint64_t host_ns;
+} test_seg_t;
+
+/* Path under test, its interrupts, host time spent in it and ontimes seen
+ * after taps */
+static bool test_legacy = false;
+static uint32_t test_irqs = 0;
+static uint64_t test_host_ns = 0;
+static int32_t test_ontime[TEST_NUM_TAPS];
+
+/* Commands the old handler would have posted */
+static uint32_t test_legacy_cmds = 0;
+static bool test_legacy_debounce = false;
+
+/* The original handler, commands are counted instead of posted so LED0
+ * timing does not add wakeups */
+void ADC0_IRQHandler(void) {
+	uint64_t t0 = test_ns();
+	uint32_t joystick = 0;
+
+	test_irqs++;
+
+	if (ADC_IntGet(ADC0) & ADC_IF_SINGLECMP) {
+		ADC_IntClear(ADC0, ADC_IF_SINGLECMP | ADC_IF_SINGLE |
+				ADC_IF_SINGLEUF | ADC_IF_SCANUF | ADC_IF_SINGLECMP);
+
+		if (test_legacy_debounce == false) {
+			for (int i = 0; i < 10; i++) {
+				joystick = ADC_DataSingleGet(ADC0);
+			}
+
+			if (joystick > JOY_UP_GT && joystick < JOY_UP_LT) {
+				test_legacy_cmds++;
+			} else if (joystick > JOY_RIGHT_GT && joystick < JOY_RIGHT_LT) {
+				test_legacy_cmds++;
+			} else if (joystick > JOY_LEFT_GT && joystick < JOY_LEFT_LT) {
+				test_legacy_cmds++;
+			} else if (joystick > JOY_DOWN_GT && joystick < JOY_DOWN_LT) {
+				test_legacy_cmds++;
+			} else if (joystick > JOY_PRESS_GT && joystick < JOY_PRESS_LT) {
+				test_legacy_cmds++;
+			}
+
+			test_legacy_debounce = true;
+		}
+	}
+
+	test_host_ns += test_ns() - t0;
+}
+
+/* The original adc_init(), in EM2 like the ring */
+static void _test_legacy_init(void) {
+	ADC_Init_TypeDef adc_init = {
+		.em2ClockConfig = adcEm2ClockAlwaysOn,
+		.ovsRateSel = adcOvsRateSel2,
+		.prescale = 111,
+		.tailgate = false,
+		.timebase = _ADC_CTRL_TIMEBASE_DEFAULT,
+		.warmUpMode = adcWarmupNormal,
+	};
+
+	ADC_InitSingle_TypeDef single_init = {
+		.acqTime = adcAcqTime32,
+		.diff = false,
+		.fifoOverwrite = true,
+		.leftAdjust = false,
+		.negSel = adcNegSelVSS,
+		.posSel = adcPosSelAPORT3XCH8,
+		.prsEnable = false,
+		.prsSel = adcPRSSELCh0,
+		.reference = adcRefVDD,
+		.rep = true,
+		.resolution = adcRes12Bit,
+		.singleDmaEm2Wu = false,
+	};
+
+	cmu_acquire(CMU_CLK_ADC0);
+
+	ADC_Init(ADC0, &adc_init);
+	ADC_InitSingle(ADC0, &single_init);
+
+	ADC0->SINGLECTRL |= ADC_SINGLECTRL_CMPEN;
+	ADC0->CMPTHR = (ADC_JOY_GT << _ADC_CMPTHR_ADGT_SHIFT) |
+			(ADC_JOY_LT << _ADC_CMPTHR_ADLT_SHIFT);
+
+	ADC_IntClear(ADC0, ADC_IF_SINGLECMP | ADC_IF_SINGLE | ADC_IF_SINGLEUF);
+	ADC0->IEN |= ADC_IEN_SINGLECMP;
+
+	slp_blockSleepMode(ADC_EM);
+	NVIC_EnableIRQ(ADC0_IRQn);
+
+	ADC_Start(ADC0, adcStartSingle);
+}
+
+static void _test_legacy_stop(void) {
+	NVIC_DisableIRQ(ADC0_IRQn);
+	ADC0->IEN = 0;
+	ADC0->CMD = ADC_CMD_SINGLESTOP;
+	ADC0->SINGLECTRL &= ~ADC_SINGLECTRL_CMPEN;
+	slp_unblockSleepMode(ADC_EM);
+	cmu_release(CMU_CLK_ADC0);
+}
+
+/* The LDMA posts EVT_JOY once per scan, the BMA280 also uses the LDMA
+ * interrupt */
+static void _test_task(void) {
+	uint64_t t0 = test_ns();
+
+	test_irqs++;
+	adc_task();
+	test_host_ns += test_ns() - t0;
+}
+
+/* Voltage that converts to a raw value against VDD */
+static uint32_t _test_uv(uint16_t raw) {
+	return (uint64_t) raw * SIM_VDD_UV / 4096 + SIM_VDD_UV / 8192;
+}
+
+static void _test_joy(void *arg) {
+	sim_set_ain(SIM_AIN_JOY, _test_uv((uint16_t) (uintptr_t) arg));
+}
+
+static void _test_check(void *arg) {
+	test_ontime[(uintptr_t) arg] = letimer_getOntime();
+}
+
+static void _test_accel(void) {
+	bma280_xyz_t xyz[BMA280_FIFO_FRAMES];
+
+	while (bma280_fifo_read(xyz, BMA280_FIFO_FRAMES) > 0);
+}
+
+/* The old main loop cleared the debounce flag before each sleep */
+static void _test_legacy_sleep(slp_em_t em) {
+	test_legacy_debounce = false;
+}
+
+/* Run the main loop for some time and count what it took */
+static void _test_seg(uint64_t ns, test_seg_t *seg) {
+	seg->ns = ns;
+	seg->wakes = test_wakes();
+	seg->irqs = test_irqs;
+	seg->samples = sim_adc_conversions;
+	seg->host_ns = test_host_ns;
+
+	test_run(ns);
+
+	seg->wakes = test_wakes() - seg->wakes;
+	seg->irqs = test_irqs - seg->irqs;
+	seg->samples = sim_adc_conversions - seg->samples;
+	seg->host_ns = test_host_ns - seg->host_ns;
+}
+
+static void _test_report(const char *path, const char *part,
+		const test_seg_t *seg) {
+	double s = (double) seg->ns / SIM_S(1);
+
+	printf("  %-10s %-5s %7.1f wakeups/s %7.1f ADC interrupts/s "
+			"%6.1f samples/s %7.1f host ns/sample\n", path, part,
+			seg->wakes / s, seg->irqs / s, seg->samples / s,
+			seg->samples ? (double) seg->host_ns / seg->samples : 0.0);
+}
+
+/* Rest, a held press, then the short presses */
+static void _test_script(test_seg_t *rest, test_seg_t *hold) {
+	uint64_t start;
+
+	test_run(SIM_S(1));
+	_test_seg(TEST_REST, rest);
+
+	start = sim_now();
+	sim_at(start, _test_joy, (void *) TEST_RAW_PRESS);
+	sim_at(start + TEST_HOLD, _test_joy, (void *) TEST_RAW_REST);
+	_test_seg(TEST_HOLD, hold);
+	test_run(SIM_S(1));
+
+	start = sim_now();
+	for (uintptr_t i = 0; i < TEST_NUM_TAPS; i++) {
+		uint64_t at = start + i * TEST_TAP_EVERY;
+
+		sim_at(at, _test_joy, (void *) (uintptr_t) test_taps[i].raw);
+		sim_at(at + TEST_TAP, _test_joy, (void *) TEST_RAW_REST);
+		sim_at(at + TEST_TAP_EVERY - SIM_MS(1), _test_check, (void *) i);
+	}
+	test_run(TEST_NUM_TAPS * TEST_TAP_EVERY);
+}
+
+int main(void) {
+	test_seg_t legacy_rest, legacy_hold;
+	test_seg_t ring_rest, ring_hold;
+	uint32_t overflows;
+	uint32_t legacy_irqs;
+	uint32_t scans;
+	adc_scan_t scan;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	slp_registerHook(EM1, _test_legacy_sleep, NULL);
+	vtmr_init();
+	sim_bma280_init();
+	bma280_init();
+	letimer_init();
+
+	evt_register(EVT_TAP, bma280_task);
+	evt_register(EVT_BMA280, bma280_task);
+	evt_register(EVT_ACCEL, _test_accel);
+	evt_register(EVT_LETIMER, letimer_task);
+	evt_register(EVT_GEST, gest_task);
+	evt_register(EVT_JOY, _test_task);
+
+	printf("adc_dma_test:\n");
+
+	/* Interrupt per sample */
+	test_legacy = true;
+	_test_legacy_init();
+	_test_script(&legacy_rest, &legacy_hold);
+	_test_legacy_stop();
+	_test_report("interrupt", "rest", &legacy_rest);
+	_test_report("interrupt", "held", &legacy_hold);
+	printf("  interrupt  %u commands from %u presses\n", test_legacy_cmds,
+			1 + (uint32_t) TEST_NUM_TAPS);
+
+	/* LDMA ring */
+	test_legacy = false;
+	overflows = sim_adc_overflows;
+	legacy_irqs = sim_stats.irqs[ADC0_IRQn];
+	scans = test_irqs;
+	adc_init();
+	_test_script(&ring_rest, &ring_hold);
+	_test_report("ring", "rest", &ring_rest);
+	_test_report("ring", "held", &ring_hold);
+
+	/* The old handler woke up for every sample while pressed */
+	CHECK(legacy_rest.irqs == 0);
+	CHECK(legacy_hold.irqs + 2 >= legacy_hold.samples);
+	CHECK(test_legacy_cmds >= 1 + TEST_NUM_TAPS);
+
+	/* One interrupt per scan whatever the joystick does, every sample
+	 * reaches the ring */
+	CHECK(sim_stats.irqs[ADC0_IRQn] == legacy_irqs);
+	CHECK(ring_rest.irqs >= ring_rest.samples / ADC_SCAN_SIZE &&
+			ring_rest.irqs <= ring_rest.samples / ADC_SCAN_SIZE + 1);
+	CHECK(ring_hold.irqs >= ring_hold.samples / ADC_SCAN_SIZE &&
+			ring_hold.irqs <= ring_hold.samples / ADC_SCAN_SIZE + 1);
+	CHECK(sim_adc_overflows == overflows);
+	CHECK(dma_errors() == 0);
+	CHECK(ring_hold.wakes * 10 < legacy_hold.wakes);
+
+	/* Scans hold what the model converts */
+	CHECK(test_irqs > scans);
+	CHECK(adc_get_scan(&scan));
+	CHECK(scan.avg[ADC_CH_JOY] == TEST_RAW_REST);
+	CHECK(scan.avdd_mv >= SIM_VDD_UV / 1000 - 2 &&
+			scan.avdd_mv <= SIM_VDD_UV / 1000);
+	CHECK(scan.temp_dc == SIM_TEMP_CAL_C * 10);
+	CHECK(!(scan.alarm & ((1 << ADC_CH_AVDD) | (1 << ADC_CH_TEMP))));
+
+	/* Each short press acted once */
+	for (uint32_t i = 0; i < TEST_NUM_TAPS; i++) {
+		CHECK(test_ontime[i] == test_taps[i].ontime);
+	}
+
+	return test_result("adc_dma_test");
+}
@@ -0,0 +1,254 @@
+/**
+ * @file adc_power_test.c
+ * @brief Host simulation of the joystick sampling current
+ *
+ * This test runs the firmware with the joystick at rest and then held, and
+ * measures the time spent in each energy mode, the wakeups, the ADC
+ * conversion time and the AUXHFRCO and ACMP0 on times. From these it
+ * estimates the average current with typical figures for the EFR32BG1. The
+ * Makefile builds it once for each sampling mode: adc_power_test runs the
+ * ADC continuously, adc_prs_test triggers each conversion from the CRYOTIMER
+ * through PRS and adc_acmp_test only runs the ADC for bursts started by
+ * ACMP0. The estimates of the first two are kept below as the references the
+ * later builds are compared against.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "adc.h"
+#include "letimer.h"
+#include "bma280.h"
+#include "gest.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+#include "em_acmp.h"
+#include "sim_bma280.h"
+
+/* Length of each measured part, an hour at rest for the comparator */
+#if ADC_ACMP
+#define TEST_REST SIM_S(3600)
+#else
+#define TEST_REST SIM_S(60)
+#endif
+#define TEST_HOLD SIM_S(10)
+
+/* Time after a release for a burst to end */
+#define TEST_AFTER SIM_S(2)
+
+/* Raw joystick values at rest and pressed */
+#define TEST_RAW_REST 4095
+#define TEST_RAW_PRESS 100
+
+/* Typical figures, estimates only. The energy mode currents and transition
+ * charges are those slp.c uses for its governor. */
+#define TEST_EM0_NA 1200000
+#define TEST_EM1_NA 700000
+#define TEST_EM2_NA 2500
+#define TEST_EM3_NA 2000
+#define TEST_EM2_WAKE_NC 15
+#define TEST_EM3_WAKE_NC 16
+
+/* ADC converting with its reference, AUXHFRCO at 1 MHz, and the HF clocks
+ * woken from EM2 for a couple of microseconds to move a sample */
+#define TEST_ADC_NA 200000
+#define TEST_AUX_NA 30000
+#define TEST_DMA_NC 2
+
+/* ACMP0 at the lowest bias with its VDD divider */
+#define TEST_ACMP_NA 500
+
+/* Estimates at rest in nA, from adc_power_test and adc_prs_test */
+#define TEST_CONT_NA 233000
+#define TEST_PRS_NA 2980
+
+/*
+ * @brief What a part of the run cost
+ */
+typedef struct test_seg_s {
+	uint64_t ns;
+	uint64_t em_ns[5];
+	uint32_t sleeps[5];
+	uint64_t adc_ns;
+	uint64_t aux_ns;
+	uint64_t acmp_ns;
+	uint32_t samples;
+	double na;
+} test_seg_t;
+
+/* The name of this build */
+#if ADC_ACMP
+#define TEST_NAME "adc_acmp_test"
+#define TEST_MODE "ACMP"
+#elif ADC_PRS
+#define TEST_NAME "adc_prs_test"
+#define TEST_MODE "PRS"
+#else
+#define TEST_NAME "adc_power_test"
+#define TEST_MODE "continuous"
+#endif
+
+static void _test_joy(void *arg) {
+	sim_set_ain(SIM_AIN_JOY, (uint64_t) (uintptr_t) arg * SIM_VDD_UV / 4096 +
+			SIM_VDD_UV / 8192);
+}
+
+static void _test_accel(void) {
+	bma280_xyz_t xyz[BMA280_FIFO_FRAMES];
+
+	while (bma280_fifo_read(xyz, BMA280_FIFO_FRAMES) > 0);
+}
+
+/* AUXHFRCO time, on demand it only runs for the conversions */
+static uint64_t _test_aux_ns(void) {
+#if ADC_PRS
+	return sim_adc_busy_time();
+#else
+	return sim_cmu_osc_ns(cmuOsc_AUXHFRCO);
+#endif
+}
+
+static void _test_snap(test_seg_t *seg) {
+	for (int em = 0; em < 5; em++) {
+		seg->em_ns[em] = sim_stats.ns[em];
+		seg->sleeps[em] = sim_stats.sleeps[em];
+	}
+	seg->adc_ns = sim_adc_busy_time();
+	seg->aux_ns = _test_aux_ns();
+	seg->acmp_ns = sim_cmu_clock_ns(cmuClock_ACMP0);
+	seg->samples = sim_adc_conversions;
+}
+
+/* Turn the snapshot into what the part cost */
+static void _test_cost(test_seg_t *seg, uint64_t ns) {
+	static const uint32_t em_na[] = {
+		TEST_EM0_NA, TEST_EM1_NA, TEST_EM2_NA, TEST_EM3_NA, 0
+	};
+	double nc = 0;
+
+	seg->ns = ns;
+	for (int em = 0; em < 5; em++) {
+		seg->em_ns[em] = sim_stats.ns[em] - seg->em_ns[em];
+		seg->sleeps[em] = sim_stats.sleeps[em] - seg->sleeps[em];
+		nc += (double) em_na[em] * seg->em_ns[em] / SIM_S(1);
+	}
+	seg->adc_ns = sim_adc_busy_time() - seg->adc_ns;
+	seg->aux_ns = _test_aux_ns() - seg->aux_ns;
+	seg->acmp_ns = sim_cmu_clock_ns(cmuClock_ACMP0) - seg->acmp_ns;
+	seg->samples = sim_adc_conversions - seg->samples;
+
+	nc += (double) TEST_ADC_NA * seg->adc_ns / SIM_S(1);
+	nc += (double) TEST_AUX_NA * seg->aux_ns / SIM_S(1);
+	nc += (double) TEST_ACMP_NA * seg->acmp_ns / SIM_S(1);
+	nc += (double) TEST_DMA_NC * seg->samples;
+	nc += (double) TEST_EM2_WAKE_NC * seg->sleeps[2];
+	nc += (double) TEST_EM3_WAKE_NC * seg->sleeps[3];
+
+	seg->na = nc * SIM_S(1) / ns;
+}
+
+/* Run the main loop for some time and work out what it cost */
+static void _test_seg(uint64_t ns, test_seg_t *seg) {
+	_test_snap(seg);
+	test_run(ns);
+	_test_cost(seg, ns);
+}
+
+static void _test_report(const char *part, const test_seg_t *seg) {
+	double pct = 100.0 / seg->ns;
+	double s = (double) seg->ns / SIM_S(1);
+
+	printf("  %-10s %-4s EM0/1/2/3 %5.2f/%5.2f/%6.2f/%6.2f %%, %6.1f "
+			"wakeups/s, %6.1f samples/s, ADC %6.2f %%, AUXHFRCO %6.2f %%, "
+			"%8.2f uA\n", TEST_MODE, part, seg->em_ns[0] * pct,
+			seg->em_ns[1] * pct, seg->em_ns[2] * pct, seg->em_ns[3] * pct,
+			(seg->sleeps[1] + seg->sleeps[2] + seg->sleeps[3]) / s,
+			seg->samples / s, seg->adc_ns * pct, seg->aux_ns * pct,
+			seg->na / 1000);
+}
+
+int main(void) {
+	test_seg_t rest;
+	test_seg_t hold;
+	uint64_t start;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+	sim_bma280_init();
+	bma280_init();
+	letimer_init();
+
+	evt_register(EVT_TAP, bma280_task);
+	evt_register(EVT_BMA280, bma280_task);
+	evt_register(EVT_ACCEL, _test_accel);
+	evt_register(EVT_LETIMER, letimer_task);
+	evt_register(EVT_GEST, gest_task);
+	evt_register(EVT_JOY, adc_task);
+
+	adc_init();
+
+	printf(TEST_NAME ": estimated average current\n");
+
+	test_run(SIM_S(1));
+	_test_seg(TEST_REST, &rest);
+
+	start = sim_now();
+	sim_at(start, _test_joy, (void *) TEST_RAW_PRESS);
+	sim_at(start + TEST_HOLD, _test_joy, (void *) TEST_RAW_REST);
+	_test_seg(TEST_HOLD, &hold);
+	test_run(TEST_AFTER);
+
+	_test_report("rest", &rest);
+	_test_report("held", &hold);
+
+	CHECK(sim_adc_overflows == 0);
+	CHECK(sim_adc_missed == 0);
+
+#if ADC_ACMP
+	/* Only the comparator at rest, so down to EM3 */
+	CHECK(rest.samples == 0);
+	CHECK(rest.acmp_ns == rest.ns);
+	CHECK(rest.em_ns[3] > rest.ns * 9 / 10);
+	CHECK(rest.na < TEST_PRS_NA);
+
+	/* A press starts a burst at the active rate, which ends after the
+	 * release */
+	CHECK(hold.samples >= (TEST_HOLD - SIM_MS(100)) / SIM_MS(8) &&
+			hold.samples <= TEST_HOLD / SIM_MS(8) * 105 / 100);
+	CHECK(hold.na < TEST_CONT_NA);
+	CHECK(sim_acmp_enabled);
+	CHECK(!sim_cmu_clock_on[cmuClock_ADC0]);
+	CHECK(sim_adc_busy_time() == sim_adc_busy_ns);
+#elif !ADC_PRS
+	/* Converting and clocked all the time, and the reference is current */
+	CHECK(rest.adc_ns * 100 > rest.ns * 99);
+	CHECK(rest.aux_ns == rest.ns);
+	CHECK(rest.na > TEST_CONT_NA * 0.95 && rest.na < TEST_CONT_NA * 1.05);
+#else
+	/* One conversion per CRYOTIMER period, slower at rest. The rate goes up
+	 * after the first scan with the joystick held. */
+	CHECK(rest.samples >= TEST_REST / SIM_MS(32) * 95 / 100 &&
+			rest.samples <= TEST_REST / SIM_MS(32) * 105 / 100);
+	CHECK(hold.samples >= (TEST_HOLD - ADC_SCAN_SIZE * SIM_MS(32)) / SIM_MS(8) &&
+			hold.samples <= TEST_HOLD / SIM_MS(8) * 105 / 100);
+
+	/* Powered for the conversions only */
+	CHECK(rest.adc_ns * 100 < rest.ns);
+	CHECK(rest.na * 10 < TEST_CONT_NA);
+	CHECK(rest.na > TEST_PRS_NA * 0.95 && rest.na < TEST_PRS_NA * 1.05);
+	CHECK(hold.na < TEST_CONT_NA);
+#endif
+
+	return test_result(TEST_NAME);
+}
@@ -0,0 +1,14 @@
+/**
+ * @file adc_prs_test.c
+ * @brief Host simulation of the joystick sampling current in PRS mode
+ *
+ * This file builds adc_power_test.c again, the Makefile sets ADC_ACMP to 0
+ * for it and the firmware files and leaves ADC_PRS on, so each conversion
+ * is triggered from the CRYOTIMER.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "adc_power_test.c"
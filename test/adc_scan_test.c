@@ -0,0 +1,248 @@
+/**
+ * @file adc_scan_test.c
+ * @brief Host test for the ADC scan parser and the scan sequence
+ *
+ * This test feeds adc_scan_parse() made up scans with layouts other than
+ * the firmware's, checking averages, rounding and the compare windows at
+ * their edges, and random scans against a plain reference. Temperatures
+ * are checked against the sensor slope in floating point. It then runs the
+ * firmware scan sequence on the ADC model with a low supply and a warm die
+ * during a press and checks the scan adc_get_scan() hands out.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include <stdlib.h>
+#include "test.h"
+#include "adc.h"
+#include "letimer.h"
+#include "bma280.h"
+#include "gest.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+#include "sim_bma280.h"
+
+/* Random scans checked against the reference */
+#define TEST_RANDOM 100000
+
+/* Largest scan the random layouts make */
+#define TEST_RAW_MAX 96
+
+/* Supply and die temperature in the sequence */
+#define TEST_AVDD_MV 2000
+#define TEST_TEMP_C 60
+
+/* A channel's window checked against a value, true when outside */
+static bool _test_outside(const adc_layout_t *l, uint32_t avg) {
+	return avg < l->gt || avg > l->lt;
+}
+
+/* What the parser should make of a scan */
+static void _test_reference(const adc_layout_t *layout, const uint16_t *raw,
+		const adc_cal_t *cal, adc_scan_t *scan) {
+	uint64_t sum;
+
+	scan->alarm = 0;
+	for (int ch = 0; ch < ADC_NUM_CH; ch++) {
+		sum = 0;
+		for (uint32_t i = 0; i < layout[ch].n; i++) {
+			sum += raw[layout[ch].ofs + i];
+		}
+
+		/* Round half up */
+		scan->avg[ch] = (2 * sum + layout[ch].n) / (2 * layout[ch].n);
+		if (_test_outside(&layout[ch], scan->avg[ch])) {
+			scan->alarm |= 1 << ch;
+		}
+	}
+
+	scan->avdd_mv = scan->avg[ADC_CH_AVDD] * ADC_AVDD_REF_MV / 4096;
+}
+
+/* Temperature in degrees from the slope */
+static double _test_temp(const adc_cal_t *cal, uint16_t avg) {
+	return cal->temp_c + ((double) cal->temp_read - avg) * ADC_TEMP_REF_MV *
+			1000.0 / 4096 / ADC_TEMP_SLOPE_UV;
+}
+
+/* Channels in another order with other lengths and windows */
+static void _test_layout(void) {
+	const adc_layout_t layout[ADC_NUM_CH] = {
+		[ADC_CH_JOY]  = { 10, 3, 100, 200 },
+		[ADC_CH_AVDD] = { 0, 2, 1000, 4095 },
+		[ADC_CH_TEMP] = { 4, 5, 0, 3000 },
+	};
+	const adc_cal_t cal = { .temp_read = 2000, .temp_c = 30 };
+	uint16_t raw[13] = {
+		/* AVDD, 3000 and 3001 round up */
+		3000, 3001,
+		/* Gap, not read */
+		4095, 4095,
+		/* TEMP, averages 2000 */
+		1999, 2001, 2000, 2000, 2000,
+		/* Gap */
+		0,
+		/* JOY, 100 is on the window edge */
+		99, 100, 101,
+	};
+	adc_scan_t scan;
+
+	adc_scan_parse(layout, raw, &cal, &scan);
+	CHECK(scan.avg[ADC_CH_AVDD] == 3001);
+	CHECK(scan.avg[ADC_CH_TEMP] == 2000);
+	CHECK(scan.avg[ADC_CH_JOY] == 100);
+	CHECK(scan.alarm == 0);
+	CHECK(scan.avdd_mv == 3001 * ADC_AVDD_REF_MV / 4096);
+	CHECK(scan.temp_dc == 300);
+
+	/* One below and one above the windows */
+	raw[10] = raw[11] = raw[12] = 99;
+	raw[0] = raw[1] = 999;
+	adc_scan_parse(layout, raw, &cal, &scan);
+	CHECK(scan.alarm == ((1 << ADC_CH_JOY) | (1 << ADC_CH_AVDD)));
+
+	raw[10] = raw[11] = raw[12] = 201;
+	raw[0] = raw[1] = 1000;
+	for (int i = 4; i < 9; i++) {
+		raw[i] = 3001;
+	}
+	adc_scan_parse(layout, raw, &cal, &scan);
+	CHECK(scan.alarm == ((1 << ADC_CH_JOY) | (1 << ADC_CH_TEMP)));
+
+	/* Colder reads higher, a degree is about 6 counts */
+	for (int i = 4; i < 9; i++) {
+		raw[i] = 2000 + 60;
+	}
+	adc_scan_parse(layout, raw, &cal, &scan);
+	CHECK(scan.temp_dc < 300 && scan.temp_dc > 200);
+}
+
+/* Random layouts and samples against the reference */
+static void _test_random(void) {
+	adc_layout_t layout[ADC_NUM_CH];
+	uint16_t raw[TEST_RAW_MAX];
+	adc_cal_t cal;
+	adc_scan_t scan;
+	adc_scan_t ref;
+	uint32_t bad = 0;
+	double worst = 0;
+	double err;
+
+	for (uint32_t r = 0; r < TEST_RANDOM; r++) {
+		uint32_t ofs = rand() % 4;
+
+		for (int ch = 0; ch < ADC_NUM_CH; ch++) {
+			layout[ch].ofs = ofs;
+			layout[ch].n = 1 + rand() % 24;
+			layout[ch].gt = rand() % 4096;
+			layout[ch].lt = layout[ch].gt + rand() % (4096 - layout[ch].gt);
+			ofs += layout[ch].n + rand() % 4;
+		}
+		for (uint32_t i = 0; i < TEST_RAW_MAX; i++) {
+			raw[i] = rand() % 4096;
+		}
+		cal.temp_read = 1500 + rand() % 2000;
+		cal.temp_c = 20 + rand() % 20;
+
+		adc_scan_parse(layout, raw, &cal, &scan);
+		_test_reference(layout, raw, &cal, &ref);
+
+		err = scan.temp_dc / 10.0 - _test_temp(&cal, scan.avg[ADC_CH_TEMP]);
+		if (err < 0) {
+			err = -err;
+		}
+		if (err > worst) {
+			worst = err;
+		}
+
+		if (scan.alarm != ref.alarm || scan.avdd_mv != ref.avdd_mv ||
+			scan.avg[ADC_CH_JOY] != ref.avg[ADC_CH_JOY] ||
+			scan.avg[ADC_CH_AVDD] != ref.avg[ADC_CH_AVDD] ||
+			scan.avg[ADC_CH_TEMP] != ref.avg[ADC_CH_TEMP]) {
+			bad++;
+		}
+	}
+
+	printf("adc_scan_test: %u random scans, %u wrong, temperature off by up "
+			"to %.4f C\n", TEST_RANDOM, bad, worst);
+
+	CHECK(bad == 0);
+
+	/* Truncated to tenths */
+	CHECK(worst < 0.1);
+}
+
+static void _test_joy(void *arg) {
+	sim_set_ain(SIM_AIN_JOY, (uint32_t) (uintptr_t) arg);
+}
+
+static void _test_accel(void) {
+	bma280_xyz_t xyz[BMA280_FIFO_FRAMES];
+
+	while (bma280_fifo_read(xyz, BMA280_FIFO_FRAMES) > 0);
+}
+
+/* The firmware's scans on the model, from a burst set off by a press */
+static void _test_sequence(void) {
+	uint32_t temp_uv = SIM_TEMP_CAL_UV - (TEST_TEMP_C - SIM_TEMP_CAL_C) *
+			ADC_TEMP_SLOPE_UV;
+	adc_scan_t scan;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+	sim_bma280_init();
+	bma280_init();
+	letimer_init();
+
+	evt_register(EVT_TAP, bma280_task);
+	evt_register(EVT_BMA280, bma280_task);
+	evt_register(EVT_ACCEL, _test_accel);
+	evt_register(EVT_LETIMER, letimer_task);
+	evt_register(EVT_GEST, gest_task);
+	evt_register(EVT_JOY, adc_task);
+
+	adc_init();
+
+	sim_set_ain(SIM_AIN_AVDD, TEST_AVDD_MV * 1000);
+	sim_set_ain(SIM_AIN_TEMP, temp_uv);
+	test_run(SIM_S(1));
+	CHECK(!adc_get_scan(&scan));
+
+	sim_at(sim_now(), _test_joy, (void *) (uintptr_t) (SIM_VDD_UV * 85 / 100));
+	sim_at(sim_now() + SIM_S(1), _test_joy, (void *) (uintptr_t) SIM_VDD_UV);
+	test_run(SIM_S(2));
+
+	CHECK(adc_get_scan(&scan));
+	printf("adc_scan_test: joystick %u, supply %u mV, %d.%d C, alarms %x\n",
+			scan.avg[ADC_CH_JOY], scan.avdd_mv, scan.temp_dc / 10,
+			scan.temp_dc % 10, scan.alarm);
+
+	/* Supply to the LSB, temperature to the tenth */
+	CHECK(scan.avdd_mv >= TEST_AVDD_MV - 2 && scan.avdd_mv <= TEST_AVDD_MV);
+	CHECK(scan.temp_dc >= TEST_TEMP_C * 10 - 1 &&
+			scan.temp_dc <= TEST_TEMP_C * 10 + 1);
+	CHECK(scan.alarm & (1 << ADC_CH_AVDD));
+	CHECK(!(scan.alarm & (1 << ADC_CH_TEMP)));
+	CHECK(sim_adc_overflows == 0);
+}
+
+int main(void) {
+	srand(18);
+
+	_test_layout();
+	_test_random();
+	_test_sequence();
+
+	return test_result("adc_scan_test");
+}
@@ -0,0 +1,202 @@
+/**
+ * @file atom_test.c
+ * @brief Multi-threaded stress test for the atomic helpers
+ *
+ * This test hammers the atomic helpers and the sleep block counters from
+ * several threads at once. Between rounds all threads stop at a barrier and
+ * the counters and the sleep mask are checked against what every thread
+ * says it holds.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include "test.h"
+#include "../slp.c"
+
+#define TEST_THREADS 8
+#define TEST_ROUNDS 200
+#define TEST_STEPS 5000
+
+/* Round trips of each bit through atom_or()/atom_xchg() */
+#define TEST_SIGNALS 20000
+
+static pthread_barrier_t test_barrier;
+
+/* Blocks held by each thread */
+static uint32_t test_held[TEST_THREADS][SLP_NUM_EM];
+
+/* Plain counter shared by the atom_inc()/atom_dec() threads */
+static volatile uint32_t test_count = 0;
+static volatile uint32_t test_underflow = 0;
+
+/* Bits in flight and bits received, one per producer */
+static volatile uint32_t test_word = 0;
+static volatile uint32_t test_done = 0;
+static uint32_t test_received[TEST_THREADS];
+
+/* Random block/unblock rounds, unblocks sometimes come without a block to
+ * check they are ignored */
+static void *_test_slp_thread(void *arg) {
+	int t = (int) (intptr_t) arg;
+	unsigned int seed = t + 1;
+	int em;
+
+	for (int r = 0; r < TEST_ROUNDS; r++) {
+		for (int i = 0; i < TEST_STEPS; i++) {
+			em = rand_r(&seed) % SLP_NUM_EM;
+			if (rand_r(&seed) % 2) {
+				slp_blockSleepMode((slp_em_t) em);
+				test_held[t][em]++;
+			} else if (test_held[t][em] > 0) {
+				slp_unblockSleepMode((slp_em_t) em);
+				test_held[t][em]--;
+			}
+		}
+
+		/* Main checks the counters in between */
+		pthread_barrier_wait(&test_barrier);
+		pthread_barrier_wait(&test_barrier);
+	}
+
+	for (em = 0; em < SLP_NUM_EM; em++) {
+		while (test_held[t][em] > 0) {
+			slp_unblockSleepMode((slp_em_t) em);
+			test_held[t][em]--;
+		}
+	}
+
+	return NULL;
+}
+
+static void _test_slp(void) {
+	pthread_t threads[TEST_THREADS];
+	uint32_t held;
+	int bad = 0;
+
+	pthread_barrier_init(&test_barrier, NULL, TEST_THREADS + 1);
+
+	for (int t = 0; t < TEST_THREADS; t++) {
+		pthread_create(&threads[t], NULL, _test_slp_thread, (void *) (intptr_t) t);
+	}
+
+	for (int r = 0; r < TEST_ROUNDS; r++) {
+		pthread_barrier_wait(&test_barrier);
+		for (int em = 0; em < SLP_NUM_EM; em++) {
+			held = 0;
+			for (int t = 0; t < TEST_THREADS; t++) {
+				held += test_held[t][em];
+			}
+			if (slp_state[em] != held ||
+				((slp_mask >> em) & 1) != (held > 0)) {
+				bad++;
+			}
+		}
+		pthread_barrier_wait(&test_barrier);
+	}
+
+	for (int t = 0; t < TEST_THREADS; t++) {
+		pthread_join(threads[t], NULL);
+	}
+
+	printf("atom_test: %d threads, %d block/unblock calls, %d bad rounds\n",
+			TEST_THREADS, TEST_THREADS * TEST_ROUNDS * TEST_STEPS, bad);
+	CHECK(bad == 0);
+	for (int em = 0; em < SLP_NUM_EM; em++) {
+		CHECK(slp_state[em] == 0);
+	}
+	CHECK(slp_mask == 0);
+
+	pthread_barrier_destroy(&test_barrier);
+}
+
+/* Half the threads decrement more often than they increment */
+static void *_test_count_thread(void *arg) {
+	int t = (int) (intptr_t) arg;
+	unsigned int seed = t + 100;
+
+	for (int i = 0; i < TEST_ROUNDS * TEST_STEPS / 4; i++) {
+		if (rand_r(&seed) % 3 == 0 || (t & 1)) {
+			atom_inc(&test_count);
+		}
+		if (atom_dec(&test_count) && test_count > 0x80000000) {
+			atom_inc(&test_underflow);
+		}
+	}
+
+	return NULL;
+}
+
+static void _test_count(void) {
+	pthread_t threads[TEST_THREADS];
+
+	for (int t = 0; t < TEST_THREADS; t++) {
+		pthread_create(&threads[t], NULL, _test_count_thread, (void *) (intptr_t) t);
+	}
+	for (int t = 0; t < TEST_THREADS; t++) {
+		pthread_join(threads[t], NULL);
+	}
+
+	/* Every decrement that went through matched an increment */
+	CHECK(test_underflow == 0);
+	CHECK(test_count < 0x80000000);
+
+	while (atom_dec(&test_count));
+	CHECK(test_count == 0);
+	CHECK(!atom_dec(&test_count));
+	CHECK(test_count == 0);
+}
+
+/* A producer sends its bit again once the consumer took it, so a bit lost
+ * between atom_or() and atom_xchg() shows up as a missing receipt */
+static void *_test_producer(void *arg) {
+	int t = (int) (intptr_t) arg;
+	uint32_t bit = 1u << t;
+
+	for (int i = 0; i < TEST_SIGNALS; i++) {
+		atom_or(&test_word, bit);
+		while (atomic_load(_ATOM(&test_word)) & bit) {
+			sched_yield();
+		}
+	}
+
+	atom_inc(&test_done);
+
+	return NULL;
+}
+
+static void _test_signal(void) {
+	pthread_t threads[TEST_THREADS - 1];
+	uint32_t bits;
+	bool done;
+
+	for (int t = 0; t < TEST_THREADS - 1; t++) {
+		pthread_create(&threads[t], NULL, _test_producer, (void *) (intptr_t) t);
+	}
+
+	do {
+		done = atomic_load(_ATOM(&test_done)) == TEST_THREADS - 1;
+		bits = atom_xchg(&test_word, 0);
+		for (int t = 0; t < TEST_THREADS - 1; t++) {
+			test_received[t] += (bits >> t) & 1;
+		}
+		sched_yield();
+	} while (!done || bits);
+
+	for (int t = 0; t < TEST_THREADS - 1; t++) {
+		pthread_join(threads[t], NULL);
+		CHECK(test_received[t] == TEST_SIGNALS);
+	}
+}
+
+int main(void) {
+	_test_slp();
+	_test_count();
+	_test_signal();
+
+	return test_result("atom_test");
+}
@@ -0,0 +1,208 @@
+/**
+ * @file bma280_burst_test.c
+ * @brief Host test and benchmark for BMA280 burst register access
+ *
+ * This test runs the BMA280 driver against the register model on the
+ * simulated SPI bus. It checks that bma280_config() writes every register
+ * of the tap and FIFO configuration in one transaction and that
+ * bma280_read_xyz() reads all three axes in one, with their signs. It then
+ * compares both with the same accesses made one register per transaction,
+ * as before, and reports transactions, bytes on the wire, bus time, wakeups
+ * and host time for each. The model charges no time for the chip select or
+ * the driver, so host time stands in for the CPU cost of a transaction.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "bma280.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+#include "sim_bma280.h"
+
+/* Times each access is repeated for the figures */
+#define TEST_ROUNDS 100
+
+/* What bma280_config() should write */
+static const uint8_t test_config[][2] = {
+	{ BMA280_PMU_RANGE, BMA280_PMU_RANGE_RANGE },
+	{ BMA280_PMU_BW, BMA280_PMU_BW_BW },
+	{ BMA280_INT_8, BMA280_INT_8_TAP_DUR | BMA280_INT_8_TAP_SHOCK |
+			BMA280_INT_8_TAP_QUIET },
+	{ BMA280_INT_9, BMA280_INT_9_TAP_TH | BMA280_INT_9_TAP_SAMP },
+	{ BMA280_INT_MAP_0, BMA280_INT_MAP_0_INT1_S_TAP |
+			BMA280_INT_MAP_0_INT1_D_TAP },
+	{ BMA280_INT_EN_0, BMA280_INT_EN_0_S_TAP_EN | BMA280_INT_EN_0_D_TAP_EN },
+	{ BMA280_INT_RST_LATCH, BMA280_INT_RST_LATCH_LATCH_INT },
+#if BMA280_FIFO
+	{ BMA280_FIFO_CONFIG_0, BMA280_FIFO_WM },
+	{ BMA280_INT_MAP_1, BMA280_INT_MAP_1_INT1_FWM },
+	{ BMA280_INT_EN_1, BMA280_INT_EN_1_INT_FWM_EN },
+	{ BMA280_FIFO_CONFIG_1, BMA280_FIFO_CONFIG_1_MODE_STREAM |
+			BMA280_FIFO_CONFIG_1_DATA_SELECT_XYZ },
+#endif
+};
+
+#define TEST_CONFIG_NUM (sizeof(test_config) / sizeof(test_config[0]))
+
+/* Sample in the data registers, left aligned 14 bit */
+static const uint8_t test_accd[BMA280_ACCD_NUM] = {
+	0x00, 0x80, 0xfc, 0x7f, 0x04, 0x00,
+};
+static const bma280_xyz_t test_xyz = { -8192, 8191, 1 };
+
+/*
+ * @brief What an access cost
+ */
+typedef struct test_cost_s {
+	uint32_t xfers;
+	uint32_t bytes;
+	uint64_t bus_ns;
+	uint32_t wakes;
+	uint64_t host_ns;
+} test_cost_t;
+
+/* The configuration one register per transaction */
+static void _test_config_single(void) {
+	for (uint32_t i = 0; i < TEST_CONFIG_NUM; i++) {
+		bma280_write(test_config[i][0], test_config[i][1]);
+	}
+}
+
+static void _test_config_burst(void) {
+	bma280_config();
+}
+
+static bma280_xyz_t test_read;
+
+/* The sample one register per transaction */
+static void _test_xyz_single(void) {
+	uint8_t d[BMA280_ACCD_NUM];
+
+	for (uint32_t i = 0; i < BMA280_ACCD_NUM; i++) {
+		d[i] = bma280_read(BMA280_ACCD_X_LSB + i);
+	}
+	test_read.x = (int16_t) ((d[1] << 8) | d[0]) >> BMA280_ACCD_SHIFT;
+	test_read.y = (int16_t) ((d[3] << 8) | d[2]) >> BMA280_ACCD_SHIFT;
+	test_read.z = (int16_t) ((d[5] << 8) | d[4]) >> BMA280_ACCD_SHIFT;
+}
+
+static void _test_xyz_burst(void) {
+	bma280_read_xyz(&test_read);
+}
+
+/* Clear the configured registers so a missed write shows */
+static void _test_clobber(void) {
+	for (uint32_t i = 0; i < TEST_CONFIG_NUM; i++) {
+		sim_bma280_reg[test_config[i][0]] = 0;
+	}
+}
+
+static bool _test_configured(void) {
+	for (uint32_t i = 0; i < TEST_CONFIG_NUM; i++) {
+		if (sim_bma280_reg[test_config[i][0]] != test_config[i][1]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Run an access a number of times, per access cost */
+static void _test_measure(void (*access)(void), test_cost_t *cost) {
+	uint32_t xfers = sim_bma280_xfers;
+	uint32_t bytes = sim_usart_bytes;
+	uint64_t now = sim_now();
+	uint32_t wakes = test_wakes();
+	uint64_t t0 = test_ns();
+
+	for (uint32_t i = 0; i < TEST_ROUNDS; i++) {
+		access();
+	}
+
+	cost->host_ns = (test_ns() - t0) / TEST_ROUNDS;
+	cost->xfers = (sim_bma280_xfers - xfers) / TEST_ROUNDS;
+	cost->bytes = (sim_usart_bytes - bytes) / TEST_ROUNDS;
+	cost->bus_ns = (sim_now() - now) / TEST_ROUNDS;
+	cost->wakes = (test_wakes() - wakes) / TEST_ROUNDS;
+}
+
+static void _test_report(const char *name, const test_cost_t *cost) {
+	printf("  %-14s %2u transactions %3u bytes %7.1f us on the bus %2u "
+			"wakeups %6llu host ns\n", name, cost->xfers, cost->bytes,
+			cost->bus_ns / 1000.0, cost->wakes,
+			(unsigned long long) cost->host_ns);
+}
+
+int main(void) {
+	test_cost_t single_cfg, burst_cfg;
+	test_cost_t single_xyz, burst_xyz;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	sim_bma280_init();
+	bma280_init();
+
+	/* Out of deep suspend, the registers come back at their defaults */
+	bma280_write(BMA280_PMU_LPW, 0);
+	CHECK(!sim_bma280_suspended());
+
+	printf("bma280_burst_test: %u registers configured, one sample read\n",
+			(uint32_t) TEST_CONFIG_NUM);
+
+	/* One transaction writes the whole configuration */
+	_test_clobber();
+	_test_measure(_test_config_burst, &burst_cfg);
+	CHECK(_test_configured());
+	CHECK(burst_cfg.xfers == 1);
+	CHECK(burst_cfg.bytes == 2 * TEST_CONFIG_NUM);
+
+	_test_clobber();
+	_test_measure(_test_config_single, &single_cfg);
+	CHECK(_test_configured());
+	CHECK(single_cfg.xfers == TEST_CONFIG_NUM);
+
+	/* And one reads all three axes, the address increments */
+	for (uint32_t i = 0; i < BMA280_ACCD_NUM; i++) {
+		sim_bma280_reg[BMA280_ACCD_X_LSB + i] = test_accd[i];
+	}
+	_test_measure(_test_xyz_burst, &burst_xyz);
+	CHECK(test_read.x == test_xyz.x && test_read.y == test_xyz.y &&
+			test_read.z == test_xyz.z);
+	CHECK(burst_xyz.xfers == 1);
+	CHECK(burst_xyz.bytes == 1 + BMA280_ACCD_NUM);
+
+	test_read = (bma280_xyz_t) { 0, 0, 0 };
+	_test_measure(_test_xyz_single, &single_xyz);
+	CHECK(test_read.x == test_xyz.x && test_read.y == test_xyz.y &&
+			test_read.z == test_xyz.z);
+	CHECK(single_xyz.xfers == BMA280_ACCD_NUM);
+	CHECK(single_xyz.bytes == 2 * BMA280_ACCD_NUM);
+
+	_test_report("config burst", &burst_cfg);
+	_test_report("config single", &single_cfg);
+	_test_report("xyz burst", &burst_xyz);
+	_test_report("xyz single", &single_xyz);
+
+	/* Writes are address and data pairs either way, reads send the address
+	 * once. Each transaction wakes the core once. */
+	CHECK(burst_cfg.bus_ns <= single_cfg.bus_ns);
+	CHECK(burst_xyz.bus_ns < single_xyz.bus_ns);
+	CHECK(burst_cfg.wakes < single_cfg.wakes);
+	CHECK(burst_xyz.wakes < single_xyz.wakes);
+	CHECK(sim_bma280_errors == 0);
+
+	return test_result("bma280_burst_test");
+}
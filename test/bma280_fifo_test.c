@@ -0,0 +1,260 @@
+/**
+ * @file bma280_fifo_test.c
+ * @brief Host simulation of BMA280 FIFO streaming
+ *
+ * This test streams acceleration from the BMA280 model through the driver's
+ * watermark drains into the sample ring and reads it from the main loop as
+ * the application would. Every sample is checked against the frame the
+ * model took, so a lost sample shows as a gap in the sequence. It runs the
+ * stream steadily, then with the application not reading the ring and then
+ * with the SPI bus held by another device long enough for the sensor FIFO
+ * to overrun. For each it reports the samples, drains and wakeups per
+ * second and the losses, which must match what the driver's statistics
+ * count.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "bma280.h"
+#include "spi.h"
+#include "dma.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+#include "sim_bma280.h"
+
+/* Output data rate of the configured 125 Hz bandwidth */
+#define TEST_ODR 250
+
+/* Length of each part */
+#define TEST_STEADY SIM_S(10)
+#define TEST_STALL SIM_S(1)
+#define TEST_AFTER SIM_MS(500)
+
+/* Transfers holding the bus, longer together than the FIFO lasts past the
+ * watermark */
+#define TEST_HOLD_XFERS 8
+
+/* Device holding the bus */
+static const spi_dev_t test_dev = { gpioPortC, 6 };
+
+/* Reading the ring, and what was read */
+static bool test_reading = true;
+static bool test_synced = false;
+static uint32_t test_next = 0;
+static uint32_t test_samples = 0;
+static uint32_t test_gaps = 0;
+static uint32_t test_bad = 0;
+
+/*
+ * @brief What a part of the run cost and lost
+ */
+typedef struct test_seg_s {
+	uint64_t ns;
+	uint64_t em_ns[5];
+	uint32_t wakes;
+	uint32_t bytes;
+	uint32_t samples;
+	uint32_t gaps;
+	uint32_t lost;
+	uint32_t flushed;
+	bma280_fifo_stats_t stats;
+} test_seg_t;
+
+static uint8_t _test_dev_xfer(uint8_t mosi) {
+	return 0;
+}
+
+/* The sample's frame number follows from x, the other axes must agree */
+static void _test_check(const bma280_xyz_t *xyz) {
+	int16_t want[3];
+	uint32_t gap = 0;
+
+	if (test_synced) {
+		sim_bma280_xyz(test_next, want);
+		gap = (uint16_t) (xyz->x - want[0]) & 0x3fff;
+	} else {
+		test_next = (uint16_t) xyz->x & 0x3fff;
+		test_synced = true;
+	}
+
+	test_next += gap;
+	test_gaps += gap;
+
+	sim_bma280_xyz(test_next, want);
+	if (xyz->x != want[0] || xyz->y != want[1] || xyz->z != want[2]) {
+		test_bad++;
+	}
+
+	test_next++;
+	test_samples++;
+}
+
+/* What the application does with EVT_ACCEL */
+static void _test_accel(void) {
+	bma280_xyz_t xyz[BMA280_FIFO_FRAMES];
+	uint32_t n;
+
+	if (!test_reading) {
+		return;
+	}
+
+	while ((n = bma280_fifo_read(xyz, BMA280_FIFO_FRAMES)) > 0) {
+		for (uint32_t i = 0; i < n; i++) {
+			_test_check(&xyz[i]);
+		}
+	}
+}
+
+static void _test_snap(test_seg_t *seg) {
+	for (int em = 0; em < 5; em++) {
+		seg->em_ns[em] = sim_stats.ns[em];
+	}
+	seg->wakes = test_wakes();
+	seg->bytes = sim_usart_bytes;
+	seg->samples = test_samples;
+	seg->gaps = test_gaps;
+	seg->lost = sim_bma280_lost;
+	seg->flushed = sim_bma280_flushed;
+	bma280_fifo_get_stats(&seg->stats);
+}
+
+static void _test_diff(test_seg_t *seg, uint64_t ns) {
+	bma280_fifo_stats_t stats;
+
+	seg->ns = ns;
+	for (int em = 0; em < 5; em++) {
+		seg->em_ns[em] = sim_stats.ns[em] - seg->em_ns[em];
+	}
+	seg->wakes = test_wakes() - seg->wakes;
+	seg->bytes = sim_usart_bytes - seg->bytes;
+	seg->samples = test_samples - seg->samples;
+	seg->gaps = test_gaps - seg->gaps;
+	seg->lost = sim_bma280_lost - seg->lost;
+	seg->flushed = sim_bma280_flushed - seg->flushed;
+
+	bma280_fifo_get_stats(&stats);
+	seg->stats.frames = stats.frames - seg->stats.frames;
+	seg->stats.drains = stats.drains - seg->stats.drains;
+	seg->stats.overruns = stats.overruns - seg->stats.overruns;
+	seg->stats.dropped = stats.dropped - seg->stats.dropped;
+}
+
+/* Run the main loop for some time and count what it cost and lost */
+static void _test_seg(uint64_t ns, test_seg_t *seg) {
+	_test_snap(seg);
+	test_run(ns);
+	_test_diff(seg, ns);
+}
+
+static void _test_report(const char *part, const test_seg_t *seg) {
+	double s = (double) seg->ns / SIM_S(1);
+	double pct = 100.0 / seg->ns;
+
+	printf("  %-7s %6.1f samples/s %5.2f drains/s %6.2f wakeups/s %7.1f "
+			"bytes/s EM1/2/3 %5.2f/%6.2f/%6.2f %%, lost %3u in the FIFO "
+			"(%u overruns, %u emptied) %3u in the ring\n", part,
+			seg->samples / s, seg->stats.drains / s, seg->wakes / s,
+			seg->bytes / s, seg->em_ns[1] * pct, seg->em_ns[2] * pct,
+			seg->em_ns[3] * pct, seg->lost, seg->stats.overruns, seg->flushed,
+			seg->stats.dropped);
+}
+
+/* Queue long transfers to the other device */
+static void _test_hold(void) {
+	static uint8_t rx[SPI_MAX_LEN];
+	static spi_xfer_t xfers[TEST_HOLD_XFERS];
+
+	for (uint32_t i = 0; i < TEST_HOLD_XFERS; i++) {
+		xfers[i] = (spi_xfer_t) {
+			.dev = &test_dev, .rx = rx, .rx_len = SPI_MAX_LEN,
+		};
+		CHECK(spi_submit(&xfers[i]));
+	}
+}
+
+int main(void) {
+	test_seg_t steady;
+	test_seg_t stall;
+	test_seg_t held;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	GPIO_PinModeSet(test_dev.port, test_dev.pin, gpioModePushPull, 1);
+	sim_usart_attach(test_dev.port, test_dev.pin, _test_dev_xfer);
+
+	sim_bma280_init();
+	bma280_init();
+
+	evt_register(EVT_TAP, bma280_task);
+	evt_register(EVT_BMA280, bma280_task);
+	evt_register(EVT_ACCEL, _test_accel);
+
+	sim_bma280_stream(true);
+	bma280_enable();
+	test_run(SIM_S(1));
+	CHECK(test_synced);
+
+	printf("bma280_fifo_test: %u Hz, watermark %u of %u frames, ring %u\n",
+			TEST_ODR, BMA280_FIFO_WM, BMA280_FIFO_FRAMES, BMA280_RING_SIZE);
+
+	/* Every frame arrives, a drain for each watermark */
+	_test_seg(TEST_STEADY, &steady);
+	_test_report("steady", &steady);
+	CHECK(steady.samples >= TEST_STEADY / SIM_S(1) * TEST_ODR - BMA280_FIFO_WM &&
+			steady.samples <= TEST_STEADY / SIM_S(1) * TEST_ODR + BMA280_FIFO_WM);
+	CHECK(steady.stats.frames + BMA280_FIFO_FRAMES >= steady.samples &&
+			steady.stats.frames <= steady.samples + BMA280_FIFO_FRAMES);
+	CHECK(steady.stats.drains * BMA280_FIFO_WM <= steady.stats.frames);
+	CHECK(steady.stats.drains * (BMA280_FIFO_WM + 1) >= steady.stats.frames);
+	CHECK(steady.gaps == 0 && steady.lost == 0 && steady.flushed == 0);
+	CHECK(steady.stats.overruns == 0 && steady.stats.dropped == 0);
+
+	/* The status read and the drain each wake the core, and the watermark
+	 * edge. Reading on each new sample would wake it at the data rate. */
+	CHECK(steady.wakes <= steady.stats.drains * 3 + 1);
+	CHECK(steady.wakes * 5 < steady.samples);
+
+	/* The ring fills when the application does not keep up, the newest
+	 * samples are dropped and counted */
+	_test_snap(&stall);
+	test_reading = false;
+	test_run(TEST_STALL);
+	test_reading = true;
+	test_run(TEST_AFTER);
+	_test_diff(&stall, TEST_STALL + TEST_AFTER);
+	_test_report("stall", &stall);
+	CHECK(stall.stats.dropped > 0);
+	CHECK(stall.gaps == stall.stats.dropped);
+	CHECK(stall.lost == 0 && stall.flushed == 0 && stall.stats.overruns == 0);
+
+	/* With the bus held, the sensor FIFO overruns and loses the oldest
+	 * frames. The driver counts it once on its next drain and clears the
+	 * flag, which empties what came in during the drain. */
+	_test_hold();
+	_test_seg(TEST_STALL, &held);
+	_test_report("held", &held);
+	CHECK(held.lost > 0);
+	CHECK(held.flushed <= 1);
+	CHECK(held.gaps == held.lost + held.flushed);
+	CHECK(held.stats.overruns == 1);
+	CHECK(held.stats.dropped == 0);
+
+	CHECK(test_bad == 0);
+	CHECK(sim_bma280_errors == 0);
+	CHECK(dma_errors() == 0);
+
+	return test_result("bma280_fifo_test");
+}
@@ -0,0 +1,215 @@
+/**
+ * @file bma280_pt_test.c
+ * @brief Host test for the BMA280 enable and tap threads
+ *
+ * This test runs the BMA280 driver against a model of the device on the
+ * simulated SPI bus. It checks the reset wait and the configuration written
+ * by the enable thread, that single and double taps drive LED1, and that the
+ * main loop keeps dispatching other events with no added latency while the
+ * tap thread waits out the double tap window in EM2. A disable that cuts an
+ * enable short right after its reset must still leave the device asleep.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "bma280.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+#include "sim_bma280.h"
+
+/* Period of the probe interrupt */
+#define TEST_PROBE SIM_MS(5)
+
+/* Time the tap thread needs from the tap to LED1 */
+#define TEST_TAP_WAIT SIM_MS(400)
+
+/* Probe raised and not yet dispatched, and the worst delay seen */
+static uint64_t test_raised = 0;
+static uint64_t test_latency = 0;
+static uint32_t test_probes = 0;
+static uint64_t test_stop = 0;
+
+void SIM_TEST_IRQHandler(void) {
+	evt_post(EVT_JOY);
+}
+
+/* Raise the probe interrupt and schedule the next one */
+static void _test_probe(void *arg) {
+	test_raised = sim_now();
+	NVIC_SetPendingIRQ(SIM_TEST_IRQn);
+
+	if (sim_now() + TEST_PROBE < test_stop) {
+		sim_at(sim_now() + TEST_PROBE, _test_probe, NULL);
+	}
+}
+
+static void _test_probe_handle(void) {
+	uint64_t latency = sim_now() - test_raised;
+
+	if (latency > test_latency) {
+		test_latency = latency;
+	}
+	test_probes++;
+}
+
+/* Drain samples so the ring never fills */
+static void _test_accel(void) {
+	bma280_xyz_t xyz[BMA280_FIFO_FRAMES];
+
+	while (bma280_fifo_read(xyz, BMA280_FIFO_FRAMES) > 0);
+}
+
+static void _test_tap(void *arg) {
+	sim_bma280_tap((uint8_t) (uintptr_t) arg);
+}
+
+/* bma280_init() resets the device, waits and puts it back to sleep */
+static void _test_init(void) {
+	CHECK(sim_bma280_resets == 1);
+	CHECK(sim_bma280_errors == 0);
+	CHECK(sim_bma280_suspended());
+	CHECK(!bma280_isEnabled());
+
+	/* The reset wait is slept through, not spun */
+	CHECK(sim_now() >= SIM_BMA280_RESET_NS);
+	CHECK(sim_stats.ns[1] < SIM_US(500));
+}
+
+static void _test_enable(void) {
+	uint8_t *r = sim_bma280_reg;
+
+	bma280_enable();
+	test_run(SIM_MS(10));
+
+	CHECK(bma280_isEnabled());
+	CHECK(!sim_bma280_suspended());
+	CHECK(sim_bma280_resets == 2);
+	CHECK(sim_bma280_errors == 0);
+
+	CHECK(r[BMA280_PMU_RANGE] == BMA280_PMU_RANGE_RANGE);
+	CHECK(r[BMA280_PMU_BW] == BMA280_PMU_BW_BW);
+	CHECK(r[BMA280_INT_8] == (BMA280_INT_8_TAP_DUR | BMA280_INT_8_TAP_SHOCK |
+			BMA280_INT_8_TAP_QUIET));
+	CHECK(r[BMA280_INT_9] == (BMA280_INT_9_TAP_TH | BMA280_INT_9_TAP_SAMP));
+	CHECK(r[BMA280_INT_MAP_0] == (BMA280_INT_MAP_0_INT1_S_TAP |
+			BMA280_INT_MAP_0_INT1_D_TAP));
+	CHECK(r[BMA280_INT_EN_0] == (BMA280_INT_EN_0_S_TAP_EN |
+			BMA280_INT_EN_0_D_TAP_EN));
+	CHECK(r[BMA280_INT_RST_LATCH] == BMA280_INT_RST_LATCH_LATCH_INT);
+}
+
+/* Tap once or twice and check LED1 and what the wait cost */
+static void _test_taps(const char *name, bool twice, bool led) {
+	uint64_t em1 = sim_stats.ns[1];
+	uint64_t em2 = sim_stats.ns[2];
+	uint32_t probes = test_probes;
+	uint64_t t = sim_now();
+
+	gpio_setLED1(!led);
+
+	test_latency = 0;
+	test_stop = t + TEST_TAP_WAIT;
+	sim_at(t + SIM_MS(1), _test_probe, NULL);
+	sim_at(t + SIM_MS(3), _test_tap,
+			(void *) (uintptr_t) BMA280_INT_STATUS_0_S_TAP_INT);
+	if (twice) {
+		sim_at(t + SIM_MS(103), _test_tap,
+				(void *) (uintptr_t) BMA280_INT_STATUS_0_D_TAP_INT);
+	}
+	test_run(TEST_TAP_WAIT);
+
+	printf("  %-10s LED1 %s, %u probes, worst latency %llu us, "
+			"EM1 %llu us, EM2 %llu us\n", name,
+			sim_gpio_out[GPIO_LED1_PORT][GPIO_LED1_PIN] ? "on" : "off",
+			test_probes - probes,
+			(unsigned long long) (test_latency / 1000),
+			(unsigned long long) ((sim_stats.ns[1] - em1) / 1000),
+			(unsigned long long) ((sim_stats.ns[2] - em2) / 1000));
+
+	CHECK(sim_gpio_out[GPIO_LED1_PORT][GPIO_LED1_PIN] == led);
+	CHECK(gpio_getLED1() == led);
+	CHECK(sim_bma280_errors == 0);
+
+	/* Probes kept being dispatched through the double tap window */
+	CHECK(test_probes - probes >= TEST_TAP_WAIT / TEST_PROBE - 1);
+	CHECK(test_latency < SIM_US(100));
+
+	/* The window is spent in EM2, the bus only needs EM1 briefly */
+	CHECK(sim_stats.ns[2] - em2 > SIM_MS(250));
+	CHECK(sim_stats.ns[1] - em1 < SIM_MS(1));
+}
+
+static void _test_disable(void) {
+	evt_stats_t before;
+	evt_stats_t after;
+
+	bma280_disable();
+	test_run(SIM_MS(10));
+
+	CHECK(!bma280_isEnabled());
+	CHECK(sim_bma280_suspended());
+
+	/* Taps are no longer seen */
+	gpio_setLED1(true);
+	evt_get_stats(&before);
+	CHECK(!sim_bma280_tap(BMA280_INT_STATUS_0_S_TAP_INT));
+	test_run(TEST_TAP_WAIT);
+	evt_get_stats(&after);
+
+	CHECK(after.count[EVT_TAP] == before.count[EVT_TAP]);
+	CHECK(gpio_getLED1());
+	CHECK(sim_bma280_errors == 0);
+}
+
+/* Disabled while the device is still coming out of the enable's reset */
+static void _test_abort(void) {
+	uint32_t resets = sim_bma280_resets;
+
+	bma280_enable();
+	test_run(SIM_US(200));
+	CHECK(sim_bma280_resets == resets + 1);
+
+	bma280_disable();
+	test_run(SIM_MS(10));
+
+	CHECK(!bma280_isEnabled());
+	CHECK(sim_bma280_suspended());
+	CHECK(sim_bma280_errors == 0);
+}
+
+int main(void) {
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	sim_bma280_init();
+	bma280_init();
+	_test_init();
+
+	evt_register(EVT_TAP, bma280_task);
+	evt_register(EVT_BMA280, bma280_task);
+	evt_register(EVT_ACCEL, _test_accel);
+	evt_register(EVT_JOY, _test_probe_handle);
+	NVIC_EnableIRQ(SIM_TEST_IRQn);
+
+	printf("bma280_pt_test: %u SPI transactions in init\n", sim_bma280_xfers);
+
+	_test_enable();
+	_test_taps("single tap", false, false);
+	_test_taps("double tap", true, true);
+	_test_disable();
+	_test_abort();
+
+	return test_result("bma280_pt_test");
+}
@@ -0,0 +1,283 @@
+/**
+ * @file cmu_test.c
+ * @brief Host test for the clock reference counts
+ *
+ * This test checks that the clocks acquired in cmu_init(), before the sleep
+ * clock runs, count their on time from its start. It then acquires and
+ * releases clocks at random, with and without interrupts masked, and checks
+ * after every call that each count is the test's own users plus the clocks
+ * that depend on it, and that the modelled clock or oscillator is on exactly
+ * when it has users. Finally it runs LED0
+ * blinking and the BMA280 tap thread with a tap every few seconds, followed
+ * by the BMA280 in deep suspend, and reports how long each clock was on
+ * against the model's own accounting.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include <stdlib.h>
+#include "test.h"
+#include "cmu.h"
+#include "bma280.h"
+#include "letimer.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+#include "em_cryotimer.h"
+#include "sim_bma280.h"
+
+/* Random acquire and release calls */
+#define TEST_OPS 100000
+
+/* Taps and the time between them in the scenario */
+#define TEST_TAPS 12
+#define TEST_TAP_EVERY SIM_S(5)
+
+/* Time in deep suspend at the end of the scenario */
+#define TEST_IDLE SIM_S(60)
+
+/*
+ * @brief The hardware behind a managed clock and what it needs
+ */
+typedef struct test_clk_s {
+	const char *name;
+	bool is_osc;
+	int hw;
+	uint32_t deps;
+} test_clk_t;
+
+static const test_clk_t test_clks[CMU_NUM_CLK] = {
+	[CMU_CLK_AUXHFRCO]  = { "AUXHFRCO", true, cmuOsc_AUXHFRCO, 0 },
+	[CMU_CLK_HFPER]     = { "HFPER", false, cmuClock_HFPER, 0 },
+	[CMU_CLK_GPIO]      = { "GPIO", false, cmuClock_GPIO, 0 },
+	[CMU_CLK_CORELE]    = { "CORELE", false, cmuClock_CORELE, 0 },
+	[CMU_CLK_LETIMER0]  = { "LETIMER0", false, cmuClock_LETIMER0,
+							(1 << CMU_CLK_CORELE) },
+	[CMU_CLK_ADC0]      = { "ADC0", false, cmuClock_ADC0,
+							(1 << CMU_CLK_HFPER) | (1 << CMU_CLK_AUXHFRCO) },
+	[CMU_CLK_USART1]    = { "USART1", false, cmuClock_USART1,
+							(1 << CMU_CLK_HFPER) },
+	[CMU_CLK_CRYOTIMER] = { "CRYOTIMER", false, cmuClock_CRYOTIMER, 0 },
+	[CMU_CLK_LDMA]      = { "LDMA", false, cmuClock_LDMA, 0 },
+	[CMU_CLK_PRS]       = { "PRS", false, cmuClock_PRS, 0 },
+	[CMU_CLK_ACMP0]     = { "ACMP0", false, cmuClock_ACMP0,
+							(1 << CMU_CLK_HFPER) },
+};
+
+static bool _test_hw_on(cmu_clk_t clk) {
+	if (test_clks[clk].is_osc) {
+		return sim_cmu_osc_on[test_clks[clk].hw];
+	}
+
+	return sim_cmu_clock_on[test_clks[clk].hw];
+}
+
+static uint64_t _test_hw_ns(cmu_clk_t clk) {
+	if (test_clks[clk].is_osc) {
+		return sim_cmu_osc_ns(test_clks[clk].hw);
+	}
+
+	return sim_cmu_clock_ns(test_clks[clk].hw);
+}
+
+/* Counts are the base users, the test's own and one per clock that is on
+ * and depends on it */
+static bool _test_counts(const uint32_t *base, const uint32_t *held) {
+	cmu_stats_t stats;
+	uint32_t expect;
+
+	cmu_get_stats(&stats);
+
+	for (int c = 0; c < CMU_NUM_CLK; c++) {
+		expect = base[c] + held[c];
+		for (int d = 0; d < CMU_NUM_CLK; d++) {
+			if ((test_clks[d].deps & (1 << c)) && stats.users[d] > 0) {
+				expect++;
+			}
+		}
+
+		if (stats.users[c] != expect || _test_hw_on(c) != (expect > 0)) {
+			printf("%s: %u users, expected %u, hardware %s\n",
+					test_clks[c].name, stats.users[c], expect,
+					_test_hw_on(c) ? "on" : "off");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void _test_refcount(void) {
+	uint32_t base[CMU_NUM_CLK];
+	uint32_t held[CMU_NUM_CLK] = {0};
+	cmu_stats_t stats;
+	bool ok = true;
+	cmu_clk_t clk;
+
+	cmu_get_stats(&stats);
+	for (int c = 0; c < CMU_NUM_CLK; c++) {
+		base[c] = stats.users[c];
+	}
+
+	/* Dependencies come and go with their users */
+	cmu_acquire(CMU_CLK_ADC0);
+	CHECK(sim_cmu_osc_on[cmuOsc_AUXHFRCO]);
+	cmu_acquire(CMU_CLK_ADC0);
+	cmu_release(CMU_CLK_ADC0);
+	CHECK(sim_cmu_clock_on[cmuClock_ADC0]);
+	cmu_release(CMU_CLK_ADC0);
+	CHECK(!sim_cmu_clock_on[cmuClock_ADC0]);
+	CHECK(!sim_cmu_osc_on[cmuOsc_AUXHFRCO]);
+	CHECK(_test_counts(base, held));
+
+	/* Releasing a clock nobody uses does nothing */
+	cmu_release(CMU_CLK_USART1);
+	CHECK(_test_counts(base, held));
+
+	/* Masked interrupts stay masked */
+	CORE_ATOMIC_IRQ_DISABLE();
+	cmu_acquire(CMU_CLK_ACMP0);
+	CHECK(sim_primask);
+	cmu_release(CMU_CLK_ACMP0);
+	CHECK(sim_primask);
+	CORE_ATOMIC_IRQ_ENABLE();
+	CHECK(!sim_primask);
+
+	/* Balanced calls in random order */
+	for (uint32_t i = 0; i < TEST_OPS && ok; i++) {
+		clk = (cmu_clk_t) (rand() % CMU_NUM_CLK);
+		if (held[clk] > 0 && (rand() & 1)) {
+			held[clk]--;
+			cmu_release(clk);
+		} else {
+			held[clk]++;
+			if (rand() & 1) {
+				cmu_acquire(clk);
+			} else {
+				CORE_ATOMIC_IRQ_DISABLE();
+				cmu_acquire(clk);
+				CORE_ATOMIC_IRQ_ENABLE();
+			}
+		}
+		ok = _test_counts(base, held);
+	}
+	CHECK(ok);
+
+	for (int c = 0; c < CMU_NUM_CLK; c++) {
+		for (; held[c] > 0; held[c]--) {
+			cmu_release((cmu_clk_t) c);
+		}
+	}
+	CHECK(_test_counts(base, held));
+}
+
+/* Drain samples so the ring never fills */
+static void _test_accel(void) {
+	bma280_xyz_t xyz[BMA280_FIFO_FRAMES];
+
+	while (bma280_fifo_read(xyz, BMA280_FIFO_FRAMES) > 0);
+}
+
+static void _test_tap(void *arg) {
+	sim_bma280_tap(BMA280_INT_STATUS_0_S_TAP_INT);
+}
+
+static void _test_scenario(void) {
+	uint64_t start = sim_now();
+	uint64_t hw0[CMU_NUM_CLK];
+	uint64_t run;
+	uint64_t hw;
+	cmu_stats_t before;
+	cmu_stats_t after;
+
+	cmu_get_stats(&before);
+	for (int c = 0; c < CMU_NUM_CLK; c++) {
+		hw0[c] = _test_hw_ns(c);
+	}
+
+	letimer_init();
+	bma280_enable();
+	for (uint32_t i = 0; i < TEST_TAPS; i++) {
+		sim_at(start + SIM_S(1) + i * TEST_TAP_EVERY, _test_tap, NULL);
+	}
+	test_run(SIM_S(1) + TEST_TAPS * TEST_TAP_EVERY);
+	bma280_disable();
+	test_run(TEST_IDLE);
+
+	run = sim_now() - start;
+	cmu_get_stats(&after);
+
+	printf("cmu_test: clocks over %llu s, %u BMA280 transactions\n",
+			(unsigned long long) (run / SIM_S(1)), sim_bma280_xfers);
+	for (int c = 0; c < CMU_NUM_CLK; c++) {
+		uint32_t ticks = after.ticks[c] - before.ticks[c];
+
+		hw = _test_hw_ns(c) - hw0[c];
+		printf("  %-10s %2u users %5u enables %8u ms on (%9.3f ms modelled)\n",
+				test_clks[c].name, after.users[c],
+				after.enables[c] - before.enables[c], ticks,
+				(double) hw / SIM_MS(1));
+
+		/* The accounting agrees with the model to a sleep clock tick per
+		 * enable */
+		CHECK(SIM_MS(ticks) <= hw +
+				SIM_MS(after.enables[c] - before.enables[c] + 1));
+		CHECK(hw <= SIM_MS(ticks + after.enables[c] - before.enables[c] + 1));
+	}
+
+	/* The bus clock is only on around transfers and off at the end */
+	CHECK(after.enables[CMU_CLK_USART1] - before.enables[CMU_CLK_USART1] >=
+			TEST_TAPS);
+	CHECK(_test_hw_ns(CMU_CLK_USART1) - hw0[CMU_CLK_USART1] < run / 100);
+	CHECK(after.users[CMU_CLK_USART1] == 0);
+	CHECK(!sim_cmu_clock_on[cmuClock_USART1]);
+
+	/* Nobody used the ADC, its oscillator never ran */
+	CHECK(after.enables[CMU_CLK_AUXHFRCO] == before.enables[CMU_CLK_AUXHFRCO]);
+	CHECK(!sim_cmu_osc_on[cmuOsc_AUXHFRCO]);
+
+	/* LED0 keeps blinking */
+	CHECK(after.users[CMU_CLK_LETIMER0] == 1);
+	CHECK(run - (_test_hw_ns(CMU_CLK_LETIMER0) - hw0[CMU_CLK_LETIMER0]) <
+			SIM_MS(1));
+	CHECK(sim_bma280_errors == 0);
+}
+
+int main(void) {
+	cmu_stats_t stats;
+
+	/* The sleep clock starts far from the zero the stopped counter reads */
+	sim_cryo_base = 0xffffff00;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	/* Clocks held from before the sleep clock ran count from its start */
+	cmu_get_stats(&stats);
+	CHECK(stats.ticks[CMU_CLK_HFPER] <= 1);
+	CHECK(stats.ticks[CMU_CLK_CORELE] <= 1);
+	CHECK(stats.ticks[CMU_CLK_CRYOTIMER] <= 1);
+
+	srand(15);
+	_test_refcount();
+
+	sim_bma280_init();
+	bma280_init();
+	evt_register(EVT_TAP, bma280_task);
+	evt_register(EVT_BMA280, bma280_task);
+	evt_register(EVT_ACCEL, _test_accel);
+	evt_register(EVT_LETIMER, letimer_task);
+
+	_test_scenario();
+
+	return test_result("cmu_test");
+}
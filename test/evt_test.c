@@ -0,0 +1,154 @@
+/**
+ * @file evt_test.c
+ * @brief Host test for the event dispatcher
+ *
+ * This test runs the main loop of main.c against a simulated interrupt
+ * source that posts tap, joystick and LETIMER events on a schedule. Each
+ * handler charges a fixed number of core cycles. The test reports handler
+ * invocations, cycles and awake time per event, and checks them against
+ * what was posted and charged.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "em_device.h"
+
+/* Length of the run */
+#define TEST_RUN SIM_S(60)
+
+/*
+ * @brief A periodic interrupt source posting one event
+ */
+typedef struct test_src_s {
+	const char *name;
+	evt_t evt;
+	uint64_t first;
+	uint64_t period;
+	uint32_t cycles;
+	uint32_t posts;
+	uint32_t calls;
+} test_src_t;
+
+static test_src_t test_src[] = {
+	{ "tap",     EVT_TAP,     SIM_MS(100), SIM_MS(300),  5000 },
+	{ "joy",     EVT_JOY,     SIM_MS(7),   SIM_MS(40),   2000 },
+	{ "letimer", EVT_LETIMER, SIM_MS(0),   SIM_MS(1750), 500  },
+};
+
+#define TEST_NUM_SRC (sizeof(test_src) / sizeof(test_src[0]))
+
+/* Interrupts raised and not yet taken, one bit per source */
+static uint32_t test_raised = 0;
+
+void SIM_TEST_IRQHandler(void) {
+	for (uint32_t i = 0; i < TEST_NUM_SRC; i++) {
+		if (test_raised & (1u << i)) {
+			evt_post(test_src[i].evt);
+			test_src[i].posts++;
+		}
+	}
+	test_raised = 0;
+}
+
+/* Raise the interrupt of a source and schedule the next one */
+static void _test_raise(void *arg) {
+	test_src_t *src = arg;
+	uint64_t next = sim_now() + src->period;
+
+	test_raised |= 1u << (src - test_src);
+	NVIC_SetPendingIRQ(SIM_TEST_IRQn);
+
+	if (next < TEST_RUN) {
+		sim_at(next, _test_raise, src);
+	}
+}
+
+static void _test_handle(test_src_t *src) {
+	src->calls++;
+	sim_cpu(src->cycles);
+}
+
+static void _test_tap(void) { _test_handle(&test_src[0]); }
+static void _test_joy(void) { _test_handle(&test_src[1]); }
+static void _test_letimer(void) { _test_handle(&test_src[2]); }
+
+/* Posting twice before a dispatch runs the handler once */
+static void _test_coalesce(void) {
+	evt_stats_t stats;
+
+	evt_post(EVT_GEST);
+	evt_post(EVT_GEST);
+	CHECK(evt_pending());
+	evt_dispatch();
+	CHECK(!evt_pending());
+
+	/* No handler registered, still counted */
+	evt_get_stats(&stats);
+	CHECK(stats.count[EVT_GEST] == 1);
+	CHECK(stats.cycles[EVT_GEST] == 0);
+}
+
+int main(void) {
+	evt_stats_t stats;
+	uint32_t wakes;
+	uint64_t awake;
+
+	cmu_init();
+	evt_init();
+	slp_init();
+
+	evt_register(EVT_TAP, _test_tap);
+	evt_register(EVT_JOY, _test_joy);
+	evt_register(EVT_LETIMER, _test_letimer);
+
+	_test_coalesce();
+	evt_init();
+
+	for (uint32_t i = 0; i < TEST_NUM_SRC; i++) {
+		sim_at(test_src[i].first, _test_raise, &test_src[i]);
+	}
+	NVIC_EnableIRQ(SIM_TEST_IRQn);
+
+	/* The main loop */
+	wakes = test_wakes();
+	test_run_until(TEST_RUN);
+	wakes = test_wakes() - wakes;
+
+	evt_get_stats(&stats);
+
+	printf("evt_test: %u wakeups in %llu s\n", wakes,
+			(unsigned long long) (TEST_RUN / SIM_S(1)));
+	awake = 0;
+	for (uint32_t i = 0; i < TEST_NUM_SRC; i++) {
+		test_src_t *src = &test_src[i];
+		uint64_t us = (uint64_t) stats.cycles[src->evt] * 1000000 / SIM_HF_FREQ;
+
+		printf("  %-8s %6u posts %6u calls %10u cycles %8llu us awake\n",
+				src->name, src->posts, stats.count[src->evt],
+				stats.cycles[src->evt], (unsigned long long) us);
+
+		/* Sources never overlap, so each post is one call */
+		CHECK(src->posts > 0);
+		CHECK(stats.count[src->evt] == src->posts);
+		CHECK(src->calls == src->posts);
+		CHECK(stats.cycles[src->evt] == src->posts * src->cycles);
+		awake += us;
+	}
+
+	/* Polling every handler on every wakeup would have run this many */
+	printf("  handler calls %u dispatched, %u polled\n",
+			test_src[0].calls + test_src[1].calls + test_src[2].calls,
+			(uint32_t) (wakes * TEST_NUM_SRC));
+	printf("  EM0 %llu us, handlers %llu us\n",
+			(unsigned long long) (sim_stats.ns[0] / 1000),
+			(unsigned long long) awake);
+	CHECK(sim_stats.ns[0] / 1000 >= awake);
+
+	return test_result("evt_test");
+}
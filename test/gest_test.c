@@ -0,0 +1,238 @@
+/**
+ * @file gest_test.c
+ * @brief Host test for the joystick gestures
+ *
+ * This test replays scripted joystick timelines into the gesture layer the
+ * way adc.c reports them, from task context with the RTCC time of the
+ * change, and checks the gestures that come out, their hold times and the
+ * wakeups each timeline took. Besides the changes themselves, only the
+ * long-press and repeat timers may wake the core. The wakeups polling every
+ * 10 ms would have taken are reported alongside.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "gest.h"
+#include "vtmr.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "prof.h"
+#include "adc.h"
+#include "em_device.h"
+#include "em_rtcc.h"
+
+/* Steps in a timeline and gestures recorded from one */
+#define TEST_STEPS 8
+#define TEST_GESTS 64
+
+/* Hold times may be off by a tick */
+#define TEST_SLACK_MS 2
+
+/* Poll interval the wakeups are compared against */
+#define TEST_POLL_MS 10
+
+/*
+ * @brief A position change, reported late_ms after it happened
+ */
+typedef struct test_step_s {
+	uint32_t at_ms;
+	joy_t joy;
+	uint32_t late_ms;
+} test_step_t;
+
+/*
+ * @brief A gesture, with the hold time it reports
+ */
+typedef struct test_gest_s {
+	gest_t gest;
+	joy_t joy;
+	uint32_t ms;
+} test_gest_t;
+
+/*
+ * @brief A timeline and what it should produce. A timeline with repeat set
+ * holds that position from the first step to the second and expects the
+ * repeats to be checked separately.
+ */
+typedef struct test_line_s {
+	const char *name;
+	uint32_t len_ms;
+	test_step_t steps[TEST_STEPS];
+	uint32_t num_steps;
+	test_gest_t want[TEST_GESTS];
+	uint32_t num_want;
+	bool repeat;
+} test_line_t;
+
+static const test_line_t test_lines[] = {
+	{ "tap", 1000,
+		{ { 100, JOY_PRESS, 0 }, { 400, JOY_NONE, 0 } }, 2,
+		{ { GEST_PRESS, JOY_PRESS, 0 }, { GEST_RELEASE, JOY_PRESS, 300 } }, 2 },
+	{ "long", 2000,
+		{ { 100, JOY_UP, 0 }, { 1100, JOY_NONE, 0 } }, 2,
+		{ { GEST_PRESS, JOY_UP, 0 }, { GEST_LONG, JOY_UP, GEST_LONG_MS },
+		  { GEST_RELEASE, JOY_UP, 1000 } }, 3 },
+	{ "late", 2000,
+		{ { 100, JOY_DOWN, 50 }, { 1100, JOY_NONE, 0 } }, 2,
+		{ { GEST_PRESS, JOY_DOWN, 0 }, { GEST_LONG, JOY_DOWN, GEST_LONG_MS },
+		  { GEST_RELEASE, JOY_DOWN, 1050 } }, 3 },
+	{ "short", 1000,
+		{ { 100, JOY_LEFT, 0 }, { 500, JOY_NONE, 0 } }, 2,
+		{ { GEST_PRESS, JOY_LEFT, 0 }, { GEST_RELEASE, JOY_LEFT, 400 } }, 2 },
+	{ "slide", 2000,
+		{ { 100, JOY_UP, 0 }, { 300, JOY_RIGHT, 0 }, { 600, JOY_NONE, 0 } }, 3,
+		{ { GEST_PRESS, JOY_UP, 0 }, { GEST_RELEASE, JOY_UP, 200 },
+		  { GEST_PRESS, JOY_RIGHT, 0 }, { GEST_RELEASE, JOY_RIGHT, 300 } }, 4 },
+	{ "repeat", 4000,
+		{ { 100, JOY_RIGHT, 0 }, { 3100, JOY_NONE, 0 } }, 2,
+		{ { 0 } }, 0, true },
+};
+
+#define TEST_NUM_LINES (sizeof(test_lines) / sizeof(test_lines[0]))
+
+static const char *test_names[] = {
+	[GEST_PRESS] = "press",
+	[GEST_RELEASE] = "release",
+	[GEST_LONG] = "long",
+	[GEST_REPEAT] = "repeat",
+};
+
+/* Gestures seen in the current timeline */
+static test_gest_t test_seen[TEST_GESTS];
+static uint32_t test_num_seen = 0;
+
+/* Change the script made and how late it is reported */
+static joy_t test_joy = JOY_NONE;
+static uint32_t test_late = 0;
+
+static void _test_handler(gest_t gest, joy_t joy, uint32_t ms) {
+	if (test_num_seen < TEST_GESTS) {
+		test_seen[test_num_seen++] = (test_gest_t) { gest, joy, ms };
+	}
+}
+
+/* Stands in for the LDMA interrupt that ends a scan */
+void SIM_TEST_IRQHandler(void) {
+	evt_post(EVT_JOY);
+}
+
+/* Script event, the position changed */
+static void _test_step(void *arg) {
+	const test_step_t *step = arg;
+
+	test_joy = step->joy;
+	test_late = VTMR_MS(step->late_ms);
+	NVIC_SetPendingIRQ(SIM_TEST_IRQn);
+}
+
+/* What adc.c does for a change */
+static void _test_task(void) {
+	gest_update(test_joy, RTCC_CounterGet() - test_late);
+}
+
+static bool _test_near(uint32_t ms, uint32_t want) {
+	return ms + TEST_SLACK_MS >= want && ms <= want + TEST_SLACK_MS;
+}
+
+/* Repeats of a hold, the interval shrinks from the start value to the
+ * minimum in timer ticks. Returns the number of repeats, each woke the
+ * core. */
+static uint32_t _test_check_repeat(const test_line_t *line) {
+	uint32_t hold = line->steps[1].at_ms - line->steps[0].at_ms;
+	uint32_t next = VTMR_MS(GEST_REPEAT_DELAY_MS);
+	uint32_t period = VTMR_MS(GEST_REPEAT_START_MS);
+	uint32_t n = 1;
+	uint32_t bad = 0;
+
+	CHECK(test_seen[0].gest == GEST_PRESS && test_seen[0].joy == JOY_RIGHT);
+
+	while (next * 1000 / VTMR_FREQ < hold) {
+		if (n >= test_num_seen || test_seen[n].gest != GEST_REPEAT ||
+			!_test_near(test_seen[n].ms, next * 1000 / VTMR_FREQ)) {
+			bad++;
+		}
+		n++;
+
+		next += period;
+		period = period * GEST_REPEAT_ACCEL_NUM / GEST_REPEAT_ACCEL_DEN;
+		if (period < VTMR_MS(GEST_REPEAT_MIN_MS)) {
+			period = VTMR_MS(GEST_REPEAT_MIN_MS);
+		}
+	}
+
+	CHECK(bad == 0);
+	CHECK(n + 1 == test_num_seen);
+	CHECK(test_seen[n].gest == GEST_RELEASE && _test_near(test_seen[n].ms, hold));
+
+	return n - 1;
+}
+
+static void _test_line(const test_line_t *line) {
+	uint64_t start = sim_now();
+	uint32_t wakes = test_wakes();
+	uint32_t timers = 0;
+	bool ok = true;
+
+	test_num_seen = 0;
+	for (uint32_t i = 0; i < line->num_steps; i++) {
+		sim_at(start + SIM_MS(line->steps[i].at_ms), _test_step,
+				(void *) &line->steps[i]);
+	}
+	test_run(SIM_MS(line->len_ms));
+	wakes = test_wakes() - wakes;
+
+	if (line->repeat) {
+		timers = _test_check_repeat(line);
+	} else {
+		ok = test_num_seen == line->num_want;
+		for (uint32_t i = 0; ok && i < test_num_seen; i++) {
+			ok = test_seen[i].gest == line->want[i].gest &&
+					test_seen[i].joy == line->want[i].joy &&
+					_test_near(test_seen[i].ms, line->want[i].ms);
+			if (test_seen[i].gest == GEST_LONG) {
+				timers++;
+			}
+		}
+		CHECK(ok);
+	}
+
+	printf("  %-6s %2u gestures, %2u wakeups (%3u polling):", line->name,
+			test_num_seen, wakes, line->len_ms / TEST_POLL_MS);
+	for (uint32_t i = 0; i < test_num_seen && i < 6; i++) {
+		printf(" %s@%u", test_names[test_seen[i].gest], test_seen[i].ms);
+	}
+	printf("%s\n", test_num_seen > 6 ? " ..." : "");
+
+	/* The changes and the gesture timers, and the end of the run */
+	CHECK(wakes == line->num_steps + timers + 1);
+}
+
+int main(void) {
+	cmu_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	evt_register(EVT_JOY, _test_task);
+	evt_register(EVT_GEST, gest_task);
+	gest_init(_test_handler);
+	NVIC_EnableIRQ(SIM_TEST_IRQn);
+
+	/* The ADC holds EM2 through a burst, which covers every change the
+	 * gestures see, so the RTCC keeps counting */
+	slp_blockSleepMode(ADC_EM);
+
+	printf("gest_test:\n");
+
+	test_run(SIM_MS(100));
+	for (uint32_t i = 0; i < TEST_NUM_LINES; i++) {
+		_test_line(&test_lines[i]);
+	}
+
+	return test_result("gest_test");
+}
@@ -0,0 +1,281 @@
+/**
+ * @file joy_test.c
+ * @brief Host test and benchmark for the joystick classifier
+ *
+ * This test checks the lookup table against the if/else chain it replaced
+ * for every raw value, then the median filter and the hysteresis on short
+ * sample sequences. It then replays joystick traces through the classifier
+ * and through the old chain and reports how often each got the position
+ * wrong, how many times each changed position and the host time per sample.
+ * The traces are generated from a script of positions with white noise,
+ * spikes and positions held close to a band edge, standing in for recorded
+ * ones.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "test.h"
+#include "joy.h"
+
+/* Positions in each trace and samples each is held for */
+#define TEST_SEGS 400
+#define TEST_HOLD_MIN 40
+#define TEST_HOLD_MAX 400
+
+/* Samples after a change not counted against either classifier, the median
+ * filter takes two */
+#define TEST_SETTLE 8
+
+/* Times each trace is classified for the timing */
+#define TEST_RUNS 20
+
+/*
+ * @brief How a trace is made
+ */
+typedef struct test_trace_s {
+	const char *name;
+	float sigma;
+	uint32_t spike_ppm;
+	uint16_t inset;
+} test_trace_t;
+
+/* Inset is how far inside its band edge a position is held, zero for the
+ * middle of the band */
+static const test_trace_t test_traces[] = {
+	{ "clean", 5, 0, 0 },
+	{ "noisy", 30, 10000, 0 },
+	{ "edge", 20, 0, 35 },
+};
+
+#define TEST_NUM_TRACES (sizeof(test_traces) / sizeof(test_traces[0]))
+
+/* Band of each position */
+static const uint16_t test_band[JOY_NUM][2] = {
+	[JOY_NONE]  = { JOY_NONE_GT, JOY_NONE_LT },
+	[JOY_UP]    = { JOY_UP_GT, JOY_UP_LT },
+	[JOY_DOWN]  = { JOY_DOWN_GT, JOY_DOWN_LT },
+	[JOY_LEFT]  = { JOY_LEFT_GT, JOY_LEFT_LT },
+	[JOY_RIGHT] = { JOY_RIGHT_GT, JOY_RIGHT_LT },
+	[JOY_PRESS] = { JOY_PRESS_GT, JOY_PRESS_LT },
+};
+
+/* Trace being replayed and the position it was made from */
+static uint16_t test_raw[TEST_SEGS * TEST_HOLD_MAX];
+static uint8_t test_truth[TEST_SEGS * TEST_HOLD_MAX];
+static uint8_t test_out[TEST_SEGS * TEST_HOLD_MAX];
+static uint32_t test_len;
+
+/* The decode of the old ADC0_IRQHandler, values outside every command band
+ * counted as released */
+static joy_t _test_chain(uint16_t v) {
+	if (v > JOY_UP_GT && v < JOY_UP_LT) {
+		return JOY_UP;
+	} else if (v > JOY_RIGHT_GT && v < JOY_RIGHT_LT) {
+		return JOY_RIGHT;
+	} else if (v > JOY_LEFT_GT && v < JOY_LEFT_LT) {
+		return JOY_LEFT;
+	} else if (v > JOY_DOWN_GT && v < JOY_DOWN_LT) {
+		return JOY_DOWN;
+	} else if (v > JOY_PRESS_GT && v < JOY_PRESS_LT) {
+		return JOY_PRESS;
+	}
+
+	return JOY_NONE;
+}
+
+/* Feed a sample a number of times and return the last position */
+static joy_t _test_feed(joy_filter_t *f, uint16_t v, uint32_t n) {
+	joy_t joy = JOY_INVALID;
+
+	while (n--) {
+		joy = joy_classify(f, v);
+	}
+
+	return joy;
+}
+
+/* The table against the chain for every raw value */
+static void _test_lookup(void) {
+	uint32_t bad = 0;
+	joy_t want;
+
+	for (uint32_t v = 0; v < 4096; v++) {
+		want = _test_chain(v);
+		if (want == JOY_NONE && !(v > JOY_NONE_GT && v < JOY_NONE_LT)) {
+			want = JOY_INVALID;
+		}
+		if (joy_lookup(v) != want) {
+			bad++;
+		}
+	}
+
+	CHECK(bad == 0);
+	CHECK(joy_lookup(JOY_UP_GT) == JOY_INVALID);
+	CHECK(joy_lookup(JOY_PRESS_GT) == JOY_INVALID);
+	CHECK(joy_lookup(4095) == JOY_NONE);
+
+	/* Only the low 12 bits count */
+	CHECK(joy_lookup(0xf000 | 100) == JOY_PRESS);
+}
+
+/* Median filter and hysteresis on short sequences */
+static void _test_filter(void) {
+	joy_filter_t f;
+	joy_filter_t g;
+
+	/* Released until the filter has three samples */
+	joy_filter_init(&f);
+	CHECK(_test_feed(&f, 100, 3) == JOY_NONE);
+	CHECK(joy_classify(&f, 100) == JOY_PRESS);
+
+	/* A single spike is filtered, two in a row are not */
+	joy_filter_init(&f);
+	CHECK(_test_feed(&f, 4095, 5) == JOY_NONE);
+	CHECK(joy_classify(&f, 100) == JOY_NONE);
+	CHECK(_test_feed(&f, 4095, 2) == JOY_NONE);
+	CHECK(joy_classify(&f, 2500) == JOY_NONE);
+	CHECK(joy_classify(&f, 2500) == JOY_LEFT);
+
+	/* Up holds until JOY_HYST past its band, released holds the same way */
+	joy_filter_init(&f);
+	CHECK(_test_feed(&f, 3500, 5) == JOY_UP);
+	CHECK(_test_feed(&f, JOY_UP_LT + JOY_HYST - 10, 3) == JOY_UP);
+	CHECK(_test_feed(&f, JOY_UP_LT + JOY_HYST + 10, 3) == JOY_NONE);
+	CHECK(_test_feed(&f, JOY_NONE_GT - JOY_HYST + 10, 3) == JOY_NONE);
+	CHECK(_test_feed(&f, JOY_NONE_GT - JOY_HYST - 10, 3) == JOY_UP);
+
+	/* A value on a threshold belongs to no band and keeps the position */
+	joy_filter_init(&f);
+	CHECK(_test_feed(&f, 4095, 5) == JOY_NONE);
+	CHECK(_test_feed(&f, JOY_RIGHT_LT, 5) == JOY_NONE);
+
+	/* Each caller has its own state */
+	joy_filter_init(&f);
+	joy_filter_init(&g);
+	for (int i = 0; i < 5; i++) {
+		joy_classify(&f, 100);
+		joy_classify(&g, 1900);
+	}
+	CHECK(joy_classify(&f, 100) == JOY_PRESS);
+	CHECK(joy_classify(&g, 1900) == JOY_DOWN);
+}
+
+/* Standard normal sample */
+static float _test_gauss(void) {
+	float u = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+	float v = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+
+	return sqrtf(-2 * logf(u)) * cosf(2 * (float) M_PI * v);
+}
+
+/* Make a trace, released between positions like a thumb would */
+static void _test_make(const test_trace_t *t) {
+	joy_t joy = JOY_NONE;
+	uint32_t hold;
+	float level;
+	int32_t v;
+
+	test_len = 0;
+	for (uint32_t s = 0; s < TEST_SEGS; s++) {
+		joy = (s & 1) ? JOY_UP + rand() % (JOY_PRESS - JOY_UP + 1) : JOY_NONE;
+		hold = TEST_HOLD_MIN + rand() % (TEST_HOLD_MAX - TEST_HOLD_MIN);
+
+		/* Middle of the band, or near an edge of it */
+		level = (test_band[joy][0] + test_band[joy][1]) / 2.0f;
+		if (t->inset && joy != JOY_NONE) {
+			level = (rand() & 1) ? test_band[joy][0] + t->inset :
+					test_band[joy][1] - t->inset;
+		}
+
+		for (uint32_t i = 0; i < hold; i++) {
+			v = (int32_t) lrintf(level + t->sigma * _test_gauss());
+			if (t->spike_ppm && (uint32_t) (rand() % 1000000) < t->spike_ppm) {
+				v = rand() % 4096;
+			}
+			test_raw[test_len] = v < 0 ? 0 : v > 4095 ? 4095 : v;
+			test_truth[test_len] = joy;
+			test_len++;
+		}
+	}
+}
+
+/* Wrong positions outside the settling time and position changes */
+static void _test_score(uint32_t *wrong, uint32_t *changes) {
+	uint32_t since = TEST_SETTLE;
+
+	*wrong = 0;
+	*changes = 0;
+	for (uint32_t i = 1; i < test_len; i++) {
+		since = test_truth[i] != test_truth[i - 1] ? 0 : since + 1;
+		if (since >= TEST_SETTLE && test_out[i] != test_truth[i]) {
+			(*wrong)++;
+		}
+		if (test_out[i] != test_out[i - 1]) {
+			(*changes)++;
+		}
+	}
+}
+
+/* Replay a trace through both and report */
+static void _test_replay(const test_trace_t *t) {
+	joy_filter_t f;
+	uint32_t wrong[2];
+	uint32_t changes[2];
+	uint64_t ns[2];
+	uint64_t t0;
+
+	_test_make(t);
+
+	t0 = test_ns();
+	for (uint32_t r = 0; r < TEST_RUNS; r++) {
+		for (uint32_t i = 0; i < test_len; i++) {
+			test_out[i] = _test_chain(test_raw[i]);
+		}
+		__asm__ volatile("" ::: "memory");
+	}
+	ns[0] = test_ns() - t0;
+	_test_score(&wrong[0], &changes[0]);
+
+	t0 = test_ns();
+	for (uint32_t r = 0; r < TEST_RUNS; r++) {
+		joy_filter_init(&f);
+		for (uint32_t i = 0; i < test_len; i++) {
+			test_out[i] = joy_classify(&f, test_raw[i]);
+		}
+		__asm__ volatile("" ::: "memory");
+	}
+	ns[1] = test_ns() - t0;
+	_test_score(&wrong[1], &changes[1]);
+
+	printf("  %-5s %6u samples, %4d changes: chain %6.3f %% wrong %5u changes "
+			"%5.1f ns/sample, table %6.3f %% wrong %5u changes %5.1f "
+			"ns/sample\n", t->name, test_len, TEST_SEGS - 1,
+			100.0 * wrong[0] / test_len, changes[0],
+			(double) ns[0] / TEST_RUNS / test_len,
+			100.0 * wrong[1] / test_len, changes[1],
+			(double) ns[1] / TEST_RUNS / test_len);
+
+	/* Never worse than the chain, and a small part of its false changes */
+	CHECK(wrong[1] <= wrong[0]);
+	CHECK(changes[1] >= TEST_SEGS - 1);
+	CHECK((changes[1] - (TEST_SEGS - 1)) * 20 <= changes[0] - (TEST_SEGS - 1));
+	CHECK(wrong[1] * 1000 < test_len);
+}
+
+int main(void) {
+	srand(19);
+
+	_test_lookup();
+	_test_filter();
+
+	printf("joy_test:\n");
+	for (uint32_t i = 0; i < TEST_NUM_TRACES; i++) {
+		_test_replay(&test_traces[i]);
+	}
+
+	return test_result("joy_test");
+}
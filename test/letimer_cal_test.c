@@ -0,0 +1,134 @@
+/**
+ * @file letimer_cal_test.c
+ * @brief Host test for the ULFRCO calibration
+ *
+ * This test starts LETIMER0 with the ULFRCO model 30 % slow and then moves
+ * the oscillator to other frequencies while LED0 blinks, the way it drifts
+ * with temperature. After each change it waits out LETIMER_CAL_INTERVAL_MS,
+ * sends a command that leaves the on time as it is to start the next
+ * calibration and checks the measured frequency and the LED0 period and on
+ * time in real time, and reports the period the uncorrected timing would have
+ * given.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "letimer.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+
+/* Time for a calibration to be due after a change, at the slowest
+ * oscillator */
+#define TEST_SETTLE SIM_S(120)
+
+/* Time for it to settle, count its periods and load the result */
+#define TEST_CAL SIM_S(15)
+
+/* Periods measured after it */
+#define TEST_PERIODS 5
+
+/* ULFRCO frequencies to go through */
+static const uint32_t test_hz[] = { 700, 1300, 1000, 853, 1187, 1000 };
+
+/* Last LED0 edges */
+static uint64_t test_rise = 0;
+static uint64_t test_fall = 0;
+static uint64_t test_period = 0;
+static uint64_t test_width = 0;
+
+static void _test_led0(bool level) {
+	if (level) {
+		test_rise = sim_now();
+		return;
+	}
+
+	if (test_fall && test_rise > test_fall) {
+		test_period = sim_now() - test_fall;
+		test_width = sim_now() - test_rise;
+	}
+	test_fall = sim_now();
+}
+
+static uint64_t _test_abs(uint64_t a, uint64_t b) {
+	return a > b ? a - b : b - a;
+}
+
+/* Check the timing after the oscillator moved to a frequency */
+static void _test_step(uint32_t hz) {
+	uint64_t period = SIM_MS(LETIMER_PERIOD_MS);
+	uint64_t width = SIM_MS(LETIMER_ONTIME_MS);
+	uint64_t tick = SIM_S(1) / hz;
+	uint64_t worst_period = 0;
+	uint64_t worst_width = 0;
+	uint64_t plain;
+	uint32_t freq;
+
+	test_run(TEST_SETTLE);
+	CHECK(letimer_cmd_post(LETIMER_CMD_INC));
+	CHECK(letimer_cmd_post(LETIMER_CMD_DEC));
+	test_run(TEST_CAL);
+	freq = letimer_getFreq();
+
+	for (uint32_t i = 0; i < TEST_PERIODS; i++) {
+		test_run(SIM_MS(LETIMER_PERIOD_MS));
+		if (_test_abs(test_period, period) > worst_period) {
+			worst_period = _test_abs(test_period, period);
+		}
+		if (_test_abs(test_width, width) > worst_width) {
+			worst_width = _test_abs(test_width, width);
+		}
+	}
+
+	/* What COMP0 + 1 nominal ticks would have taken */
+	plain = (uint64_t) (LETIMER_TICKS(LETIMER_ULFRCO_FREQ,
+			LETIMER_PERIOD_MS) + 1) * SIM_S(1) / hz;
+
+	printf("  ULFRCO %4u Hz: measured %4u Hz, period off by %5.2f ms, on "
+			"time off by %4.2f ms (uncorrected %4llu ms)\n", hz, freq,
+			(double) worst_period / SIM_MS(1), (double) worst_width / SIM_MS(1),
+			(unsigned long long) (plain / SIM_MS(1)));
+
+	/* The RTCC resolves the window to a part in a few thousand */
+	CHECK(_test_abs(freq, hz) <= hz / 1000 + 1);
+
+	/* COMP0 + 1 and COMP1 + 1 ticks, off by up to a tick each plus the
+	 * frequency error */
+	CHECK(worst_period <= 2 * tick + period / 500);
+	CHECK(worst_width <= 2 * tick + width / 500);
+}
+
+int main(void) {
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	evt_register(EVT_LETIMER, letimer_task);
+	sim_gpio_watch(GPIO_LED0_PORT, GPIO_LED0_PIN, _test_led0);
+
+	printf("letimer_cal_test:\n");
+
+	sim_set_ulfrco(test_hz[0]);
+	letimer_init();
+	_test_step(test_hz[0]);
+
+	for (uint32_t i = 1; i < sizeof(test_hz) / sizeof(test_hz[0]); i++) {
+		sim_set_ulfrco(test_hz[i]);
+		_test_step(test_hz[i]);
+	}
+
+	/* Calibration only ever blocked EM2 for a while */
+	CHECK(sim_stats.ns[3] > sim_now() * 9 / 10);
+
+	return test_result("letimer_cal_test");
+}
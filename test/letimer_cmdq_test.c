@@ -0,0 +1,138 @@
+/**
+ * @file letimer_cmdq_test.c
+ * @brief Multi-threaded test and benchmark for the LETIMER0 command ring
+ *
+ * This test posts commands from a producer thread with letimer_cmd_post()
+ * while the main thread takes them off the ring, and checks every command
+ * comes out once and in order. The producer posts again when the ring is
+ * full, so the drop count must match the refused posts. It reports the
+ * host time per command through the ring. It then fills the ring from one
+ * thread, checks the post past the end is refused and counted, and that
+ * letimer_task() applies runs of INC and DEC as a net change and discards
+ * what came before a reset.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include "test.h"
+#include "vtmr.h"
+#include "../letimer.c"
+
+/* Commands through the ring */
+#define TEST_CMDS 1000000
+
+/* Posts refused because the ring was full */
+static volatile uint32_t test_full = 0;
+
+/* Same sequence on both sides */
+static letimer_cmd_t _test_cmd(unsigned int *seed) {
+	return (letimer_cmd_t) (LETIMER_CMD_INC + rand_r(seed) % 3);
+}
+
+static void *_test_producer(void *arg) {
+	unsigned int seed = 1;
+	letimer_cmd_t cmd;
+
+	for (uint32_t i = 0; i < TEST_CMDS; i++) {
+		cmd = _test_cmd(&seed);
+		while (!letimer_cmd_post(cmd)) {
+			test_full++;
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+/* Take everything the producer sends off the ring, in order */
+static void _test_threads(void) {
+	pthread_t producer;
+	letimer_cmd_rec_t rec;
+	unsigned int seed = 1;
+	uint32_t dropped = letimer_cmd_dropped();
+	uint32_t bad = 0;
+	uint64_t t0;
+	uint64_t ns;
+
+	t0 = test_ns();
+	pthread_create(&producer, NULL, _test_producer, NULL);
+
+	for (uint32_t i = 0; i < TEST_CMDS; i++) {
+		while (!_letimer_cmd_pop(&rec)) {
+			sched_yield();
+		}
+		if (rec.cmd != _test_cmd(&seed)) {
+			bad++;
+		}
+	}
+
+	pthread_join(producer, NULL);
+	ns = test_ns() - t0;
+
+	printf("letimer_cmdq_test: %u commands, %.1f host ns each, %u posts "
+			"refused, %u out of order\n", TEST_CMDS, (double) ns / TEST_CMDS,
+			test_full, bad);
+
+	CHECK(bad == 0);
+	CHECK(!_letimer_cmd_pop(&rec));
+	CHECK(letimer_cmd_dropped() - dropped == test_full);
+}
+
+/* Post some commands and let the main loop apply them */
+static void _test_apply(const letimer_cmd_t *cmds, uint32_t n) {
+	for (uint32_t i = 0; i < n; i++) {
+		CHECK(letimer_cmd_post(cmds[i]));
+	}
+	test_run(SIM_MS(1));
+}
+
+static void _test_coalesce(void) {
+	static const letimer_cmd_t down_up[] = {
+		LETIMER_CMD_DEC, LETIMER_CMD_DEC, LETIMER_CMD_INC, LETIMER_CMD_INC,
+	};
+	static const letimer_cmd_t reset[] = {
+		LETIMER_CMD_INC, LETIMER_CMD_INC, LETIMER_CMD_RST,
+	};
+	uint32_t dropped = letimer_cmd_dropped();
+
+	/* A full ring refuses the next post and counts it, a reset first and
+	 * then alternating steps ending on INC */
+	CHECK(letimer_cmd_post(LETIMER_CMD_RST));
+	for (uint32_t i = 1; i < LETIMER_CMDQ_SIZE; i++) {
+		CHECK(letimer_cmd_post((i & 1) ? LETIMER_CMD_INC : LETIMER_CMD_DEC));
+	}
+	CHECK(!letimer_cmd_post(LETIMER_CMD_INC));
+	CHECK(letimer_cmd_dropped() - dropped == 1);
+	test_run(SIM_MS(1));
+	CHECK(letimer_getOntime() == LETIMER_ONTIME_MS + LETIMER_STEP);
+
+	/* One at a time this would clamp at zero on the way down */
+	_test_apply(down_up, sizeof(down_up) / sizeof(down_up[0]));
+	CHECK(letimer_getOntime() == LETIMER_ONTIME_MS + LETIMER_STEP);
+
+	/* The steps before the reset are dropped */
+	_test_apply(reset, sizeof(reset) / sizeof(reset[0]));
+	CHECK(letimer_getOntime() == LETIMER_ONTIME_MS);
+}
+
+int main(void) {
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	evt_register(EVT_LETIMER, letimer_task);
+	letimer_init();
+
+	_test_threads();
+	_test_coalesce();
+
+	return test_result("letimer_cmdq_test");
+}
@@ -0,0 +1,131 @@
+/**
+ * @file letimer_em4_test.c
+ * @brief Host test for stopping LETIMER0 when LED0 is dimmed to zero
+ *
+ * This test runs LETIMER0 and the joystick watch as main() does, with an
+ * EM4 handler registered, and checks the system stays out of EM4 while LED0
+ * blinks. It then dims LED0 to zero and checks that LETIMER0 stops at the
+ * next underflow with LED0 off and its clock released, and that once the
+ * joystick has been at rest for ACMP_EM4_IDLE_MS the system goes down to
+ * EM4H with the zero on time in the snapshot. Finally a command brings LED0
+ * back with its period and EM3 blocked again.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include <setjmp.h>
+#include "test.h"
+#include "letimer.h"
+#include "adc.h"
+#include "acmp.h"
+#include "gest.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+
+/* Nominal period, COMP0 + 1 ticks */
+#define TEST_PERIOD SIM_MS(LETIMER_PERIOD_MS + 1000 / LETIMER_FREQ)
+
+/* LED0 pulses and its last edge */
+static uint32_t test_pulses = 0;
+static bool test_led0 = false;
+static uint64_t test_edge = 0;
+
+/* On time in the EM4 snapshot */
+static int32_t test_saved = -1;
+
+static void _test_led0(bool level) {
+	if (level) {
+		test_pulses++;
+	}
+	test_led0 = level;
+	test_edge = sim_now();
+}
+
+static void _test_save(slp_retain_t *state) {
+	state->letimer_ontime = letimer_getOntime();
+	test_saved = state->letimer_ontime;
+}
+
+int main(void) {
+	jmp_buf env;
+	uint32_t pulses;
+	uint64_t armed;
+	uint64_t posted;
+	uint64_t stopped;
+	uint64_t em4_at;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	slp_em4_setHandler(_test_save);
+	vtmr_init();
+
+	evt_register(EVT_LETIMER, letimer_task);
+	evt_register(EVT_GEST, gest_task);
+	evt_register(EVT_JOY, adc_task);
+	sim_gpio_watch(GPIO_LED0_PORT, GPIO_LED0_PIN, _test_led0);
+
+	letimer_init();
+	adc_init();
+	armed = sim_now();
+
+	/* Blinking, EM4 would abort the test */
+	test_run(SIM_S(20));
+	CHECK(test_pulses >= SIM_S(20) / TEST_PERIOD - 1);
+	CHECK(sim_stats.sleeps[4] == 0);
+	CHECK(sim_cmu_clock_on[cmuClock_LETIMER0]);
+
+	/* Dimmed to zero, stops at the next underflow */
+	posted = sim_now();
+	pulses = test_pulses;
+	CHECK(letimer_cmd_post(LETIMER_CMD_DEC));
+	test_run(TEST_PERIOD + SIM_MS(1));
+	stopped = test_edge;
+	CHECK(!test_led0);
+	CHECK(test_pulses - pulses <= 1);
+	CHECK(!sim_cmu_clock_on[cmuClock_LETIMER0]);
+	CHECK(letimer_nextWake() == SLP_WAKE_NONE);
+
+	/* Then down to EM4 once the joystick watch lets go */
+	sim_em4_env = &env;
+	if (setjmp(env) == 0) {
+		test_run(SIM_MS(ACMP_EM4_IDLE_MS));
+		CHECK(false);
+	}
+	sim_em4_env = NULL;
+	sim_primask = 0;
+	em4_at = sim_now();
+
+	printf("letimer_em4_test: LETIMER0 stopped %.1f ms after the command, "
+			"EM4 %.1f s after the joystick watch started\n",
+			(double) (stopped - posted) / SIM_MS(1),
+			(double) (em4_at - armed) / SIM_S(1));
+
+	CHECK(stopped - posted <= TEST_PERIOD);
+	CHECK(test_pulses - pulses <= 1);
+	CHECK(letimer_getOntime() == 0);
+	CHECK(test_saved == 0);
+	CHECK(sim_stats.sleeps[4] == 1);
+	CHECK(em4_at >= armed + SIM_MS(ACMP_EM4_IDLE_MS));
+	CHECK(em4_at <= armed + SIM_MS(ACMP_EM4_IDLE_MS) + SIM_MS(10));
+
+	/* Brought back, blinks with its period and keeps out of EM4 */
+	pulses = test_pulses;
+	CHECK(letimer_cmd_post(LETIMER_CMD_INC));
+	test_run(SIM_S(20));
+	CHECK(letimer_getOntime() == LETIMER_STEP);
+	CHECK(test_pulses - pulses >= SIM_S(20) / TEST_PERIOD - 1);
+	CHECK(sim_stats.sleeps[4] == 1);
+	CHECK(sim_cmu_clock_on[cmuClock_LETIMER0]);
+
+	return test_result("letimer_em4_test");
+}
@@ -0,0 +1,196 @@
+/**
+ * @file letimer_glitch_test.c
+ * @brief Host test for glitch-free LETIMER0 duty cycle updates
+ *
+ * This test runs LETIMER0 on the model and posts INC and DEC commands at
+ * random times, some just before and just after an underflow, the way
+ * adc_task() does. It records the LED0 waveform and checks that every period
+ * has the nominal length, so the timer never stopped or restarted, and that
+ * every pulse has the width of the on time in force when its period began.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include <stdlib.h>
+#include "test.h"
+#include "letimer.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+#include "em_letimer.h"
+
+/* Length of the run and number of random commands */
+#define TEST_RUN SIM_S(600)
+#define TEST_CMDS 200
+
+/* Nominal period, COMP0 + 1 ticks */
+#define TEST_PERIOD SIM_MS(LETIMER_PERIOD_MS + 1000 / LETIMER_FREQ)
+
+#define TEST_MAX_EDGES 4096
+
+/*
+ * @brief A command, when the main loop posted it and the on time it asks for
+ */
+typedef struct test_cmd_s {
+	letimer_cmd_t cmd;
+	uint64_t posted;
+	int32_t ontime;
+} test_cmd_t;
+
+static test_cmd_t test_cmds[TEST_CMDS + 8];
+static uint32_t test_num_cmds = 0;
+
+/* Command source interrupts raised and not yet handled */
+static uint32_t test_raised = 0;
+
+/* LED0 edges, time and level */
+static uint64_t test_edge_t[TEST_MAX_EDGES];
+static bool test_edge_lvl[TEST_MAX_EDGES];
+static uint32_t test_edges = 0;
+
+static void _test_led0(bool level) {
+	if (test_edges < TEST_MAX_EDGES) {
+		test_edge_t[test_edges] = sim_now();
+		test_edge_lvl[test_edges] = level;
+		test_edges++;
+	}
+}
+
+/* The command source interrupt, handled in the main loop like a joystick
+ * sample */
+void SIM_TEST_IRQHandler(void) {
+	evt_post(EVT_JOY);
+}
+
+/* Post one command for each interrupt, keeping the on time within the
+ * period */
+static void _test_joy(void) {
+	int32_t ontime = test_num_cmds ? test_cmds[test_num_cmds - 1].ontime :
+			LETIMER_ONTIME_MS;
+	letimer_cmd_t cmd;
+
+	for (; test_raised > 0; test_raised--) {
+		if (ontime + LETIMER_STEP >= LETIMER_PERIOD_MS) {
+			cmd = LETIMER_CMD_DEC;
+		} else if (ontime - LETIMER_STEP < 0) {
+			cmd = LETIMER_CMD_INC;
+		} else {
+			cmd = (rand() & 1) ? LETIMER_CMD_INC : LETIMER_CMD_DEC;
+		}
+
+		ontime += (cmd == LETIMER_CMD_INC) ? LETIMER_STEP : -LETIMER_STEP;
+		test_cmds[test_num_cmds++] = (test_cmd_t) { cmd, sim_now(), ontime };
+		CHECK(letimer_cmd_post(cmd));
+	}
+}
+
+static void _test_raise(void *arg) {
+	test_raised++;
+	NVIC_SetPendingIRQ(SIM_TEST_IRQn);
+}
+
+/* On time in force for a period starting at a time */
+static int32_t _test_ontime_at(uint64_t t) {
+	int32_t ontime = LETIMER_ONTIME_MS;
+
+	for (uint32_t i = 0; i < test_num_cmds; i++) {
+		if (test_cmds[i].posted < t) {
+			ontime = test_cmds[i].ontime;
+		}
+	}
+
+	return ontime;
+}
+
+static void _test_check(void) {
+	uint32_t periods = 0;
+	uint32_t widths = 0;
+	uint32_t changes = 0;
+	uint64_t fall = 0;
+	uint64_t rise = 0;
+	int32_t last = -1;
+	int32_t ontime;
+
+	for (uint32_t i = 0; i < test_edges; i++) {
+		if (test_edge_lvl[i]) {
+			rise = test_edge_t[i];
+			continue;
+		}
+
+		if (fall && rise > fall) {
+			/* The timer never stopped, every period is the same */
+			CHECK(test_edge_t[i] - fall == TEST_PERIOD);
+			periods++;
+
+			/* The pulse ends the period and has the on time that was
+			 * staged when it began, COMP1 + 1 ticks */
+			ontime = _test_ontime_at(fall);
+			CHECK(test_edge_t[i] - rise ==
+					SIM_MS(ontime + 1000 / LETIMER_FREQ));
+			widths++;
+				if (ontime != last) {
+				changes++;
+			}
+			last = ontime;
+		}
+		fall = test_edge_t[i];
+	}
+
+	printf("letimer_glitch_test: %u periods, %u pulses, %u commands, "
+			"%u width changes, %u LETIMER0 interrupts\n", periods, widths,
+			test_num_cmds, changes, sim_stats.irqs[LETIMER0_IRQn]);
+
+	CHECK(periods >= TEST_RUN / TEST_PERIOD - 2);
+	CHECK(test_edges < TEST_MAX_EDGES);
+	CHECK(letimer_cmd_dropped() == 0);
+	CHECK(letimer_getFreq() == LETIMER_FREQ);
+}
+
+int main(void) {
+	uint64_t uf;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	evt_register(EVT_LETIMER, letimer_task);
+	evt_register(EVT_JOY, _test_joy);
+	NVIC_EnableIRQ(SIM_TEST_IRQn);
+	sim_gpio_watch(GPIO_LED0_PORT, GPIO_LED0_PIN, _test_led0);
+
+	letimer_init();
+
+	/* Find the underflow phase, then post around underflows and at random */
+	test_run_until(SIM_S(10));
+	CHECK(test_edges > 0 && !test_edge_lvl[test_edges - 1]);
+	uf = test_edge_t[test_edges - 1];
+	while (uf < SIM_S(12)) {
+		uf += TEST_PERIOD;
+	}
+
+	srand(11);
+	sim_at(uf - SIM_US(500), _test_raise, NULL);
+	sim_at(uf + 3 * TEST_PERIOD + SIM_US(500), _test_raise, NULL);
+	sim_at(uf + 6 * TEST_PERIOD - SIM_MS(1), _test_raise, NULL);
+	sim_at(uf + 6 * TEST_PERIOD - SIM_US(300), _test_raise, NULL);
+	for (uint32_t i = 0; i < TEST_CMDS; i++) {
+		sim_at(uf + 10 * TEST_PERIOD +
+				(((uint64_t) rand() << 31) | rand()) %
+				(TEST_RUN - uf - 12 * TEST_PERIOD),
+				_test_raise, NULL);
+	}
+
+	test_run_until(TEST_RUN);
+	_test_check();
+
+	return test_result("letimer_glitch_test");
+}
@@ -0,0 +1,187 @@
+/**
+ * @file letimer_isr_test.c
+ * @brief Host test for the worst case time in the LETIMER0 handler
+ *
+ * This test sends LETIMER0 bursts of commands of growing length while LED0
+ * blinks and reads the PROF_LETIMER0 histogram, first with the handler as it
+ * is, which leaves the commands to letimer_task() in the main loop, and then
+ * with a copy of the handler from before that change, which drained the ring
+ * and wrote the new timing itself. It reports the longest run and its bucket
+ * for each and checks the handler is now shorter.
+ *
+ * The simulation only counts cycles that are charged, so the test charges
+ * each LETIMER0 access, each command taken off the ring, the timing
+ * calculation and the SYNCBUSY waits of the old handler with the costs
+ * below.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "vtmr.h"
+
+/* The handler as it is, under another name */
+#define LETIMER0_IRQHandler _test_deferred_handler
+#include "../letimer.c"
+#undef LETIMER0_IRQHandler
+
+/* Cost of an interrupt or compare register access over the LE bus */
+#define TEST_ACCESS_CYCLES 4
+
+/* Cost of taking a command off the ring and applying it */
+#define TEST_CMD_CYCLES 60
+
+/* Cost of the old floating point timing calculation */
+#define TEST_TIMING_CYCLES 400
+
+/* A SYNCBUSY wait lasts up to three LFA clock cycles */
+#define TEST_SYNC_CYCLES (3 * (SIM_HF_FREQ / LETIMER_FREQ))
+
+/* Bursts for each handler, one every TEST_GAP */
+#define TEST_BURSTS 16
+#define TEST_GAP SIM_S(5)
+
+/*
+ * @brief What the handler cost
+ */
+typedef struct test_isr_s {
+	uint32_t count;
+	uint32_t max;
+	uint32_t bucket;
+} test_isr_t;
+
+/* Run the old handler instead */
+static bool test_inline = false;
+
+/* Burst of INC and DEC pairs, the on time comes back to where it was */
+static void _test_burst(void *arg) {
+	uint32_t pairs = (uint32_t) (uintptr_t) arg;
+
+	for (uint32_t i = 0; i < pairs; i++) {
+		CHECK(letimer_cmd_post(LETIMER_CMD_INC));
+		CHECK(letimer_cmd_post(LETIMER_CMD_DEC));
+	}
+}
+
+static void _test_nothing(void) {
+}
+
+/* The handler before commands moved to the main loop. Runs of commands
+ * are taken off the ring at the underflow, and the new timing is
+ * calculated and written right away with a wait for each write to cross
+ * into the LFA clock domain. */
+static void _test_inline_handler(void) {
+	PROF_ISR_ENTER(PROF_LETIMER0);
+
+	uint32_t int_flag = 0;
+	uint32_t cmds;
+
+	if (LETIMER_IntGet(LETIMER0) & LETIMER_IF_UF) {
+		int_flag = LETIMER_IF_UF;
+	} else if (LETIMER_IntGet(LETIMER0) & LETIMER_IF_COMP1) {
+		int_flag = LETIMER_IF_COMP1;
+	}
+
+	LETIMER_IntClear(LETIMER0, LETIMER_IEN_UF | LETIMER_IEN_COMP1);
+
+	cmds = letimer_cmdq_head - letimer_cmdq_tail;
+	if (int_flag == LETIMER_IF_UF && cmds > 0) {
+		sim_cpu(cmds * TEST_CMD_CYCLES + TEST_TIMING_CYCLES);
+		_letimer_process();
+
+		LETIMER_CompareSet(LETIMER0, 0, letimer_next.comp0);
+		LETIMER_CompareSet(LETIMER0, 1, letimer_next.comp1);
+		letimer_cur = letimer_next;
+		letimer_next_pending = false;
+		sim_cpu(3 * TEST_SYNC_CYCLES);
+	}
+
+	if (int_flag == LETIMER_IF_UF) {
+		gpio_setLED0(false);
+	} else if (int_flag == LETIMER_IF_COMP1) {
+		gpio_setLED0(true);
+	}
+
+	PROF_ISR_EXIT(PROF_LETIMER0);
+}
+
+void LETIMER0_IRQHandler(void) {
+	if (test_inline) {
+		_test_inline_handler();
+	} else {
+		_test_deferred_handler();
+	}
+}
+
+/* Send the bursts and read the histogram */
+static void _test_bursts(test_isr_t *run) {
+	uint64_t start = sim_now();
+	prof_hist_t hist;
+
+	prof_clear();
+	for (uint32_t i = 0; i < TEST_BURSTS; i++) {
+		sim_at(start + TEST_GAP * i + SIM_MS(333), _test_burst,
+				(void *) (uintptr_t) (i % (LETIMER_CMDQ_SIZE / 2) + 1));
+	}
+	test_run(TEST_GAP * TEST_BURSTS);
+
+	prof_get(PROF_LETIMER0, &hist);
+	run->count = hist.count;
+	run->max = hist.dur_max;
+	run->bucket = 0;
+	for (uint32_t b = 0; b < PROF_BUCKETS; b++) {
+		if (hist.dur[b]) {
+			run->bucket = b;
+		}
+	}
+}
+
+static void _test_report(const char *name, const test_isr_t *run) {
+	printf("  %-8s %5u runs, longest %7u cycles (%8.1f us), bucket %2u\n",
+			name, run->count, run->max,
+			(double) run->max * 1000000 / SIM_HF_FREQ, run->bucket);
+}
+
+int main(void) {
+	test_isr_t deferred;
+	test_isr_t old;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	evt_register(EVT_LETIMER, letimer_task);
+	letimer_init();
+	test_run(SIM_S(10));
+
+	sim_letimer_access_cycles = TEST_ACCESS_CYCLES;
+
+	_test_bursts(&deferred);
+
+	/* Only the copy takes commands off the ring */
+	test_inline = true;
+	evt_register(EVT_LETIMER, _test_nothing);
+	_test_bursts(&old);
+
+	printf("letimer_isr_test: LETIMER0 handler, %u bursts of up to %u "
+			"commands\n", TEST_BURSTS, LETIMER_CMDQ_SIZE);
+	_test_report("deferred", &deferred);
+	_test_report("inline", &old);
+
+	/* Both ran for every underflow and match */
+	CHECK(deferred.count > 0);
+	CHECK(old.count >= deferred.count - 1 &&
+			old.count <= deferred.count + 1);
+
+	CHECK(deferred.max < old.max);
+	CHECK(deferred.bucket < old.bucket);
+	CHECK(letimer_getOntime() == LETIMER_ONTIME_MS);
+	CHECK(letimer_cmd_dropped() == 0);
+
+	return test_result("letimer_isr_test");
+}
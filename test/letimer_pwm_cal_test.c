@@ -0,0 +1,14 @@
+/**
+ * @file letimer_pwm_cal_test.c
+ * @brief Host test counting LETIMER0 wakeups in PWM mode with calibration
+ *
+ * This file builds letimer_pwm_test.c again, the Makefile sets LETIMER_CAL
+ * to 1 for it and the firmware files, so LETIMER0 also interrupts for the
+ * periods of each calibration, but still not while LED0 is left alone.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "letimer_pwm_test.c"
@@ -0,0 +1,162 @@
+/**
+ * @file letimer_pwm_test.c
+ * @brief Host test counting LETIMER0 wakeups per hour
+ *
+ * This test runs the main loop for a simulated hour with LED0 idle and then
+ * for an hour with a duty cycle command every minute. It counts core wakeups
+ * and LETIMER0 interrupts in each hour and checks LED0 still gets a pulse
+ * every period. With LETIMER_PWM the hardware drives LED0 and the core only
+ * wakes up to load a new duty cycle and, with LETIMER_CAL, for the periods
+ * of a calibration. Toggled in software (see letimer_soft_test.c) it wakes
+ * twice per period. letimer_pwm_cal_test.c builds it with calibration.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "letimer.h"
+#include "gpio.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "vtmr.h"
+#include "prof.h"
+#include "em_device.h"
+
+#if !LETIMER_PWM
+#define TEST_NAME "letimer_soft_test"
+#elif LETIMER_CAL
+#define TEST_NAME "letimer_pwm_cal_test"
+#else
+#define TEST_NAME "letimer_pwm_test"
+#endif
+
+#define TEST_HOUR SIM_S(3600)
+
+/* Nominal period, COMP0 + 1 ticks */
+#define TEST_PERIOD SIM_MS(LETIMER_PERIOD_MS + 1000 / LETIMER_FREQ)
+#define TEST_PERIODS (TEST_HOUR / TEST_PERIOD)
+
+/* Commands in the busy hour */
+#define TEST_CMDS 60
+
+/*
+ * @brief What happened in an hour
+ */
+typedef struct test_hour_s {
+	uint32_t wakes;
+	uint32_t irqs;
+	uint32_t pulses;
+} test_hour_t;
+
+static uint32_t test_pulses = 0;
+static uint32_t test_raised = 0;
+static uint32_t test_posted = 0;
+
+static void _test_led0(bool level) {
+	if (level) {
+		test_pulses++;
+	}
+}
+
+/* The command source interrupt, handled in the main loop like a joystick
+ * sample */
+void SIM_TEST_IRQHandler(void) {
+	evt_post(EVT_JOY);
+}
+
+static void _test_joy(void) {
+	for (; test_raised > 0; test_raised--) {
+		CHECK(letimer_cmd_post((test_posted++ & 1) ? LETIMER_CMD_DEC :
+				LETIMER_CMD_INC));
+	}
+}
+
+static void _test_raise(void *arg) {
+	test_raised++;
+	NVIC_SetPendingIRQ(SIM_TEST_IRQn);
+}
+
+/* Run the main loop up to a time and count what happened */
+static void _test_hour(uint64_t end, test_hour_t *hour) {
+	uint32_t wakes = test_wakes();
+	uint32_t irqs = sim_stats.irqs[LETIMER0_IRQn];
+	uint32_t pulses = test_pulses;
+
+	test_run_until(end);
+
+	if (hour) {
+		hour->wakes = test_wakes() - wakes;
+		hour->irqs = sim_stats.irqs[LETIMER0_IRQn] - irqs;
+		hour->pulses = test_pulses - pulses;
+	}
+}
+
+int main(void) {
+	test_hour_t idle;
+	test_hour_t busy;
+	uint64_t start;
+
+	cmu_init();
+	gpio_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	evt_register(EVT_LETIMER, letimer_task);
+	evt_register(EVT_JOY, _test_joy);
+	NVIC_EnableIRQ(SIM_TEST_IRQn);
+	sim_gpio_watch(GPIO_LED0_PORT, GPIO_LED0_PIN, _test_led0);
+
+	letimer_init();
+
+	/* Past the first calibration */
+	test_run_until(SIM_S(10));
+	start = sim_now();
+	_test_hour(start + TEST_HOUR, &idle);
+
+	/* One command a minute, away from the period boundaries */
+	start = sim_now();
+	for (uint32_t i = 0; i < TEST_CMDS; i++) {
+		sim_at(start + SIM_S(60) * i + SIM_MS(333), _test_raise, NULL);
+	}
+	_test_hour(start + TEST_HOUR, &busy);
+
+	printf("%s: idle hour %u wakeups %u LETIMER0 interrupts, busy hour "
+			"%u wakeups %u LETIMER0 interrupts\n", TEST_NAME, idle.wakes,
+			idle.irqs, busy.wakes, busy.irqs);
+
+	/* LED0 pulses every period whoever drives it */
+	CHECK(idle.pulses >= TEST_PERIODS && idle.pulses <= TEST_PERIODS + 1);
+	CHECK(busy.pulses >= TEST_PERIODS && busy.pulses <= TEST_PERIODS + 1);
+	CHECK(test_posted == TEST_CMDS);
+
+#if !LETIMER_PWM
+	/* Underflow and COMP1 every period */
+	CHECK(idle.irqs >= 2 * TEST_PERIODS && idle.irqs <= 2 * TEST_PERIODS + 2);
+	CHECK(busy.irqs >= 2 * TEST_PERIODS && busy.irqs <= 2 * TEST_PERIODS + 2);
+#else
+	/* Nothing to do while idle */
+	CHECK(idle.irqs == 0);
+	CHECK(idle.wakes <= 1);
+#if LETIMER_CAL
+	/* A command may start a calibration, which counts its periods and loads
+	 * the new frequency at one more underflow */
+	CHECK(busy.irqs >= TEST_CMDS &&
+			busy.irqs <= (LETIMER_CAL_PERIODS + 2) * TEST_CMDS);
+#else
+	/* One underflow to load each command */
+	CHECK(busy.irqs == TEST_CMDS);
+	CHECK(busy.wakes <= 2 * TEST_CMDS + 1);
+#endif
+#endif
+
+	/* Every wakeup has a reason */
+	CHECK(idle.wakes <= idle.irqs + 1);
+	CHECK(busy.wakes <= busy.irqs + 2 * TEST_CMDS + 1);
+
+	return test_result(TEST_NAME);
+}
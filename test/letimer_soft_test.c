@@ -0,0 +1,14 @@
+/**
+ * @file letimer_soft_test.c
+ * @brief Host test counting LETIMER0 wakeups with LED0 toggled in software
+ *
+ * This file builds letimer_pwm_test.c again, the Makefile sets LETIMER_PWM
+ * to 0 for it and the firmware files, so LED0 is toggled from the UF and
+ * COMP1 interrupts.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "letimer_pwm_test.c"
@@ -0,0 +1,203 @@
+/**
+ * @file letimer_timing_test.c
+ * @brief Host test for the LETIMER0 timing calculation
+ *
+ * This test sweeps every period up to TEST_SWEEP_MS with every on time up
+ * to it, and longer periods up to the end of the prescaler range with a few
+ * on times, for the ULFRCO and the LFXO. letimer_timing() and LETIMER_TIMING
+ * evaluated at run time are checked against the floating point calculation
+ * with the halving loop that letimer_init() used to do. The old code took
+ * the period in seconds, which is not exact in a double and lost a tick for
+ * some periods, so the reference scales from ms and the test reports how
+ * often the old code was off. Constant tables check that LETIMER_TIMING
+ * folds at compile time.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "letimer.h"
+
+/* Periods swept with every on time */
+#define TEST_SWEEP_MS 4000
+
+/* Ticks past the end of the prescaler range */
+#define TEST_TICKS_MAX ((uint64_t) (LETIMER_MAX + 1) << LETIMER_PRESC_MAX)
+
+/* Periods the old calculation got a tick short */
+static uint32_t test_old_short = 0;
+
+/* Static initializers only take constants */
+static const letimer_timing_t test_const[] = {
+	LETIMER_TIMING(LETIMER_ULFRCO_FREQ, LETIMER_PERIOD_MS, LETIMER_ONTIME_MS),
+	LETIMER_TIMING(LETIMER_LFXO_FREQ, LETIMER_PERIOD_MS, LETIMER_ONTIME_MS),
+	LETIMER_TIMING(LETIMER_LFXO_FREQ, 5000, 2500),
+};
+
+_Static_assert(LETIMER_PRESC(LETIMER_TICKS(LETIMER_LFXO_FREQ, 5000)) == 2,
+		"LETIMER_PRESC gives the wrong prescaler");
+
+static const uint32_t test_freqs[] = { LETIMER_ULFRCO_FREQ, LETIMER_LFXO_FREQ };
+
+/*
+ * @brief The calculation letimer_init() used to do
+ *
+ * Ticks from a double, on time in ms, both compare values halved with the
+ * prescaler doubled until COMP0 fits.
+ */
+static bool _test_reference(uint32_t freq, uint32_t period_ms,
+		uint32_t ontime_ms, letimer_timing_t *timing) {
+	uint32_t comp0_val = (double) freq * period_ms / 1000.0;
+	uint32_t comp1_val;
+	uint32_t presc = 0;
+
+	if (ontime_ms > period_ms) {
+		ontime_ms = period_ms;
+	}
+	comp1_val = (uint64_t) freq * ontime_ms / 1000;
+
+	while (comp0_val > LETIMER_MAX) {
+		comp0_val /= 2;
+		comp1_val /= 2;
+		presc++;
+	}
+
+	timing->presc = presc;
+	timing->comp0 = comp0_val;
+	timing->comp1 = comp1_val;
+
+	return presc <= LETIMER_PRESC_MAX;
+}
+
+static bool _test_same(const letimer_timing_t *a, const letimer_timing_t *b) {
+	return a->presc == b->presc && a->comp0 == b->comp0 && a->comp1 == b->comp1;
+}
+
+/* Check one pair, returns false on the first mismatch */
+static bool _test_pair(uint32_t freq, uint32_t period_ms, uint32_t ontime_ms) {
+	letimer_timing_t ref;
+	letimer_timing_t fn;
+	bool ok_ref = _test_reference(freq, period_ms, ontime_ms, &ref);
+	bool ok_fn = letimer_timing(freq, period_ms, ontime_ms, &fn);
+
+	if (ok_fn != ok_ref || (ok_ref && !_test_same(&fn, &ref))) {
+		printf("letimer_timing(%u, %u, %u) = %d %u/%u/%u, reference %d "
+				"%u/%u/%u\n", freq, period_ms, ontime_ms, ok_fn, fn.presc,
+				fn.comp0, fn.comp1, ok_ref, ref.presc, ref.comp0, ref.comp1);
+		return false;
+	}
+
+	/* The macro does not clamp the on time */
+	if (ok_ref && ontime_ms <= period_ms) {
+		letimer_timing_t macro = LETIMER_TIMING(freq, period_ms, ontime_ms);
+
+		if (!_test_same(&macro, &ref)) {
+			printf("LETIMER_TIMING(%u, %u, %u) = %u/%u/%u, reference "
+					"%u/%u/%u\n", freq, period_ms, ontime_ms, macro.presc,
+					macro.comp0, macro.comp1, ref.presc, ref.comp0, ref.comp1);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void _test_const(void) {
+	letimer_timing_t ref;
+
+	CHECK(_test_reference(LETIMER_ULFRCO_FREQ, LETIMER_PERIOD_MS,
+			LETIMER_ONTIME_MS, &ref));
+	CHECK(_test_same(&test_const[0], &ref));
+	CHECK(_test_reference(LETIMER_LFXO_FREQ, LETIMER_PERIOD_MS,
+			LETIMER_ONTIME_MS, &ref));
+	CHECK(_test_same(&test_const[1], &ref));
+	CHECK(_test_reference(LETIMER_LFXO_FREQ, 5000, 2500, &ref));
+	CHECK(_test_same(&test_const[2], &ref));
+	CHECK(test_const[2].presc == 2);
+}
+
+/* Every period up to TEST_SWEEP_MS with every on time, one past the period
+ * included */
+static uint64_t _test_sweep(uint32_t freq) {
+	uint64_t pairs = 0;
+	double old;
+
+	for (uint32_t period = 1; period <= TEST_SWEEP_MS; period++) {
+		/* As letimer_init() used to, with the period in seconds */
+		old = period / 1000.0;
+		if ((uint32_t) (freq * old) != LETIMER_TICKS(freq, period)) {
+			test_old_short++;
+		}
+
+		for (uint32_t ontime = 0; ontime <= period + 1; ontime++) {
+			if (!_test_pair(freq, period, ontime)) {
+				CHECK(false);
+				return pairs;
+			}
+			pairs++;
+		}
+	}
+
+	return pairs;
+}
+
+/* Longer periods in growing steps up to past the prescaler range, with on
+ * times at the ends and in between */
+static uint64_t _test_long(uint32_t freq) {
+	uint64_t limit = TEST_TICKS_MAX * 1000 / freq + 1000;
+	uint64_t pairs = 0;
+	bool failed = false;
+	uint32_t ontimes[5];
+
+	for (uint64_t period = TEST_SWEEP_MS; period <= limit && !failed;
+			period += period / 97 + 1) {
+		ontimes[0] = 0;
+		ontimes[1] = 1;
+		ontimes[2] = period / 3;
+		ontimes[3] = period - 1;
+		ontimes[4] = period;
+		for (uint32_t i = 0; i < 5 && !failed; i++) {
+			failed = !_test_pair(freq, period, ontimes[i]);
+			pairs++;
+		}
+	}
+	CHECK(!failed);
+
+	return pairs;
+}
+
+/* Right at the end of the prescaler range */
+static void _test_limit(uint32_t freq) {
+	uint32_t last = (TEST_TICKS_MAX - 1) * 1000 / freq;
+	letimer_timing_t t;
+
+	while (LETIMER_TICKS(freq, last) >= TEST_TICKS_MAX) {
+		last--;
+	}
+
+	CHECK(letimer_timing(freq, last, 0, &t));
+	CHECK(t.presc == LETIMER_PRESC_MAX);
+	CHECK(_test_pair(freq, last, last / 2));
+	CHECK(!letimer_timing(freq, last + 1000, 0, &t));
+	CHECK(_test_pair(freq, last + 1000, 0));
+}
+
+int main(void) {
+	uint64_t pairs = 0;
+
+	_test_const();
+
+	for (uint32_t i = 0; i < sizeof(test_freqs) / sizeof(test_freqs[0]); i++) {
+		pairs += _test_sweep(test_freqs[i]);
+		pairs += _test_long(test_freqs[i]);
+		_test_limit(test_freqs[i]);
+	}
+
+	printf("letimer_timing_test: %llu period and on time pairs, old "
+			"calculation a tick short for %u periods\n",
+			(unsigned long long) pairs, test_old_short);
+
+	return test_result("letimer_timing_test");
+}
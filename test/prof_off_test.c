@@ -0,0 +1,13 @@
+/**
+ * @file prof_off_test.c
+ * @brief Host test for interrupt profiling compiled out
+ *
+ * This file builds prof_test.c again, the Makefile sets PROF_ENABLE to 0
+ * for it and the firmware files.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "prof_test.c"
@@ -0,0 +1,185 @@
+/**
+ * @file prof_test.c
+ * @brief Host test for the interrupt profiling histograms
+ *
+ * This test runs an instrumented handler that charges known cycle counts on
+ * the simulated cycle counter and checks the bucket, maximum and count it
+ * leaves in the histogram, including across a counter wrap. It then holds
+ * the interrupt off for known cycle counts after stamping its trigger and
+ * checks the start latency histogram, and the trigger a handler works out
+ * from a slower counter. It reports the host cost of an entry and exit pair. Built with PROF_ENABLE 0 (see
+ * prof_off_test.c) it checks that the histogram storage is compiled out.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "prof.h"
+#include "evt.h"
+#include "em_device.h"
+
+/* Rounds of the host benchmark */
+#define TEST_ROUNDS 10000000
+
+/* Cycles the next handler run charges */
+static uint32_t test_cycles = 0;
+
+#if PROF_ENABLE
+/* Cycle counter when the next run was triggered, if it records latency */
+static bool test_stamped = false;
+static uint32_t test_trigger = 0;
+#endif
+
+void SIM_TEST_IRQHandler(void) {
+	PROF_ISR_ENTER(PROF_LETIMER0);
+
+#if PROF_ENABLE
+	if (test_stamped) {
+		PROF_ISR_LATENCY(PROF_LETIMER0, test_trigger);
+	}
+#endif
+
+	sim_cpu(test_cycles);
+
+	PROF_ISR_EXIT(PROF_LETIMER0);
+}
+
+static void _test_irq(uint32_t cycles) {
+	test_cycles = cycles;
+	NVIC_SetPendingIRQ(SIM_TEST_IRQn);
+}
+
+#if PROF_ENABLE
+
+/* Each duration lands in the bucket of its bit length */
+static void _test_buckets(void) {
+	CHECK(prof_bucket(0) == 0);
+	CHECK(prof_bucket(1) == 1);
+	CHECK(prof_bucket(2) == 2);
+	CHECK(prof_bucket(3) == 2);
+	CHECK(prof_bucket(4) == 3);
+	CHECK(prof_bucket(0x80000000) == 32);
+	CHECK(prof_bucket(0xffffffff) == 32);
+
+	for (uint32_t b = 1; b < PROF_BUCKETS; b++) {
+		CHECK(prof_bucket(1u << (b - 1)) == b);
+		CHECK(prof_bucket((uint32_t) ((1ull << b) - 1)) == b);
+	}
+}
+
+static void _test_handler(void) {
+	static const uint32_t cycles[] = { 0, 1, 5, 100, 1000, 65536, 19000000 };
+	prof_hist_t hist;
+
+	prof_clear();
+	for (uint32_t i = 0; i < sizeof(cycles) / sizeof(cycles[0]); i++) {
+		_test_irq(cycles[i]);
+	}
+
+	prof_get(PROF_LETIMER0, &hist);
+	CHECK(hist.count == sizeof(cycles) / sizeof(cycles[0]));
+	CHECK(hist.dur_max == 19000000);
+	for (uint32_t i = 0; i < sizeof(cycles) / sizeof(cycles[0]); i++) {
+		CHECK(hist.dur[prof_bucket(cycles[i])] == 1);
+	}
+
+	/* Only the instrumented handler was counted */
+	prof_get(PROF_LDMA, &hist);
+	CHECK(hist.count == 0);
+
+	/* The counter wraps during the handler */
+	prof_clear();
+	DWT->CYCCNT = 0xffffff00;
+	_test_irq(0x200);
+	prof_get(PROF_LETIMER0, &hist);
+	CHECK(hist.count == 1);
+	CHECK(hist.dur_max == 0x200);
+	CHECK(hist.dur[prof_bucket(0x200)] == 1);
+}
+
+/* Triggered with interrupts masked, taken once they are enabled again */
+static void _test_latency(void) {
+	static const uint32_t delays[] = { 0, 3, 700, 40000 };
+	prof_hist_t hist;
+
+	prof_clear();
+	test_cycles = 10;
+	test_stamped = true;
+	for (uint32_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+		CORE_ATOMIC_IRQ_DISABLE();
+		test_trigger = DWT->CYCCNT;
+		NVIC_SetPendingIRQ(SIM_TEST_IRQn);
+		sim_cpu(delays[i]);
+		CORE_ATOMIC_IRQ_ENABLE();
+	}
+	test_stamped = false;
+
+	prof_get(PROF_LETIMER0, &hist);
+	CHECK(hist.count == sizeof(delays) / sizeof(delays[0]));
+	CHECK(hist.lat_max == 40000);
+	for (uint32_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+		CHECK(hist.lat[prof_bucket(delays[i])] == 1);
+	}
+
+	/* A run without a trigger leaves latency alone */
+	_test_irq(10);
+	prof_get(PROF_LETIMER0, &hist);
+	CHECK(hist.count == sizeof(delays) / sizeof(delays[0]) + 1);
+	CHECK(hist.lat_max == 40000);
+
+	/* Ticks of a slower clock back from a stamp, across a wrap */
+	CHECK(prof_ago(100000, 0, 1024) == 100000);
+	CHECK(prof_ago(100000, 2, 1000) == 100000 - 2 * PROF_CORE_FREQ / 1000);
+	CHECK(prof_ago(5, 1, PROF_CORE_FREQ / 10) == (uint32_t) (5 - 10));
+}
+
+/* Host cost of the instrumentation */
+static void _test_bench(void) {
+	uint64_t start = test_ns();
+	uint32_t t;
+
+	for (uint32_t i = 0; i < TEST_ROUNDS; i++) {
+		t = prof_enter(PROF_RTCC);
+		DWT->CYCCNT += i & 0xfff;
+		prof_exit(PROF_RTCC, t);
+	}
+
+	printf("prof_test: %.2f host ns per entry and exit\n",
+			(double) (test_ns() - start) / TEST_ROUNDS);
+}
+
+int main(void) {
+	evt_init();
+	prof_init();
+	NVIC_EnableIRQ(SIM_TEST_IRQn);
+
+	_test_buckets();
+	_test_handler();
+	_test_latency();
+	_test_bench();
+
+	return test_result("prof_test");
+}
+
+#else
+
+/* Only resolves if prof.c still defines the storage */
+extern prof_hist_t prof_hist[] __attribute__((weak));
+
+int main(void) {
+	evt_init();
+	prof_init();
+	NVIC_EnableIRQ(SIM_TEST_IRQn);
+
+	/* The handler still builds and runs */
+	_test_irq(100);
+	CHECK(DWT->CYCCNT == 100);
+
+	CHECK(prof_hist == NULL);
+
+	return test_result("prof_off_test");
+}
+
+#endif /* PROF_ENABLE */
@@ -0,0 +1,121 @@
+/**
+ * @file em_acmp.c
+ * @brief Host stand-in for the emlib ACMP module
+ *
+ * This file implements the ACMP0 model. See associated header file for
+ * function descriptions.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_acmp.h"
+#include "em_cmu.h"
+
+ACMP_TypeDef sim_acmp0;
+bool sim_acmp_enabled = false;
+uint32_t sim_acmp_edges = 0;
+
+static bool sim_acmp_fall = false;
+static bool sim_acmp_rise = false;
+static uint32_t sim_acmp_div0 = 0;
+static uint32_t sim_acmp_div1 = 0;
+
+/* Compare the input against the threshold of the current output */
+void sim_acmp_update(void) {
+	bool out = ACMP0->STATUS & ACMP_STATUS_ACMPOUT;
+	uint32_t div = out ? sim_acmp_div1 : sim_acmp_div0;
+	bool now;
+
+	if (!sim_acmp_enabled) {
+		return;
+	}
+
+	now = sim_ain(SIM_AIN_JOY) > (uint64_t) SIM_VDD_UV * (div + 1) / 64;
+	if (now == out) {
+		return;
+	}
+
+	sim_acmp_edges++;
+	if (now) {
+		ACMP0->STATUS |= ACMP_STATUS_ACMPOUT;
+	} else {
+		ACMP0->STATUS &= ~ACMP_STATUS_ACMPOUT;
+	}
+
+	if ((now && sim_acmp_rise) || (!now && sim_acmp_fall)) {
+		ACMP0->IF |= ACMP_IF_EDGE;
+	}
+}
+
+/* Flags are cleared through IFC too */
+bool sim_acmp_line(void) {
+	if (ACMP0->IFC) {
+		ACMP0->IF &= ~ACMP0->IFC;
+		ACMP0->IFC = 0;
+	}
+
+	return (ACMP0->IF & ACMP0->IEN) != 0;
+}
+
+void ACMP_Init(ACMP_TypeDef *acmp, const ACMP_Init_TypeDef *init) {
+	sim_acmp_fall = init->interruptOnFallingEdge;
+	sim_acmp_rise = init->interruptOnRisingEdge;
+
+	if (init->enable) {
+		ACMP_Enable(acmp);
+	} else {
+		ACMP_Disable(acmp);
+	}
+}
+
+void ACMP_VAConfig(ACMP_TypeDef *acmp, const ACMP_VAConfig_TypeDef *va) {
+	(void) acmp;
+
+	if (va->input != acmpVAInputVDD || va->div0 > 63 || va->div1 > 63) {
+		sim_fatal("ACMP0 divider not modelled");
+	}
+
+	sim_acmp_div0 = va->div0;
+	sim_acmp_div1 = va->div1;
+}
+
+void ACMP_ChannelSet(ACMP_TypeDef *acmp, ACMP_Channel_TypeDef neg,
+		ACMP_Channel_TypeDef pos) {
+	(void) acmp;
+
+	if (neg != acmpInputVADIV || pos != acmpInputAPORT3XCH8) {
+		sim_fatal("ACMP0 inputs not modelled");
+	}
+}
+
+/* Output starts low, the comparator catches up without an edge */
+void ACMP_Enable(ACMP_TypeDef *acmp) {
+	if (!sim_cmu_clock_on[cmuClock_ACMP0]) {
+		sim_fatal("ACMP0 enabled with its clock off");
+	}
+
+	sim_acmp_enabled = true;
+	acmp->STATUS = ACMP_STATUS_ACMPACT;
+	if (sim_ain(SIM_AIN_JOY) > (uint64_t) SIM_VDD_UV * (sim_acmp_div0 + 1) / 64) {
+		acmp->STATUS |= ACMP_STATUS_ACMPOUT;
+	}
+}
+
+void ACMP_Disable(ACMP_TypeDef *acmp) {
+	sim_acmp_enabled = false;
+	acmp->STATUS = 0;
+}
+
+void ACMP_IntClear(ACMP_TypeDef *acmp, uint32_t flags) {
+	acmp->IF &= ~flags;
+}
+
+void ACMP_IntEnable(ACMP_TypeDef *acmp, uint32_t flags) {
+	acmp->IEN |= flags;
+}
+
+void ACMP_IntDisable(ACMP_TypeDef *acmp, uint32_t flags) {
+	acmp->IEN &= ~flags;
+}
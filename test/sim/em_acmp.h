@@ -0,0 +1,106 @@
+/**
+ * @file em_acmp.h
+ * @brief Host stand-in for the emlib ACMP module
+ *
+ * This file models ACMP0 comparing an APORT input against the VDD divider,
+ * which is all acmp.c uses. The output is high while the input is above
+ * VDD * (div + 1) / 64, with div1 applying while the output is high and div0
+ * while it is low. The comparator is active as soon as it is enabled and
+ * follows its input in every energy mode down to EM3, setting EDGE on the
+ * enabled edges.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_ACMP_H__
+#define __EM_ACMP_H__
+
+#include "sim.h"
+
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t STATUS;
+	volatile uint32_t IF;
+	volatile uint32_t IFC;
+	volatile uint32_t IEN;
+} ACMP_TypeDef;
+
+extern ACMP_TypeDef sim_acmp0;
+#define ACMP0 (&sim_acmp0)
+
+#define ACMP_STATUS_ACMPACT (1UL << 0)
+#define ACMP_STATUS_ACMPOUT (1UL << 1)
+
+#define ACMP_IF_EDGE (1UL << 0)
+#define ACMP_IF_WARMUP (1UL << 1)
+#define ACMP_IFC_EDGE ACMP_IF_EDGE
+#define ACMP_IEN_EDGE ACMP_IF_EDGE
+#define _ACMP_IEN_MASK 0x3UL
+#define _ACMP_IFC_MASK 0x3UL
+
+typedef enum {
+	acmpInputAPORT3XCH8 = 0x68,
+	acmpInputVADIV = 0xf2,
+} ACMP_Channel_TypeDef;
+
+typedef enum {
+	acmpInputRangeFull,
+} ACMP_InputRange_TypeDef;
+
+typedef enum {
+	acmpAccuracyLow,
+} ACMP_Accuracy_TypeDef;
+
+typedef enum {
+	acmpPowerSourceAvdd,
+} ACMP_PowerSource_TypeDef;
+
+typedef enum {
+	acmpHysteresisLevel0,
+} ACMP_HysteresisLevel_TypeDef;
+
+typedef enum {
+	acmpVLPInputVADIV,
+} ACMP_VLPInput_Typedef;
+
+typedef enum {
+	acmpVAInputVDD,
+} ACMP_VAInput_TypeDef;
+
+typedef struct {
+	uint32_t biasProg;
+	bool interruptOnFallingEdge;
+	bool interruptOnRisingEdge;
+	ACMP_InputRange_TypeDef inputRange;
+	ACMP_Accuracy_TypeDef accuracy;
+	ACMP_PowerSource_TypeDef powerSource;
+	ACMP_HysteresisLevel_TypeDef hysteresisLevel_0;
+	ACMP_HysteresisLevel_TypeDef hysteresisLevel_1;
+	ACMP_VLPInput_Typedef vlpInput;
+	bool inactiveValue;
+	bool enable;
+} ACMP_Init_TypeDef;
+
+typedef struct {
+	ACMP_VAInput_TypeDef input;
+	uint32_t div0;
+	uint32_t div1;
+} ACMP_VAConfig_TypeDef;
+
+/* Enabled, and the edges seen since the start */
+extern bool sim_acmp_enabled;
+extern uint32_t sim_acmp_edges;
+
+void ACMP_Init(ACMP_TypeDef *acmp, const ACMP_Init_TypeDef *init);
+void ACMP_VAConfig(ACMP_TypeDef *acmp, const ACMP_VAConfig_TypeDef *va);
+void ACMP_ChannelSet(ACMP_TypeDef *acmp, ACMP_Channel_TypeDef neg,
+		ACMP_Channel_TypeDef pos);
+void ACMP_Enable(ACMP_TypeDef *acmp);
+void ACMP_Disable(ACMP_TypeDef *acmp);
+void ACMP_IntClear(ACMP_TypeDef *acmp, uint32_t flags);
+void ACMP_IntEnable(ACMP_TypeDef *acmp, uint32_t flags);
+void ACMP_IntDisable(ACMP_TypeDef *acmp, uint32_t flags);
+
+#endif /* __EM_ACMP_H__ */
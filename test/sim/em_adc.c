@@ -0,0 +1,333 @@
+/**
+ * @file em_adc.c
+ * @brief Host stand-in for the emlib ADC module
+ *
+ * This file implements the ADC0 model. See associated header file for
+ * function descriptions.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_adc.h"
+#include "em_cmu.h"
+#include "em_ldma.h"
+#include "em_acmp.h"
+
+#define SIM_ADC_FIFO 4
+
+/* AUXHFRCO band set up by cmu.c */
+#define SIM_ADC_CLK_FREQ 1000000
+
+ADC_TypeDef sim_adc0;
+uint32_t sim_adc_conversions = 0;
+uint64_t sim_adc_busy_ns = 0;
+uint32_t sim_adc_overflows = 0;
+uint32_t sim_adc_missed = 0;
+
+static bool sim_adc_ready = false;
+
+/* Conversion in progress, when it started and the repeat mode it runs in */
+static bool sim_adc_busy = false;
+static bool sim_adc_rep = false;
+static uint64_t sim_adc_since = 0;
+static sim_evt_t sim_adc_evt;
+
+static uint16_t sim_adc_fifo[SIM_ADC_FIFO];
+static uint32_t sim_adc_fifo_n = 0;
+static uint16_t sim_adc_last = 0;
+
+static void _sim_adc_stop(void);
+
+/* Carry out commands and flag clears the firmware wrote */
+static void _sim_adc_regs(void) {
+	uint32_t cmd = ADC0->CMD;
+
+	if (ADC0->IFC) {
+		ADC0->IF &= ~ADC0->IFC;
+		ADC0->IFC = 0;
+	}
+
+	if (cmd == 0) {
+		return;
+	}
+	ADC0->CMD = 0;
+
+	if (cmd & ADC_CMD_SINGLESTOP) {
+		_sim_adc_stop();
+	}
+	if (cmd & ADC_CMD_SINGLESTART) {
+		sim_fatal("ADC0 started by the core without emlib, not modelled");
+	}
+}
+
+/* Input voltage and reference of a conversion as a 12 bit result */
+static uint16_t _sim_adc_sample(uint32_t ctrl) {
+	uint32_t ref;
+	uint32_t uv;
+	uint64_t raw;
+
+	switch ((ctrl & _ADC_SINGLECTRL_REF_MASK) >> _ADC_SINGLECTRL_REF_SHIFT) {
+	case adcRef1V25:
+		ref = 1250000;
+		break;
+	case adcRef2V5:
+		ref = 2500000;
+		break;
+	case adcRefVDD:
+		ref = SIM_VDD_UV;
+		break;
+	case adcRef5V:
+		ref = 5000000;
+		break;
+	default:
+		sim_fatal("ADC0 reference not modelled");
+	}
+
+	switch ((ctrl & _ADC_SINGLECTRL_POSSEL_MASK) >>
+			_ADC_SINGLECTRL_POSSEL_SHIFT) {
+	case adcPosSelAPORT3XCH8:
+		uv = sim_ain(SIM_AIN_JOY);
+		break;
+	case adcPosSelAVDD:
+		uv = sim_ain(SIM_AIN_AVDD);
+		break;
+	case adcPosSelTEMP:
+		uv = sim_ain(SIM_AIN_TEMP);
+		break;
+	default:
+		sim_fatal("ADC0 input not modelled");
+	}
+
+	raw = (uint64_t) uv * 4096 / ref;
+
+	return raw > 4095 ? 4095 : (uint16_t) raw;
+}
+
+uint64_t sim_adc_busy_time(void) {
+	return sim_adc_busy_ns + (sim_adc_busy ? sim_now() - sim_adc_since : 0);
+}
+
+/* Start a conversion, with the warm-up when the ADC was idle */
+static void _sim_adc_convert(bool warm) {
+	uint32_t ctrl = ADC0->SINGLECTRL;
+	uint32_t presc = (ADC0->CTRL & _ADC_CTRL_PRESC_MASK) >> _ADC_CTRL_PRESC_SHIFT;
+	uint32_t at = (ctrl & _ADC_SINGLECTRL_AT_MASK) >> _ADC_SINGLECTRL_AT_SHIFT;
+	uint64_t clocks = ((1u << at) + 13) * (uint64_t) (presc + 1);
+
+	if (!sim_cmu_clock_on[cmuClock_ADC0] || !sim_cmu_osc_on[cmuOsc_AUXHFRCO] ||
+		!(CMU->ADCCTRL & CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO)) {
+		sim_fatal("ADC0 conversion with its clock off");
+	}
+	if (sim_em > 2) {
+		sim_fatal("ADC0 conversion in EM3");
+	}
+	if (((ctrl & _ADC_SINGLECTRL_POSSEL_MASK) >> _ADC_SINGLECTRL_POSSEL_SHIFT) ==
+			adcPosSelAPORT3XCH8 && sim_acmp_enabled) {
+		sim_fatal("APORT3X used by ADC0 and ACMP0");
+	}
+
+	if (!sim_adc_busy) {
+		sim_adc_since = sim_now();
+	}
+	sim_adc_busy = true;
+	sim_adc_rep = ctrl & ADC_SINGLECTRL_REP;
+	ADC0->STATUS |= ADC_STATUS_SINGLEACT;
+
+	sim_evt_arm(&sim_adc_evt, sim_dom_now(SIM_DOM_LFXO) +
+			(warm ? SIM_ADC_WARMUP : 0) +
+			(clocks * SIM_S(1) + SIM_ADC_CLK_FREQ - 1) / SIM_ADC_CLK_FREQ);
+}
+
+static void _sim_adc_stop(void) {
+	if (sim_adc_busy) {
+		sim_adc_busy_ns += sim_now() - sim_adc_since;
+	}
+
+	sim_adc_busy = false;
+	sim_adc_rep = false;
+	ADC0->STATUS &= ~ADC_STATUS_SINGLEACT;
+	sim_evt_cancel(&sim_adc_evt);
+}
+
+/* End of a conversion */
+static void _sim_adc_done(sim_evt_t *evt) {
+	uint32_t ctrl = ADC0->SINGLECTRL;
+	uint32_t lt = (ADC0->CMPTHR >> _ADC_CMPTHR_ADLT_SHIFT) & 0xffff;
+	uint32_t gt = (ADC0->CMPTHR >> _ADC_CMPTHR_ADGT_SHIFT) & 0xffff;
+	uint16_t v;
+
+	(void) evt;
+
+	_sim_adc_regs();
+	if (!sim_adc_busy) {
+		return;
+	}
+
+	v = _sim_adc_sample(ctrl);
+	sim_adc_conversions++;
+
+	if (sim_adc_fifo_n == SIM_ADC_FIFO) {
+		ADC0->IF |= ADC_IF_SINGLEOF;
+		sim_adc_overflows++;
+		if (ADC0->SINGLECTRLX & ADC_SINGLECTRLX_FIFOOFACT_OVERWRITE) {
+			for (uint32_t i = 1; i < SIM_ADC_FIFO; i++) {
+				sim_adc_fifo[i - 1] = sim_adc_fifo[i];
+			}
+			sim_adc_fifo[SIM_ADC_FIFO - 1] = v;
+		}
+	} else {
+		sim_adc_fifo[sim_adc_fifo_n++] = v;
+	}
+
+	ADC0->IF |= ADC_IF_SINGLE;
+
+	/* In the window between ADGT and ADLT, outside it when ADGT is above */
+	if ((ctrl & ADC_SINGLECTRL_CMPEN) &&
+		(gt <= lt ? (v >= gt && v <= lt) : (v >= gt || v <= lt))) {
+		ADC0->IF |= ADC_IF_SINGLECMP;
+	}
+
+	if (sim_adc_rep) {
+		_sim_adc_convert(false);
+	} else {
+		_sim_adc_stop();
+	}
+
+	sim_ldma_kick();
+}
+
+/* Oldest result, the last one again and SINGLEUF if there is none */
+static uint32_t _sim_adc_pop(void) {
+	_sim_adc_regs();
+
+	if (sim_adc_fifo_n == 0) {
+		ADC0->IF |= ADC_IF_SINGLEUF;
+		return sim_adc_last;
+	}
+
+	sim_adc_last = sim_adc_fifo[0];
+	for (uint32_t i = 1; i < sim_adc_fifo_n; i++) {
+		sim_adc_fifo[i - 1] = sim_adc_fifo[i];
+	}
+	sim_adc_fifo_n--;
+
+	return sim_adc_last;
+}
+
+static void _sim_adc_fifo_clear(uint32_t v) {
+	_sim_adc_regs();
+
+	if (v & ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR) {
+		sim_adc_fifo_n = 0;
+	}
+}
+
+static void _sim_adc_cmd(uint32_t v) {
+	_sim_adc_regs();
+
+	if (v & ADC_CMD_SINGLESTOP) {
+		_sim_adc_stop();
+	}
+	if ((v & ADC_CMD_SINGLESTART) && !sim_adc_busy) {
+		_sim_adc_convert(true);
+	}
+}
+
+/* The LDMA only runs in EM2 when the FIFO may wake it */
+static bool _sim_adc_single(void) {
+	_sim_adc_regs();
+
+	return sim_adc_fifo_n > 0 &&
+			(sim_em < 2 || (ADC0->CTRL & ADC_CTRL_DMAWUFIFOSINGLE));
+}
+
+bool sim_adc_line(void) {
+	_sim_adc_regs();
+
+	return (ADC0->IF & ADC0->IEN) != 0;
+}
+
+void sim_adc_prs(uint32_t ch) {
+	if (!sim_adc_ready) {
+		return;
+	}
+
+	_sim_adc_regs();
+
+	if (!(ADC0->SINGLECTRL & ADC_SINGLECTRL_PRSEN) ||
+		((ADC0->SINGLECTRLX & _ADC_SINGLECTRLX_PRSSEL_MASK) >>
+		_ADC_SINGLECTRLX_PRSSEL_SHIFT) != ch) {
+		return;
+	}
+
+	if (sim_adc_busy) {
+		sim_adc_missed++;
+		return;
+	}
+
+	_sim_adc_convert(true);
+}
+
+void ADC_Init(ADC_TypeDef *adc, const ADC_Init_TypeDef *init) {
+	adc->CTRL = ((uint32_t) init->prescale << _ADC_CTRL_PRESC_SHIFT) |
+			((uint32_t) init->timebase << _ADC_CTRL_TIMEBASE_SHIFT) |
+			(init->em2ClockConfig == adcEm2ClockAlwaysOn ?
+			ADC_CTRL_ASYNCCLKEN_ALWAYSON : 0);
+
+	if (!sim_adc_ready) {
+		sim_evt_init(&sim_adc_evt, SIM_DOM_LFXO, _sim_adc_done, NULL);
+		sim_reg_hook(&ADC0->CMD, NULL, _sim_adc_cmd);
+		sim_reg_hook(&ADC0->SINGLEFIFOCLEAR, NULL, _sim_adc_fifo_clear);
+		sim_reg_hook(&ADC0->SINGLEDATA, _sim_adc_pop, NULL);
+		sim_ldma_signal(ldmaPeripheralSignal_ADC0_SINGLE, _sim_adc_single);
+		sim_adc_ready = true;
+	}
+}
+
+void ADC_InitSingle(ADC_TypeDef *adc, const ADC_InitSingle_TypeDef *init) {
+	if (init->diff || init->leftAdjust || init->negSel != adcNegSelVSS) {
+		sim_fatal("ADC0 single mode not modelled");
+	}
+
+	adc->SINGLECTRL = (init->rep ? ADC_SINGLECTRL_REP : 0) |
+			((uint32_t) init->reference << _ADC_SINGLECTRL_REF_SHIFT) |
+			((uint32_t) init->posSel << _ADC_SINGLECTRL_POSSEL_SHIFT) |
+			((uint32_t) init->acqTime << _ADC_SINGLECTRL_AT_SHIFT) |
+			(init->prsEnable ? ADC_SINGLECTRL_PRSEN : 0);
+	adc->SINGLECTRLX = ((uint32_t) init->prsSel << _ADC_SINGLECTRLX_PRSSEL_SHIFT) |
+			(init->fifoOverwrite ? ADC_SINGLECTRLX_FIFOOFACT_OVERWRITE : 0);
+
+	if (init->singleDmaEm2Wu) {
+		adc->CTRL |= ADC_CTRL_DMAWUFIFOSINGLE;
+	} else {
+		adc->CTRL &= ~ADC_CTRL_DMAWUFIFOSINGLE;
+	}
+}
+
+void ADC_Start(ADC_TypeDef *adc, ADC_Start_TypeDef cmd) {
+	(void) adc;
+
+	_sim_adc_cmd(cmd);
+}
+
+uint32_t ADC_DataSingleGet(ADC_TypeDef *adc) {
+	(void) adc;
+
+	return _sim_adc_pop();
+}
+
+void ADC_IntClear(ADC_TypeDef *adc, uint32_t flags) {
+	adc->IF &= ~flags;
+}
+
+void ADC_IntEnable(ADC_TypeDef *adc, uint32_t flags) {
+	adc->IEN |= flags;
+}
+
+uint32_t ADC_IntGet(ADC_TypeDef *adc) {
+	_sim_adc_regs();
+
+	return adc->IF;
+}
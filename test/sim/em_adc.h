@@ -0,0 +1,218 @@
+/**
+ * @file em_adc.h
+ * @brief Host stand-in for the emlib ADC module
+ *
+ * This file models single conversions of ADC0 on the AUXHFRCO. A conversion
+ * is started by SINGLESTART or, with PRSEN set, by a pulse on the selected
+ * PRS channel. It takes the warm-up time plus the acquisition time and 13
+ * ADC clocks, then samples the input of SINGLECTRL against its reference into
+ * a four deep FIFO. Repeat mode starts the next conversion right away. The
+ * LDMA request is active while the FIFO holds data, in EM2 only with DMA
+ * wakeup enabled. SINGLECMP is set when a result falls in the compare
+ * window. Writes by the core to CMD and IFC take effect the next time the
+ * model runs, the emlib functions act at once. Scan mode, differential
+ * inputs and oversampling are not modelled.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_ADC_H__
+#define __EM_ADC_H__
+
+#include "sim.h"
+
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t CMD;
+	volatile uint32_t STATUS;
+	volatile uint32_t SINGLECTRL;
+	volatile uint32_t SINGLECTRLX;
+	volatile uint32_t CMPTHR;
+	volatile uint32_t SINGLEFIFOCLEAR;
+	volatile uint32_t SINGLEDATA;
+	volatile uint32_t IF;
+	volatile uint32_t IFC;
+	volatile uint32_t IEN;
+} ADC_TypeDef;
+
+extern ADC_TypeDef sim_adc0;
+#define ADC0 (&sim_adc0)
+
+#define ADC_CMD_SINGLESTART (1UL << 0)
+#define ADC_CMD_SINGLESTOP (1UL << 1)
+
+#define ADC_STATUS_SINGLEACT (1UL << 0)
+
+#define _ADC_CTRL_PRESC_SHIFT 8
+#define _ADC_CTRL_PRESC_MASK (0x7fUL << 8)
+#define _ADC_CTRL_TIMEBASE_SHIFT 16
+#define _ADC_CTRL_TIMEBASE_DEFAULT 0x1fUL
+#define ADC_CTRL_ASYNCCLKEN_ALWAYSON (1UL << 6)
+#define ADC_CTRL_DMAWUFIFOSINGLE (1UL << 29)
+
+#define _ADC_SINGLECTRL_REP_SHIFT 0
+#define ADC_SINGLECTRL_REP (1UL << 0)
+#define _ADC_SINGLECTRL_REF_SHIFT 5
+#define _ADC_SINGLECTRL_REF_MASK (0x7UL << 5)
+#define _ADC_SINGLECTRL_POSSEL_SHIFT 8
+#define _ADC_SINGLECTRL_POSSEL_MASK (0xffUL << 8)
+#define _ADC_SINGLECTRL_AT_SHIFT 24
+#define _ADC_SINGLECTRL_AT_MASK (0xfUL << 24)
+#define ADC_SINGLECTRL_PRSEN (1UL << 29)
+#define ADC_SINGLECTRL_CMPEN (1UL << 31)
+
+#define _ADC_SINGLECTRLX_PRSSEL_SHIFT 20
+#define _ADC_SINGLECTRLX_PRSSEL_MASK (0xfUL << 20)
+#define ADC_SINGLECTRLX_FIFOOFACT_OVERWRITE (1UL << 16)
+
+#define ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR (1UL << 0)
+
+#define _ADC_CMPTHR_RESETVALUE 0
+#define _ADC_CMPTHR_ADLT_SHIFT 0
+#define _ADC_CMPTHR_ADGT_SHIFT 16
+
+#define ADC_IF_SINGLE (1UL << 0)
+#define ADC_IF_SCAN (1UL << 1)
+#define ADC_IF_SINGLEOF (1UL << 8)
+#define ADC_IF_SCANOF (1UL << 9)
+#define ADC_IF_SINGLEUF (1UL << 10)
+#define ADC_IF_SCANUF (1UL << 11)
+#define ADC_IF_SINGLECMP (1UL << 16)
+#define ADC_IF_SCANCMP (1UL << 17)
+#define ADC_IF_VREFOV (1UL << 24)
+#define ADC_IF_PROGERR (1UL << 25)
+
+#define ADC_IFC_SINGLEOF ADC_IF_SINGLEOF
+#define ADC_IFC_SCANOF ADC_IF_SCANOF
+#define ADC_IFC_SINGLEUF ADC_IF_SINGLEUF
+#define ADC_IFC_SCANUF ADC_IF_SCANUF
+#define ADC_IFC_SINGLECMP ADC_IF_SINGLECMP
+#define ADC_IFC_SCANCMP ADC_IF_SCANCMP
+#define ADC_IFC_VREFOV ADC_IF_VREFOV
+#define ADC_IFC_PROGERR ADC_IF_PROGERR
+
+#define ADC_IEN_SINGLE ADC_IF_SINGLE
+#define ADC_IEN_SINGLECMP ADC_IF_SINGLECMP
+
+typedef enum {
+	adcAcqTime1,
+	adcAcqTime2,
+	adcAcqTime4,
+	adcAcqTime8,
+	adcAcqTime16,
+	adcAcqTime32,
+	adcAcqTime64,
+	adcAcqTime128,
+	adcAcqTime256,
+} ADC_AcqTime_TypeDef;
+
+typedef enum {
+	adcRef1V25,
+	adcRef2V5,
+	adcRefVDD,
+	adcRef5V,
+} ADC_Ref_TypeDef;
+
+typedef enum {
+	adcPosSelAPORT3XCH8 = 0x68,
+	adcPosSelAVDD = 0xe0,
+	adcPosSelTEMP = 0xf3,
+} ADC_PosSel_TypeDef;
+
+typedef enum {
+	adcNegSelVSS = 0xff,
+} ADC_NegSel_TypeDef;
+
+typedef enum {
+	adcPRSSELCh0,
+	adcPRSSELCh1,
+	adcPRSSELCh2,
+	adcPRSSELCh3,
+} ADC_PRSSEL_TypeDef;
+
+typedef enum {
+	adcStartSingle = ADC_CMD_SINGLESTART,
+} ADC_Start_TypeDef;
+
+typedef enum {
+	adcRes12Bit,
+} ADC_Res_TypeDef;
+
+typedef enum {
+	adcEm2Disabled,
+	adcEm2ClockOnDemand,
+	adcEm2ClockAlwaysOn,
+} ADC_EM2ClockConfig_TypeDef;
+
+typedef enum {
+	adcOvsRateSel2,
+} ADC_OvsRateSel_TypeDef;
+
+typedef enum {
+	adcWarmupNormal,
+} ADC_Warmup_TypeDef;
+
+typedef struct {
+	ADC_OvsRateSel_TypeDef ovsRateSel;
+	ADC_Warmup_TypeDef warmUpMode;
+	uint8_t timebase;
+	uint8_t prescale;
+	bool tailgate;
+	ADC_EM2ClockConfig_TypeDef em2ClockConfig;
+} ADC_Init_TypeDef;
+
+typedef struct {
+	ADC_PRSSEL_TypeDef prsSel;
+	ADC_AcqTime_TypeDef acqTime;
+	ADC_Ref_TypeDef reference;
+	ADC_Res_TypeDef resolution;
+	ADC_PosSel_TypeDef posSel;
+	ADC_NegSel_TypeDef negSel;
+	bool diff;
+	bool prsEnable;
+	bool leftAdjust;
+	bool rep;
+	bool singleDmaEm2Wu;
+	bool fifoOverwrite;
+} ADC_InitSingle_TypeDef;
+
+/* Warm-up before a conversion from idle */
+#define SIM_ADC_WARMUP SIM_US(5)
+
+/* Conversions done and time spent converting since the start, the FIFO
+ * results lost to overflow and PRS triggers that came while busy */
+extern uint32_t sim_adc_conversions;
+extern uint64_t sim_adc_busy_ns;
+extern uint32_t sim_adc_overflows;
+extern uint32_t sim_adc_missed;
+
+/**
+ * @brief Trigger a conversion from PRS
+ *
+ * Called by the PRS model on a pulse. A conversion starts if PRSEN is set,
+ * the pulse is on the selected channel and the ADC is idle.
+ *
+ * @param ch PRS channel
+ *
+ * @return Void
+ */
+void sim_adc_prs(uint32_t ch);
+
+/**
+ * @brief Time spent converting
+ *
+ * @return Nanoseconds including the conversion in progress
+ */
+uint64_t sim_adc_busy_time(void);
+
+void ADC_Init(ADC_TypeDef *adc, const ADC_Init_TypeDef *init);
+void ADC_InitSingle(ADC_TypeDef *adc, const ADC_InitSingle_TypeDef *init);
+void ADC_Start(ADC_TypeDef *adc, ADC_Start_TypeDef cmd);
+uint32_t ADC_DataSingleGet(ADC_TypeDef *adc);
+void ADC_IntClear(ADC_TypeDef *adc, uint32_t flags);
+void ADC_IntEnable(ADC_TypeDef *adc, uint32_t flags);
+uint32_t ADC_IntGet(ADC_TypeDef *adc);
+
+#endif /* __EM_ADC_H__ */
@@ -0,0 +1,80 @@
+/**
+ * @file em_cmu.c
+ * @brief Host stand-in for the emlib CMU module
+ *
+ * This file implements the clock bookkeeping. See associated header file for
+ * function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_cmu.h"
+
+CMU_TypeDef sim_cmu;
+
+bool sim_cmu_clock_on[SIM_CMU_NUM_CLOCK];
+uint32_t sim_cmu_clock_enables[SIM_CMU_NUM_CLOCK];
+bool sim_cmu_osc_on[SIM_CMU_NUM_OSC];
+uint32_t sim_cmu_osc_enables[SIM_CMU_NUM_OSC];
+CMU_Select_TypeDef sim_cmu_lfa = cmuSelect_Disabled;
+
+static uint64_t sim_cmu_clock_total[SIM_CMU_NUM_CLOCK];
+static uint64_t sim_cmu_clock_since[SIM_CMU_NUM_CLOCK];
+static uint64_t sim_cmu_osc_total[SIM_CMU_NUM_OSC];
+static uint64_t sim_cmu_osc_since[SIM_CMU_NUM_OSC];
+
+/* Turn something on or off and keep its time */
+static void _sim_cmu_set(bool *on, uint32_t *enables, uint64_t *total,
+		uint64_t *since, bool enable) {
+	if (enable && !*on) {
+		(*enables)++;
+		*since = sim_now();
+	} else if (!enable && *on) {
+		*total += sim_now() - *since;
+	}
+	*on = enable;
+}
+
+uint64_t sim_cmu_clock_ns(CMU_Clock_TypeDef clock) {
+	return sim_cmu_clock_total[clock] + (sim_cmu_clock_on[clock] ?
+			sim_now() - sim_cmu_clock_since[clock] : 0);
+}
+
+uint64_t sim_cmu_osc_ns(CMU_Osc_TypeDef osc) {
+	return sim_cmu_osc_total[osc] + (sim_cmu_osc_on[osc] ?
+			sim_now() - sim_cmu_osc_since[osc] : 0);
+}
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable) {
+	_sim_cmu_set(&sim_cmu_clock_on[clock], &sim_cmu_clock_enables[clock],
+			&sim_cmu_clock_total[clock], &sim_cmu_clock_since[clock], enable);
+}
+
+void CMU_OscillatorEnable(CMU_Osc_TypeDef osc, bool enable, bool wait) {
+	(void) wait;
+	_sim_cmu_set(&sim_cmu_osc_on[osc], &sim_cmu_osc_enables[osc],
+			&sim_cmu_osc_total[osc], &sim_cmu_osc_since[osc], enable);
+}
+
+void CMU_ClockSelectSet(CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref) {
+	if (clock == cmuClock_LFA) {
+		sim_cmu_lfa = ref;
+	}
+}
+
+void CMU_HFRCOBandSet(CMU_HFRCOFreq_TypeDef freq) {
+	(void) freq;
+}
+
+void CMU_AUXHFRCOBandSet(CMU_AUXHFRCOFreq_TypeDef freq) {
+	(void) freq;
+}
+
+void CMU_HFXOAutostartEnable(uint32_t userSel, bool enEM0EM1Start,
+		bool enEM0EM1StartSel) {
+	(void) userSel;
+	(void) enEM0EM1Start;
+	(void) enEM0EM1StartSel;
+}
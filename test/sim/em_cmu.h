@@ -0,0 +1,109 @@
+/**
+ * @file em_cmu.h
+ * @brief Host stand-in for the emlib CMU module
+ *
+ * This file keeps track of which clocks and oscillators are on, how often
+ * they were turned on and for how long, as ground truth for the clock
+ * gating tests.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_CMU_H__
+#define __EM_CMU_H__
+
+#include "sim.h"
+
+typedef enum {
+	cmuClock_HF,
+	cmuClock_HFPER,
+	cmuClock_CORELE,
+	cmuClock_LFA,
+	cmuClock_LFB,
+	cmuClock_LFE,
+	cmuClock_GPIO,
+	cmuClock_LDMA,
+	cmuClock_PRS,
+	cmuClock_GPCRC,
+	cmuClock_ADC0,
+	cmuClock_ACMP0,
+	cmuClock_USART1,
+	cmuClock_CRYOTIMER,
+	cmuClock_LETIMER0,
+	cmuClock_RTCC,
+	SIM_CMU_NUM_CLOCK
+} CMU_Clock_TypeDef;
+
+typedef enum {
+	cmuOsc_HFRCO,
+	cmuOsc_HFXO,
+	cmuOsc_AUXHFRCO,
+	cmuOsc_LFRCO,
+	cmuOsc_LFXO,
+	cmuOsc_ULFRCO,
+	SIM_CMU_NUM_OSC
+} CMU_Osc_TypeDef;
+
+typedef enum {
+	cmuSelect_Disabled,
+	cmuSelect_HFRCO,
+	cmuSelect_HFXO,
+	cmuSelect_LFRCO,
+	cmuSelect_LFXO,
+	cmuSelect_ULFRCO,
+} CMU_Select_TypeDef;
+
+typedef enum {
+	cmuHFRCOFreq_19M0Hz = 19000000,
+} CMU_HFRCOFreq_TypeDef;
+
+typedef enum {
+	cmuAUXHFRCOFreq_1M0Hz = 1000000,
+} CMU_AUXHFRCOFreq_TypeDef;
+
+typedef struct {
+	volatile uint32_t LFAPRESC0;
+	volatile uint32_t ADCCTRL;
+} CMU_TypeDef;
+
+extern CMU_TypeDef sim_cmu;
+#define CMU (&sim_cmu)
+
+#define CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO (1UL << 0)
+
+/* Ground truth, enable count and time each clock and oscillator was on */
+extern bool sim_cmu_clock_on[SIM_CMU_NUM_CLOCK];
+extern uint32_t sim_cmu_clock_enables[SIM_CMU_NUM_CLOCK];
+extern bool sim_cmu_osc_on[SIM_CMU_NUM_OSC];
+extern uint32_t sim_cmu_osc_enables[SIM_CMU_NUM_OSC];
+extern CMU_Select_TypeDef sim_cmu_lfa;
+
+/**
+ * @brief Time a clock has been on
+ *
+ * @param clock The clock
+ *
+ * @return Nanoseconds including the current enabled period
+ */
+uint64_t sim_cmu_clock_ns(CMU_Clock_TypeDef clock);
+
+/**
+ * @brief Time an oscillator has been on
+ *
+ * @param osc The oscillator
+ *
+ * @return Nanoseconds including the current enabled period
+ */
+uint64_t sim_cmu_osc_ns(CMU_Osc_TypeDef osc);
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable);
+void CMU_OscillatorEnable(CMU_Osc_TypeDef osc, bool enable, bool wait);
+void CMU_ClockSelectSet(CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref);
+void CMU_HFRCOBandSet(CMU_HFRCOFreq_TypeDef freq);
+void CMU_AUXHFRCOBandSet(CMU_AUXHFRCOFreq_TypeDef freq);
+void CMU_HFXOAutostartEnable(uint32_t userSel, bool enEM0EM1Start,
+		bool enEM0EM1StartSel);
+
+#endif /* __EM_CMU_H__ */
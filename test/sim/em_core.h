@@ -0,0 +1,27 @@
+/**
+ * @file em_core.h
+ * @brief Host stand-in for the emlib CORE module
+ *
+ * This file maps the interrupt masking macros onto the simulated PRIMASK.
+ * Unmasking takes the interrupts that became pending while masked.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_CORE_H__
+#define __EM_CORE_H__
+
+#include "em_device.h"
+
+#define CORE_ATOMIC_IRQ_DISABLE() (sim_primask = 1)
+#define CORE_ATOMIC_IRQ_ENABLE() sim_irq_enable()
+
+#define CORE_DECLARE_IRQ_STATE uint32_t irqState
+#define CORE_ENTER_CRITICAL() (irqState = sim_primask, sim_primask = 1)
+#define CORE_EXIT_CRITICAL() sim_irq_restore(irqState)
+#define CORE_ENTER_ATOMIC() CORE_ENTER_CRITICAL()
+#define CORE_EXIT_ATOMIC() CORE_EXIT_CRITICAL()
+
+#endif /* __EM_CORE_H__ */
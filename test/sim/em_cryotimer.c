@@ -0,0 +1,103 @@
+/**
+ * @file em_cryotimer.c
+ * @brief Host stand-in for the emlib CRYOTIMER module
+ *
+ * This file implements the CRYOTIMER model. See associated header file for
+ * function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_cryotimer.h"
+
+uint32_t sim_cryo_base = 0;
+void (*sim_cryo_pulse)(void) = NULL;
+CRYOTIMER_Period_TypeDef sim_cryo_period = cryotimerPeriod_1;
+bool sim_cryo_em4wu = false;
+
+static bool sim_cryo_on = false;
+static uint64_t sim_cryo_start = 0;
+static uint32_t sim_cryo_if = 0;
+static uint32_t sim_cryo_ien = 0;
+static sim_evt_t sim_cryo_evt;
+
+/* Counter, 64 bits wide so the next period is easy to find */
+static uint64_t _sim_cryo_count(void) {
+	return sim_cryo_base + (sim_ulfrco_ticks() - sim_cryo_start);
+}
+
+/* Schedule the next period, counter multiples of a power of two are also
+ * multiples of it once the counter wraps */
+void sim_cryo_resched(void) {
+	uint64_t period = 1ULL << sim_cryo_period;
+	uint64_t next;
+
+	if (!sim_cryo_on) {
+		return;
+	}
+
+	next = (_sim_cryo_count() & ~(period - 1)) + period;
+	sim_evt_arm(&sim_cryo_evt, sim_ulfrco_due(sim_cryo_start + (next -
+			sim_cryo_base)));
+}
+
+static void _sim_cryo_period(sim_evt_t *evt) {
+	(void) evt;
+
+	sim_cryo_if |= CRYOTIMER_IF_PERIOD;
+	if (sim_cryo_pulse) {
+		sim_cryo_pulse();
+	}
+
+	sim_cryo_resched();
+}
+
+bool sim_cryo_line(void) {
+	return (sim_cryo_if & sim_cryo_ien) != 0;
+}
+
+void CRYOTIMER_Init(const CRYOTIMER_Init_TypeDef *init) {
+	if (init->osc != cryotimerOscULFRCO || init->presc != cryotimerPresc_1) {
+		sim_fatal("CRYOTIMER only modelled on the undivided ULFRCO");
+	}
+
+	sim_evt_init(&sim_cryo_evt, SIM_DOM_ULFRCO, _sim_cryo_period, NULL);
+	sim_cryo_on = init->enable;
+	sim_cryo_start = sim_ulfrco_ticks();
+	sim_cryo_period = init->period;
+	sim_cryo_em4wu = init->em4Wakeup;
+
+	sim_cryo_resched();
+}
+
+/* The counter reads zero until the timer is started */
+uint32_t CRYOTIMER_CounterGet(void) {
+	return sim_cryo_on ? (uint32_t) _sim_cryo_count() : 0;
+}
+
+void CRYOTIMER_PeriodSet(CRYOTIMER_Period_TypeDef period) {
+	sim_cryo_period = period;
+	sim_cryo_resched();
+}
+
+void CRYOTIMER_EM4WakeupEnable(bool enable) {
+	sim_cryo_em4wu = enable;
+}
+
+void CRYOTIMER_IntClear(uint32_t flags) {
+	sim_cryo_if &= ~flags;
+}
+
+void CRYOTIMER_IntEnable(uint32_t flags) {
+	sim_cryo_ien |= flags;
+}
+
+void CRYOTIMER_IntDisable(uint32_t flags) {
+	sim_cryo_ien &= ~flags;
+}
+
+uint32_t CRYOTIMER_IntGet(void) {
+	return sim_cryo_if;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file em_cryotimer.h
+ * @brief Host stand-in for the emlib CRYOTIMER module
+ *
+ * This file models the CRYOTIMER counting ULFRCO cycles in every energy
+ * mode. The period flag is set each time the counter reaches a multiple of
+ * the period, which also pulses its PRS output.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_CRYOTIMER_H__
+#define __EM_CRYOTIMER_H__
+
+#include "sim.h"
+
+typedef enum {
+	cryotimerPeriod_1 = 0,
+	cryotimerPeriod_2 = 1,
+	cryotimerPeriod_4 = 2,
+	cryotimerPeriod_8 = 3,
+	cryotimerPeriod_16 = 4,
+	cryotimerPeriod_32 = 5,
+	cryotimerPeriod_64 = 6,
+	cryotimerPeriod_128 = 7,
+	cryotimerPeriod_256 = 8,
+	cryotimerPeriod_512 = 9,
+	cryotimerPeriod_1k = 10,
+	cryotimerPeriod_2k = 11,
+	cryotimerPeriod_4k = 12,
+} CRYOTIMER_Period_TypeDef;
+
+typedef enum {
+	cryotimerOscLFRCO,
+	cryotimerOscLFXO,
+	cryotimerOscULFRCO,
+} CRYOTIMER_Osc_TypeDef;
+
+typedef enum {
+	cryotimerPresc_1,
+} CRYOTIMER_Presc_TypeDef;
+
+typedef struct {
+	bool enable;
+	bool debugRun;
+	bool em4Wakeup;
+	CRYOTIMER_Osc_TypeDef osc;
+	CRYOTIMER_Presc_TypeDef presc;
+	CRYOTIMER_Period_TypeDef period;
+} CRYOTIMER_Init_TypeDef;
+
+#define CRYOTIMER_IF_PERIOD (1UL << 0)
+#define CRYOTIMER_IEN_PERIOD (1UL << 0)
+
+/* Counter value when the timer is started, set by a test to check wrap
+ * around */
+extern uint32_t sim_cryo_base;
+
+/* Called on every period pulse, the PRS consumer */
+extern void (*sim_cryo_pulse)(void);
+
+/* Period and EM4 wakeup as last set */
+extern CRYOTIMER_Period_TypeDef sim_cryo_period;
+extern bool sim_cryo_em4wu;
+
+void CRYOTIMER_Init(const CRYOTIMER_Init_TypeDef *init);
+uint32_t CRYOTIMER_CounterGet(void);
+void CRYOTIMER_PeriodSet(CRYOTIMER_Period_TypeDef period);
+void CRYOTIMER_EM4WakeupEnable(bool enable);
+void CRYOTIMER_IntClear(uint32_t flags);
+void CRYOTIMER_IntEnable(uint32_t flags);
+void CRYOTIMER_IntDisable(uint32_t flags);
+uint32_t CRYOTIMER_IntGet(void);
+
+#endif /* __EM_CRYOTIMER_H__ */
@@ -0,0 +1,79 @@
+/**
+ * @file em_device.h
+ * @brief Host stand-in for the device and CMSIS core headers
+ *
+ * This file provides the core registers and intrinsics the firmware uses.
+ * The exclusive access instructions are emulated with a monitor that any
+ * interrupt or successful store clears, so they also work between threads.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_DEVICE_H__
+#define __EM_DEVICE_H__
+
+#include "sim.h"
+
+/*
+ * @brief Cycle counter, only counts the cycles charged with sim_cpu()
+ */
+typedef struct DWT_s {
+	volatile uint32_t CTRL;
+	volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct CoreDebug_s {
+	volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+/*
+ * @brief Factory calibration, the temperature the sensor was read at and
+ * the 12 bit reading against the 1.25 V reference
+ */
+typedef struct DEVINFO_s {
+	uint32_t CAL;
+	uint32_t ADC0CAL3;
+} DEVINFO_TypeDef;
+
+#define _DEVINFO_CAL_TEMP_SHIFT 16
+#define _DEVINFO_CAL_TEMP_MASK (0xffUL << 16)
+#define _DEVINFO_ADC0CAL3_TEMPREAD1V25_SHIFT 4
+#define _DEVINFO_ADC0CAL3_TEMPREAD1V25_MASK (0xfffUL << 4)
+
+/* Calibration of the modelled part, and the sensor voltage at that
+ * temperature */
+#define SIM_TEMP_CAL_C 25
+#define SIM_TEMP_CAL_READ 2440
+#define SIM_TEMP_CAL_UV (SIM_TEMP_CAL_READ * 1250000ULL / 4096 + 1)
+
+extern DWT_Type sim_dwt;
+extern CoreDebug_Type sim_coredebug;
+extern DEVINFO_TypeDef sim_devinfo;
+
+#define DWT (&sim_dwt)
+#define CoreDebug (&sim_coredebug)
+#define DEVINFO (&sim_devinfo)
+
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+static inline uint32_t __CLZ(uint32_t v) {
+	return v ? (uint32_t) __builtin_clz(v) : 32;
+}
+
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DSB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __NOP() ((void) 0)
+
+uint32_t __LDREXW(volatile uint32_t *addr);
+uint32_t __STREXW(uint32_t value, volatile uint32_t *addr);
+void __CLREX(void);
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+
+#endif /* __EM_DEVICE_H__ */
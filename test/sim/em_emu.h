@@ -0,0 +1,36 @@
+/**
+ * @file em_emu.h
+ * @brief Host stand-in for the emlib EMU module
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_EMU_H__
+#define __EM_EMU_H__
+
+#include "sim.h"
+
+static inline void EMU_EnterEM1(void) {
+	sim_sleep(1);
+}
+
+static inline void EMU_EnterEM2(bool restore) {
+	(void) restore;
+	sim_sleep(2);
+}
+
+static inline void EMU_EnterEM3(bool restore) {
+	(void) restore;
+	sim_sleep(3);
+}
+
+static inline void EMU_EnterEM4(void) {
+	sim_em4();
+}
+
+static inline void EMU_UnlatchPinRetention(void) {
+}
+
+#endif /* __EM_EMU_H__ */
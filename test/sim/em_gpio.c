@@ -0,0 +1,151 @@
+/**
+ * @file em_gpio.c
+ * @brief Host stand-in for the emlib GPIO module
+ *
+ * This file implements the GPIO model. See associated header file for
+ * function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_gpio.h"
+
+GPIO_Mode_TypeDef sim_gpio_mode[SIM_GPIO_PORTS][SIM_GPIO_PINS];
+bool sim_gpio_out[SIM_GPIO_PORTS][SIM_GPIO_PINS];
+uint32_t sim_gpio_edges[SIM_GPIO_PORTS][SIM_GPIO_PINS];
+uint32_t sim_gpio_em4wu = 0;
+
+/* Input levels */
+static bool sim_gpio_in[SIM_GPIO_PORTS][SIM_GPIO_PINS];
+
+/* Output watchers */
+static void (*sim_gpio_watcher[SIM_GPIO_PORTS][SIM_GPIO_PINS])(bool level);
+
+/* External interrupts, one per pin number like the hardware */
+static uint32_t sim_gpio_if = 0;
+static uint32_t sim_gpio_ien = 0;
+static GPIO_Port_TypeDef sim_gpio_ext_port[SIM_GPIO_PINS];
+static bool sim_gpio_ext_rise[SIM_GPIO_PINS];
+static bool sim_gpio_ext_fall[SIM_GPIO_PINS];
+
+bool sim_gpio_even_line(void) {
+	return (sim_gpio_if & sim_gpio_ien & 0x5555) != 0;
+}
+
+bool sim_gpio_odd_line(void) {
+	return (sim_gpio_if & sim_gpio_ien & 0xaaaa) != 0;
+}
+
+static void _sim_gpio_out(GPIO_Port_TypeDef port, unsigned int pin, bool level) {
+	bool changed = sim_gpio_out[port][pin] != level;
+
+	sim_gpio_out[port][pin] = level;
+
+	if (changed) {
+		sim_gpio_edges[port][pin]++;
+		if (sim_gpio_watcher[port][pin]) {
+			sim_gpio_watcher[port][pin](level);
+		}
+	}
+}
+
+void sim_gpio_drive(GPIO_Port_TypeDef port, unsigned int pin, bool level) {
+	_sim_gpio_out(port, pin, level);
+}
+
+void sim_gpio_watch(GPIO_Port_TypeDef port, unsigned int pin,
+		void (*fn)(bool level)) {
+	sim_gpio_watcher[port][pin] = fn;
+}
+
+void sim_gpio_set_in(GPIO_Port_TypeDef port, unsigned int pin, bool level) {
+	bool old = sim_gpio_in[port][pin];
+
+	sim_gpio_in[port][pin] = level;
+
+	if (sim_gpio_ext_port[pin] != port || old == level) {
+		return;
+	}
+
+	if ((level && sim_gpio_ext_rise[pin]) || (!level && sim_gpio_ext_fall[pin])) {
+		sim_gpio_if |= 1u << pin;
+	}
+}
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin,
+		GPIO_Mode_TypeDef mode, unsigned int out) {
+	sim_gpio_mode[port][pin] = mode;
+	_sim_gpio_out(port, pin, out != 0);
+}
+
+void GPIO_DriveStrengthSet(GPIO_Port_TypeDef port,
+		GPIO_DriveStrength_TypeDef strength) {
+	(void) port;
+	(void) strength;
+}
+
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin) {
+	_sim_gpio_out(port, pin, true);
+}
+
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin) {
+	_sim_gpio_out(port, pin, false);
+}
+
+void GPIO_PinOutToggle(GPIO_Port_TypeDef port, unsigned int pin) {
+	_sim_gpio_out(port, pin, !sim_gpio_out[port][pin]);
+}
+
+unsigned int GPIO_PinOutGet(GPIO_Port_TypeDef port, unsigned int pin) {
+	return sim_gpio_out[port][pin];
+}
+
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin) {
+	return sim_gpio_in[port][pin];
+}
+
+void GPIO_IntConfig(GPIO_Port_TypeDef port, unsigned int pin,
+		bool risingEdge, bool fallingEdge, bool enable) {
+	sim_gpio_ext_port[pin] = port;
+	sim_gpio_ext_rise[pin] = risingEdge;
+	sim_gpio_ext_fall[pin] = fallingEdge;
+
+	/* Like emlib the flag is cleared before the interrupt is enabled */
+	sim_gpio_if &= ~(1u << pin);
+	if (enable) {
+		sim_gpio_ien |= 1u << pin;
+	} else {
+		sim_gpio_ien &= ~(1u << pin);
+	}
+}
+
+uint32_t GPIO_IntGet(void) {
+	return sim_gpio_if;
+}
+
+uint32_t GPIO_IntGetEnabled(void) {
+	return sim_gpio_if & sim_gpio_ien;
+}
+
+void GPIO_IntSet(uint32_t flags) {
+	sim_gpio_if |= flags & _GPIO_IF_EXT_MASK;
+}
+
+void GPIO_IntClear(uint32_t flags) {
+	sim_gpio_if &= ~flags;
+}
+
+void GPIO_IntEnable(uint32_t flags) {
+	sim_gpio_ien |= flags & _GPIO_IF_EXT_MASK;
+}
+
+void GPIO_IntDisable(uint32_t flags) {
+	sim_gpio_ien &= ~flags;
+}
+
+void GPIO_EM4EnablePinWakeup(uint32_t pinmask, uint32_t polaritymask) {
+	(void) polaritymask;
+	sim_gpio_em4wu |= pinmask;
+}
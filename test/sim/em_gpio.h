@@ -0,0 +1,111 @@
+/**
+ * @file em_gpio.h
+ * @brief Host stand-in for the emlib GPIO module
+ *
+ * This file models pin outputs, pin inputs driven by a test and the external
+ * interrupts, which work in every energy mode down to EM3.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_GPIO_H__
+#define __EM_GPIO_H__
+
+#include "sim.h"
+
+#define SIM_GPIO_PORTS 6
+#define SIM_GPIO_PINS 16
+
+typedef enum {
+	gpioPortA,
+	gpioPortB,
+	gpioPortC,
+	gpioPortD,
+	gpioPortE,
+	gpioPortF,
+} GPIO_Port_TypeDef;
+
+typedef enum {
+	gpioModeDisabled,
+	gpioModeInput,
+	gpioModeInputPull,
+	gpioModeInputPullFilter,
+	gpioModePushPull,
+	gpioModeWiredAnd,
+} GPIO_Mode_TypeDef;
+
+typedef enum {
+	gpioDriveStrengthWeakAlternateWeak,
+	gpioDriveStrengthStrongAlternateStrong,
+} GPIO_DriveStrength_TypeDef;
+
+#define _GPIO_IF_EXT_MASK 0xffffUL
+#define GPIO_EXTILEVEL_EM4WU1 (1UL << 17)
+
+/* Pin state, outputs are written by the firmware and inputs by a test */
+extern GPIO_Mode_TypeDef sim_gpio_mode[SIM_GPIO_PORTS][SIM_GPIO_PINS];
+extern bool sim_gpio_out[SIM_GPIO_PORTS][SIM_GPIO_PINS];
+extern uint32_t sim_gpio_edges[SIM_GPIO_PORTS][SIM_GPIO_PINS];
+extern uint32_t sim_gpio_em4wu;
+
+/**
+ * @brief Drive an input pin
+ *
+ * An edge sets the external interrupt flag if the pin is configured for it.
+ *
+ * @param port The port
+ * @param pin The pin
+ * @param level The new level
+ *
+ * @return Void
+ */
+void sim_gpio_set_in(GPIO_Port_TypeDef port, unsigned int pin, bool level);
+
+/**
+ * @brief Drive an output pin from a peripheral
+ *
+ * @param port The port
+ * @param pin The pin
+ * @param level The new level
+ *
+ * @return Void
+ */
+void sim_gpio_drive(GPIO_Port_TypeDef port, unsigned int pin, bool level);
+
+/**
+ * @brief Watch an output pin
+ *
+ * The function is called on every change of the pin, after the new level is
+ * in sim_gpio_out. Chip selects and LEDs use this.
+ *
+ * @param port The port
+ * @param pin The pin
+ * @param fn Called with the new level, NULL to stop watching
+ *
+ * @return Void
+ */
+void sim_gpio_watch(GPIO_Port_TypeDef port, unsigned int pin,
+		void (*fn)(bool level));
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin,
+		GPIO_Mode_TypeDef mode, unsigned int out);
+void GPIO_DriveStrengthSet(GPIO_Port_TypeDef port,
+		GPIO_DriveStrength_TypeDef strength);
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_PinOutToggle(GPIO_Port_TypeDef port, unsigned int pin);
+unsigned int GPIO_PinOutGet(GPIO_Port_TypeDef port, unsigned int pin);
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_IntConfig(GPIO_Port_TypeDef port, unsigned int pin,
+		bool risingEdge, bool fallingEdge, bool enable);
+uint32_t GPIO_IntGet(void);
+uint32_t GPIO_IntGetEnabled(void);
+void GPIO_IntSet(uint32_t flags);
+void GPIO_IntClear(uint32_t flags);
+void GPIO_IntEnable(uint32_t flags);
+void GPIO_IntDisable(uint32_t flags);
+void GPIO_EM4EnablePinWakeup(uint32_t pinmask, uint32_t polaritymask);
+
+#endif /* __EM_GPIO_H__ */
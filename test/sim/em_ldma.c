@@ -0,0 +1,165 @@
+/**
+ * @file em_ldma.c
+ * @brief Host stand-in for the emlib LDMA module
+ *
+ * This file implements the LDMA model. See associated header file for
+ * function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_ldma.h"
+#include "em_device.h"
+
+LDMA_TypeDef sim_ldma;
+
+/*
+ * @brief State of a channel
+ */
+typedef struct sim_ldma_ch_s {
+	bool active;
+	LDMA_PeripheralSignal_t signal;
+	const LDMA_Descriptor_t *desc;
+	uint32_t left;
+	uintptr_t src;
+	uintptr_t dst;
+} sim_ldma_ch_t;
+
+static sim_ldma_ch_t sim_ldma_ch[DMA_CHAN_COUNT];
+static bool (*sim_ldma_level[SIM_LDMA_NUM_SIGNAL])(void);
+static bool sim_ldma_busy = false;
+static bool sim_ldma_again = false;
+
+/* Flags are cleared through IFC, which the firmware writes directly */
+bool sim_ldma_line(void) {
+	if (LDMA->IFC) {
+		LDMA->IF &= ~LDMA->IFC;
+		LDMA->IFC = 0;
+	}
+
+	return (LDMA->IF & LDMA->IEN) != 0;
+}
+
+void sim_ldma_signal(LDMA_PeripheralSignal_t signal, bool (*level)(void)) {
+	sim_ldma_level[signal] = level;
+}
+
+bool sim_ldma_active(int ch) {
+	return sim_ldma_ch[ch].active;
+}
+
+/* Make a descriptor current */
+static void _sim_ldma_load(sim_ldma_ch_t *c, const LDMA_Descriptor_t *desc) {
+	c->desc = desc;
+	c->left = desc->xfer.xferCnt + 1;
+	c->src = desc->xfer.srcAddr;
+	c->dst = desc->xfer.dstAddr;
+}
+
+/* Current descriptor done, follow the link */
+static void _sim_ldma_next(int ch) {
+	sim_ldma_ch_t *c = &sim_ldma_ch[ch];
+	const LDMA_Descriptor_t *d = c->desc;
+
+	if (d->xfer.doneIfs) {
+		LDMA->IF |= 1u << ch;
+	}
+
+	if (!d->xfer.link) {
+		c->active = false;
+		return;
+	}
+
+	if (d->xfer.linkMode != ldmaLinkModeRel) {
+		sim_fatal("LDMA absolute links not modelled");
+	}
+
+	_sim_ldma_load(c, (const LDMA_Descriptor_t *) ((const char *) d +
+			d->xfer.linkAddr * 4));
+}
+
+/* Step in bytes of an address */
+static uint32_t _sim_ldma_step(uint32_t inc, uint32_t unit) {
+	return inc == 3 ? 0 : unit << inc;
+}
+
+/* Run a channel until it waits for a request or finishes */
+static void _sim_ldma_run(int ch) {
+	sim_ldma_ch_t *c = &sim_ldma_ch[ch];
+	const LDMA_Descriptor_t *d;
+	uint32_t unit;
+	uint32_t v;
+
+	while (c->active) {
+		d = c->desc;
+
+		if (d->xfer.structType == ldmaCtrlStructTypeWrite) {
+			sim_reg_write((volatile void *) d->wri.dstAddr,
+					(uint32_t) d->wri.immVal, 4);
+			_sim_ldma_next(ch);
+			continue;
+		}
+
+		if (d->xfer.structType != ldmaCtrlStructTypeXfer) {
+			sim_fatal("LDMA descriptor type not modelled");
+		}
+
+		if (!d->xfer.structReq &&
+			(!sim_ldma_level[c->signal] || !sim_ldma_level[c->signal]())) {
+			return;
+		}
+
+		unit = 1u << d->xfer.size;
+		v = sim_reg_read((volatile void *) c->src, unit);
+		sim_reg_write((volatile void *) c->dst, v, unit);
+		c->src += _sim_ldma_step(d->xfer.srcInc, unit);
+		c->dst += _sim_ldma_step(d->xfer.dstInc, unit);
+
+		if (--c->left == 0) {
+			_sim_ldma_next(ch);
+		}
+	}
+}
+
+/* Register accesses call back into the peripheral models, which may kick
+ * again, so only the outermost call runs the channels */
+void sim_ldma_kick(void) {
+	if (sim_ldma_busy) {
+		sim_ldma_again = true;
+		return;
+	}
+
+	sim_ldma_busy = true;
+	do {
+		sim_ldma_again = false;
+		for (int ch = 0; ch < DMA_CHAN_COUNT; ch++) {
+			_sim_ldma_run(ch);
+		}
+	} while (sim_ldma_again);
+	sim_ldma_busy = false;
+}
+
+void LDMA_Init(const LDMA_Init_t *init) {
+	(void) init;
+
+	LDMA->IEN = LDMA_IEN_ERROR;
+	NVIC_ClearPendingIRQ(LDMA_IRQn);
+	NVIC_EnableIRQ(LDMA_IRQn);
+}
+
+void LDMA_StartTransfer(int ch, const LDMA_TransferCfg_t *cfg,
+		const LDMA_Descriptor_t *desc) {
+	sim_ldma_ch_t *c = &sim_ldma_ch[ch];
+
+	c->active = true;
+	c->signal = cfg->ldmaReqSel;
+	_sim_ldma_load(c, desc);
+
+	sim_ldma_kick();
+}
+
+void LDMA_StopTransfer(int ch) {
+	sim_ldma_ch[ch].active = false;
+}
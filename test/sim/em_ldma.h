@@ -0,0 +1,180 @@
+/**
+ * @file em_ldma.h
+ * @brief Host stand-in for the emlib LDMA module
+ *
+ * This file models the LDMA running descriptor chains. Transfer descriptors
+ * move one unit each time their peripheral request is active, write
+ * descriptors run straight away. Peripheral registers are reached through
+ * sim_reg_read() and sim_reg_write() so their models see the access.
+ * Descriptors are larger than on the target, relative links are still
+ * counted in words.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_LDMA_H__
+#define __EM_LDMA_H__
+
+#include "sim.h"
+
+#define DMA_CHAN_COUNT 8
+
+typedef enum {
+	ldmaPeripheralSignal_NONE,
+	ldmaPeripheralSignal_ADC0_SINGLE,
+	ldmaPeripheralSignal_USART1_RXDATAV,
+	ldmaPeripheralSignal_USART1_TXBL,
+	SIM_LDMA_NUM_SIGNAL
+} LDMA_PeripheralSignal_t;
+
+enum {
+	ldmaCtrlStructTypeXfer,
+	ldmaCtrlStructTypeSync,
+	ldmaCtrlStructTypeWrite,
+};
+
+enum {
+	ldmaCtrlBlockSizeUnit1,
+};
+
+enum {
+	ldmaCtrlReqModeBlock,
+	ldmaCtrlReqModeAll,
+};
+
+enum {
+	ldmaCtrlSrcIncOne,
+	ldmaCtrlSrcIncTwo,
+	ldmaCtrlSrcIncFour,
+	ldmaCtrlSrcIncNone,
+};
+
+enum {
+	ldmaCtrlDstIncOne,
+	ldmaCtrlDstIncTwo,
+	ldmaCtrlDstIncFour,
+	ldmaCtrlDstIncNone,
+};
+
+enum {
+	ldmaCtrlSizeByte,
+	ldmaCtrlSizeHalf,
+	ldmaCtrlSizeWord,
+};
+
+enum {
+	ldmaLinkModeAbs,
+	ldmaLinkModeRel,
+};
+
+/* Same layout for every descriptor type, the source of a write descriptor
+ * is its immediate value */
+#define _LDMA_DESC_FIELDS(src) \
+	uint32_t structType; \
+	uint32_t structReq; \
+	uint32_t xferCnt; \
+	uint32_t blockSize; \
+	uint32_t doneIfs; \
+	uint32_t reqMode; \
+	uint32_t srcInc; \
+	uint32_t size; \
+	uint32_t dstInc; \
+	uintptr_t src; \
+	uintptr_t dstAddr; \
+	uint32_t linkMode; \
+	uint32_t link; \
+	int32_t linkAddr;
+
+typedef union {
+	struct { _LDMA_DESC_FIELDS(srcAddr) } xfer;
+	struct { _LDMA_DESC_FIELDS(immVal) } wri;
+} LDMA_Descriptor_t;
+
+/* Words per descriptor, for relative links */
+#define _LDMA_DESC_WORDS ((int32_t) (sizeof(LDMA_Descriptor_t) / 4))
+
+#define LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(s, d, count, linkjmp) { .xfer = { \
+	.structType = ldmaCtrlStructTypeXfer, .xferCnt = (count) - 1, \
+	.blockSize = ldmaCtrlBlockSizeUnit1, .reqMode = ldmaCtrlReqModeBlock, \
+	.srcInc = ldmaCtrlSrcIncOne, .size = ldmaCtrlSizeByte, \
+	.dstInc = ldmaCtrlDstIncNone, .srcAddr = (uintptr_t) (s), \
+	.dstAddr = (uintptr_t) (d), .linkMode = ldmaLinkModeRel, .link = 1, \
+	.linkAddr = (linkjmp) * _LDMA_DESC_WORDS } }
+
+#define LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(s, d, count, linkjmp) { .xfer = { \
+	.structType = ldmaCtrlStructTypeXfer, .xferCnt = (count) - 1, \
+	.blockSize = ldmaCtrlBlockSizeUnit1, .reqMode = ldmaCtrlReqModeBlock, \
+	.srcInc = ldmaCtrlSrcIncNone, .size = ldmaCtrlSizeByte, \
+	.dstInc = ldmaCtrlDstIncOne, .srcAddr = (uintptr_t) (s), \
+	.dstAddr = (uintptr_t) (d), .linkMode = ldmaLinkModeRel, .link = 1, \
+	.linkAddr = (linkjmp) * _LDMA_DESC_WORDS } }
+
+#define LDMA_DESCRIPTOR_LINKREL_WRITE(value, address, linkjmp) { .wri = { \
+	.structType = ldmaCtrlStructTypeWrite, .structReq = 1, \
+	.immVal = (value), .dstAddr = (uintptr_t) (address), \
+	.linkMode = ldmaLinkModeRel, .link = 1, \
+	.linkAddr = (linkjmp) * _LDMA_DESC_WORDS } }
+
+typedef struct {
+	LDMA_PeripheralSignal_t ldmaReqSel;
+} LDMA_TransferCfg_t;
+
+#define LDMA_TRANSFER_CFG_PERIPHERAL(signal) { .ldmaReqSel = (signal) }
+
+typedef struct {
+	uint8_t ldmaInitCtrlNumFixed;
+	uint8_t ldmaInitIrqPriority;
+} LDMA_Init_t;
+
+#define LDMA_INIT_DEFAULT { .ldmaInitCtrlNumFixed = 0, .ldmaInitIrqPriority = 3 }
+
+typedef struct {
+	volatile uint32_t IF;
+	volatile uint32_t IFC;
+	volatile uint32_t IEN;
+} LDMA_TypeDef;
+
+extern LDMA_TypeDef sim_ldma;
+#define LDMA (&sim_ldma)
+
+#define LDMA_IF_ERROR (1UL << 31)
+#define LDMA_IFC_ERROR (1UL << 31)
+#define LDMA_IEN_ERROR (1UL << 31)
+
+/**
+ * @brief Connect a peripheral request
+ *
+ * @param signal The request signal
+ * @param level Returns true while the request is active
+ *
+ * @return Void
+ */
+void sim_ldma_signal(LDMA_PeripheralSignal_t signal, bool (*level)(void));
+
+/**
+ * @brief Let the LDMA serve requests
+ *
+ * Called by a peripheral model when one of its requests may have become
+ * active.
+ *
+ * @return Void
+ */
+void sim_ldma_kick(void);
+
+/**
+ * @brief Check whether a channel is still running
+ *
+ * @param ch The channel
+ *
+ * @return True if the channel has a descriptor loaded
+ */
+bool sim_ldma_active(int ch);
+
+void LDMA_Init(const LDMA_Init_t *init);
+void LDMA_StartTransfer(int ch, const LDMA_TransferCfg_t *cfg,
+		const LDMA_Descriptor_t *desc);
+void LDMA_StopTransfer(int ch);
+
+#endif /* __EM_LDMA_H__ */
@@ -0,0 +1,250 @@
+/**
+ * @file em_letimer.c
+ * @brief Host stand-in for the emlib LETIMER module
+ *
+ * This file implements the LETIMER0 model. See associated header file for
+ * function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_letimer.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+
+LETIMER_TypeDef sim_letimer0;
+uint32_t sim_letimer_uf = 0;
+bool sim_letimer_out = false;
+uint32_t sim_letimer_access_cycles = 0;
+
+static bool sim_letimer_ready = false;
+static bool sim_letimer_on = false;
+static LETIMER_UFOA_TypeDef sim_letimer_ufoa0 = letimerUFOANone;
+static bool sim_letimer_pol = false;
+static sim_evt_t sim_letimer_evt;
+
+/* Counter, the LFA clock tick it was last worked out at and the prescaler
+ * it runs on */
+static uint32_t sim_letimer_cnt = 0;
+static uint64_t sim_letimer_at = 0;
+static uint32_t sim_letimer_presc = 0;
+
+/* LFA clock ticks and when a tick comes round */
+static uint64_t _sim_letimer_lfa(void) {
+	if (sim_cmu_lfa == cmuSelect_ULFRCO) {
+		return sim_ulfrco_ticks();
+	}
+
+	return sim_dom_now(SIM_DOM_LFXO) * SIM_LFXO_FREQ / SIM_S(1);
+}
+
+static uint64_t _sim_letimer_due(uint64_t tick) {
+	if (sim_cmu_lfa == cmuSelect_ULFRCO) {
+		return sim_ulfrco_due(tick);
+	}
+
+	return (tick * SIM_S(1) + SIM_LFXO_FREQ - 1) / SIM_LFXO_FREQ;
+}
+
+/* Charge the core for an access */
+static void _sim_letimer_access(void) {
+	if (sim_letimer_access_cycles) {
+		sim_cpu(sim_letimer_access_cycles);
+	}
+}
+
+/* Output 0, driven onto its pin when routed */
+static void _sim_letimer_out(bool active) {
+	bool level = active != sim_letimer_pol;
+
+	if (sim_letimer_ufoa0 != letimerUFOAPwm) {
+		return;
+	}
+
+	sim_letimer_out = level;
+
+	if (LETIMER0->ROUTEPEN & LETIMER_ROUTEPEN_OUT0PEN) {
+		if (LETIMER0->ROUTELOC0 != LETIMER_ROUTELOC0_OUT0LOC_LOC28) {
+			sim_fatal("LETIMER0 output location not modelled");
+		}
+		sim_gpio_drive(gpioPortF, 4, level);
+	}
+}
+
+/* Counter steps to the next underflow or COMP1 match */
+static uint32_t _sim_letimer_next(void) {
+	uint32_t cnt = sim_letimer_cnt;
+	uint32_t comp1 = LETIMER0->COMP1;
+
+	return (cnt > comp1) ? cnt - comp1 : cnt + 1;
+}
+
+/* Run the counter a number of steps */
+static void _sim_letimer_run(uint64_t steps) {
+	uint32_t k;
+
+	while (steps > 0) {
+		k = _sim_letimer_next();
+		if (k > steps) {
+			sim_letimer_cnt -= (uint32_t) steps;
+			return;
+		}
+		steps -= k;
+
+		if (k == sim_letimer_cnt + 1) {
+			sim_letimer_cnt = LETIMER0->COMP0 & 0xffff;
+			sim_letimer_uf++;
+			LETIMER0->IF |= LETIMER_IF_UF;
+			_sim_letimer_out(false);
+			if (sim_letimer_cnt != LETIMER0->COMP1) {
+				continue;
+			}
+		} else {
+			sim_letimer_cnt -= k;
+		}
+
+		LETIMER0->IF |= LETIMER_IF_COMP1;
+		_sim_letimer_out(true);
+	}
+}
+
+/* Catch up with the clock, then pick up a new prescaler */
+static void _sim_letimer_sync(void) {
+	uint64_t now = _sim_letimer_lfa();
+	uint64_t steps;
+	uint32_t presc = CMU->LFAPRESC0 & 0xf;
+
+	if (LETIMER0->CMD) {
+		sim_fatal("LETIMER0 commands not modelled");
+	}
+
+	if (!sim_letimer_on) {
+		sim_letimer_at = now;
+		sim_letimer_presc = presc;
+		return;
+	}
+
+	steps = (now - sim_letimer_at) >> sim_letimer_presc;
+	sim_letimer_at += steps << sim_letimer_presc;
+	_sim_letimer_run(steps);
+
+	sim_letimer_presc = presc;
+}
+
+/* Schedule the next underflow or match */
+static void _sim_letimer_arm(void) {
+	if (!sim_letimer_on) {
+		sim_evt_cancel(&sim_letimer_evt);
+		return;
+	}
+
+	sim_letimer_evt.dom = (sim_cmu_lfa == cmuSelect_ULFRCO) ?
+			SIM_DOM_ULFRCO : SIM_DOM_LFXO;
+	sim_evt_arm(&sim_letimer_evt, _sim_letimer_due(sim_letimer_at +
+			((uint64_t) _sim_letimer_next() << sim_letimer_presc)));
+}
+
+static void _sim_letimer_event(sim_evt_t *evt) {
+	_sim_letimer_sync();
+	_sim_letimer_arm();
+}
+
+void sim_letimer_resched(void) {
+	if (sim_letimer_ready) {
+		_sim_letimer_sync();
+		_sim_letimer_arm();
+	}
+}
+
+bool sim_letimer_line(void) {
+	if (LETIMER0->IFC) {
+		LETIMER0->IF &= ~LETIMER0->IFC;
+		LETIMER0->IFC = 0;
+	}
+
+	return (LETIMER0->IF & LETIMER0->IEN) != 0;
+}
+
+void LETIMER_Init(LETIMER_TypeDef *letimer, const LETIMER_Init_TypeDef *init) {
+	(void) letimer;
+
+	if (!init->comp0Top || init->bufTop || init->repMode != letimerRepeatFree) {
+		sim_fatal("LETIMER0 mode not modelled");
+	}
+
+	if (!sim_letimer_ready) {
+		sim_evt_init(&sim_letimer_evt, SIM_DOM_ULFRCO, _sim_letimer_event, NULL);
+		sim_letimer_ready = true;
+	}
+
+	sim_letimer_ufoa0 = init->ufoa0;
+	sim_letimer_pol = init->out0Pol;
+	LETIMER_Enable(letimer, init->enable);
+}
+
+void LETIMER_Enable(LETIMER_TypeDef *letimer, bool enable) {
+	(void) letimer;
+
+	if (enable && (!sim_cmu_clock_on[cmuClock_LETIMER0] ||
+		(sim_cmu_lfa != cmuSelect_ULFRCO && sim_cmu_lfa != cmuSelect_LFXO))) {
+		sim_fatal("LETIMER0 started without a clock");
+	}
+
+	_sim_letimer_sync();
+	sim_letimer_on = enable;
+	_sim_letimer_arm();
+}
+
+void LETIMER_CompareSet(LETIMER_TypeDef *letimer, unsigned int comp,
+		uint32_t value) {
+	(void) letimer;
+
+	_sim_letimer_sync();
+	if (comp == 0) {
+		LETIMER0->COMP0 = value & 0xffff;
+	} else {
+		LETIMER0->COMP1 = value & 0xffff;
+	}
+	if (sim_letimer_ready) {
+		_sim_letimer_arm();
+	}
+	_sim_letimer_access();
+}
+
+uint32_t LETIMER_CompareGet(LETIMER_TypeDef *letimer, unsigned int comp) {
+	(void) letimer;
+
+	return comp == 0 ? LETIMER0->COMP0 : LETIMER0->COMP1;
+}
+
+uint32_t LETIMER_CounterGet(LETIMER_TypeDef *letimer) {
+	(void) letimer;
+
+	_sim_letimer_sync();
+
+	return sim_letimer_cnt;
+}
+
+uint32_t LETIMER_IntGet(LETIMER_TypeDef *letimer) {
+	_sim_letimer_access();
+	sim_letimer_line();
+
+	return letimer->IF;
+}
+
+void LETIMER_IntClear(LETIMER_TypeDef *letimer, uint32_t flags) {
+	letimer->IF &= ~flags;
+	_sim_letimer_access();
+}
+
+void LETIMER_IntEnable(LETIMER_TypeDef *letimer, uint32_t flags) {
+	letimer->IEN |= flags;
+	_sim_letimer_access();
+}
+
+void LETIMER_IntDisable(LETIMER_TypeDef *letimer, uint32_t flags) {
+	letimer->IEN &= ~flags;
+	_sim_letimer_access();
+}
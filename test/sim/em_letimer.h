@@ -0,0 +1,119 @@
+/**
+ * @file em_letimer.h
+ * @brief Host stand-in for the emlib LETIMER module
+ *
+ * This file models LETIMER0 in free running mode with COMP0 as top. The
+ * counter runs down on the prescaled LFA clock (CMU->LFAPRESC0), reloads
+ * from COMP0 on underflow and matches COMP1 on the way. In PWM mode output 0
+ * goes idle on underflow and active on the COMP1 match, and drives its pin
+ * when routed. The counter is worked out from the clock when needed, events
+ * are only scheduled for underflows and matches. Prescaler writes take
+ * effect the next time the model runs. Commands through CMD, buffered top
+ * and repeat modes are not modelled.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_LETIMER_H__
+#define __EM_LETIMER_H__
+
+#include "sim.h"
+
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t CMD;
+	volatile uint32_t COMP0;
+	volatile uint32_t COMP1;
+	volatile uint32_t IF;
+	volatile uint32_t IFC;
+	volatile uint32_t IEN;
+	volatile uint32_t SYNCBUSY;
+	volatile uint32_t ROUTEPEN;
+	volatile uint32_t ROUTELOC0;
+} LETIMER_TypeDef;
+
+extern LETIMER_TypeDef sim_letimer0;
+#define LETIMER0 (&sim_letimer0)
+
+#define LETIMER_IF_COMP0 (1UL << 0)
+#define LETIMER_IF_COMP1 (1UL << 1)
+#define LETIMER_IF_UF (1UL << 2)
+#define LETIMER_IF_REP0 (1UL << 3)
+#define LETIMER_IF_REP1 (1UL << 4)
+
+#define LETIMER_IFC_COMP0 LETIMER_IF_COMP0
+#define LETIMER_IFC_COMP1 LETIMER_IF_COMP1
+#define LETIMER_IFC_UF LETIMER_IF_UF
+#define LETIMER_IFC_REP0 LETIMER_IF_REP0
+#define LETIMER_IFC_REP1 LETIMER_IF_REP1
+
+#define LETIMER_IEN_COMP0 LETIMER_IF_COMP0
+#define LETIMER_IEN_COMP1 LETIMER_IF_COMP1
+#define LETIMER_IEN_UF LETIMER_IF_UF
+
+#define LETIMER_CMD_START (1UL << 0)
+#define LETIMER_CMD_STOP (1UL << 1)
+#define LETIMER_CMD_CLEAR (1UL << 2)
+
+#define LETIMER_ROUTEPEN_OUT0PEN (1UL << 0)
+#define LETIMER_ROUTELOC0_OUT0LOC_LOC28 (28UL << 0)
+
+typedef enum {
+	letimerRepeatFree,
+	letimerRepeatOneshot,
+	letimerRepeatBuffered,
+	letimerRepeatDouble,
+} LETIMER_RepeatMode_TypeDef;
+
+typedef enum {
+	letimerUFOANone,
+	letimerUFOAToggle,
+	letimerUFOAPulse,
+	letimerUFOAPwm,
+} LETIMER_UFOA_TypeDef;
+
+typedef struct {
+	bool enable;
+	bool debugRun;
+	bool comp0Top;
+	bool bufTop;
+	uint8_t out0Pol;
+	uint8_t out1Pol;
+	LETIMER_UFOA_TypeDef ufoa0;
+	LETIMER_UFOA_TypeDef ufoa1;
+	LETIMER_RepeatMode_TypeDef repMode;
+} LETIMER_Init_TypeDef;
+
+/* Underflows since the start */
+extern uint32_t sim_letimer_uf;
+
+/* Level of output 0, also when it is not routed */
+extern bool sim_letimer_out;
+
+/* Core cycles each interrupt and compare access costs, 0 unless a test
+ * models it */
+extern uint32_t sim_letimer_access_cycles;
+
+/**
+ * @brief Bring the model up to date
+ *
+ * Called when the LFA clock changes speed.
+ *
+ * @return Void
+ */
+void sim_letimer_resched(void);
+
+void LETIMER_Init(LETIMER_TypeDef *letimer, const LETIMER_Init_TypeDef *init);
+void LETIMER_Enable(LETIMER_TypeDef *letimer, bool enable);
+void LETIMER_CompareSet(LETIMER_TypeDef *letimer, unsigned int comp,
+		uint32_t value);
+uint32_t LETIMER_CompareGet(LETIMER_TypeDef *letimer, unsigned int comp);
+uint32_t LETIMER_CounterGet(LETIMER_TypeDef *letimer);
+uint32_t LETIMER_IntGet(LETIMER_TypeDef *letimer);
+void LETIMER_IntClear(LETIMER_TypeDef *letimer, uint32_t flags);
+void LETIMER_IntEnable(LETIMER_TypeDef *letimer, uint32_t flags);
+void LETIMER_IntDisable(LETIMER_TypeDef *letimer, uint32_t flags);
+
+#endif /* __EM_LETIMER_H__ */
@@ -0,0 +1,45 @@
+/**
+ * @file em_prs.c
+ * @brief Host stand-in for the emlib PRS module
+ *
+ * This file implements the PRS model. See associated header file for
+ * function descriptions.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_prs.h"
+#include "em_cmu.h"
+#include "em_adc.h"
+#include "em_cryotimer.h"
+
+uint32_t sim_prs_pulses[PRS_CHAN_COUNT];
+
+static bool sim_prs_cryo[PRS_CHAN_COUNT];
+
+/* CRYOTIMER period pulse to every channel it is routed to */
+static void _sim_prs_cryo(void) {
+	if (!sim_cmu_clock_on[cmuClock_PRS]) {
+		return;
+	}
+
+	for (uint32_t ch = 0; ch < PRS_CHAN_COUNT; ch++) {
+		if (sim_prs_cryo[ch]) {
+			sim_prs_pulses[ch]++;
+			sim_adc_prs(ch);
+		}
+	}
+}
+
+void PRS_SourceSignalSet(unsigned int ch, uint32_t source, uint32_t signal,
+		PRS_Edge_TypeDef edge) {
+	if (ch >= PRS_CHAN_COUNT || edge != prsEdgeOff) {
+		sim_fatal("PRS channel not modelled");
+	}
+
+	sim_prs_cryo[ch] = source == PRS_CH_CTRL_SOURCESEL_CRYOTIMER &&
+			signal == PRS_CH_CTRL_SIGSEL_CRYOTIMERPERIOD;
+	sim_cryo_pulse = _sim_prs_cryo;
+}
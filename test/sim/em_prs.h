@@ -0,0 +1,38 @@
+/**
+ * @file em_prs.h
+ * @brief Host stand-in for the emlib PRS module
+ *
+ * This file models the PRS channels as far as the firmware uses them, the
+ * CRYOTIMER period pulse routed to the ADC conversion trigger. A channel
+ * with another source carries nothing.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_PRS_H__
+#define __EM_PRS_H__
+
+#include "sim.h"
+
+#define PRS_CHAN_COUNT 12
+
+#define PRS_CH_CTRL_SOURCESEL_NONE (0x0UL << 8)
+#define PRS_CH_CTRL_SOURCESEL_CRYOTIMER (0x3cUL << 8)
+#define PRS_CH_CTRL_SIGSEL_CRYOTIMERPERIOD (0x0UL << 0)
+
+typedef enum {
+	prsEdgeOff,
+	prsEdgePos,
+	prsEdgeNeg,
+	prsEdgeBoth,
+} PRS_Edge_TypeDef;
+
+/* Pulses carried by each channel since the start */
+extern uint32_t sim_prs_pulses[PRS_CHAN_COUNT];
+
+void PRS_SourceSignalSet(unsigned int ch, uint32_t source, uint32_t signal,
+		PRS_Edge_TypeDef edge);
+
+#endif /* __EM_PRS_H__ */
@@ -0,0 +1,12 @@
+/**
+ * @file em_rmu.c
+ * @brief Host stand-in for the emlib RMU module
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_rmu.h"
+
+uint32_t sim_rmu_cause = 0;
@@ -0,0 +1,28 @@
+/**
+ * @file em_rmu.h
+ * @brief Host stand-in for the emlib RMU module
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_RMU_H__
+#define __EM_RMU_H__
+
+#include "sim.h"
+
+#define RMU_RSTCAUSE_EM4RST (1UL << 11)
+
+/* Reset cause, set by a test before calling into the firmware */
+extern uint32_t sim_rmu_cause;
+
+static inline uint32_t RMU_ResetCauseGet(void) {
+	return sim_rmu_cause;
+}
+
+static inline void RMU_ResetCauseClear(void) {
+	sim_rmu_cause = 0;
+}
+
+#endif /* __EM_RMU_H__ */
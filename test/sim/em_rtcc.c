@@ -0,0 +1,84 @@
+/**
+ * @file em_rtcc.c
+ * @brief Host stand-in for the emlib RTCC module
+ *
+ * This file implements the RTCC model. See associated header file for
+ * function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_rtcc.h"
+
+RTCC_TypeDef sim_rtcc;
+uint32_t sim_rtcc_base = 0;
+
+/* Compare match of each channel */
+static sim_evt_t sim_rtcc_cc[RTCC_NUM_CC];
+static bool sim_rtcc_ready = false;
+
+/* Ticks since the start of the run */
+static uint64_t _sim_rtcc_ticks(void) {
+	return sim_dom_now(SIM_DOM_LFXO) * SIM_RTCC_FREQ / SIM_S(1);
+}
+
+/* Schedule the next time the counter steps onto the compare value. A value
+ * equal to the counter has already matched and comes round again after a
+ * full wrap. */
+static void _sim_rtcc_arm(int ch) {
+	uint64_t ticks = _sim_rtcc_ticks();
+	uint32_t delta = RTCC->CC[ch].CCV - (sim_rtcc_base + (uint32_t) ticks);
+	uint64_t at = ticks + (delta ? delta : (1ULL << 32));
+
+	if (RTCC->CC[ch].CTRL != rtccCapComChModeCompare) {
+		sim_evt_cancel(&sim_rtcc_cc[ch]);
+		return;
+	}
+
+	sim_evt_arm(&sim_rtcc_cc[ch], (at * SIM_S(1) + SIM_RTCC_FREQ - 1) /
+			SIM_RTCC_FREQ);
+}
+
+static void _sim_rtcc_match(sim_evt_t *evt) {
+	int ch = (int) (evt - sim_rtcc_cc);
+
+	RTCC->IF |= RTCC_IF_CC0 << ch;
+	_sim_rtcc_arm(ch);
+}
+
+static void _sim_rtcc_init(void) {
+	if (sim_rtcc_ready) {
+		return;
+	}
+
+	for (int ch = 0; ch < RTCC_NUM_CC; ch++) {
+		sim_evt_init(&sim_rtcc_cc[ch], SIM_DOM_LFXO, _sim_rtcc_match, NULL);
+	}
+	sim_rtcc_ready = true;
+}
+
+bool sim_rtcc_line(void) {
+	return (RTCC->IF & RTCC->IEN) != 0;
+}
+
+uint32_t RTCC_CounterGet(void) {
+	return sim_rtcc_base + (uint32_t) _sim_rtcc_ticks();
+}
+
+void RTCC_ChannelInit(int ch, const RTCC_CCChConf_TypeDef *conf) {
+	_sim_rtcc_init();
+	RTCC->CC[ch].CTRL = conf->chMode;
+	_sim_rtcc_arm(ch);
+}
+
+void RTCC_ChannelCCVSet(int ch, uint32_t value) {
+	_sim_rtcc_init();
+	RTCC->CC[ch].CCV = value;
+	_sim_rtcc_arm(ch);
+}
+
+uint32_t RTCC_ChannelCCVGet(int ch) {
+	return RTCC->CC[ch].CCV;
+}
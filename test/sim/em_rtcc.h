@@ -0,0 +1,86 @@
+/**
+ * @file em_rtcc.h
+ * @brief Host stand-in for the emlib RTCC module
+ *
+ * This file models the RTCC counting at SIM_RTCC_FREQ from the LFXO, so it
+ * stops while the core is in EM3. Compare channels set their interrupt flag
+ * when the counter steps onto the compare value.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_RTCC_H__
+#define __EM_RTCC_H__
+
+#include "sim.h"
+
+#define RTCC_NUM_CC 3
+#define RTCC_NUM_RET 32
+
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t CCV;
+} RTCC_CC_TypeDef;
+
+typedef struct {
+	volatile uint32_t REG;
+} RTCC_RET_TypeDef;
+
+typedef struct {
+	volatile uint32_t IF;
+	volatile uint32_t IEN;
+	RTCC_CC_TypeDef CC[RTCC_NUM_CC];
+	RTCC_RET_TypeDef RET[RTCC_NUM_RET];
+} RTCC_TypeDef;
+
+extern RTCC_TypeDef sim_rtcc;
+#define RTCC (&sim_rtcc)
+
+#define RTCC_IF_OF (1UL << 0)
+#define RTCC_IF_CC0 (1UL << 1)
+#define RTCC_IF_CC1 (1UL << 2)
+#define RTCC_IF_CC2 (1UL << 3)
+
+typedef enum {
+	rtccCapComChModeOff,
+	rtccCapComChModeCapture,
+	rtccCapComChModeCompare,
+} RTCC_CapComChMode_TypeDef;
+
+typedef struct {
+	RTCC_CapComChMode_TypeDef chMode;
+} RTCC_CCChConf_TypeDef;
+
+#define RTCC_CH_INIT_COMPARE_DEFAULT { rtccCapComChModeCompare }
+
+/* Counter value at the start of the run, set by a test to check wrap around */
+extern uint32_t sim_rtcc_base;
+
+uint32_t RTCC_CounterGet(void);
+void RTCC_ChannelInit(int ch, const RTCC_CCChConf_TypeDef *conf);
+void RTCC_ChannelCCVSet(int ch, uint32_t value);
+uint32_t RTCC_ChannelCCVGet(int ch);
+
+static inline void RTCC_IntEnable(uint32_t flags) {
+	RTCC->IEN |= flags;
+}
+
+static inline void RTCC_IntDisable(uint32_t flags) {
+	RTCC->IEN &= ~flags;
+}
+
+static inline void RTCC_IntSet(uint32_t flags) {
+	RTCC->IF |= flags;
+}
+
+static inline void RTCC_IntClear(uint32_t flags) {
+	RTCC->IF &= ~flags;
+}
+
+static inline uint32_t RTCC_IntGet(void) {
+	return RTCC->IF;
+}
+
+#endif /* __EM_RTCC_H__ */
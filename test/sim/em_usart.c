@@ -0,0 +1,193 @@
+/**
+ * @file em_usart.c
+ * @brief Host stand-in for the emlib USART module
+ *
+ * This file implements the USART1 model. See associated header file for
+ * function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "em_usart.h"
+#include "em_ldma.h"
+#include "em_cmu.h"
+
+#define SIM_USART_MAX_SLAVE 4
+#define SIM_USART_RX_BUF 2
+
+USART_TypeDef sim_usart1;
+uint32_t sim_usart_bytes = 0;
+
+/*
+ * @brief A slave on the bus
+ */
+typedef struct sim_usart_slave_s {
+	GPIO_Port_TypeDef port;
+	unsigned int pin;
+	uint8_t (*xfer)(uint8_t mosi);
+} sim_usart_slave_t;
+
+static sim_usart_slave_t sim_usart_slave[SIM_USART_MAX_SLAVE];
+static uint32_t sim_usart_num_slaves = 0;
+
+static bool sim_usart_enabled = false;
+static uint32_t sim_usart_baud = 0;
+
+/* Transmit buffer and shift register */
+static bool sim_usart_tx_full = false;
+static uint8_t sim_usart_tx_buf;
+static bool sim_usart_shifting = false;
+static uint8_t sim_usart_shift;
+static sim_evt_t sim_usart_evt;
+
+/* Receive buffer */
+static uint8_t sim_usart_rx_buf[SIM_USART_RX_BUF];
+static uint32_t sim_usart_rx_num = 0;
+
+/* Carry out commands the firmware wrote */
+static void _sim_usart_cmd(void) {
+	uint32_t cmd = USART1->CMD;
+
+	if (cmd == 0) {
+		return;
+	}
+	USART1->CMD = 0;
+
+	if (cmd & USART_CMD_CLEARRX) {
+		sim_usart_rx_num = 0;
+	}
+	if (cmd & USART_CMD_CLEARTX) {
+		if (sim_usart_shifting) {
+			sim_fatal("USART1 transmit cleared while shifting");
+		}
+		sim_usart_tx_full = false;
+	}
+}
+
+static bool _sim_usart_txbl(void) {
+	_sim_usart_cmd();
+
+	return sim_usart_enabled && !sim_usart_tx_full;
+}
+
+static bool _sim_usart_rxdatav(void) {
+	_sim_usart_cmd();
+
+	return sim_usart_rx_num > 0;
+}
+
+/* Move the buffer to the shift register */
+static void _sim_usart_load(void) {
+	if (sim_usart_shifting || !sim_usart_tx_full) {
+		return;
+	}
+
+	if (!sim_cmu_clock_on[cmuClock_USART1]) {
+		sim_fatal("USART1 used with its clock off");
+	}
+
+	sim_usart_shift = sim_usart_tx_buf;
+	sim_usart_tx_full = false;
+	sim_usart_shifting = true;
+	sim_evt_arm(&sim_usart_evt, sim_dom_now(SIM_DOM_HF) +
+			(SIM_S(8) + sim_usart_baud - 1) / sim_usart_baud);
+}
+
+/* End of a byte */
+static void _sim_usart_done(sim_evt_t *evt) {
+	uint8_t miso = 0xff;
+	uint32_t selected = 0;
+
+	for (uint32_t i = 0; i < sim_usart_num_slaves; i++) {
+		sim_usart_slave_t *s = &sim_usart_slave[i];
+
+		if (!sim_gpio_out[s->port][s->pin]) {
+			miso = s->xfer(sim_usart_shift);
+			selected++;
+		}
+	}
+
+	if (selected > 1) {
+		sim_fatal("more than one SPI slave selected");
+	}
+
+	if (sim_usart_rx_num == SIM_USART_RX_BUF) {
+		sim_fatal("USART1 receive overflow");
+	}
+	sim_usart_rx_buf[sim_usart_rx_num++] = miso;
+
+	sim_usart_bytes++;
+	sim_usart_shifting = false;
+	_sim_usart_load();
+
+	sim_ldma_kick();
+}
+
+static uint32_t _sim_usart_rx_read(void) {
+	uint8_t v;
+
+	_sim_usart_cmd();
+
+	if (sim_usart_rx_num == 0) {
+		sim_fatal("USART1 read with nothing received");
+	}
+
+	v = sim_usart_rx_buf[0];
+	sim_usart_rx_buf[0] = sim_usart_rx_buf[1];
+	sim_usart_rx_num--;
+
+	return v;
+}
+
+static void _sim_usart_tx_write(uint32_t v) {
+	_sim_usart_cmd();
+
+	if (!sim_usart_enabled) {
+		sim_fatal("USART1 written while disabled");
+	}
+	if (sim_usart_tx_full) {
+		sim_fatal("USART1 transmit overflow");
+	}
+
+	sim_usart_tx_buf = (uint8_t) v;
+	sim_usart_tx_full = true;
+	_sim_usart_load();
+}
+
+void sim_usart_attach(GPIO_Port_TypeDef port, unsigned int pin,
+		uint8_t (*xfer)(uint8_t mosi)) {
+	if (sim_usart_num_slaves == SIM_USART_MAX_SLAVE) {
+		sim_fatal("too many SPI slaves");
+	}
+
+	sim_usart_slave[sim_usart_num_slaves++] = (sim_usart_slave_t) {
+		port, pin, xfer };
+}
+
+void USART_InitSync(USART_TypeDef *usart, const USART_InitSync_TypeDef *init) {
+	if (usart != USART1 || !init->master || init->baudrate == 0) {
+		sim_fatal("USART mode not modelled");
+	}
+
+	sim_usart_baud = init->baudrate;
+	sim_usart_enabled = false;
+	sim_usart_tx_full = false;
+	sim_usart_rx_num = 0;
+
+	sim_evt_init(&sim_usart_evt, SIM_DOM_HF, _sim_usart_done, NULL);
+	sim_reg_hook(&USART1->TXDATA, NULL, _sim_usart_tx_write);
+	sim_reg_hook(&USART1->RXDATA, _sim_usart_rx_read, NULL);
+	sim_ldma_signal(ldmaPeripheralSignal_USART1_TXBL, _sim_usart_txbl);
+	sim_ldma_signal(ldmaPeripheralSignal_USART1_RXDATAV, _sim_usart_rxdatav);
+
+	USART_Enable(usart, init->enable);
+}
+
+void USART_Enable(USART_TypeDef *usart, USART_Enable_TypeDef enable) {
+	(void) usart;
+
+	sim_usart_enabled = enable == usartEnable;
+	sim_ldma_kick();
+}
@@ -0,0 +1,104 @@
+/**
+ * @file em_usart.h
+ * @brief Host stand-in for the emlib USART module
+ *
+ * This file models USART1 as a synchronous master. A byte written to TXDATA
+ * moves to the shift register when it is free and takes eight bit times on
+ * the HF clock. At the end of each byte it is exchanged with the slave whose
+ * chip select is low and the answer goes into a two byte receive buffer.
+ * TXBL and RXDATAV drive the LDMA requests. Commands written to CMD are
+ * carried out the next time the model runs.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __EM_USART_H__
+#define __EM_USART_H__
+
+#include "sim.h"
+#include "em_gpio.h"
+
+typedef struct {
+	volatile uint32_t CMD;
+	volatile uint32_t TXDATA;
+	volatile uint32_t RXDATA;
+	volatile uint32_t ROUTELOC0;
+	volatile uint32_t ROUTEPEN;
+	volatile uint32_t STATUS;
+	volatile uint32_t CTRL;
+} USART_TypeDef;
+
+extern USART_TypeDef sim_usart1;
+#define USART1 (&sim_usart1)
+
+#define USART_CMD_CLEARTX (1UL << 10)
+#define USART_CMD_CLEARRX (1UL << 11)
+
+#define USART_ROUTELOC0_RXLOC_LOC11 (11UL << 0)
+#define USART_ROUTELOC0_TXLOC_LOC11 (11UL << 8)
+#define USART_ROUTELOC0_CLKLOC_LOC11 (11UL << 24)
+
+#define USART_ROUTEPEN_RXPEN (1UL << 0)
+#define USART_ROUTEPEN_TXPEN (1UL << 1)
+#define USART_ROUTEPEN_CLKPEN (1UL << 3)
+
+typedef enum {
+	usartDisable,
+	usartEnableRx,
+	usartEnableTx,
+	usartEnable,
+} USART_Enable_TypeDef;
+
+typedef enum {
+	usartClockMode0,
+	usartClockMode1,
+	usartClockMode2,
+	usartClockMode3,
+} USART_ClockMode_TypeDef;
+
+typedef enum {
+	usartDatabits8 = 8,
+} USART_Databits_TypeDef;
+
+typedef enum {
+	usartPrsRxCh0,
+} USART_PrsRxCh_TypeDef;
+
+typedef struct {
+	USART_Enable_TypeDef enable;
+	uint32_t refFreq;
+	uint32_t baudrate;
+	USART_Databits_TypeDef databits;
+	bool master;
+	bool msbf;
+	USART_ClockMode_TypeDef clockMode;
+	bool prsRxEnable;
+	USART_PrsRxCh_TypeDef prsRxCh;
+	bool autoTx;
+	bool autoCsEnable;
+	uint8_t autoCsHold;
+	uint8_t autoCsSetup;
+} USART_InitSync_TypeDef;
+
+/* Bytes moved since the start */
+extern uint32_t sim_usart_bytes;
+
+/**
+ * @brief Attach a slave to USART1
+ *
+ * @param port Port of the chip select, active low
+ * @param pin Pin of the chip select
+ * @param xfer Called at the end of each byte with what the master sent,
+ * returns what the slave sent back
+ *
+ * @return Void
+ */
+void sim_usart_attach(GPIO_Port_TypeDef port, unsigned int pin,
+		uint8_t (*xfer)(uint8_t mosi));
+
+void USART_InitSync(USART_TypeDef *usart, const USART_InitSync_TypeDef *init);
+void USART_Enable(USART_TypeDef *usart, USART_Enable_TypeDef enable);
+
+#endif /* __EM_USART_H__ */
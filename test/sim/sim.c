@@ -0,0 +1,521 @@
+/**
+ * @file sim.c
+ * @brief Host simulation core
+ *
+ * This file implements the virtual time, events, interrupts and energy modes
+ * for the host harnesses, along with the core parts of CMSIS (NVIC, DWT and
+ * the exclusive access instructions). See associated header file for
+ * function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "sim.h"
+#include "em_device.h"
+
+/* Interrupts taken without time moving before the test is stopped */
+#define SIM_STORM 100000
+
+volatile uint32_t sim_primask = 0;
+int sim_em = 0;
+sim_stats_t sim_stats;
+jmp_buf *sim_em4_env = NULL;
+
+DWT_Type sim_dwt;
+CoreDebug_Type sim_coredebug;
+DEVINFO_TypeDef sim_devinfo = {
+	.CAL = SIM_TEMP_CAL_C << _DEVINFO_CAL_TEMP_SHIFT,
+	.ADC0CAL3 = SIM_TEMP_CAL_READ << _DEVINFO_ADC0CAL3_TEMPREAD1V25_SHIFT,
+};
+
+/* Virtual time and the time of each clock domain */
+static uint64_t sim_time = 0;
+static uint64_t sim_dom[SIM_NUM_DOM];
+static uint64_t sim_limit = SIM_FOREVER;
+
+/* Deepest energy mode each domain runs in */
+static const int sim_dom_em[SIM_NUM_DOM] = {
+	[SIM_DOM_ULFRCO] = 4,
+	[SIM_DOM_LFXO] = 2,
+	[SIM_DOM_HF] = 1,
+	[SIM_DOM_CORE] = 0,
+};
+
+/* Every event ever armed */
+static sim_evt_t *sim_evts = NULL;
+
+/* ULFRCO, counted from the last frequency change */
+static uint32_t sim_ulfrco_hz = SIM_ULFRCO_FREQ;
+static uint64_t sim_ulfrco_base_ns = 0;
+static uint64_t sim_ulfrco_base_ticks = 0;
+
+/* Analog inputs, at rest and at the calibration temperature */
+static uint32_t sim_ain_uv[SIM_NUM_AIN] = {
+	[SIM_AIN_JOY] = SIM_VDD_UV,
+	[SIM_AIN_AVDD] = SIM_VDD_UV,
+	[SIM_AIN_TEMP] = SIM_TEMP_CAL_UV,
+};
+
+/* NVIC */
+static uint32_t sim_nvic_en = 0;
+static uint32_t sim_nvic_pend = 0;
+static bool sim_in_isr = false;
+static uint32_t sim_storm = 0;
+
+/* Exclusive monitor, any successful store or exception clears everyone's
+ * reservation, like an exception does on a single core */
+static pthread_mutex_t sim_excl_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t sim_excl_gen = 0;
+static __thread volatile uint32_t *sim_excl_addr = NULL;
+static __thread uint64_t sim_excl_tag = 0;
+
+/* Registers with a model */
+#define SIM_MAX_REG 32
+
+typedef struct sim_reg_s {
+	volatile void *reg;
+	uint32_t (*read)(void);
+	void (*write)(uint32_t v);
+} sim_reg_t;
+
+static sim_reg_t sim_regs[SIM_MAX_REG];
+static uint32_t sim_num_regs = 0;
+
+/* Script events */
+typedef struct sim_script_s {
+	sim_evt_t evt;
+	void (*fn)(void *arg);
+	void *arg;
+} sim_script_t;
+
+/* Handlers the firmware does not define, a test that enables their line
+ * must provide one */
+#define SIM_HANDLER(name) \
+	void name(void) __attribute__((weak)); \
+	void name(void) { sim_fatal("no " #name); }
+
+SIM_HANDLER(LDMA_IRQHandler)
+SIM_HANDLER(GPIO_EVEN_IRQHandler)
+SIM_HANDLER(GPIO_ODD_IRQHandler)
+SIM_HANDLER(LETIMER0_IRQHandler)
+SIM_HANDLER(RTCC_IRQHandler)
+SIM_HANDLER(ACMP0_IRQHandler)
+SIM_HANDLER(ADC0_IRQHandler)
+SIM_HANDLER(CRYOTIMER_IRQHandler)
+SIM_HANDLER(SIM_TEST_IRQHandler)
+
+/* Lines that are only pended by software */
+static bool _sim_no_line(void) {
+	return false;
+}
+
+static const struct {
+	void (*handler)(void);
+	bool (*line)(void);
+} sim_irq[SIM_NUM_IRQ] = {
+	[LDMA_IRQn]      = { LDMA_IRQHandler,      sim_ldma_line },
+	[GPIO_EVEN_IRQn] = { GPIO_EVEN_IRQHandler, sim_gpio_even_line },
+	[GPIO_ODD_IRQn]  = { GPIO_ODD_IRQHandler,  sim_gpio_odd_line },
+	[LETIMER0_IRQn]  = { LETIMER0_IRQHandler,  sim_letimer_line },
+	[RTCC_IRQn]      = { RTCC_IRQHandler,      sim_rtcc_line },
+	[ACMP0_IRQn]     = { ACMP0_IRQHandler,     sim_acmp_line },
+	[ADC0_IRQn]      = { ADC0_IRQHandler,      sim_adc_line },
+	[CRYOTIMER_IRQn] = { CRYOTIMER_IRQHandler, sim_cryo_line },
+	[SIM_TEST_IRQn]  = { SIM_TEST_IRQHandler,  _sim_no_line },
+};
+
+void sim_fatal(const char *msg) {
+	fprintf(stderr, "sim: %s at %llu ns\n", msg, (unsigned long long) sim_time);
+	exit(2);
+}
+
+uint64_t sim_now(void) {
+	return sim_time;
+}
+
+uint64_t sim_dom_now(sim_dom_t dom) {
+	return sim_dom[dom];
+}
+
+/* Real time an event is due, never if its domain is stopped */
+static uint64_t _sim_evt_due(const sim_evt_t *evt) {
+	if (!evt->armed || sim_em > sim_dom_em[evt->dom]) {
+		return SIM_FOREVER;
+	}
+
+	if (evt->due <= sim_dom[evt->dom]) {
+		return sim_time;
+	}
+
+	return sim_time + (evt->due - sim_dom[evt->dom]);
+}
+
+/* Let time pass in the current energy mode */
+static void _sim_advance(uint64_t to) {
+	uint64_t dt = to - sim_time;
+
+	if (to <= sim_time) {
+		return;
+	}
+
+	for (int d = 0; d < SIM_NUM_DOM; d++) {
+		if (sim_em <= sim_dom_em[d]) {
+			sim_dom[d] += dt;
+		}
+	}
+
+	sim_stats.ns[sim_em] += dt;
+	sim_time = to;
+	sim_storm = 0;
+}
+
+/* Run the next event due by the limit, or advance to the limit */
+static bool _sim_step(uint64_t limit) {
+	sim_evt_t *next = NULL;
+	uint64_t best = SIM_FOREVER;
+	uint64_t t;
+
+	for (sim_evt_t *evt = sim_evts; evt; evt = evt->next) {
+		t = _sim_evt_due(evt);
+		if (t < best) {
+			best = t;
+			next = evt;
+		}
+	}
+
+	if (next == NULL || best > limit) {
+		if (limit == SIM_FOREVER) {
+			sim_fatal("sleeping with nothing to wake up");
+		}
+		_sim_advance(limit);
+		return false;
+	}
+
+	_sim_advance(best);
+	next->armed = false;
+	next->fn(next);
+
+	return true;
+}
+
+void sim_evt_init(sim_evt_t *evt, sim_dom_t dom, void (*fn)(sim_evt_t *evt),
+		void *arg) {
+	evt->dom = dom;
+	evt->due = 0;
+	evt->armed = false;
+	evt->fn = fn;
+	evt->arg = arg;
+	evt->next = NULL;
+}
+
+void sim_evt_arm(sim_evt_t *evt, uint64_t due) {
+	bool listed = false;
+
+	for (sim_evt_t *e = sim_evts; e; e = e->next) {
+		if (e == evt) {
+			listed = true;
+			break;
+		}
+	}
+
+	if (!listed) {
+		evt->next = sim_evts;
+		sim_evts = evt;
+	}
+
+	evt->due = due;
+	evt->armed = true;
+}
+
+void sim_evt_cancel(sim_evt_t *evt) {
+	evt->armed = false;
+}
+
+/* Run a script event and forget it */
+static void _sim_script(sim_evt_t *evt) {
+	sim_script_t *s = evt->arg;
+
+	for (sim_evt_t **p = &sim_evts; *p; p = &(*p)->next) {
+		if (*p == evt) {
+			*p = evt->next;
+			break;
+		}
+	}
+
+	s->fn(s->arg);
+	free(s);
+}
+
+void sim_at(uint64_t ns, void (*fn)(void *arg), void *arg) {
+	sim_script_t *s = malloc(sizeof(*s));
+
+	if (s == NULL) {
+		sim_fatal("out of memory");
+	}
+
+	s->fn = fn;
+	s->arg = arg;
+	sim_evt_init(&s->evt, SIM_DOM_ULFRCO, _sim_script, s);
+	sim_evt_arm(&s->evt, ns);
+}
+
+void sim_set_limit(uint64_t ns) {
+	sim_limit = ns;
+}
+
+void sim_cpu(uint32_t cycles) {
+	uint64_t start = sim_time;
+	uint64_t end = sim_time + ((uint64_t) cycles * SIM_S(1) + SIM_HF_FREQ - 1) /
+			SIM_HF_FREQ;
+	uint32_t cyc = sim_dwt.CYCCNT;
+	bool count = sim_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk;
+
+	/* The cycle counter keeps up with events that fall due on the way */
+	while (_sim_step(end)) {
+		if (count) {
+			sim_dwt.CYCCNT = cyc + (uint32_t) ((sim_time - start) *
+					SIM_HF_FREQ / SIM_S(1));
+		}
+		sim_irq_take();
+	}
+
+	if (count) {
+		sim_dwt.CYCCNT = cyc + cycles;
+	}
+	sim_irq_take();
+}
+
+void sim_sleep(int em) {
+	if (sim_in_isr) {
+		sim_fatal("sleeping in an interrupt handler");
+	}
+
+	sim_stats.sleeps[em]++;
+	sim_em = em;
+
+	while (!sim_irq_pending() && _sim_step(sim_limit));
+
+	sim_em = 0;
+
+	/* With interrupts unmasked the handler runs before WFI returns */
+	sim_irq_take();
+}
+
+void sim_em4(void) {
+	sim_stats.sleeps[4]++;
+
+	if (sim_em4_env == NULL) {
+		sim_fatal("entered EM4");
+	}
+
+	longjmp(*sim_em4_env, 1);
+}
+
+/* Lowest pending interrupt that is enabled, -1 if none */
+static int _sim_irq_next(void) {
+	for (int i = 0; i < SIM_NUM_IRQ; i++) {
+		if ((sim_nvic_en & (1u << i)) &&
+			((sim_nvic_pend & (1u << i)) || sim_irq[i].line())) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+bool sim_irq_pending(void) {
+	return _sim_irq_next() >= 0;
+}
+
+void sim_irq_take(void) {
+	int i;
+
+	if (sim_primask || sim_in_isr) {
+		return;
+	}
+
+	while ((i = _sim_irq_next()) >= 0) {
+		if (++sim_storm > SIM_STORM) {
+			sim_fatal("interrupt storm");
+		}
+
+		/* Exception entry clears the exclusive monitor */
+		pthread_mutex_lock(&sim_excl_lock);
+		sim_excl_gen++;
+		pthread_mutex_unlock(&sim_excl_lock);
+
+		sim_nvic_pend &= ~(1u << i);
+		sim_stats.irqs[i]++;
+
+		sim_in_isr = true;
+		sim_irq[i].handler();
+		sim_in_isr = false;
+
+		if (sim_primask) {
+			sim_fatal("interrupt handler returned with interrupts masked");
+		}
+	}
+}
+
+void sim_irq_enable(void) {
+	sim_primask = 0;
+	sim_irq_take();
+}
+
+void sim_irq_restore(uint32_t state) {
+	sim_primask = state;
+	sim_irq_take();
+}
+
+void sim_set_ulfrco(uint32_t hz) {
+	sim_ulfrco_base_ticks = sim_ulfrco_ticks();
+	sim_ulfrco_base_ns = sim_dom[SIM_DOM_ULFRCO];
+	sim_ulfrco_hz = hz;
+
+	sim_cryo_resched();
+	sim_letimer_resched();
+}
+
+uint64_t sim_ulfrco_ticks(void) {
+	return sim_ulfrco_base_ticks + (sim_dom[SIM_DOM_ULFRCO] - sim_ulfrco_base_ns) *
+			sim_ulfrco_hz / SIM_S(1);
+}
+
+uint64_t sim_ulfrco_due(uint64_t ticks) {
+	if (ticks <= sim_ulfrco_base_ticks) {
+		return sim_ulfrco_base_ns;
+	}
+
+	return sim_ulfrco_base_ns + ((ticks - sim_ulfrco_base_ticks) * SIM_S(1) +
+			sim_ulfrco_hz - 1) / sim_ulfrco_hz;
+}
+
+void sim_set_ain(sim_ain_t ain, uint32_t uv) {
+	sim_ain_uv[ain] = uv;
+
+	if (ain == SIM_AIN_JOY) {
+		sim_acmp_update();
+	}
+}
+
+uint32_t sim_ain(sim_ain_t ain) {
+	return sim_ain_uv[ain];
+}
+
+void sim_reg_hook(volatile void *reg, uint32_t (*read)(void),
+		void (*write)(uint32_t v)) {
+	for (uint32_t i = 0; i < sim_num_regs; i++) {
+		if (sim_regs[i].reg == reg) {
+			sim_regs[i].read = read;
+			sim_regs[i].write = write;
+			return;
+		}
+	}
+
+	if (sim_num_regs >= SIM_MAX_REG) {
+		sim_fatal("too many register models");
+	}
+
+	sim_regs[sim_num_regs++] = (sim_reg_t) { reg, read, write };
+}
+
+static sim_reg_t *_sim_reg_find(volatile void *addr) {
+	for (uint32_t i = 0; i < sim_num_regs; i++) {
+		if (sim_regs[i].reg == addr) {
+			return &sim_regs[i];
+		}
+	}
+
+	return NULL;
+}
+
+uint32_t sim_reg_read(volatile void *addr, uint32_t size) {
+	sim_reg_t *r = _sim_reg_find(addr);
+
+	if (r && r->read) {
+		return r->read();
+	}
+
+	switch (size) {
+	case 1:
+		return *(volatile uint8_t *) addr;
+	case 2:
+		return *(volatile uint16_t *) addr;
+	default:
+		return *(volatile uint32_t *) addr;
+	}
+}
+
+void sim_reg_write(volatile void *addr, uint32_t v, uint32_t size) {
+	sim_reg_t *r = _sim_reg_find(addr);
+
+	if (r && r->write) {
+		r->write(v);
+		return;
+	}
+
+	switch (size) {
+	case 1:
+		*(volatile uint8_t *) addr = (uint8_t) v;
+		break;
+	case 2:
+		*(volatile uint16_t *) addr = (uint16_t) v;
+		break;
+	default:
+		*(volatile uint32_t *) addr = v;
+		break;
+	}
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+	sim_nvic_en |= 1u << irq;
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq) {
+	sim_nvic_en &= ~(1u << irq);
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq) {
+	sim_nvic_pend |= 1u << irq;
+	sim_irq_take();
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq) {
+	sim_nvic_pend &= ~(1u << irq);
+}
+
+uint32_t __LDREXW(volatile uint32_t *addr) {
+	uint32_t v;
+
+	pthread_mutex_lock(&sim_excl_lock);
+	v = *addr;
+	sim_excl_addr = addr;
+	sim_excl_tag = sim_excl_gen;
+	pthread_mutex_unlock(&sim_excl_lock);
+
+	return v;
+}
+
+uint32_t __STREXW(uint32_t value, volatile uint32_t *addr) {
+	uint32_t fail = 1;
+
+	pthread_mutex_lock(&sim_excl_lock);
+	if (sim_excl_addr == addr && sim_excl_tag == sim_excl_gen) {
+		*addr = value;
+		sim_excl_gen++;
+		fail = 0;
+	}
+	sim_excl_addr = NULL;
+	pthread_mutex_unlock(&sim_excl_lock);
+
+	return fail;
+}
+
+void __CLREX(void) {
+	sim_excl_addr = NULL;
+}
@@ -0,0 +1,368 @@
+/**
+ * @file sim.h
+ * @brief Host simulation core
+ *
+ * This file defines the virtual time, clock domains, interrupts and energy
+ * modes behind the emlib stand-ins in this directory. Firmware code runs in
+ * zero virtual time. Time only moves while the core sleeps, or when a test
+ * charges core cycles with sim_cpu().
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+
+/*
+ * @brief Virtual time is kept in nanoseconds
+ */
+#define SIM_US(us) ((uint64_t) (us) * 1000)
+#define SIM_MS(ms) ((uint64_t) (ms) * 1000000)
+#define SIM_S(s) ((uint64_t) (s) * 1000000000)
+#define SIM_FOREVER UINT64_MAX
+
+/*
+ * @brief Clock rates in Hz. The RTCC runs from the LFXO divided by 32 as set
+ * up in InitDevice.c.
+ */
+#define SIM_HF_FREQ 19000000
+#define SIM_LFXO_FREQ 32768
+#define SIM_RTCC_FREQ 1024
+#define SIM_ULFRCO_FREQ 1000
+
+/*
+ * @brief Supply voltage in uV, also the ADC and ACMP0 VDD reference
+ */
+#define SIM_VDD_UV 3300000
+
+/*
+ * @brief Analog inputs, the joystick line on PA0 (APORT3XCH8), the supply
+ * and the die temperature sensor
+ */
+typedef enum sim_ain_e {
+	SIM_AIN_JOY,
+	SIM_AIN_AVDD,
+	SIM_AIN_TEMP,
+	SIM_NUM_AIN
+} sim_ain_t;
+
+/*
+ * @brief Clock domains, each one only runs in some energy modes
+ */
+typedef enum sim_dom_e {
+	SIM_DOM_ULFRCO,	/* every mode, this is also real time */
+	SIM_DOM_LFXO,	/* EM0 to EM2 */
+	SIM_DOM_HF,		/* EM0 and EM1 */
+	SIM_DOM_CORE,	/* EM0 only */
+	SIM_NUM_DOM
+} sim_dom_t;
+
+/*
+ * @brief Interrupt lines, the lowest pending one is taken first
+ */
+typedef enum IRQn {
+	LDMA_IRQn,
+	GPIO_EVEN_IRQn,
+	GPIO_ODD_IRQn,
+	LETIMER0_IRQn,
+	RTCC_IRQn,
+	ACMP0_IRQn,
+	ADC0_IRQn,
+	CRYOTIMER_IRQn,
+	SIM_TEST_IRQn,
+	SIM_NUM_IRQ
+} IRQn_Type;
+
+/*
+ * @brief Scheduled change of a peripheral model
+ *
+ * The due time is in the time of the event's clock domain, so an event on
+ * the LFXO is held off while the core sleeps in EM3.
+ */
+typedef struct sim_evt_s {
+	sim_dom_t dom;
+	uint64_t due;
+	bool armed;
+	void (*fn)(struct sim_evt_s *evt);
+	void *arg;
+	struct sim_evt_s *next;
+} sim_evt_t;
+
+/*
+ * @brief Ground truth kept by the simulation
+ */
+typedef struct sim_stats_s {
+	uint64_t ns[5];
+	uint32_t sleeps[5];
+	uint32_t irqs[SIM_NUM_IRQ];
+} sim_stats_t;
+
+/* Interrupt mask (PRIMASK), set by the CORE_* macros */
+extern volatile uint32_t sim_primask;
+
+/* Energy mode the core is in, EM0 while code runs */
+extern int sim_em;
+
+extern sim_stats_t sim_stats;
+
+/**
+ * @brief Current virtual time
+ *
+ * @return Nanoseconds since the start of the run
+ */
+uint64_t sim_now(void);
+
+/**
+ * @brief Time of a clock domain
+ *
+ * @param dom The clock domain
+ *
+ * @return Nanoseconds the domain has been running
+ */
+uint64_t sim_dom_now(sim_dom_t dom);
+
+/**
+ * @brief Set up an event
+ *
+ * @param evt The event, owned by the caller
+ * @param dom Clock domain of the due time
+ * @param fn Called when the event is due
+ * @param arg For the caller
+ *
+ * @return Void
+ */
+void sim_evt_init(sim_evt_t *evt, sim_dom_t dom, void (*fn)(sim_evt_t *evt),
+		void *arg);
+
+/**
+ * @brief Schedule an event
+ *
+ * @param evt The event
+ * @param due Time in the event's domain, in the past means now
+ *
+ * @return Void
+ */
+void sim_evt_arm(sim_evt_t *evt, uint64_t due);
+
+/**
+ * @brief Cancel an event
+ *
+ * @param evt The event
+ *
+ * @return Void
+ */
+void sim_evt_cancel(sim_evt_t *evt);
+
+/**
+ * @brief Run a function at a virtual time
+ *
+ * This function is meant for test scripts, the function runs like a
+ * peripheral would, between instructions and with no interrupt taken.
+ *
+ * @param ns Virtual time
+ * @param fn Function to run
+ * @param arg Passed to the function
+ *
+ * @return Void
+ */
+void sim_at(uint64_t ns, void (*fn)(void *arg), void *arg);
+
+/**
+ * @brief Limit how far a sleep may go
+ *
+ * A sleep that reaches the limit returns without an interrupt, like a
+ * spurious wakeup. Without a limit a sleep nothing can wake up from aborts
+ * the test.
+ *
+ * @param ns Virtual time, SIM_FOREVER for none
+ *
+ * @return Void
+ */
+void sim_set_limit(uint64_t ns);
+
+/**
+ * @brief Charge core cycles
+ *
+ * This function lets time pass in EM0. Events that fall due are run and
+ * their interrupts are taken if they are not masked.
+ *
+ * @param cycles Core clock cycles
+ *
+ * @return Void
+ */
+void sim_cpu(uint32_t cycles);
+
+/**
+ * @brief Sleep until an interrupt is pending
+ *
+ * Called by the EMU_EnterEMx stand-ins. Like WFI the core wakes up on a
+ * pending interrupt even while they are masked.
+ *
+ * @param em The energy mode to sleep in
+ *
+ * @return Void
+ */
+void sim_sleep(int em);
+
+/**
+ * @brief Enter EM4
+ *
+ * Jumps to sim_em4_env if a test set it, otherwise the test aborts.
+ *
+ * @return Does not return
+ */
+void sim_em4(void);
+
+/* Set by a test that expects the core to enter EM4 */
+extern jmp_buf *sim_em4_env;
+
+/**
+ * @brief Unmask interrupts and take the pending ones
+ *
+ * @return Void
+ */
+void sim_irq_enable(void);
+
+/**
+ * @brief Restore the interrupt mask saved by CORE_ENTER_CRITICAL
+ *
+ * @param state The saved mask
+ *
+ * @return Void
+ */
+void sim_irq_restore(uint32_t state);
+
+/**
+ * @brief Check for a pending interrupt
+ *
+ * @return True if an enabled interrupt line is pending
+ */
+bool sim_irq_pending(void);
+
+/**
+ * @brief Take pending interrupts if they are not masked
+ *
+ * @return Void
+ */
+void sim_irq_take(void);
+
+/**
+ * @brief Set the ULFRCO frequency
+ *
+ * The counters running from it carry on from where they are.
+ *
+ * @param hz New frequency
+ *
+ * @return Void
+ */
+void sim_set_ulfrco(uint32_t hz);
+
+/**
+ * @brief ULFRCO cycles since the start of the run
+ *
+ * @return Cycles
+ */
+uint64_t sim_ulfrco_ticks(void);
+
+/**
+ * @brief Time the ULFRCO reaches a cycle count
+ *
+ * @param ticks Cycles since the start of the run
+ *
+ * @return ULFRCO domain time in ns
+ */
+uint64_t sim_ulfrco_due(uint64_t ticks);
+
+/**
+ * @brief Set an analog input
+ *
+ * The ADC samples the input at the end of each conversion, ACMP0 compares it
+ * at once.
+ *
+ * @param ain The input
+ * @param uv Voltage in uV
+ *
+ * @return Void
+ */
+void sim_set_ain(sim_ain_t ain, uint32_t uv);
+
+/**
+ * @brief Read an analog input
+ *
+ * @param ain The input
+ *
+ * @return Voltage in uV
+ */
+uint32_t sim_ain(sim_ain_t ain);
+
+/**
+ * @brief Give a peripheral register a model
+ *
+ * Register accesses made by the LDMA go through the model, so a peripheral
+ * sees the bytes the LDMA moves. Accesses by the core are plain memory
+ * accesses and models pick them up when they next run.
+ *
+ * @param reg The register
+ * @param read Called for a read, may be NULL
+ * @param write Called for a write, may be NULL
+ *
+ * @return Void
+ */
+void sim_reg_hook(volatile void *reg, uint32_t (*read)(void),
+		void (*write)(uint32_t v));
+
+/**
+ * @brief Read memory or a register with a model
+ *
+ * @param addr The address
+ * @param size Bytes to read, 1, 2 or 4
+ *
+ * @return The value read
+ */
+uint32_t sim_reg_read(volatile void *addr, uint32_t size);
+
+/**
+ * @brief Write memory or a register with a model
+ *
+ * @param addr The address
+ * @param v The value
+ * @param size Bytes to write, 1, 2 or 4
+ *
+ * @return Void
+ */
+void sim_reg_write(volatile void *addr, uint32_t v, uint32_t size);
+
+/**
+ * @brief Abort the test
+ *
+ * @param msg What went wrong
+ *
+ * @return Does not return
+ */
+void sim_fatal(const char *msg) __attribute__((noreturn));
+
+/*
+ * Peripheral model hooks used by the core, the level of each interrupt line,
+ * rescheduling after a ULFRCO frequency change and following the joystick
+ * line
+ */
+bool sim_ldma_line(void);
+bool sim_gpio_even_line(void);
+bool sim_letimer_line(void);
+bool sim_gpio_odd_line(void);
+bool sim_rtcc_line(void);
+bool sim_acmp_line(void);
+bool sim_adc_line(void);
+bool sim_cryo_line(void);
+void sim_cryo_resched(void);
+void sim_letimer_resched(void);
+void sim_acmp_update(void);
+
+#endif /* __SIM_H__ */
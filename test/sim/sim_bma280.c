@@ -0,0 +1,416 @@
+/**
+ * @file sim_bma280.c
+ * @brief Model of the BMA280 accelerometer on the SPI bus
+ *
+ * This file implements the BMA280 model. See associated header file for
+ * function descriptions. Register addresses come from the datasheet rather
+ * than bma280.h, so a wrong definition there is caught.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include <string.h>
+#include "sim_bma280.h"
+#include "em_usart.h"
+#include "em_gpio.h"
+
+/* Registers the model acts on */
+#define SIM_BMA280_CHIPID 0x00
+#define SIM_BMA280_INT_STATUS_0 0x09
+#define SIM_BMA280_INT_STATUS_1 0x0a
+#define SIM_BMA280_FIFO_STATUS 0x0e
+#define SIM_BMA280_PMU_RANGE 0x0f
+#define SIM_BMA280_PMU_BW 0x10
+#define SIM_BMA280_PMU_LPW 0x11
+#define SIM_BMA280_SOFTRESET 0x14
+#define SIM_BMA280_INT_EN_0 0x16
+#define SIM_BMA280_INT_EN_1 0x17
+#define SIM_BMA280_INT_MAP_0 0x19
+#define SIM_BMA280_INT_MAP_1 0x1a
+#define SIM_BMA280_INT_RST_LATCH 0x21
+#define SIM_BMA280_INT_8 0x2a
+#define SIM_BMA280_INT_9 0x2b
+#define SIM_BMA280_FIFO_CONFIG_0 0x30
+#define SIM_BMA280_FIFO_CONFIG_1 0x3e
+#define SIM_BMA280_FIFO_DATA 0x3f
+
+#define SIM_BMA280_TAP_MASK 0x30
+#define SIM_BMA280_TAP_DUR_MASK 0x07
+#define SIM_BMA280_DEEP_SUSPEND (1 << 5)
+#define SIM_BMA280_RESET_INT (1 << 7)
+#define SIM_BMA280_LATCH_MASK 0x0f
+#define SIM_BMA280_RESET_CMD 0xb6
+#define SIM_BMA280_FWM_INT (1 << 6)
+#define SIM_BMA280_FWM_EN (1 << 6)
+#define SIM_BMA280_INT1_FWM (1 << 1)
+#define SIM_BMA280_OVERRUN (1 << 7)
+#define SIM_BMA280_WM_MASK 0x3f
+#define SIM_BMA280_MODE_MASK 0xc0
+#define SIM_BMA280_MODE_BYPASS 0x00
+#define SIM_BMA280_MODE_FIFO 0x40
+#define SIM_BMA280_BW_MIN 0x08
+#define SIM_BMA280_BW_MAX 0x0f
+
+/* FIFO depth and the bytes of an XYZ frame */
+#define SIM_BMA280_FIFO_FRAMES 32
+#define SIM_BMA280_FRAME 6
+
+/* Output data rate period at the lowest bandwidth, halved for each step */
+#define SIM_BMA280_ODR_NS SIM_MS(64)
+
+/* Wiring on the board */
+#define SIM_BMA280_CS_PORT gpioPortC
+#define SIM_BMA280_CS_PIN 9
+#define SIM_BMA280_INT_PORT gpioPortD
+#define SIM_BMA280_INT_PIN 11
+
+/* Latch time of each INT_RST_LATCH setting, 0 for non-latched and
+ * SIM_FOREVER for latched */
+static const uint64_t sim_bma280_latch[16] = {
+	0, SIM_MS(250), SIM_MS(500), SIM_S(1), SIM_S(2), SIM_S(4), SIM_S(8),
+	SIM_FOREVER, 0, SIM_US(250), SIM_US(500), SIM_MS(1), SIM_US(12500),
+	SIM_MS(25), SIM_MS(50), SIM_FOREVER,
+};
+
+/* Tap duration of each INT_8 setting, the status bit of a tap stays set for
+ * this long */
+static const uint64_t sim_bma280_tap_dur[8] = {
+	SIM_MS(50), SIM_MS(100), SIM_MS(150), SIM_MS(200), SIM_MS(250),
+	SIM_MS(375), SIM_MS(500), SIM_MS(700),
+};
+
+uint8_t sim_bma280_reg[SIM_BMA280_REGS];
+uint32_t sim_bma280_resets = 0;
+uint32_t sim_bma280_errors = 0;
+uint32_t sim_bma280_xfers = 0;
+uint32_t sim_bma280_frames = 0;
+uint32_t sim_bma280_lost = 0;
+uint32_t sim_bma280_flushed = 0;
+
+static bool sim_bma280_deep = false;
+static uint64_t sim_bma280_ready = 0;
+static sim_evt_t sim_bma280_latch_evt;
+static sim_evt_t sim_bma280_tap_evt;
+static sim_evt_t sim_bma280_odr_evt;
+
+/* FIFO, oldest frame first, and how much of that one has been read */
+static uint8_t sim_bma280_fifo[SIM_BMA280_FIFO_FRAMES][SIM_BMA280_FRAME];
+static uint32_t sim_bma280_fifo_first = 0;
+static uint32_t sim_bma280_fifo_num = 0;
+static uint32_t sim_bma280_fifo_byte = 0;
+static bool sim_bma280_overrun = false;
+
+/* Interrupt pin held by the latch */
+static bool sim_bma280_int = false;
+
+/* Transaction state */
+static uint32_t sim_bma280_idx = 0;
+static uint8_t sim_bma280_addr;
+static bool sim_bma280_rd;
+
+static void _sim_bma280_pin(void) {
+	uint8_t *r = sim_bma280_reg;
+	bool fwm = (r[SIM_BMA280_INT_STATUS_1] & SIM_BMA280_FWM_INT) &&
+			(r[SIM_BMA280_INT_MAP_1] & SIM_BMA280_INT1_FWM);
+
+	sim_gpio_set_in(SIM_BMA280_INT_PORT, SIM_BMA280_INT_PIN,
+			sim_bma280_int || fwm);
+}
+
+/* Frame count, overrun and watermark into the status registers */
+static void _sim_bma280_fifo_status(void) {
+	uint8_t *r = sim_bma280_reg;
+	uint32_t wm = r[SIM_BMA280_FIFO_CONFIG_0] & SIM_BMA280_WM_MASK;
+
+	r[SIM_BMA280_FIFO_STATUS] = sim_bma280_fifo_num |
+			(sim_bma280_overrun ? SIM_BMA280_OVERRUN : 0);
+
+	if (wm && sim_bma280_fifo_num >= wm &&
+		(r[SIM_BMA280_INT_EN_1] & SIM_BMA280_FWM_EN)) {
+		r[SIM_BMA280_INT_STATUS_1] |= SIM_BMA280_FWM_INT;
+	} else {
+		r[SIM_BMA280_INT_STATUS_1] &= ~SIM_BMA280_FWM_INT;
+	}
+}
+
+static void _sim_bma280_fifo_clear(void) {
+	sim_bma280_fifo_first = 0;
+	sim_bma280_fifo_num = 0;
+	sim_bma280_fifo_byte = 0;
+	sim_bma280_overrun = false;
+	_sim_bma280_fifo_status();
+}
+
+/* Done with the oldest frame */
+static void _sim_bma280_fifo_pop(void) {
+	sim_bma280_fifo_first = (sim_bma280_fifo_first + 1) %
+			SIM_BMA280_FIFO_FRAMES;
+	sim_bma280_fifo_num--;
+	sim_bma280_fifo_byte = 0;
+	_sim_bma280_fifo_status();
+}
+
+/* One byte of FIFO_DATA, an empty FIFO reads zero */
+static uint8_t _sim_bma280_fifo_read(void) {
+	uint8_t v;
+
+	if (sim_bma280_fifo_num == 0) {
+		return 0;
+	}
+
+	v = sim_bma280_fifo[sim_bma280_fifo_first][sim_bma280_fifo_byte++];
+	if (sim_bma280_fifo_byte == SIM_BMA280_FRAME) {
+		_sim_bma280_fifo_pop();
+		_sim_bma280_pin();
+	}
+
+	return v;
+}
+
+/* Reset the interrupt, status and pin */
+static void _sim_bma280_unlatch(void) {
+	sim_evt_cancel(&sim_bma280_latch_evt);
+	sim_evt_cancel(&sim_bma280_tap_evt);
+	sim_bma280_reg[SIM_BMA280_INT_STATUS_0] &= ~SIM_BMA280_TAP_MASK;
+	sim_bma280_int = false;
+	_sim_bma280_pin();
+}
+
+static void _sim_bma280_latch_expire(sim_evt_t *evt) {
+	sim_bma280_int = false;
+	_sim_bma280_pin();
+}
+
+static void _sim_bma280_tap_expire(sim_evt_t *evt) {
+	sim_bma280_reg[SIM_BMA280_INT_STATUS_0] &= ~SIM_BMA280_TAP_MASK;
+}
+
+/* Register defaults, as after power up or a soft reset */
+static void _sim_bma280_defaults(void) {
+	memset(sim_bma280_reg, 0, sizeof(sim_bma280_reg));
+	sim_bma280_reg[SIM_BMA280_CHIPID] = 0xfb;
+	sim_bma280_reg[SIM_BMA280_PMU_RANGE] = 0x03;
+	sim_bma280_reg[SIM_BMA280_PMU_BW] = 0x0f;
+	sim_bma280_reg[SIM_BMA280_INT_8] = 0x04;
+	sim_bma280_reg[SIM_BMA280_INT_9] = 0x0a;
+	_sim_bma280_fifo_clear();
+	_sim_bma280_unlatch();
+}
+
+/* Frame at the output data rate, while the device is awake */
+static void _sim_bma280_odr(sim_evt_t *evt) {
+	uint8_t *r = sim_bma280_reg;
+	uint8_t mode = r[SIM_BMA280_FIFO_CONFIG_1] & SIM_BMA280_MODE_MASK;
+	uint32_t bw = r[SIM_BMA280_PMU_BW];
+	uint32_t depth = mode == SIM_BMA280_MODE_BYPASS ? 1 :
+			SIM_BMA280_FIFO_FRAMES;
+	uint32_t n;
+	int16_t xyz[3];
+	uint8_t *frame;
+
+	if (bw < SIM_BMA280_BW_MIN) {
+		bw = SIM_BMA280_BW_MIN;
+	} else if (bw > SIM_BMA280_BW_MAX) {
+		bw = SIM_BMA280_BW_MAX;
+	}
+	sim_evt_arm(evt, evt->due + (SIM_BMA280_ODR_NS >> (bw - SIM_BMA280_BW_MIN)));
+
+	if (sim_bma280_deep || sim_now() < sim_bma280_ready) {
+		return;
+	}
+
+	/* Frames are numbered whether they are kept or not */
+	n = sim_bma280_frames++;
+
+	if (sim_bma280_fifo_num == depth) {
+		sim_bma280_lost++;
+		if (mode != SIM_BMA280_MODE_BYPASS) {
+			sim_bma280_overrun = true;
+		}
+		if (mode == SIM_BMA280_MODE_FIFO) {
+			_sim_bma280_fifo_status();
+			return;
+		}
+		_sim_bma280_fifo_pop();
+	}
+
+	/* Left aligned, the low byte first */
+	sim_bma280_xyz(n, xyz);
+	frame = sim_bma280_fifo[(sim_bma280_fifo_first + sim_bma280_fifo_num) %
+			SIM_BMA280_FIFO_FRAMES];
+	for (int i = 0; i < 3; i++) {
+		uint16_t v = (uint16_t) xyz[i] << 2;
+
+		frame[2 * i] = (uint8_t) v;
+		frame[2 * i + 1] = (uint8_t) (v >> 8);
+	}
+	sim_bma280_fifo_num++;
+
+	_sim_bma280_fifo_status();
+	_sim_bma280_pin();
+}
+
+static uint8_t _sim_bma280_read(uint8_t addr) {
+	if (addr == SIM_BMA280_FIFO_DATA) {
+		return _sim_bma280_fifo_read();
+	}
+
+	return sim_bma280_reg[addr];
+}
+
+static void _sim_bma280_write(uint8_t addr, uint8_t v) {
+
+	/* Deep suspend only listens for the way out */
+	if (sim_bma280_deep && addr != SIM_BMA280_PMU_LPW &&
+		addr != SIM_BMA280_SOFTRESET) {
+		sim_bma280_errors++;
+		return;
+	}
+
+	switch (addr) {
+	case SIM_BMA280_SOFTRESET:
+		if (v == SIM_BMA280_RESET_CMD) {
+			_sim_bma280_defaults();
+			sim_bma280_deep = false;
+			sim_bma280_resets++;
+			sim_bma280_ready = sim_now() + SIM_BMA280_RESET_NS;
+		}
+		break;
+	case SIM_BMA280_PMU_LPW:
+		if (sim_bma280_deep && !(v & SIM_BMA280_DEEP_SUSPEND)) {
+			/* Nothing was kept */
+			_sim_bma280_defaults();
+		}
+		sim_bma280_deep = v & SIM_BMA280_DEEP_SUSPEND;
+		sim_bma280_reg[addr] = v;
+		if (sim_bma280_deep) {
+			_sim_bma280_unlatch();
+		}
+		break;
+	case SIM_BMA280_INT_RST_LATCH:
+		if (v & SIM_BMA280_RESET_INT) {
+			_sim_bma280_unlatch();
+		}
+		sim_bma280_reg[addr] = v & SIM_BMA280_LATCH_MASK;
+		break;
+	case SIM_BMA280_FIFO_CONFIG_1:
+		sim_bma280_reg[addr] = v;
+		sim_bma280_flushed += sim_bma280_fifo_num;
+		_sim_bma280_fifo_clear();
+		break;
+	default:
+		/* Data and status are read only */
+		if (addr > SIM_BMA280_FIFO_STATUS && addr != SIM_BMA280_FIFO_DATA) {
+			sim_bma280_reg[addr] = v;
+		}
+		_sim_bma280_fifo_status();
+		break;
+	}
+
+	_sim_bma280_pin();
+}
+
+/* One byte of a transaction */
+static uint8_t _sim_bma280_xfer(uint8_t mosi) {
+	uint32_t idx = sim_bma280_idx++;
+	uint8_t miso = 0xff;
+
+	if (sim_now() < sim_bma280_ready) {
+		sim_bma280_errors++;
+		return miso;
+	}
+
+	if (idx == 0) {
+		sim_bma280_rd = mosi & 0x80;
+		sim_bma280_addr = mosi & 0x3f;
+	} else if (sim_bma280_rd) {
+		miso = _sim_bma280_read(sim_bma280_addr);
+		if (sim_bma280_addr != SIM_BMA280_FIFO_DATA) {
+			sim_bma280_addr = (sim_bma280_addr + 1) & 0x3f;
+		}
+	} else if (idx & 1) {
+		_sim_bma280_write(sim_bma280_addr, mosi);
+	} else {
+		sim_bma280_addr = mosi & 0x3f;
+	}
+
+	return miso;
+}
+
+static void _sim_bma280_cs(bool level) {
+	if (level && sim_bma280_idx > 0) {
+		sim_bma280_xfers++;
+	}
+	if (level && sim_bma280_fifo_byte > 0) {
+		_sim_bma280_fifo_pop();
+		_sim_bma280_pin();
+	}
+	sim_bma280_idx = 0;
+}
+
+void sim_bma280_init(void) {
+	sim_evt_init(&sim_bma280_latch_evt, SIM_DOM_ULFRCO,
+			_sim_bma280_latch_expire, NULL);
+	sim_evt_init(&sim_bma280_tap_evt, SIM_DOM_ULFRCO,
+			_sim_bma280_tap_expire, NULL);
+	sim_evt_init(&sim_bma280_odr_evt, SIM_DOM_ULFRCO, _sim_bma280_odr, NULL);
+	_sim_bma280_defaults();
+	sim_bma280_deep = true;
+
+	sim_usart_attach(SIM_BMA280_CS_PORT, SIM_BMA280_CS_PIN, _sim_bma280_xfer);
+	sim_gpio_watch(SIM_BMA280_CS_PORT, SIM_BMA280_CS_PIN, _sim_bma280_cs);
+}
+
+bool sim_bma280_tap(uint8_t status) {
+	uint8_t *r = sim_bma280_reg;
+	uint64_t latch = sim_bma280_latch[r[SIM_BMA280_INT_RST_LATCH]];
+
+	if (sim_bma280_deep || sim_now() < sim_bma280_ready ||
+		!(r[SIM_BMA280_INT_EN_0] & status & SIM_BMA280_TAP_MASK)) {
+		return false;
+	}
+
+	r[SIM_BMA280_INT_STATUS_0] = (r[SIM_BMA280_INT_STATUS_0] &
+			~SIM_BMA280_TAP_MASK) | (status & SIM_BMA280_TAP_MASK);
+	sim_evt_arm(&sim_bma280_tap_evt, sim_dom_now(SIM_DOM_ULFRCO) +
+			sim_bma280_tap_dur[r[SIM_BMA280_INT_8] & SIM_BMA280_TAP_DUR_MASK]);
+
+	if (!(r[SIM_BMA280_INT_MAP_0] & status & SIM_BMA280_TAP_MASK)) {
+		return true;
+	}
+
+	sim_bma280_int = true;
+	_sim_bma280_pin();
+
+	if (latch == 0) {
+		/* A pulse, only the edge is seen */
+		sim_bma280_int = false;
+		_sim_bma280_pin();
+	} else if (latch != SIM_FOREVER) {
+		sim_evt_arm(&sim_bma280_latch_evt,
+				sim_dom_now(SIM_DOM_ULFRCO) + latch);
+	}
+
+	return true;
+}
+
+bool sim_bma280_suspended(void) {
+	return sim_bma280_deep;
+}
+
+void sim_bma280_stream(bool on) {
+	if (on) {
+		sim_evt_arm(&sim_bma280_odr_evt, sim_dom_now(SIM_DOM_ULFRCO));
+	} else {
+		sim_evt_cancel(&sim_bma280_odr_evt);
+	}
+}
+
+void sim_bma280_xyz(uint32_t n, int16_t xyz[3]) {
+	/* Every axis changes with each frame, wrapping in 14 bits */
+	xyz[0] = (int16_t) (n << 2) >> 2;
+	xyz[1] = ~xyz[0];
+	xyz[2] = (int16_t) ((n * 7) << 2) >> 2;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file sim_bma280.h
+ * @brief Model of the BMA280 accelerometer on the SPI bus
+ *
+ * This file models the BMA280 registers as seen over SPI. Reads increment
+ * the address after each byte except at the FIFO data register, writes take
+ * address and data pairs. A soft reset restores the register defaults and
+ * the device ignores the bus for 1.8 ms after it. Taps are injected by the
+ * test. A tap sets its INT_STATUS_0 bit for the tap duration of INT_8,
+ * replacing the other tap type, and holds the interrupt pin for the latch
+ * time of INT_RST_LATCH if it is mapped there.
+ *
+ * Once the test starts the data stream, a frame is taken at the output data
+ * rate of PMU_BW, twice the bandwidth, into the 32 frame FIFO. Frame n holds
+ * the sample of sim_bma280_xyz(). FIFO_STATUS gives the frame count and the
+ * overrun flag, which stays set until FIFO_CONFIG_1 is written. Writing
+ * FIFO_CONFIG_1 also empties the FIFO. Stream mode drops the oldest frame
+ * when full, FIFO mode the newest and bypass mode keeps one frame. Reads of
+ * FIFO_DATA take the frames in order, a frame partly read when the chip
+ * select is released is gone. The watermark interrupt is not latched, it is
+ * set while the frame count is at or above the watermark of FIFO_CONFIG_0
+ * and drives the interrupt pin along with a tap if mapped there.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __SIM_BMA280_H__
+#define __SIM_BMA280_H__
+
+#include "sim.h"
+
+#define SIM_BMA280_REGS 64
+
+/* Time the device needs after a soft reset */
+#define SIM_BMA280_RESET_NS SIM_US(1800)
+
+/* Register contents */
+extern uint8_t sim_bma280_reg[SIM_BMA280_REGS];
+
+/* Soft resets seen */
+extern uint32_t sim_bma280_resets;
+
+/* Accesses the device would have missed, during a reset or in deep suspend */
+extern uint32_t sim_bma280_errors;
+
+/* Transactions seen, one per chip select */
+extern uint32_t sim_bma280_xfers;
+
+/* Frames taken, those lost to a full FIFO and those emptied by a write to
+ * FIFO_CONFIG_1 */
+extern uint32_t sim_bma280_frames;
+extern uint32_t sim_bma280_lost;
+extern uint32_t sim_bma280_flushed;
+
+/**
+ * @brief Put the BMA280 on the bus
+ *
+ * The device is attached to USART1 with its chip select on PC9 and its
+ * interrupt on PD11, and comes up in deep suspend like after the firmware
+ * put it there.
+ *
+ * @return Void
+ */
+void sim_bma280_init(void);
+
+/**
+ * @brief Tap the device
+ *
+ * @param status BMA280_INT_STATUS_0_S_TAP_INT or BMA280_INT_STATUS_0_D_TAP_INT
+ *
+ * @return True if the tap interrupt is enabled and the status was set
+ */
+bool sim_bma280_tap(uint8_t status);
+
+/**
+ * @brief Check the power mode
+ *
+ * @return True while the device is in deep suspend
+ */
+bool sim_bma280_suspended(void);
+
+/**
+ * @brief Start or stop the data stream
+ *
+ * @param on True to take frames at the output data rate
+ *
+ * @return Void
+ */
+void sim_bma280_stream(bool on);
+
+/**
+ * @brief Sample of a frame
+ *
+ * @param n Frame number, counted from the first frame of the run
+ * @param xyz The three axes, 14 bit signed counts
+ *
+ * @return Void
+ */
+void sim_bma280_xyz(uint32_t n, int16_t xyz[3]);
+
+#endif /* __SIM_BMA280_H__ */
@@ -0,0 +1,167 @@
+/**
+ * @file slp_em4_test.c
+ * @brief Host test for EM4 entry and the retained snapshot
+ *
+ * This test checks the snapshot encoding and its corruption checks, enters
+ * EM4 through slp_sleep() with nothing blocked, checks the retention
+ * registers and wakeup sources it leaves behind, and restores the snapshot
+ * after a simulated EM4 reset exactly once.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include <string.h>
+#include "test.h"
+#include "slp.h"
+#include "cmu.h"
+#include "em_device.h"
+#include "em_rtcc.h"
+#include "em_rmu.h"
+#include "em_gpio.h"
+#include "em_cryotimer.h"
+
+static const slp_retain_t test_state = {
+	.letimer_ontime = -123456,
+	.bma280_enabled = true,
+	.led1 = false,
+};
+
+static uint32_t test_saves = 0;
+
+void CRYOTIMER_IRQHandler(void) {
+	CRYOTIMER_IntClear(CRYOTIMER_IF_PERIOD);
+}
+
+static void _test_save(slp_retain_t *state) {
+	*state = test_state;
+	test_saves++;
+}
+
+static bool _test_equal(const slp_retain_t *a, const slp_retain_t *b) {
+	return a->letimer_ontime == b->letimer_ontime &&
+		a->bma280_enabled == b->bma280_enabled &&
+		a->led1 == b->led1;
+}
+
+static void _test_pack(void) {
+	uint32_t words[SLP_RETAIN_WORDS];
+	uint32_t bad[SLP_RETAIN_WORDS];
+	slp_retain_t state;
+	slp_retain_t out;
+	int32_t ontimes[] = { 0, 1, 20, -1, INT32_MAX, INT32_MIN };
+
+	/* Every combination survives the round trip */
+	for (unsigned i = 0; i < sizeof(ontimes) / sizeof(ontimes[0]); i++) {
+		for (int flags = 0; flags < 4; flags++) {
+			state.letimer_ontime = ontimes[i];
+			state.bma280_enabled = flags & 1;
+			state.led1 = flags & 2;
+			slp_em4_pack(&state, words);
+			CHECK(slp_em4_unpack(words, &out));
+			CHECK(_test_equal(&state, &out));
+		}
+	}
+
+	/* Any single flipped bit is caught */
+	slp_em4_pack(&test_state, words);
+	for (int w = 0; w < SLP_RETAIN_WORDS; w++) {
+		for (int b = 0; b < 32; b++) {
+			memcpy(bad, words, sizeof(bad));
+			bad[w] ^= 1u << b;
+			CHECK(!slp_em4_unpack(bad, &out));
+		}
+	}
+
+	/* Cleared retention memory is not a snapshot */
+	memset(bad, 0, sizeof(bad));
+	CHECK(!slp_em4_unpack(bad, &out));
+}
+
+static void _test_sleep(void) {
+	CORE_ATOMIC_IRQ_DISABLE();
+	slp_sleep();
+	CORE_ATOMIC_IRQ_ENABLE();
+}
+
+static void _test_em4(void) {
+	jmp_buf env;
+	uint32_t words[SLP_RETAIN_WORDS];
+	slp_retain_t out;
+
+	/* No handler, EM3 instead */
+	_test_sleep();
+	CHECK(sim_stats.sleeps[4] == 0);
+	CHECK(sim_stats.sleeps[3] == 1);
+
+	slp_em4_setHandler(_test_save);
+
+	/* EM3 blocked, as in the shipped configuration */
+	slp_blockSleepMode(EM3);
+	_test_sleep();
+	CHECK(sim_stats.sleeps[4] == 0);
+	CHECK(test_saves == 0);
+	slp_unblockSleepMode(EM3);
+
+	/* Nothing blocked */
+	sim_em4_env = &env;
+	if (setjmp(env) == 0) {
+		_test_sleep();
+		CHECK(false);
+	}
+	sim_em4_env = NULL;
+
+	/* The core comes back through reset */
+	sim_primask = 0;
+
+	CHECK(sim_stats.sleeps[4] == 1);
+	CHECK(test_saves == 1);
+
+	for (int i = 0; i < SLP_RETAIN_WORDS; i++) {
+		words[i] = RTCC->RET[i].REG;
+	}
+	CHECK(slp_em4_unpack(words, &out));
+	CHECK(_test_equal(&out, &test_state));
+
+	/* Both wakeup sources armed */
+	CHECK(sim_cryo_period == SLP_EM4_CRYO_PERIOD);
+	CHECK(sim_cryo_em4wu);
+	CHECK(sim_gpio_mode[SLP_EM4_WU_PORT][SLP_EM4_WU_PIN] ==
+			gpioModeInputPullFilter);
+	CHECK(sim_gpio_out[SLP_EM4_WU_PORT][SLP_EM4_WU_PIN]);
+	CHECK(sim_gpio_em4wu & SLP_EM4_WU_MASK);
+}
+
+static void _test_restore(void) {
+	slp_retain_t out;
+
+	/* Warm start restores once */
+	sim_rmu_cause = RMU_RSTCAUSE_EM4RST;
+	CHECK(slp_em4_restore(&out));
+	CHECK(_test_equal(&out, &test_state));
+	CHECK(sim_rmu_cause == 0);
+
+	sim_rmu_cause = RMU_RSTCAUSE_EM4RST;
+	CHECK(!slp_em4_restore(&out));
+
+	/* A cold start ignores whatever is in retention memory */
+	slp_em4_pack(&test_state, (uint32_t *) RTCC->RET);
+	sim_rmu_cause = 0;
+	CHECK(!slp_em4_restore(&out));
+}
+
+int main(void) {
+	cmu_init();
+	slp_init();
+
+	CRYOTIMER_PeriodSet(cryotimerPeriod_32);
+	CRYOTIMER_IntEnable(CRYOTIMER_IEN_PERIOD);
+	NVIC_EnableIRQ(CRYOTIMER_IRQn);
+
+	_test_pack();
+	_test_em4();
+	_test_restore();
+
+	return test_result("slp_em4_test");
+}
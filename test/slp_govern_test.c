@@ -0,0 +1,208 @@
+/**
+ * @file slp_govern_test.c
+ * @brief Host simulation of the sleep governor
+ *
+ * This test replays wake traces (idle windows between wakeups) through
+ * slp_govern() and through the old always-deepest policy, charging each
+ * window from the slp_cost table, and compares the average current. A
+ * window shorter than the latency of the chosen mode wakes up late and the
+ * difference is charged at the EM0 current. It also checks that slp_sleep()
+ * asks the registered wake sources.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "test.h"
+#include "../slp.c"
+
+/* Windows per generated trace */
+#define TEST_WINDOWS 100000
+
+/*
+ * @brief Wake trace, idle windows in us
+ */
+typedef struct test_trace_s {
+	const char *name;
+	slp_em_t deepest;
+	uint32_t *us;
+	uint32_t len;
+} test_trace_t;
+
+/*
+ * @brief Outcome of a policy over a trace
+ */
+typedef struct test_result_s {
+	double charge_pC;
+	double time_us;
+	uint32_t late;
+	uint32_t chosen[SLP_NUM_EM];
+} test_result_t;
+
+static uint32_t test_next_us = SLP_WAKE_NONE;
+
+void CRYOTIMER_IRQHandler(void) {
+	CRYOTIMER_IntClear(CRYOTIMER_IF_PERIOD);
+}
+
+static uint32_t _test_wake_source(void) {
+	return test_next_us;
+}
+
+static slp_em_t _test_deepest(slp_em_t deepest, uint32_t next_us) {
+	(void) next_us;
+
+	return deepest;
+}
+
+static void _test_run(const test_trace_t *trace,
+		slp_em_t (*policy)(slp_em_t, uint32_t), test_result_t *res) {
+	slp_em_t em;
+	uint32_t us;
+
+	*res = (test_result_t) {0};
+
+	for (uint32_t i = 0; i < trace->len; i++) {
+		us = trace->us[i];
+		em = policy(trace->deepest, us);
+		res->chosen[em]++;
+		res->charge_pC += (double) slp_cost[em].transition_nC * 1000 +
+				(double) slp_cost[em].current_nA * us / 1000;
+		res->time_us += us;
+
+		if (slp_cost[em].latency_us > us) {
+			res->late++;
+			res->charge_pC += (double) slp_cost[EM0].current_nA *
+					(slp_cost[em].latency_us - us) / 1000;
+			res->time_us += slp_cost[em].latency_us - us;
+		}
+	}
+}
+
+static void _test_compare(const test_trace_t *trace) {
+	test_result_t gov;
+	test_result_t deep;
+
+	_test_run(trace, slp_govern, &gov);
+	_test_run(trace, _test_deepest, &deep);
+
+	printf("  %-26s %6.2f uA governed (EM1/2/3 %u/%u/%u), %6.2f uA deepest "
+			"(%u late)\n", trace->name, gov.charge_pC / gov.time_us,
+			gov.chosen[EM1], gov.chosen[EM2], gov.chosen[EM3],
+			deep.charge_pC / deep.time_us, deep.late);
+
+	/* Never worse, never late */
+	CHECK(gov.charge_pC <= deep.charge_pC);
+	CHECK(gov.late == 0);
+}
+
+/* Log-uniform window between lo and hi us */
+static uint32_t _test_log_uniform(uint32_t lo, uint32_t hi) {
+	double r = (double) rand() / RAND_MAX;
+
+	return (uint32_t) exp(log(lo) + r * (log(hi) - log(lo)));
+}
+
+static void _test_traces(void) {
+	static uint32_t spi[TEST_WINDOWS];
+	static uint32_t letimer[TEST_WINDOWS];
+	static uint32_t adc[TEST_WINDOWS];
+	static uint32_t mixed[TEST_WINDOWS];
+	uint32_t n;
+
+	srand(4);
+
+	/* Tap bursts, a 16 byte transfer at 1 MHz split into descriptor
+	 * completions every few us, then the next tap */
+	for (n = 0; n < TEST_WINDOWS; n++) {
+		spi[n] = (n % 17 == 16) ? _test_log_uniform(2000, 500000) :
+				2 + rand() % 8;
+	}
+
+	/* LED0 on for 20 ms every 1.75 s */
+	for (n = 0; n < TEST_WINDOWS; n++) {
+		letimer[n] = (n & 1) ? 20000 : 1730000;
+	}
+
+	/* Joystick held, a conversion every 8 ms with LDMA wakeups in between */
+	for (n = 0; n < TEST_WINDOWS; n++) {
+		adc[n] = (n % 3 == 2) ? 8000 - 60 : 30;
+	}
+
+	/* Everything at once */
+	for (n = 0; n < TEST_WINDOWS; n++) {
+		mixed[n] = _test_log_uniform(1, 2000000);
+	}
+
+	test_trace_t traces[] = {
+		{ "BMA280 tap bursts (EM3)", EM3, spi, TEST_WINDOWS },
+		{ "BMA280 tap bursts (EM2)", EM2, spi, TEST_WINDOWS },
+		{ "LETIMER blink (EM3)", EM3, letimer, TEST_WINDOWS },
+		{ "joystick held (EM2)", EM2, adc, TEST_WINDOWS },
+		{ "log-uniform 1us-2s (EM3)", EM3, mixed, TEST_WINDOWS },
+	};
+
+	printf("slp_govern_test: average current per trace\n");
+	for (n = 0; n < sizeof(traces) / sizeof(traces[0]); n++) {
+		_test_compare(&traces[n]);
+	}
+}
+
+/* Break-even points of the cost table */
+static void _test_govern(void) {
+	CHECK(slp_govern(EM3, SLP_WAKE_NONE) == EM3);
+	CHECK(slp_govern(EM2, SLP_WAKE_NONE) == EM2);
+	CHECK(slp_govern(EM1, 1000000) == EM1);
+	CHECK(slp_govern(EM3, 0) == EM1);
+	CHECK(slp_govern(EM3, 10) == EM1);
+	CHECK(slp_govern(EM3, 30) == EM2);
+
+	/* EM3 draws less than EM2 but costs more to enter, so it only wins
+	 * past about 2 ms */
+	CHECK(slp_govern(EM3, 1000) == EM2);
+	CHECK(slp_govern(EM3, 10000) == EM3);
+
+	/* Deeper modes are only picked once they are cheaper */
+	for (uint32_t us = 0; us < 100000; us += 7) {
+		slp_em_t em = slp_govern(EM3, us);
+		CHECK(em == EM1 || us >= slp_cost[em].latency_us);
+	}
+}
+
+/* slp_sleep() goes through the wake sources and the governor */
+static void _test_sleep(void) {
+	uint32_t em1 = sim_stats.sleeps[1];
+	uint32_t em3 = sim_stats.sleeps[3];
+
+	CHECK(slp_registerWakeSource(_test_wake_source));
+
+	test_next_us = 5;
+	CORE_ATOMIC_IRQ_DISABLE();
+	slp_sleep();
+	CORE_ATOMIC_IRQ_ENABLE();
+	CHECK(sim_stats.sleeps[1] == em1 + 1);
+
+	test_next_us = SLP_WAKE_NONE;
+	CORE_ATOMIC_IRQ_DISABLE();
+	slp_sleep();
+	CORE_ATOMIC_IRQ_ENABLE();
+	CHECK(sim_stats.sleeps[3] == em3 + 1);
+}
+
+int main(void) {
+	cmu_init();
+	slp_init();
+
+	CRYOTIMER_PeriodSet(cryotimerPeriod_32);
+	CRYOTIMER_IntEnable(CRYOTIMER_IEN_PERIOD);
+	NVIC_EnableIRQ(CRYOTIMER_IRQn);
+
+	_test_govern();
+	_test_sleep();
+	_test_traces();
+
+	return test_result("slp_govern_test");
+}
@@ -0,0 +1,196 @@
+/**
+ * @file slp_mask_test.c
+ * @brief Host test for the sleep mask and the suspend/resume hooks
+ *
+ * This test checks the mask lookup against the if/else cascade it replaced
+ * over random block/unblock sequences, checks the order and masking of the
+ * suspend/resume hooks, and benchmarks both lookups.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "../slp.c"
+
+/* Random block/unblock steps */
+#define TEST_STEPS 100000
+
+/* Lookups per benchmark */
+#define TEST_BENCH 10000000
+
+static volatile uint32_t test_sink;
+
+/* Hook calls, one character each */
+static char test_log[64];
+static int test_log_len = 0;
+static bool test_masked = true;
+
+void CRYOTIMER_IRQHandler(void) {
+	CRYOTIMER_IntClear(CRYOTIMER_IF_PERIOD);
+}
+
+/* The cascade slp_sleep() used before the mask, over the same counters */
+static slp_em_t _test_cascade(void) {
+	if (slp_state[EM0] > 0) {
+		return EM0;
+	} else if (slp_state[EM1] > 0) {
+		return EM1;
+	} else if (slp_state[EM2] > 0) {
+		return EM2;
+	} else if (slp_state[EM3] > 0) {
+		return EM3;
+	} else {
+		return EM3;
+	}
+}
+
+/* The mask lookup the way slp_sleep() uses it without an EM4 handler */
+static slp_em_t _test_lowest(void) {
+	slp_em_t em = _slp_lowest();
+
+	return em == EM4 ? EM3 : em;
+}
+
+static void _test_hook(char c) {
+	if (test_log_len < (int) sizeof(test_log) - 1) {
+		test_log[test_log_len++] = c;
+	}
+	if (!sim_primask) {
+		test_masked = false;
+	}
+}
+
+static void _test_suspend1(slp_em_t em) { (void) em; _test_hook('a'); }
+static void _test_resume1(slp_em_t em) { (void) em; _test_hook('A'); }
+static void _test_suspend2(slp_em_t em) { (void) em; _test_hook('b'); }
+static void _test_resume2(slp_em_t em) { (void) em; _test_hook('B'); }
+static void _test_suspend3(slp_em_t em) { (void) em; _test_hook('c'); }
+static void _test_resume3(slp_em_t em) { (void) em; _test_hook('C'); }
+
+static void _test_sleep(void) {
+	test_log_len = 0;
+	test_log[0] = '\0';
+
+	CORE_ATOMIC_IRQ_DISABLE();
+	slp_sleep();
+	CORE_ATOMIC_IRQ_ENABLE();
+
+	test_log[test_log_len] = '\0';
+}
+
+static void _test_random(void) {
+	uint32_t held[SLP_NUM_EM] = {0};
+	int em;
+
+	srand(1);
+	for (int i = 0; i < TEST_STEPS; i++) {
+		em = rand() % SLP_NUM_EM;
+
+		/* Unblock more often than not when held, including a few extra
+		 * unblocks that must be ignored */
+		if (rand() % 3 == 0) {
+			slp_blockSleepMode((slp_em_t) em);
+			held[em]++;
+		} else {
+			slp_unblockSleepMode((slp_em_t) em);
+			if (held[em] > 0) {
+				held[em]--;
+			}
+		}
+
+		for (int j = 0; j < SLP_NUM_EM; j++) {
+			CHECK(slp_state[j] == held[j]);
+			CHECK(((slp_mask >> j) & 1) == (held[j] > 0));
+		}
+		CHECK(_test_lowest() == _test_cascade());
+	}
+
+	for (em = 0; em < SLP_NUM_EM; em++) {
+		while (held[em]--) {
+			slp_unblockSleepMode((slp_em_t) em);
+		}
+	}
+	CHECK(slp_mask == 0);
+}
+
+static void _test_hooks(void) {
+	CHECK(slp_registerHook(EM1, _test_suspend1, _test_resume1));
+	CHECK(slp_registerHook(EM2, _test_suspend2, _test_resume2));
+	CHECK(slp_registerHook(EM3, _test_suspend3, _test_resume3));
+
+	/* Hooks run for modes at or below their minimum, resume in reverse */
+	slp_blockSleepMode(EM1);
+	_test_sleep();
+	CHECK(strcmp(test_log, "aA") == 0);
+	slp_unblockSleepMode(EM1);
+
+	slp_blockSleepMode(EM2);
+	_test_sleep();
+	CHECK(strcmp(test_log, "abBA") == 0);
+	slp_unblockSleepMode(EM2);
+
+	_test_sleep();
+	CHECK(strcmp(test_log, "abcCBA") == 0);
+
+	/* Nothing runs when the core stays awake */
+	slp_blockSleepMode(EM0);
+	_test_sleep();
+	CHECK(test_log_len == 0);
+	slp_unblockSleepMode(EM0);
+
+	CHECK(test_masked);
+
+	/* NULL callbacks are skipped, the registry is bounded */
+	for (int i = 3; i < SLP_MAX_HOOKS; i++) {
+		CHECK(slp_registerHook(EM1, NULL, NULL));
+	}
+	CHECK(!slp_registerHook(EM1, NULL, NULL));
+	_test_sleep();
+	CHECK(strcmp(test_log, "abcCBA") == 0);
+}
+
+/* Host time of a lookup with the current blockers */
+static void _test_bench(const char *name) {
+	uint64_t t0;
+	double cascade;
+	double lowest;
+
+	t0 = test_ns();
+	for (uint32_t i = 0; i < TEST_BENCH; i++) {
+		test_sink = _test_cascade();
+	}
+	cascade = (double) (test_ns() - t0) / TEST_BENCH;
+
+	t0 = test_ns();
+	for (uint32_t i = 0; i < TEST_BENCH; i++) {
+		test_sink = _test_lowest();
+	}
+	lowest = (double) (test_ns() - t0) / TEST_BENCH;
+
+	printf("slp_mask_test: %s, lookup %.2f host ns with the mask, %.2f with "
+			"the cascade\n", name, lowest, cascade);
+}
+
+int main(void) {
+	cmu_init();
+	slp_init();
+
+	CRYOTIMER_PeriodSet(cryotimerPeriod_32);
+	CRYOTIMER_IntEnable(CRYOTIMER_IEN_PERIOD);
+	NVIC_EnableIRQ(CRYOTIMER_IRQn);
+
+	_test_random();
+	_test_hooks();
+
+	/* Best case for the cascade, then the worst */
+	slp_blockSleepMode(EM1);
+	_test_bench("EM1 blocked");
+	slp_unblockSleepMode(EM1);
+	_test_bench("nothing blocked");
+
+	return test_result("slp_mask_test");
+}
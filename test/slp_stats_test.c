@@ -0,0 +1,162 @@
+/**
+ * @file slp_stats_test.c
+ * @brief Host test for the sleep residency statistics
+ *
+ * This test sleeps in each energy mode with the CRYOTIMER period interrupt
+ * as the only wakeup and compares slp_get_stats() to the time the
+ * simulation actually spent in each mode, across a counter wrap. It also
+ * reports the host time of one slp_sleep() call.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "test.h"
+#include "slp.h"
+#include "cmu.h"
+#include "em_device.h"
+#include "em_rtcc.h"
+#include "em_cryotimer.h"
+
+/* Wakeup period of the test, 32 sleep clock ticks */
+#define TEST_PERIOD cryotimerPeriod_32
+
+/* Work done after each wakeup */
+#define TEST_WORK 1000
+
+/* Simulated time spent in each mode in the current run */
+static uint64_t test_base[SLP_NUM_EM];
+
+void CRYOTIMER_IRQHandler(void) {
+	CRYOTIMER_IntClear(CRYOTIMER_IF_PERIOD);
+}
+
+/* Sleep the way the main loop does, then do some work */
+static void _test_loop(uint64_t until) {
+	while (sim_now() < until) {
+		CORE_ATOMIC_IRQ_DISABLE();
+		slp_sleep();
+		CORE_ATOMIC_IRQ_ENABLE();
+		sim_cpu(TEST_WORK);
+	}
+}
+
+static void _test_mark(void) {
+	for (int em = 0; em < SLP_NUM_EM; em++) {
+		test_base[em] = sim_stats.ns[em];
+	}
+}
+
+/* Every accounted interval is a difference of two counter readings and is
+ * off by less than a tick */
+static void _test_compare(const slp_stats_t *stats) {
+	uint64_t truth;
+	uint64_t slack;
+
+	for (int em = EM0; em <= EM3; em++) {
+		truth = (sim_stats.ns[em] - test_base[em]) * SLP_CLK_FREQ / SIM_S(1);
+		slack = stats->count[em] + 1;
+		printf("  EM%d: %10u ticks (truth %10llu) %8u entries\n", em,
+				stats->ticks[em], (unsigned long long) truth, stats->count[em]);
+		CHECK(stats->ticks[em] + slack >= truth);
+		CHECK(stats->ticks[em] <= truth + slack);
+	}
+}
+
+static uint32_t _test_sum(const slp_stats_t *stats) {
+	uint32_t sum = 0;
+
+	for (int em = 0; em < SLP_NUM_EM; em++) {
+		sum += stats->ticks[em];
+	}
+
+	return sum;
+}
+
+int main(void) {
+	slp_stats_t stats;
+	uint32_t start;
+	uint32_t rtcc;
+	uint64_t t0;
+	uint32_t n;
+
+	/* Wrap the sleep clock a quarter second in */
+	sim_cryo_base = 0xffffff00;
+
+	cmu_init();
+	slp_init();
+	start = slp_now();
+	_test_mark();
+
+	CRYOTIMER_PeriodSet(TEST_PERIOD);
+	CRYOTIMER_IntClear(CRYOTIMER_IF_PERIOD);
+	CRYOTIMER_IntEnable(CRYOTIMER_IEN_PERIOD);
+	NVIC_EnableIRQ(CRYOTIMER_IRQn);
+
+	/* Nothing blocked, EM3 */
+	_test_loop(SIM_S(1));
+
+	/* EM3 stops the LFXO and the RTCC with it, the CRYOTIMER keeps going */
+	rtcc = RTCC_CounterGet();
+	n = slp_now();
+	CORE_ATOMIC_IRQ_DISABLE();
+	slp_sleep();
+	CORE_ATOMIC_IRQ_ENABLE();
+	CHECK(RTCC_CounterGet() == rtcc);
+	CHECK(slp_now() != n);
+
+	/* One second each in EM2 and EM1 */
+	slp_blockSleepMode(EM2);
+	_test_loop(SIM_S(2));
+	slp_blockSleepMode(EM1);
+	_test_loop(SIM_S(3));
+	slp_unblockSleepMode(EM1);
+	slp_unblockSleepMode(EM2);
+
+	/* One second awake */
+	sim_cpu(SIM_HF_FREQ);
+
+	printf("slp_stats_test: residency after a counter wrap\n");
+	slp_get_stats(&stats);
+	CHECK(slp_now() < start);
+	CHECK(_test_sum(&stats) == slp_now() - start);
+	CHECK(stats.count[EM4] == 0);
+	CHECK(stats.count[EM3] > 0 && stats.count[EM2] > 0 && stats.count[EM1] > 0);
+	CHECK(stats.count[EM0] == stats.count[EM1] + stats.count[EM2] +
+			stats.count[EM3]);
+	_test_compare(&stats);
+
+	/* Clear restarts accounting from now */
+	slp_clear_stats();
+	_test_mark();
+	start = slp_now();
+	slp_get_stats(&stats);
+	CHECK(_test_sum(&stats) == 0);
+	for (int em = 0; em < SLP_NUM_EM; em++) {
+		CHECK(stats.count[em] == 0);
+	}
+
+	slp_blockSleepMode(EM2);
+	_test_loop(SIM_S(5));
+	slp_unblockSleepMode(EM2);
+
+	printf("slp_stats_test: residency after clear\n");
+	slp_get_stats(&stats);
+	CHECK(_test_sum(&stats) == slp_now() - start);
+	CHECK(stats.count[EM3] == 0 && stats.count[EM1] == 0);
+	_test_compare(&stats);
+
+	/* Host cost of a sleep with accounting, the simulation included */
+	n = 100000;
+	t0 = test_ns();
+	for (uint32_t i = 0; i < n; i++) {
+		CORE_ATOMIC_IRQ_DISABLE();
+		slp_sleep();
+		CORE_ATOMIC_IRQ_ENABLE();
+	}
+	printf("slp_stats_test: %.1f host ns per slp_sleep()\n",
+			(double) (test_ns() - t0) / n);
+
+	return test_result("slp_stats_test");
+}
@@ -0,0 +1,277 @@
+/**
+ * @file spi_test.c
+ * @brief Host test and benchmark for the queued SPI driver
+ *
+ * This test puts two devices with their own chip selects on the simulated
+ * USART1 and LDMA. It checks that queued transfers run in order with only
+ * their own device selected, what each device saw and sent back, that the
+ * callbacks run after the chip select is released and may queue more, and
+ * that bad submissions are refused. It then times transfers of several
+ * lengths and reports the core's time asleep in EM1, the wakeups and the
+ * host time spent queueing. With the old busy-wait, the core was in EM0
+ * for the whole bus time.
+ *
+ * @date October 17 2026
+ * @version 1.0
+ *
+ */
+
+#include <string.h>
+#include "test.h"
+#include "spi.h"
+#include "dma.h"
+#include "slp.h"
+#include "cmu.h"
+#include "em_device.h"
+
+/* Devices on the bus */
+#define TEST_DEVS 2
+
+/* Transfers kept in the log */
+#define TEST_LOG 16
+
+/* Transfers of each length in the benchmark */
+#define TEST_ROUNDS 20
+
+/* EM0 and EM1 currents, as in slp.c */
+#define TEST_EM0_NA 1200000
+#define TEST_EM1_NA 700000
+
+/*
+ * @brief A device and what it saw of the current transaction
+ */
+typedef struct test_dev_s {
+	spi_dev_t spi;
+	uint8_t tag;
+	uint8_t seen[SPI_MAX_LEN * 2];
+	uint32_t n;
+	uint32_t xfers;
+} test_dev_t;
+
+static test_dev_t test_devs[TEST_DEVS] = {
+	{ .spi = { gpioPortC, 6 }, .tag = 0xa0 },
+	{ .spi = { gpioPortD, 13 }, .tag = 0x50 },
+};
+
+/* Device of each finished transaction and its length */
+static uint32_t test_log_dev[TEST_LOG];
+static uint32_t test_log_len[TEST_LOG];
+static uint32_t test_log_n = 0;
+
+/* Callbacks run, in order, and whether the chip select was released */
+static spi_xfer_t *test_done[TEST_LOG];
+static uint32_t test_done_n = 0;
+static bool test_cs_held = false;
+
+/* Sent back by a device for the byte at an index */
+static uint8_t _test_miso(const test_dev_t *dev, uint32_t idx) {
+	return dev->tag ^ (uint8_t) idx;
+}
+
+static uint8_t _test_xfer(test_dev_t *dev, uint8_t mosi) {
+	uint32_t idx = dev->n++;
+
+	dev->seen[idx % sizeof(dev->seen)] = mosi;
+
+	return _test_miso(dev, idx);
+}
+
+static void _test_cs(test_dev_t *dev, bool level) {
+	if (!level) {
+		dev->n = 0;
+		return;
+	}
+
+	dev->xfers++;
+	if (test_log_n < TEST_LOG) {
+		test_log_dev[test_log_n] = dev - test_devs;
+		test_log_len[test_log_n] = dev->n;
+		test_log_n++;
+	}
+}
+
+static uint8_t _test_xfer0(uint8_t mosi) { return _test_xfer(&test_devs[0], mosi); }
+static uint8_t _test_xfer1(uint8_t mosi) { return _test_xfer(&test_devs[1], mosi); }
+static void _test_cs0(bool level) { _test_cs(&test_devs[0], level); }
+static void _test_cs1(bool level) { _test_cs(&test_devs[1], level); }
+
+static void _test_done(spi_xfer_t *xfer) {
+	const spi_dev_t *dev = xfer->dev;
+
+	if (!GPIO_PinOutGet(dev->port, dev->pin)) {
+		test_cs_held = true;
+	}
+	if (test_done_n < TEST_LOG) {
+		test_done[test_done_n++] = xfer;
+	}
+}
+
+/* Queues the transfer in arg from the callback */
+static void _test_chain(spi_xfer_t *xfer) {
+	_test_done(xfer);
+	CHECK(spi_submit(xfer->arg));
+}
+
+static void _test_reset(void) {
+	test_log_n = 0;
+	test_done_n = 0;
+	test_cs_held = false;
+}
+
+/* Received bytes are what the device sent after the transmit phase */
+static bool _test_rx_ok(const test_dev_t *dev, const spi_xfer_t *xfer) {
+	for (uint32_t i = 0; i < xfer->rx_len; i++) {
+		if (xfer->rx[i] != _test_miso(dev, xfer->tx_len + i)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Three queued at once, with both phases, transmit only and receive only */
+static void _test_queue(void) {
+	static const uint8_t cmd[] = { 0x82, 0x11, 0x22 };
+	uint8_t rx0[4];
+	uint8_t rx1[5];
+	spi_xfer_t a = {
+		.dev = &test_devs[0].spi, .tx = cmd, .tx_len = 1, .rx = rx0,
+		.rx_len = sizeof(rx0), .done = _test_done,
+	};
+	spi_xfer_t b = {
+		.dev = &test_devs[1].spi, .tx = cmd, .tx_len = sizeof(cmd),
+		.done = _test_done,
+	};
+	spi_xfer_t c = {
+		.dev = &test_devs[0].spi, .rx = rx1, .rx_len = sizeof(rx1),
+		.done = _test_done,
+	};
+
+	_test_reset();
+	CHECK(spi_submit(&a));
+	CHECK(spi_submit(&b));
+	CHECK(spi_submit(&c));
+
+	/* Already queued */
+	CHECK(!spi_submit(&b));
+	CHECK(spi_busy(&a) && spi_busy(&b) && spi_busy(&c));
+
+	spi_wait(&c);
+	CHECK(!spi_busy(&a) && !spi_busy(&b));
+	CHECK(_test_rx_ok(&test_devs[0], &a));
+
+	/* In order, one device at a time */
+	CHECK(test_log_n == 3);
+	CHECK(test_log_dev[0] == 0 && test_log_len[0] == 1 + sizeof(rx0));
+	CHECK(test_log_dev[1] == 1 && test_log_len[1] == sizeof(cmd));
+	CHECK(test_log_dev[2] == 0 && test_log_len[2] == sizeof(rx1));
+	CHECK(test_done_n == 3 && test_done[0] == &a && test_done[1] == &b &&
+			test_done[2] == &c);
+	CHECK(!test_cs_held);
+
+	/* Zeros go out while receiving */
+	CHECK(memcmp(test_devs[1].seen, cmd, sizeof(cmd)) == 0);
+	CHECK(test_devs[0].seen[0] == 0 && test_devs[0].seen[4] == 0);
+	CHECK(_test_rx_ok(&test_devs[0], &c));
+}
+
+/* A callback queueing the next transfer, and refused submissions */
+static void _test_callbacks(void) {
+	static const uint8_t cmd[] = { 0x01, 0x02 };
+	uint8_t rx[2];
+	spi_xfer_t second = {
+		.dev = &test_devs[1].spi, .tx = cmd, .tx_len = 1, .rx = rx,
+		.rx_len = sizeof(rx), .done = _test_done,
+	};
+	spi_xfer_t first = {
+		.dev = &test_devs[0].spi, .tx = cmd, .tx_len = sizeof(cmd),
+		.done = _test_chain, .arg = &second,
+	};
+	spi_xfer_t empty = { .dev = &test_devs[0].spi };
+	spi_xfer_t big = {
+		.dev = &test_devs[0].spi, .rx_len = SPI_MAX_LEN + 1,
+	};
+
+	_test_reset();
+	CHECK(spi_submit(&first));
+	spi_wait(&first);
+	spi_wait(&second);
+	CHECK(test_done_n == 2 && test_done[0] == &first &&
+			test_done[1] == &second);
+	CHECK(test_log_n == 2 && test_log_dev[1] == 1);
+	CHECK(_test_rx_ok(&test_devs[1], &second));
+
+	CHECK(!spi_submit(&empty));
+	CHECK(!spi_submit(&big));
+
+	/* Nothing left holding the bus */
+	CHECK(!sim_cmu_clock_on[cmuClock_USART1]);
+}
+
+/* Transfers of one length one after the other */
+static void _test_bench(uint16_t len) {
+	static uint8_t buf[SPI_MAX_LEN];
+	spi_xfer_t xfer = {
+		.dev = &test_devs[1].spi, .tx = buf, .tx_len = 1, .rx = buf,
+		.rx_len = len - 1,
+	};
+	uint64_t now = sim_now();
+	uint64_t em1 = sim_stats.ns[1];
+	uint32_t wakes = test_wakes();
+	uint64_t host = 0;
+	uint64_t t0;
+	double bus;
+	double asleep;
+
+	for (uint32_t i = 0; i < TEST_ROUNDS; i++) {
+		t0 = test_ns();
+		CHECK(spi_submit(&xfer));
+		host += test_ns() - t0;
+		spi_wait(&xfer);
+	}
+
+	bus = (double) (sim_now() - now) / TEST_ROUNDS;
+	asleep = (double) (sim_stats.ns[1] - em1) / TEST_ROUNDS;
+	wakes = (test_wakes() - wakes) / TEST_ROUNDS;
+
+	printf("  %4u bytes %8.1f us on the bus, %5.1f %% of it in EM1, %u "
+			"wakeups, %5llu host ns to queue, %7.2f nC (busy-wait %7.2f nC)\n",
+			len, bus / 1000, 100 * asleep / bus, wakes,
+			(unsigned long long) (host / TEST_ROUNDS),
+			(TEST_EM1_NA * asleep + TEST_EM0_NA * (bus - asleep)) / SIM_S(1),
+			TEST_EM0_NA * bus / SIM_S(1));
+
+	/* Asleep for the whole transfer and woken once at its end */
+	CHECK(asleep >= bus * 0.99);
+	CHECK(wakes == 1);
+}
+
+int main(void) {
+	static const uint16_t lens[] = { 2, 7, 64, 256, SPI_MAX_LEN };
+
+	cmu_init();
+	slp_init();
+
+	for (uint32_t i = 0; i < TEST_DEVS; i++) {
+		GPIO_PinModeSet(test_devs[i].spi.port, test_devs[i].spi.pin,
+				gpioModePushPull, 1);
+	}
+	sim_usart_attach(test_devs[0].spi.port, test_devs[0].spi.pin, _test_xfer0);
+	sim_usart_attach(test_devs[1].spi.port, test_devs[1].spi.pin, _test_xfer1);
+	sim_gpio_watch(test_devs[0].spi.port, test_devs[0].spi.pin, _test_cs0);
+	sim_gpio_watch(test_devs[1].spi.port, test_devs[1].spi.pin, _test_cs1);
+
+	spi_init();
+
+	_test_queue();
+	_test_callbacks();
+
+	printf("spi_test: per transfer\n");
+	for (uint32_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+		_test_bench(lens[i]);
+	}
+
+	CHECK(dma_errors() == 0);
+
+	return test_result("spi_test");
+}
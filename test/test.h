@@ -0,0 +1,113 @@
+/**
+ * @file test.h
+ * @brief Helpers shared by the host tests
+ *
+ * This file defines the check macro, result reporting, the host clock used
+ * for the benchmarks and the main loop the simulated firmware runs in. Each
+ * test is a single program linked against the simulation in sim/ and the
+ * firmware files it exercises.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "sim.h"
+#include "evt.h"
+#include "slp.h"
+
+/* Number of failed checks */
+static int test_failures = 0;
+
+/*
+ * @brief Check a condition, reporting where it failed
+ */
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+		test_failures++; \
+	} \
+} while (0)
+
+/**
+ * @brief Host time for benchmarks
+ *
+ * @return Monotonic time in ns
+ */
+static inline uint64_t test_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Run the main loop of main.c up to a time
+ *
+ * Events are dispatched and the core sleeps between them, as in main(),
+ * until the simulated clock reaches the given time. Only tests linking
+ * evt.c and slp.c may call it.
+ *
+ * @param end Simulated time to stop at in ns
+ *
+ * @return Void
+ */
+static inline void test_run_until(uint64_t end) {
+	sim_set_limit(end);
+	while (sim_now() < end) {
+		evt_dispatch();
+		CORE_ATOMIC_IRQ_DISABLE();
+		if (!evt_pending()) {
+			slp_sleep();
+		}
+		CORE_ATOMIC_IRQ_ENABLE();
+	}
+}
+
+/**
+ * @brief Run the main loop of main.c for a while
+ *
+ * @param ns Simulated time to run for in ns
+ *
+ * @return Void
+ */
+static inline void test_run(uint64_t ns) {
+	test_run_until(sim_now() + ns);
+}
+
+/**
+ * @brief Count core wakeups
+ *
+ * @return Number of sleeps in EM1 to EM4 so far
+ */
+static inline uint32_t test_wakes(void) {
+	uint32_t wakes = 0;
+
+	for (int em = 1; em < 5; em++) {
+		wakes += sim_stats.sleeps[em];
+	}
+
+	return wakes;
+}
+
+/**
+ * @brief Report the result of a test
+ *
+ * @param name Name of the test
+ *
+ * @return Exit code for main()
+ */
+static inline int test_result(const char *name) {
+	printf("%s: %s\n", name, test_failures ? "FAIL" : "ok");
+
+	return test_failures ? 1 : 0;
+}
+
+#endif /* __TEST_H__ */
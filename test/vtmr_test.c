@@ -0,0 +1,237 @@
+/**
+ * @file vtmr_test.c
+ * @brief Host test and benchmark for the virtual timer service
+ *
+ * This test runs one-shot and periodic timers on the RTCC model from the
+ * main loop and checks that every timer fires on its tick, that periodic
+ * timers keep their phase and that stopped timers never fire, and that the
+ * start latency the RTCC handler records is zero while the core is free and
+ * the time interrupts were masked past an expiry otherwise. It then
+ * reports the host cost of insert, cancel and expire with 10, 100 and 1000
+ * timers running. The Makefile raises VTMR_MAX to 1000 for it.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "vtmr.h"
+#include "evt.h"
+#include "slp.h"
+#include "cmu.h"
+#include "prof.h"
+#include "em_device.h"
+#include "em_rtcc.h"
+
+_Static_assert(VTMR_MAX >= 1000, "build with VTMR_MAX of at least 1000");
+
+/* Timers in the functional part */
+#define TEST_TIMERS 64
+
+/* Benchmark rounds of every timer */
+#define TEST_ROUNDS 200
+
+/*
+ * @brief A timer and what was expected and seen of it
+ */
+typedef struct test_tmr_s {
+	vtmr_t tmr;
+	uint32_t first;
+	uint32_t period;
+	uint32_t fired;
+	bool late;
+	bool stopped;
+} test_tmr_t;
+
+static test_tmr_t test_tmrs[VTMR_MAX];
+
+static void _test_cb(void *arg) {
+	test_tmr_t *t = arg;
+
+	if (RTCC_CounterGet() != t->first + t->fired * t->period || t->stopped) {
+		t->late = true;
+	}
+	t->fired++;
+}
+
+static void _test_fire(void) {
+	uint32_t ticks;
+	uint32_t fired = 0;
+	uint64_t end = sim_now() + SIM_S(10);
+	vtmr_t extra;
+	prof_hist_t hist;
+
+	prof_clear();
+
+	for (uint32_t i = 0; i < TEST_TIMERS; i++) {
+		test_tmr_t *t = &test_tmrs[i];
+
+		ticks = 1 + rand() % VTMR_MS(5000);
+		vtmr_create(&t->tmr, _test_cb, t);
+		t->first = RTCC_CounterGet() + ticks;
+		t->period = (i % 4 == 0) ? 1 + rand() % VTMR_MS(1000) : 0;
+		CHECK(vtmr_start(&t->tmr, ticks, t->period));
+	}
+
+	/* Stop every third before it fires */
+	for (uint32_t i = 0; i < TEST_TIMERS; i += 3) {
+		test_tmrs[i].stopped = true;
+		CHECK(vtmr_stop(&test_tmrs[i].tmr));
+		CHECK(!vtmr_active(&test_tmrs[i].tmr));
+	}
+	CHECK(!vtmr_stop(&test_tmrs[0].tmr));
+
+	test_run_until(end);
+
+	for (uint32_t i = 0; i < TEST_TIMERS; i++) {
+		test_tmr_t *t = &test_tmrs[i];
+		uint32_t now = RTCC_CounterGet();
+
+		CHECK(!t->late);
+		if (t->stopped) {
+			CHECK(t->fired == 0);
+		} else if (t->period) {
+			CHECK(t->fired == (now - t->first) / t->period + 1);
+			CHECK(vtmr_active(&t->tmr));
+		} else {
+			CHECK(t->fired == 1);
+			CHECK(!vtmr_active(&t->tmr));
+		}
+		fired += t->fired;
+		vtmr_stop(&t->tmr);
+	}
+
+	/* No room past VTMR_MAX */
+	for (uint32_t i = 0; i < VTMR_MAX; i++) {
+		vtmr_create(&test_tmrs[i].tmr, _test_cb, &test_tmrs[i]);
+		CHECK(vtmr_start(&test_tmrs[i].tmr, VTMR_MS(1000), 0));
+	}
+	vtmr_create(&extra, _test_cb, NULL);
+	CHECK(!vtmr_start(&extra, 1, 0));
+	for (uint32_t i = 0; i < VTMR_MAX; i++) {
+		CHECK(vtmr_stop(&test_tmrs[i].tmr));
+	}
+	CHECK(vtmr_nextWake() == SLP_WAKE_NONE);
+
+	/* Every expiry woke the core on its tick */
+	prof_get(PROF_RTCC, &hist);
+	CHECK(hist.count > 0);
+	CHECK(hist.lat_max == 0);
+
+	printf("vtmr_test: %u timers fired %u times in 10 s\n", TEST_TIMERS, fired);
+}
+
+/* Expiries in the benchmark */
+static uint32_t test_expired = 0;
+
+static void _test_count(void *arg) {
+	test_expired++;
+}
+
+/* With interrupts masked past the expiry the handler starts late by that
+ * many ticks, to a tick */
+static void _test_late(void) {
+	uint32_t tick = PROF_CORE_FREQ / VTMR_FREQ;
+	vtmr_t tmr;
+	prof_hist_t hist;
+
+	prof_clear();
+	test_expired = 0;
+	vtmr_create(&tmr, _test_count, NULL);
+	CHECK(vtmr_start(&tmr, 10, 0));
+
+	CORE_ATOMIC_IRQ_DISABLE();
+	sim_cpu(25 * tick);
+	CORE_ATOMIC_IRQ_ENABLE();
+
+	prof_get(PROF_RTCC, &hist);
+	printf("vtmr_test: masked for 25 ticks past a 10 tick timer, started "
+			"%u cycles late\n", hist.lat_max);
+	CHECK(test_expired == 1);
+	CHECK(hist.count == 1);
+	CHECK(hist.lat_max >= 14 * tick && hist.lat_max <= 16 * tick);
+	CHECK(hist.lat[prof_bucket(hist.lat_max)] == 1);
+}
+
+/* Host cost of each operation with a number of timers running */
+static void _test_bench(uint32_t n) {
+	uint64_t insert = 0;
+	uint64_t cancel = 0;
+	uint64_t expire = 0;
+	uint64_t t0;
+	uint32_t half = (n + 1) / 2;
+	uint32_t ticks[VTMR_MAX];
+
+	memset(test_tmrs, 0, sizeof(test_tmrs));
+	for (uint32_t i = 0; i < n; i++) {
+		vtmr_create(&test_tmrs[i].tmr, _test_count, NULL);
+		vtmr_start(&test_tmrs[i].tmr, 1000 + rand() % 100000, 0);
+	}
+
+	/* Take half out at random and put them back */
+	for (uint32_t r = 0; r < TEST_ROUNDS; r++) {
+		uint32_t base = rand() % n;
+
+		for (uint32_t i = 0; i < half; i++) {
+			ticks[i] = 1000 + rand() % 100000;
+		}
+
+		t0 = test_ns();
+		for (uint32_t i = 0; i < half; i++) {
+			vtmr_stop(&test_tmrs[(base + i * 7) % n].tmr);
+		}
+		cancel += test_ns() - t0;
+
+		t0 = test_ns();
+		for (uint32_t i = 0; i < half; i++) {
+			vtmr_start(&test_tmrs[(base + i * 7) % n].tmr, ticks[i], 0);
+		}
+		insert += test_ns() - t0;
+	}
+
+	/* All periodic and due in the next n ticks, then let them expire in one
+	 * go. The timers go back into the heap, as periodic timers do. */
+	for (uint32_t i = 0; i < n; i++) {
+		vtmr_start(&test_tmrs[i].tmr, 1 + i, 2 * n);
+	}
+	test_expired = 0;
+	for (uint32_t r = 0; r < TEST_ROUNDS / 10; r++) {
+		CORE_ATOMIC_IRQ_DISABLE();
+		sim_cpu((uint64_t) (2 * n) * SIM_HF_FREQ / VTMR_FREQ);
+		t0 = test_ns();
+		CORE_ATOMIC_IRQ_ENABLE();
+		expire += test_ns() - t0;
+	}
+	CHECK(test_expired == TEST_ROUNDS / 10 * n);
+
+	for (uint32_t i = 0; i < n; i++) {
+		vtmr_stop(&test_tmrs[i].tmr);
+	}
+
+	printf("vtmr_test: %4u timers, %6.1f host ns insert, %6.1f cancel, "
+			"%6.1f expire\n", n,
+			(double) insert / (TEST_ROUNDS * half),
+			(double) cancel / (TEST_ROUNDS * half),
+			(double) expire / (TEST_ROUNDS / 10 * n));
+}
+
+int main(void) {
+	cmu_init();
+	prof_init();
+	evt_init();
+	slp_init();
+	vtmr_init();
+
+	srand(14);
+	_test_fire();
+	_test_late();
+
+	_test_bench(10);
+	_test_bench(100);
+	_test_bench(1000);
+
+	return test_result("vtmr_test");
+}
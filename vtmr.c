@@ -0,0 +1,230 @@
+/**
+ * @file vtmr.c
+ * @brief The implementation for the virtual timer service
+ *
+ * This file implements software timers on an RTCC compare channel. See the
+ * associated header file for function descriptions.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#include "vtmr.h"
+#include "em_rtcc.h"
+#include "prof.h"
+
+/* Interrupt flag of the compare channel */
+#define VTMR_IF (RTCC_IF_CC0 << VTMR_CC)
+
+/* Running timers, heap[0] expires first */
+static vtmr_t *vtmr_heap[VTMR_MAX];
+static uint32_t vtmr_num = 0;
+
+/* Expiry order, the RTCC counter wraps so compare the signed difference */
+static bool _vtmr_before(const vtmr_t *a, const vtmr_t *b) {
+	return (int32_t) (a->expire - b->expire) < 0;
+}
+
+/* Put a timer at a heap slot */
+static void _vtmr_place(uint32_t i, vtmr_t *tmr) {
+	vtmr_heap[i] = tmr;
+	tmr->idx = i;
+}
+
+/* Move a timer towards the root until its parent expires first */
+static void _vtmr_up(uint32_t i) {
+	vtmr_t *tmr = vtmr_heap[i];
+
+	while (i > 0 && _vtmr_before(tmr, vtmr_heap[(i - 1) / 2])) {
+		_vtmr_place(i, vtmr_heap[(i - 1) / 2]);
+		i = (i - 1) / 2;
+	}
+	_vtmr_place(i, tmr);
+}
+
+/* Move a timer towards the leaves until both children expire later */
+static void _vtmr_down(uint32_t i) {
+	vtmr_t *tmr = vtmr_heap[i];
+	uint32_t c;
+
+	while ((c = 2 * i + 1) < vtmr_num) {
+		if (c + 1 < vtmr_num && _vtmr_before(vtmr_heap[c + 1], vtmr_heap[c])) {
+			c++;
+		}
+		if (!_vtmr_before(vtmr_heap[c], tmr)) {
+			break;
+		}
+		_vtmr_place(i, vtmr_heap[c]);
+		i = c;
+	}
+	_vtmr_place(i, tmr);
+}
+
+/* Add a timer, caller checks there is room */
+static void _vtmr_insert(vtmr_t *tmr) {
+	if (vtmr_num++ == 0) {
+		slp_blockSleepMode(VTMR_EM);
+	}
+	_vtmr_place(vtmr_num - 1, tmr);
+	_vtmr_up(vtmr_num - 1);
+}
+
+/* Take a running timer out of the heap */
+static void _vtmr_remove(vtmr_t *tmr) {
+	uint32_t i = tmr->idx;
+	vtmr_t *last = vtmr_heap[--vtmr_num];
+
+	tmr->idx = VTMR_IDLE;
+
+	if (i != vtmr_num) {
+		_vtmr_place(i, last);
+		_vtmr_up(i);
+		_vtmr_down(last->idx);
+	}
+
+	if (vtmr_num == 0) {
+		slp_unblockSleepMode(VTMR_EM);
+	}
+}
+
+/* Point the compare channel at the earliest expiry. If that time has
+ * already passed the match is missed, so pend the interrupt by hand. */
+static void _vtmr_arm(void) {
+	if (vtmr_num == 0) {
+		RTCC_IntDisable(VTMR_IF);
+		return;
+	}
+
+	RTCC_ChannelCCVSet(VTMR_CC, vtmr_heap[0]->expire);
+	RTCC_IntEnable(VTMR_IF);
+
+	if ((int32_t) (vtmr_heap[0]->expire - RTCC_CounterGet()) <= 0) {
+		RTCC_IntSet(VTMR_IF);
+	}
+}
+
+void RTCC_IRQHandler(void) {
+	PROF_ISR_ENTER(PROF_RTCC);
+
+	vtmr_t *tmr;
+
+	/* The counter has moved on from the compare value since the match */
+	PROF_ISR_LATENCY(PROF_RTCC, prof_ago(_prof_start,
+			RTCC_CounterGet() - RTCC_ChannelCCVGet(VTMR_CC), VTMR_FREQ));
+
+	RTCC_IntClear(VTMR_IF);
+
+	/* Callbacks run with interrupts enabled and may start or stop timers */
+	while (1) {
+		CORE_ATOMIC_IRQ_DISABLE();
+		if (vtmr_num == 0 ||
+			(int32_t) (vtmr_heap[0]->expire - RTCC_CounterGet()) > 0) {
+			_vtmr_arm();
+			CORE_ATOMIC_IRQ_ENABLE();
+			break;
+		}
+
+		tmr = vtmr_heap[0];
+		if (tmr->period) {
+			/* Keep the original phase */
+			tmr->expire += tmr->period;
+			_vtmr_down(0);
+		} else {
+			_vtmr_remove(tmr);
+		}
+		CORE_ATOMIC_IRQ_ENABLE();
+
+		tmr->cb(tmr->arg);
+	}
+
+	PROF_ISR_EXIT(PROF_RTCC);
+}
+
+void vtmr_create(vtmr_t *tmr, void (*cb)(void *arg), void *arg) {
+	tmr->expire = 0;
+	tmr->period = 0;
+	tmr->cb = cb;
+	tmr->arg = arg;
+	tmr->idx = VTMR_IDLE;
+}
+
+bool vtmr_start(vtmr_t *tmr, uint32_t ticks, uint32_t period) {
+
+	if (ticks == 0) {
+		ticks = 1;
+	}
+
+	CORE_ATOMIC_IRQ_DISABLE();
+
+	if (tmr->idx != VTMR_IDLE) {
+		_vtmr_remove(tmr);
+	} else if (vtmr_num >= VTMR_MAX) {
+		CORE_ATOMIC_IRQ_ENABLE();
+		return false;
+	}
+
+	tmr->expire = RTCC_CounterGet() + ticks;
+	tmr->period = period;
+	_vtmr_insert(tmr);
+
+	/* New earliest expiry */
+	if (tmr->idx == 0) {
+		_vtmr_arm();
+	}
+
+	CORE_ATOMIC_IRQ_ENABLE();
+
+	return true;
+}
+
+bool vtmr_stop(vtmr_t *tmr) {
+	bool running;
+
+	CORE_ATOMIC_IRQ_DISABLE();
+
+	running = tmr->idx != VTMR_IDLE;
+	if (running) {
+		_vtmr_remove(tmr);
+		_vtmr_arm();
+	}
+
+	CORE_ATOMIC_IRQ_ENABLE();
+
+	return running;
+}
+
+bool vtmr_active(const vtmr_t *tmr) {
+	return tmr->idx != VTMR_IDLE;
+}
+
+uint32_t vtmr_nextWake(void) {
+	int32_t ticks;
+
+	if (vtmr_num == 0) {
+		return SLP_WAKE_NONE;
+	}
+
+	ticks = (int32_t) (vtmr_heap[0]->expire - RTCC_CounterGet());
+	if (ticks <= 0) {
+		return 0;
+	}
+
+	return (uint32_t) ((uint64_t) ticks * 1000000 / VTMR_FREQ);
+}
+
+void vtmr_init(void) {
+	RTCC_CCChConf_TypeDef cc_init = RTCC_CH_INIT_COMPARE_DEFAULT;
+
+	RTCC_ChannelInit(VTMR_CC, &cc_init);
+	RTCC_IntDisable(VTMR_IF);
+	RTCC_IntClear(VTMR_IF);
+
+	/* Let the sleep governor know when we wake up next */
+	slp_registerWakeSource(vtmr_nextWake);
+
+	NVIC_ClearPendingIRQ(RTCC_IRQn);
+	NVIC_EnableIRQ(RTCC_IRQn);
+
+	return;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file vtmr.h
+ * @brief Definitions and interfaces for the virtual timer service
+ *
+ * This file declares a software timer service that multiplexes any number of
+ * one-shot and periodic timers on a single RTCC compare channel. Running
+ * timers are kept in a min-heap ordered by expiry time.
+ *
+ * @date October 16 2026
+ * @version 1.0
+ *
+ */
+
+#ifndef __VTMR_H__
+#define __VTMR_H__
+
+#include "main.h"
+#include "slp.h"
+
+/*
+ * @brief Maximum number of timers running at once
+ *
+ * The heap costs a pointer per timer. The firmware needs a handful, builds
+ * that need more (the host benchmark runs 1000) can define it up to
+ * VTMR_IDLE - 1.
+ */
+#ifndef VTMR_MAX
+#define VTMR_MAX 16
+#endif
+
+/*
+ * @brief RTCC compare channel used by the service
+ */
+#define VTMR_CC 1
+
+/*
+ * @brief Tick rate of the service in Hz (the RTCC counter)
+ */
+#define VTMR_FREQ SLP_RTCC_FREQ
+
+/*
+ * @brief Energy mode to block while any timer runs, the RTCC runs from the
+ * LFXO which is stopped in EM3
+ */
+#define VTMR_EM 2
+
+/*
+ * @brief Convert milliseconds to ticks, rounding up
+ */
+#define VTMR_MS(ms) ((uint32_t) (((uint64_t) (ms) * VTMR_FREQ + 999) / 1000))
+
+/*
+ * @brief Heap index of a timer that is not running
+ */
+#define VTMR_IDLE 0xffff
+
+_Static_assert(VTMR_MAX < VTMR_IDLE, "VTMR_MAX too large for the heap index");
+
+/*
+ * @brief Virtual timer
+ *
+ * Owned by the caller, the service only keeps a pointer to it while it runs.
+ * Fields are private to the service.
+ */
+typedef struct vtmr_s {
+	uint32_t expire;
+	uint32_t period;
+	void (*cb)(void *arg);
+	void *arg;
+	uint16_t idx;
+} vtmr_t;
+
+/**
+ * @brief Set up a timer
+ *
+ * This function must be called once on a timer before it is started.
+ *
+ * @param tmr The timer
+ * @param cb Function called on expiry
+ * @param arg Passed to the function
+ *
+ * @return Void
+ */
+void vtmr_create(vtmr_t *tmr, void (*cb)(void *arg), void *arg);
+
+/**
+ * @brief Start a timer
+ *
+ * This function starts a timer, restarting it if it is already running. The
+ * callback runs from the RTCC interrupt handler, so it should be short,
+ * typically posting an event. A one-shot timer expires at least ticks - 1
+ * full ticks from now.
+ *
+ * @param tmr The timer
+ * @param ticks Ticks until the first expiry, at least 1
+ * @param period Ticks between later expiries, 0 for a one-shot timer
+ *
+ * @return False if too many timers are running
+ */
+bool vtmr_start(vtmr_t *tmr, uint32_t ticks, uint32_t period);
+
+/**
+ * @brief Stop a timer
+ *
+ * @param tmr The timer
+ *
+ * @return True if the timer was running
+ */
+bool vtmr_stop(vtmr_t *tmr);
+
+/**
+ * @brief Check if a timer is running
+ *
+ * @param tmr The timer
+ *
+ * @return True if the timer is running
+ */
+bool vtmr_active(const vtmr_t *tmr);
+
+/**
+ * @brief Time until the next expiry
+ *
+ * This function is registered with the sleep manager as a wake source.
+ *
+ * @return Microseconds until the earliest timer expires, or SLP_WAKE_NONE
+ */
+uint32_t vtmr_nextWake(void);
+
+/**
+ * @brief Initializes the virtual timer service
+ *
+ * This function sets up the RTCC compare channel and its interrupt. The RTCC
+ * must already be running.
+ *
+ * @return Void
+ */
+void vtmr_init(void);
+
+#endif /* __VTMR_H__ */